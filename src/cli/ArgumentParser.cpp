@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <fstream>
+#include <mutex>
 #include <thread>
 #include <termios.h>
 #include <unistd.h>
@@ -123,6 +126,10 @@ void ArgumentParser::parse()
 	{
 		processResource();
 	}
+	else if (cmd == "batch")
+	{
+		processAppBatch();
+	}
 	else if (cmd == "enable")
 	{
 		processAppControl(true);
@@ -202,6 +209,7 @@ void ArgumentParser::printMainHelp()
 	std::cout << "  enable      Enable a application" << std::endl;
 	std::cout << "  disable     Disable a application" << std::endl;
 	std::cout << "  restart     Restart a application" << std::endl;
+	std::cout << "  batch       Register/enable/disable/remove applications in batch" << std::endl;
 	std::cout << std::endl;
 
 	std::cout << "  join        Join to a Consul cluster" << std::endl;
@@ -349,7 +357,7 @@ void ArgumentParser::processAppAdd()
 		("perm", po::value<int>(), "application user permission, value is 2 bit integer: [group & other], each bit can be deny:1, read:2, write: 3.")
 		("cmd,c", po::value<std::string>(), "full command line with arguments")
 		("shell_mode,S", "use shell mode, cmd can be more commands")
-		("health_check,l", po::value<std::string>(), "health check script command (e.g., sh -x 'curl host:port/health', return 0 is health)")
+		("health_check,l", po::value<std::string>(), "health check script command (e.g., sh -x 'curl host:port/health', return 0 is health) or native probe: http://ip:port/path [status], tcp://ip:port, unix:///path, file:///path [max age seconds], pid://")
 		("docker_image,d", po::value<std::string>(), "docker image which used to run command line (for docker container application)")
 		("workdir,w", po::value<std::string>(), "working directory")
 		("status,s", po::value<bool>()->default_value(true), "initial application status (true is enable, false is disabled)")
@@ -589,6 +597,7 @@ void ArgumentParser::processAppDel()
 	}
 
 	auto appNames = m_commandLineVariables["name"].as<std::vector<std::string>>();
+	std::vector<std::string> removeList;
 	for (auto appName : appNames)
 	{
 		if (isAppExist(appName))
@@ -601,15 +610,23 @@ void ArgumentParser::processAppDel()
 					return;
 				}
 			}
-			std::string restPath = std::string("/appmesh/app/") + appName;
-			auto response = requestHttp(true, methods::DEL, restPath);
-			std::cout << parseOutputMessage(response) << std::endl;
+			removeList.push_back(appName);
 		}
 		else
 		{
 			throw std::invalid_argument(Utility::stringFormat("No such application <%s>", appName.c_str()));
 		}
 	}
+	if (removeList.size() == 1)
+	{
+		std::string restPath = std::string("/appmesh/app/") + removeList.front();
+		auto response = requestHttp(true, methods::DEL, restPath);
+		std::cout << parseOutputMessage(response) << std::endl;
+	}
+	else if (removeList.size() > 1)
+	{
+		batchAppOperation(JSON_KEY_BATCH_action_remove, removeList);
+	}
 }
 
 void ArgumentParser::processAppView()
@@ -620,6 +637,10 @@ void ArgumentParser::processAppView()
 		COMMON_OPTIONS
 		("name,n", po::value<std::string>(), "application name.")
 		("long,l", "display the complete information without reduce")
+		("pattern,p", po::value<std::string>(), "filter application name with wildcards pattern.")
+		("status,s", po::value<std::string>(), "filter application status: enabled, disabled.")
+		("owner,w", po::value<std::string>(), "filter application owner.")
+		("label,L", po::value<std::string>(), "filter application metadata with key=value.")
 		("output,o", "view the application output")
 		("stdout_index,O", po::value<int>(), "application output index")
 		("tail,t", "continue view the application output");
@@ -669,7 +690,17 @@ void ArgumentParser::processAppView()
 	else
 	{
 		std::string restPath = "/appmesh/applications";
-		auto response = requestHttp(true, methods::GET, restPath);
+		// server side filter
+		std::map<std::string, std::string> query;
+		if (m_commandLineVariables.count("pattern"))
+			query[HTTP_QUERY_KEY_app_name] = m_commandLineVariables["pattern"].as<std::string>();
+		if (m_commandLineVariables.count("status"))
+			query[HTTP_QUERY_KEY_app_status] = m_commandLineVariables["status"].as<std::string>();
+		if (m_commandLineVariables.count("owner"))
+			query[HTTP_QUERY_KEY_app_owner] = m_commandLineVariables["owner"].as<std::string>();
+		if (m_commandLineVariables.count("label"))
+			query[HTTP_QUERY_KEY_app_label] = m_commandLineVariables["label"].as<std::string>();
+		auto response = requestHttp(true, methods::GET, restPath, query);
 		printApps(response.extract_json(true).get(), reduce);
 	}
 }
@@ -754,18 +785,81 @@ void ArgumentParser::processAppControl(bool start)
 			appList.push_back(appName);
 		}
 	}
-	for (auto app : appList)
+	if (appList.size() == 1)
 	{
-		std::string restPath = std::string("/appmesh/app/") + app + +"/" + (start ? HTTP_QUERY_KEY_action_start : HTTP_QUERY_KEY_action_stop);
+		std::string restPath = std::string("/appmesh/app/") + appList.front() + +"/" + (start ? HTTP_QUERY_KEY_action_start : HTTP_QUERY_KEY_action_stop);
 		auto response = requestHttp(true, methods::POST, restPath);
 		std::cout << parseOutputMessage(response) << std::endl;
 	}
+	else if (appList.size() > 1)
+	{
+		// one request and one configuration flush for multiple applications
+		batchAppOperation(start ? JSON_KEY_BATCH_action_enable : JSON_KEY_BATCH_action_disable, appList);
+	}
 	if (appList.size() == 0)
 	{
 		std::cout << "No application processed." << std::endl;
 	}
 }
 
+void ArgumentParser::processAppBatch()
+{
+	po::options_description desc("Register/enable/disable/remove applications in batch:", BOOST_DESC_WIDTH);
+	desc.add_options()
+		("help,h", "Prints command usage to stdout and exits")
+		COMMON_OPTIONS
+		("file,f", po::value<std::string>(), "JSON file with operation array: [{\"action\": \"add|enable|disable|remove\", \"name\": \"app\", \"app\": {}}]")
+		("stdin", "accept operation JSON array from stdin");
+
+	shiftCommandLineArgs(desc);
+	HELP_ARG_CHECK_WITH_RETURN;
+	if (m_commandLineVariables.count("file") == 0 && m_commandLineVariables.count("stdin") == 0)
+	{
+		std::cout << desc << std::endl;
+		return;
+	}
+
+	web::json::value operations;
+	if (m_commandLineVariables.count("stdin"))
+	{
+		operations = web::json::value::parse(Utility::readStdin2End());
+	}
+	else
+	{
+		const auto file = m_commandLineVariables["file"].as<std::string>();
+		if (!Utility::isFileExist(file))
+		{
+			throw std::invalid_argument(Utility::stringFormat("file <%s> not exist", file.c_str()));
+		}
+		operations = web::json::value::parse(Utility::readFileCpp(file));
+	}
+	printBatchResult(requestHttp(true, methods::POST, "/appmesh/applications/batch", operations));
+}
+
+void ArgumentParser::batchAppOperation(const std::string &action, const std::vector<std::string> &appNames)
+{
+	auto operations = web::json::value::array(appNames.size());
+	for (std::size_t i = 0; i < appNames.size(); ++i)
+	{
+		operations[i][JSON_KEY_BATCH_action] = web::json::value::string(action);
+		operations[i][JSON_KEY_BATCH_name] = web::json::value::string(appNames[i]);
+	}
+	printBatchResult(requestHttp(true, methods::POST, "/appmesh/applications/batch", operations));
+}
+
+void ArgumentParser::printBatchResult(http_response response)
+{
+	for (const auto &item : response.extract_json(true).get().as_array())
+	{
+		const auto name = GET_JSON_STR_VALUE(item, JSON_KEY_BATCH_name);
+		const auto action = GET_JSON_STR_VALUE(item, JSON_KEY_BATCH_action);
+		if (GET_JSON_BOOL_VALUE(item, JSON_KEY_BATCH_success))
+			std::cout << action << " <" << name << "> success." << std::endl;
+		else
+			std::cout << action << " <" << name << "> failed: " << GET_JSON_STR_VALUE(item, REST_TEXT_MESSAGE_JSON_KEY) << std::endl;
+	}
+}
+
 void ArgumentParser::processAppRun()
 {
 	po::options_description desc("Run commands or application:", BOOST_DESC_WIDTH);
@@ -1119,6 +1213,7 @@ void ArgumentParser::processFileDownload()
 		COMMON_OPTIONS
 		("remote,r", po::value<std::string>(), "remote file path to download")
 		("local,l", po::value<std::string>(), "local file path to save")
+		("parallel,n", po::value<int>()->default_value(1), "parallel ranged download connections")
 		("help,h", "Prints command usage to stdout and exits");
 	shiftCommandLineArgs(desc);
 	HELP_ARG_CHECK_WITH_RETURN;
@@ -1132,15 +1227,64 @@ void ArgumentParser::processFileDownload()
 	std::string restPath = "/appmesh/file/download";
 	auto file = m_commandLineVariables["remote"].as<std::string>();
 	auto local = m_commandLineVariables["local"].as<std::string>();
+	auto parallel = std::max(1, m_commandLineVariables["parallel"].as<int>());
+	const std::size_t chunkSize = FILE_TRANSFER_CHUNK_SIZE;
+
+	// first chunk get total size and ETag
 	std::map<std::string, std::string> query, headers;
 	headers[HTTP_HEADER_KEY_file_path] = file;
-	auto response = requestHttp(true, methods::GET, restPath, query, nullptr, &headers);
-
-	auto stream = concurrency::streams::fstream::open_ostream(local, std::ios::out | std::ios::binary | std::ios::trunc).get();
-	response.body().read_to_end(stream.streambuf()).wait();
-
-	std::cout << "Download file <" << local << "> size <" << Utility::humanReadableSize(stream.streambuf().size()) << ">" << std::endl;
-	stream.close();
+	headers[HTTP_HEADER_KEY_range] = Utility::stringFormat("bytes=0-%zu", chunkSize - 1);
+	auto response = requestHttp(false, methods::GET, restPath, query, nullptr, &headers);
+	if (response.status_code() != status_codes::OK && response.status_code() != status_codes::PartialContent)
+	{
+		throw std::invalid_argument(parseOutputMessage(response));
+	}
+	std::size_t fileSize = 0;
+	if (response.status_code() == status_codes::PartialContent && response.headers().has(HTTP_HEADER_KEY_content_range))
+	{
+		// Content-Range: bytes 0-1023/4096
+		const auto contentRange = response.headers().find(HTTP_HEADER_KEY_content_range)->second;
+		fileSize = std::stoull(contentRange.substr(contentRange.find('/') + 1));
+	}
+	const auto etag = response.headers().has(HTTP_HEADER_KEY_etag) ? response.headers().find(HTTP_HEADER_KEY_etag)->second : std::string();
+	const auto firstChunk = response.extract_vector().get();
+	{
+		std::ofstream stream(local, std::ios::out | std::ios::binary | std::ios::trunc);
+		stream.write(reinterpret_cast<const char *>(firstChunk.data()), firstChunk.size());
+	}
+	fileSize = std::max(fileSize, firstChunk.size());
+
+	// rest chunks with ranged request
+	std::vector<std::size_t> offsets;
+	for (std::size_t offset = firstChunk.size(); offset < fileSize; offset += chunkSize)
+	{
+		offsets.push_back(offset);
+	}
+	transferChunks(offsets, parallel, [&](std::size_t offset)
+				   {
+					   const auto length = std::min(chunkSize, fileSize - offset);
+					   std::map<std::string, std::string> chunkQuery, chunkHeaders;
+					   chunkHeaders[HTTP_HEADER_KEY_file_path] = file;
+					   chunkHeaders[HTTP_HEADER_KEY_range] = Utility::stringFormat("bytes=%zu-%zu", offset, offset + length - 1);
+					   if (etag.length())
+						   chunkHeaders[HTTP_HEADER_KEY_if_range] = etag;
+					   auto chunkResponse = requestHttp(false, methods::GET, restPath, chunkQuery, nullptr, &chunkHeaders);
+					   if (chunkResponse.status_code() != status_codes::PartialContent)
+					   {
+						   // remote file changed (If-Range mismatch) or failed
+						   throw std::invalid_argument(Utility::stringFormat("download range <%zu> failed: %s", offset, parseOutputMessage(chunkResponse).c_str()));
+					   }
+					   const auto data = chunkResponse.extract_vector().get();
+					   if (data.size() != length)
+					   {
+						   throw std::invalid_argument(Utility::stringFormat("download range <%zu> incomplete", offset));
+					   }
+					   std::fstream stream(local, std::ios::in | std::ios::out | std::ios::binary);
+					   stream.seekp(offset);
+					   stream.write(reinterpret_cast<const char *>(data.data()), data.size());
+				   });
+
+	std::cout << "Download file <" << local << "> size <" << Utility::humanReadableSize(fileSize) << ">" << std::endl;
 
 	if (response.headers().has(HTTP_HEADER_KEY_file_mode))
 		os::fileChmod(local, std::stoi(response.headers().find(HTTP_HEADER_KEY_file_mode)->second));
@@ -1157,6 +1301,7 @@ void ArgumentParser::processFileUpload()
 		COMMON_OPTIONS
 		("remote,r", po::value<std::string>(), "remote file path to save")
 		("local,l", po::value<std::string>(), "local file to upload")
+		("parallel,n", po::value<int>()->default_value(1), "parallel chunk upload connections")
 		("help,h", "Prints command usage to stdout and exits");
 	shiftCommandLineArgs(desc);
 	HELP_ARG_CHECK_WITH_RETURN;
@@ -1169,39 +1314,130 @@ void ArgumentParser::processFileUpload()
 
 	auto file = m_commandLineVariables["remote"].as<std::string>();
 	auto local = m_commandLineVariables["local"].as<std::string>();
+	auto parallel = std::max(1, m_commandLineVariables["parallel"].as<int>());
+	const std::size_t chunkSize = FILE_TRANSFER_CHUNK_SIZE;
 
 	if (!Utility::isFileExist(local))
 	{
 		std::cout << "local file not exist" << std::endl;
 		return;
 	}
-	// https://msdn.microsoft.com/en-us/magazine/dn342869.aspx
-
-	auto fileStream = concurrency::streams::file_stream<uint8_t>::open_istream(local, std::ios_base::binary).get();
-	// Get the content length, which is used to set the
-	// Content-Length property
-	fileStream.seek(0, std::ios::end);
-	auto length = static_cast<std::size_t>(fileStream.tell());
-	fileStream.seek(0, std::ios::beg);
+	std::size_t fileSize = 0;
+	{
+		std::ifstream stream(local, std::ios::in | std::ios::binary | std::ios::ate);
+		fileSize = static_cast<std::size_t>(stream.tellg());
+	}
 	auto fileInfo = os::fileStat(local);
+	// identify file content, server restart the upload when the unfinished one is another file
+	const auto fileChecksum = Utility::fileChecksum(local);
 
+	std::string restPath = "/appmesh/file/upload";
 	std::map<std::string, std::string> query, header;
 	header[HTTP_HEADER_KEY_file_path] = file;
+
+	// resume unfinished upload of the same file: skip chunks already received by server
+	std::vector<std::pair<std::size_t, std::size_t>> received;
+	auto status = requestHttp(true, methods::GET, restPath, query, nullptr, &header).extract_json(true).get();
+	if (GET_JSON_NUMBER_VALUE(status, JSON_KEY_FILE_size) == static_cast<int64_t>(fileSize) &&
+		GET_JSON_STR_VALUE(status, JSON_KEY_FILE_checksum) == fileChecksum && HAS_JSON_FIELD(status, JSON_KEY_FILE_received))
+	{
+		for (const auto &range : status.at(JSON_KEY_FILE_received).as_array())
+		{
+			received.push_back(std::make_pair(range.at(0).as_number().to_uint64(), range.at(1).as_number().to_uint64()));
+		}
+	}
+	std::vector<std::size_t> offsets;
+	for (std::size_t offset = 0; offset < fileSize || (fileSize == 0 && offsets.empty()); offset += chunkSize)
+	{
+		const auto length = std::min(chunkSize, fileSize - offset);
+		const bool uploaded = std::any_of(received.begin(), received.end(), [&](const std::pair<std::size_t, std::size_t> &range)
+										  { return range.first <= offset && offset + length <= range.first + range.second; });
+		if (!uploaded)
+			offsets.push_back(offset);
+	}
+	if (received.size())
+	{
+		std::cout << "Resume upload <" << local << "> with <" << offsets.size() << "> chunks left" << std::endl;
+	}
+
 	header[HTTP_HEADER_KEY_file_mode] = std::to_string(std::get<0>(fileInfo));
 	header[HTTP_HEADER_KEY_file_user] = std::to_string(std::get<1>(fileInfo));
 	header[HTTP_HEADER_KEY_file_group] = std::to_string(std::get<2>(fileInfo));
+	header[HTTP_HEADER_KEY_file_size] = std::to_string(fileSize);
+	header[HTTP_HEADER_KEY_file_checksum] = fileChecksum;
+	transferChunks(offsets, parallel, [&](std::size_t offset)
+				   {
+					   std::vector<unsigned char> data(std::min(chunkSize, fileSize - offset));
+					   {
+						   std::ifstream stream(local, std::ios::in | std::ios::binary);
+						   stream.seekg(offset);
+						   stream.read(reinterpret_cast<char *>(data.data()), data.size());
+					   }
+					   std::map<std::string, std::string> chunkQuery, chunkHeader = header;
+					   chunkHeader[HTTP_HEADER_KEY_upload_offset] = std::to_string(offset);
+					   chunkHeader[HTTP_HEADER_KEY_upload_checksum] = Utility::checksum(reinterpret_cast<const char *>(data.data()), data.size());
+
+					   // Create http_client to send the request.
+					   http_client_config config;
+					   config.set_timeout(std::chrono::seconds(200));
+					   config.set_validate_certificates(false);
+					   http_client client(m_url, config);
+					   auto request = createRequest(methods::POST, restPath, chunkQuery, &chunkHeader);
+					   request.set_body(std::move(data));
+					   http_response response = client.request(request).get();
+					   if (response.status_code() != status_codes::OK)
+					   {
+						   throw std::invalid_argument(Utility::stringFormat("upload chunk <%zu> failed: %s", offset, parseOutputMessage(response).c_str()));
+					   }
+				   });
+	std::cout << "Upload file <" << file << "> size <" << Utility::humanReadableSize(fileSize) << ">" << std::endl;
+}
 
-	// Create http_client to send the request.
-	http_client_config config;
-	config.set_timeout(std::chrono::seconds(200));
-	config.set_validate_certificates(false);
-	http_client client(m_url, config);
-	std::string restPath = "/appmesh/file/upload";
-	auto request = createRequest(methods::POST, restPath, query, &header);
-	request.set_body(fileStream, length);
-	http_response response = client.request(request).get();
-	fileStream.close();
-	std::cout << parseOutputMessage(response) << std::endl;
+void ArgumentParser::transferChunks(const std::vector<std::size_t> &offsets, int parallel, const std::function<void(std::size_t)> &transfer)
+{
+	std::atomic<std::size_t> next(0);
+	std::mutex errorMutex;
+	std::string error;
+	auto worker = [&]()
+	{
+		std::size_t index;
+		while ((index = next++) < offsets.size())
+		{
+			for (int retry = 1;; retry++)
+			{
+				try
+				{
+					transfer(offsets[index]);
+					break;
+				}
+				catch (const std::exception &e)
+				{
+					if (retry >= FILE_TRANSFER_RETRY_TIMES)
+					{
+						std::lock_guard<std::mutex> guard(errorMutex);
+						error = e.what();
+						next = offsets.size(); // stop other workers
+						return;
+					}
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (int i = 1; i < std::min<int>(parallel, offsets.size()); i++)
+	{
+		workers.push_back(std::thread(worker));
+	}
+	worker();
+	for (auto &t : workers)
+	{
+		t.join();
+	}
+	if (error.length())
+	{
+		throw std::invalid_argument(error);
+	}
 }
 
 void ArgumentParser::processTags()
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <iomanip>
 #include <string>
 
@@ -36,6 +37,7 @@ private:
 	void processAppDel();
 	void processAppView();
 	void processAppControl(bool start);
+	void processAppBatch();
 	void processAppRun();
 	void processExec();
 
@@ -79,6 +81,10 @@ private:
 	void regSignal();
 	void unregSignal();
 	std::string parseOutputMessage(http_response &resp);
+	void batchAppOperation(const std::string &action, const std::vector<std::string> &appNames);
+	void printBatchResult(http_response response);
+	// transfer file chunks with parallel threads, each chunk retry FILE_TRANSFER_RETRY_TIMES
+	void transferChunks(const std::vector<std::size_t> &offsets, int parallel, const std::function<void(std::size_t)> &transfer);
 
 private:
 	po::variables_map m_commandLineVariables;
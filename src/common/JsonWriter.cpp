@@ -0,0 +1,216 @@
+#include <cstdio>
+
+#include "JsonWriter.h"
+
+JsonWriter::JsonWriter(std::string &buffer, bool pretty)
+	: m_buffer(buffer), m_pretty(pretty), m_afterKey(false)
+{
+}
+
+void JsonWriter::indent()
+{
+	m_buffer.push_back('\n');
+	m_buffer.append(m_counts.size() * 2, ' ');
+}
+
+void JsonWriter::prefix()
+{
+	if (m_afterKey)
+	{
+		// value follow key
+		m_afterKey = false;
+		return;
+	}
+	if (m_counts.size())
+	{
+		if (m_counts.back()++)
+			m_buffer.push_back(',');
+		if (m_pretty)
+			indent();
+	}
+}
+
+JsonWriter &JsonWriter::start(char bracket)
+{
+	prefix();
+	m_buffer.push_back(bracket);
+	m_counts.push_back(0);
+	return *this;
+}
+
+JsonWriter &JsonWriter::end(char bracket)
+{
+	const bool empty = m_counts.empty() || m_counts.back() == 0;
+	if (m_counts.size())
+		m_counts.pop_back();
+	if (m_pretty && !empty)
+		indent();
+	m_buffer.push_back(bracket);
+	return *this;
+}
+
+JsonWriter &JsonWriter::startObject()
+{
+	return start('{');
+}
+
+JsonWriter &JsonWriter::endObject()
+{
+	return end('}');
+}
+
+JsonWriter &JsonWriter::startArray()
+{
+	return start('[');
+}
+
+JsonWriter &JsonWriter::endArray()
+{
+	return end(']');
+}
+
+JsonWriter &JsonWriter::key(const std::string &name)
+{
+	prefix();
+	appendString(m_buffer, name);
+	m_buffer.append(m_pretty ? ": " : ":");
+	m_afterKey = true;
+	return *this;
+}
+
+JsonWriter &JsonWriter::value(const std::string &str)
+{
+	prefix();
+	appendString(m_buffer, str);
+	return *this;
+}
+
+JsonWriter &JsonWriter::value(const char *str)
+{
+	return value(std::string(str));
+}
+
+JsonWriter &JsonWriter::value(bool b)
+{
+	prefix();
+	m_buffer.append(b ? "true" : "false");
+	return *this;
+}
+
+JsonWriter &JsonWriter::value(int number)
+{
+	return value(static_cast<int64_t>(number));
+}
+
+JsonWriter &JsonWriter::value(int64_t number)
+{
+	prefix();
+	m_buffer.append(std::to_string(number));
+	return *this;
+}
+
+JsonWriter &JsonWriter::value(uint64_t number)
+{
+	prefix();
+	m_buffer.append(std::to_string(number));
+	return *this;
+}
+
+JsonWriter &JsonWriter::value(double number)
+{
+	prefix();
+	// same precision with cpprest json serializer
+	char buff[32];
+	const int len = std::snprintf(buff, sizeof(buff), "%.17g", number);
+	m_buffer.append(buff, len);
+	return *this;
+}
+
+JsonWriter &JsonWriter::null()
+{
+	prefix();
+	m_buffer.append("null");
+	return *this;
+}
+
+JsonWriter &JsonWriter::value(const web::json::value &json)
+{
+	switch (json.type())
+	{
+	case web::json::value::Object:
+		startObject();
+		for (const auto &field : json.as_object())
+		{
+			key(field.first).value(field.second);
+		}
+		return endObject();
+	case web::json::value::Array:
+		startArray();
+		for (const auto &element : json.as_array())
+		{
+			value(element);
+		}
+		return endArray();
+	case web::json::value::String:
+		return value(json.as_string());
+	case web::json::value::Boolean:
+		return value(json.as_bool());
+	case web::json::value::Null:
+		return null();
+	default:
+		// number: keep cpprest integer/double format
+		return raw(json.serialize());
+	}
+}
+
+JsonWriter &JsonWriter::raw(const std::string &json)
+{
+	prefix();
+	m_buffer.append(json);
+	return *this;
+}
+
+void JsonWriter::appendString(std::string &buffer, const std::string &str)
+{
+	static const char *hex = "0123456789abcdef";
+	buffer.push_back('"');
+	for (const char c : str)
+	{
+		switch (c)
+		{
+		case '"':
+			buffer.append("\\\"");
+			break;
+		case '\\':
+			buffer.append("\\\\");
+			break;
+		case '\b':
+			buffer.append("\\b");
+			break;
+		case '\f':
+			buffer.append("\\f");
+			break;
+		case '\n':
+			buffer.append("\\n");
+			break;
+		case '\r':
+			buffer.append("\\r");
+			break;
+		case '\t':
+			buffer.append("\\t");
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				buffer.append("\\u00");
+				buffer.push_back(hex[(c >> 4) & 0xF]);
+				buffer.push_back(hex[c & 0xF]);
+			}
+			else
+			{
+				buffer.push_back(c);
+			}
+		}
+	}
+	buffer.push_back('"');
+}
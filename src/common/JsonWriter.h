@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <cpprest/json.h>
+
+//////////////////////////////////////////////////////////////////////////
+/// Streaming JSON writer, append JSON text to a caller owned buffer directly
+/// without building web::json::value DOM, the buffer can be reused (clear()
+/// keeps capacity) between serializations.
+/// Number and string format is same with web::json::value::serialize().
+//////////////////////////////////////////////////////////////////////////
+class JsonWriter
+{
+public:
+	/// <summary>
+	/// Construct writer
+	/// </summary>
+	/// <param name="buffer">output buffer, writer append to it</param>
+	/// <param name="pretty">indent output with 2 spaces, same layout with Utility::prettyJson() except empty container keep "{}"</param>
+	explicit JsonWriter(std::string &buffer, bool pretty = false);
+
+	JsonWriter &startObject();
+	JsonWriter &endObject();
+	JsonWriter &startArray();
+	JsonWriter &endArray();
+	JsonWriter &key(const std::string &name);
+
+	JsonWriter &value(const std::string &str);
+	JsonWriter &value(const char *str);
+	JsonWriter &value(bool b);
+	JsonWriter &value(int number);
+	JsonWriter &value(int64_t number);
+	JsonWriter &value(uint64_t number);
+	JsonWriter &value(double number);
+	JsonWriter &null();
+	/// <summary>
+	/// Write a json DOM value, used for dynamic content like metadata
+	/// </summary>
+	JsonWriter &value(const web::json::value &json);
+	/// <summary>
+	/// Write a serialized compact json fragment as a value
+	/// </summary>
+	JsonWriter &raw(const std::string &json);
+
+	/// <summary>
+	/// key and value
+	/// </summary>
+	template <typename T>
+	JsonWriter &member(const std::string &name, const T &v)
+	{
+		return key(name).value(v);
+	}
+
+	/// <summary>
+	/// Escape string with quotes
+	/// </summary>
+	static void appendString(std::string &buffer, const std::string &str);
+
+private:
+	// comma, new line and indent before a value or key
+	void prefix();
+	void indent();
+	JsonWriter &start(char bracket);
+	JsonWriter &end(char bracket);
+
+private:
+	std::string &m_buffer;
+	const bool m_pretty;
+	// element count of each open container
+	std::vector<std::size_t> m_counts;
+	bool m_afterKey;
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+/// Read-copy-update registry of named items
+///  1. readers atomically load an immutable snapshot, no registry lock and no copy
+///  2. writers are serialized, copy current snapshot, modify and publish new version
+///  3. snapshot keeps registration order and a hash index by name
+/// Suitable for read mostly data like application list.
+//////////////////////////////////////////////////////////////////////////
+template <typename T>
+class RcuRegistry
+{
+public:
+	/// <summary>
+	/// Immutable registry version
+	/// </summary>
+	class Snapshot
+	{
+	public:
+		typedef typename std::vector<std::shared_ptr<T>>::const_iterator const_iterator;
+
+		const_iterator begin() const { return m_items.begin(); }
+		const_iterator end() const { return m_items.end(); }
+		std::size_t size() const { return m_items.size(); }
+		bool empty() const { return m_items.empty(); }
+		const std::vector<std::shared_ptr<T>> &items() const { return m_items; }
+
+		/// <summary>
+		/// O(1) lookup by name
+		/// </summary>
+		/// <returns>nullptr if not exist</returns>
+		std::shared_ptr<T> find(const std::string &name) const
+		{
+			auto iter = m_index.find(name);
+			return iter == m_index.end() ? nullptr : m_items[iter->second];
+		}
+
+	private:
+		friend class RcuRegistry<T>;
+		// registration order
+		std::vector<std::shared_ptr<T>> m_items;
+		// name to position in m_items
+		std::unordered_map<std::string, std::size_t> m_index;
+	};
+	typedef std::shared_ptr<const Snapshot> SnapshotPtr;
+
+	RcuRegistry() : m_snapshot(std::make_shared<Snapshot>()), m_version(0) {}
+
+	/// <summary>
+	/// Current snapshot, valid until reader release it even if writers publish new versions
+	/// </summary>
+	SnapshotPtr snapshot() const
+	{
+		return std::atomic_load(&m_snapshot);
+	}
+
+	std::shared_ptr<T> find(const std::string &name) const
+	{
+		return snapshot()->find(name);
+	}
+
+	/// <summary>
+	/// Publish version increase when any writer change the registry
+	/// </summary>
+	uint64_t version() const
+	{
+		return m_version.load();
+	}
+
+	/// <summary>
+	/// Add item or replace the item with same name (keep position)
+	/// </summary>
+	/// <returns>replaced item, nullptr for new added</returns>
+	std::shared_ptr<T> put(const std::string &name, const std::shared_ptr<T> &item)
+	{
+		std::lock_guard<std::mutex> guard(m_writeMutex);
+		auto next = std::make_shared<Snapshot>(*std::atomic_load(&m_snapshot));
+		std::shared_ptr<T> replaced;
+		auto pos = next->m_index.find(name);
+		if (pos != next->m_index.end())
+		{
+			replaced = next->m_items[pos->second];
+			next->m_items[pos->second] = item;
+		}
+		else
+		{
+			next->m_index[name] = next->m_items.size();
+			next->m_items.push_back(item);
+		}
+		publish(next);
+		return replaced;
+	}
+
+	/// <summary>
+	/// Add item only when name not exist
+	/// </summary>
+	/// <returns>false if name already exist</returns>
+	bool add(const std::string &name, const std::shared_ptr<T> &item)
+	{
+		std::lock_guard<std::mutex> guard(m_writeMutex);
+		auto current = std::atomic_load(&m_snapshot);
+		if (current->m_index.count(name))
+		{
+			return false;
+		}
+		auto next = std::make_shared<Snapshot>(*current);
+		next->m_index[name] = next->m_items.size();
+		next->m_items.push_back(item);
+		publish(next);
+		return true;
+	}
+
+	/// <summary>
+	/// Remove item by name
+	/// </summary>
+	/// <returns>removed item, nullptr if not exist</returns>
+	std::shared_ptr<T> remove(const std::string &name)
+	{
+		std::lock_guard<std::mutex> guard(m_writeMutex);
+		auto current = std::atomic_load(&m_snapshot);
+		auto pos = current->m_index.find(name);
+		if (pos == current->m_index.end())
+		{
+			return nullptr;
+		}
+		const auto removedPos = pos->second;
+		auto next = std::make_shared<Snapshot>();
+		next->m_items.reserve(current->m_items.size() - 1);
+		for (std::size_t i = 0; i < current->m_items.size(); ++i)
+		{
+			if (i != removedPos)
+				next->m_items.push_back(current->m_items[i]);
+		}
+		next->m_index = current->m_index;
+		next->m_index.erase(name);
+		for (auto &position : next->m_index)
+		{
+			if (position.second > removedPos)
+				position.second--;
+		}
+		auto removed = current->m_items[removedPos];
+		publish(next);
+		return removed;
+	}
+
+private:
+	void publish(const std::shared_ptr<Snapshot> &next)
+	{
+		std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>(next));
+		m_version++;
+	}
+
+private:
+	std::shared_ptr<const Snapshot> m_snapshot;
+	std::atomic<uint64_t> m_version;
+	std::mutex m_writeMutex;
+};
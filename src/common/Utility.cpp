@@ -10,6 +10,7 @@
 #include <boost/archive/iterators/base64_from_binary.hpp>
 #include <boost/archive/iterators/binary_from_base64.hpp>
 #include <boost/archive/iterators/transform_width.hpp>
+#include <boost/crc.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/program_options/parsers.hpp>
 #include <log4cpp/Appender.hh>
@@ -734,6 +735,29 @@ std::string Utility::hash(const std::string &str)
 	return std::to_string(std::hash<std::string>()(str));
 }
 
+std::string Utility::checksum(const char *data, std::size_t length)
+{
+	boost::crc_32_type crc;
+	crc.process_bytes(data, length);
+	return stringFormat("%08x", crc.checksum());
+}
+
+std::string Utility::fileChecksum(const std::string &path)
+{
+	std::ifstream stream(path, std::ios::in | std::ios::binary);
+	if (!stream.is_open())
+	{
+		throw std::invalid_argument(stringFormat("failed to open <%s>", path.c_str()));
+	}
+	boost::crc_32_type crc;
+	std::vector<char> buffer(1024 * 1024);
+	while (stream.read(buffer.data(), buffer.size()) || stream.gcount())
+	{
+		crc.process_bytes(buffer.data(), static_cast<std::size_t>(stream.gcount()));
+	}
+	return stringFormat("%08x", crc.checksum());
+}
+
 std::string Utility::stringFormat(const std::string fmt_str, ...)
 {
 	// https://stackoverflow.com/questions/2342162/stdstring-formatting-like-sprintf
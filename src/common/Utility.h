@@ -102,6 +102,7 @@ std::shared_ptr<T> make_shared_array(size_t size)
 	} while (false)
 
 #define APPMESH_CONFIG_JSON_FILE "appsvc.json"
+#define APPMESH_CONFIG_JOURNAL_FILE "appsvc.journal"
 #define APPMESH_SECURITY_JSON_FILE "security.json"
 #define APPMESH_SECURITY_LDAP_JSON_FILE "ldap.json"
 #define DEFAULT_PROM_LISTEN_PORT 0
@@ -109,6 +110,14 @@ std::shared_ptr<T> make_shared_array(size_t size)
 #define DEFAULT_TCP_REST_LISTEN_PORT 6059
 #define DEFAULT_SCHEDULE_INTERVAL 2
 #define DEFAULT_HTTP_THREAD_POOL_SIZE 6
+#define DEFAULT_COMPRESSION_LEVEL 6		// response compression level, 0 disable, 1(fast) ~ 9(best)
+#define DEFAULT_COMPRESSION_MIN_SIZE 1024 // response smaller than this is not compressed
+#define DEFAULT_PROCESS_REAPER_POOL_SIZE 2 // threads reply finished sync run processes
+#define DEFAULT_PROCESS_REAPER_POLL_MS 100 // poll interval for kernel without pidfd support
+#define DEFAULT_CONFIG_JOURNAL_SYNC_MS 100 // batch fdatasync for configuration journal records
+#define DEFAULT_CONFIG_JOURNAL_COMPACT_RECORDS 1000 // rewrite checkpoint when journal records exceed
+#define DEFAULT_CONFIG_JOURNAL_COMPACT_SIZE (4 * 1024 * 1024) // rewrite checkpoint when journal size exceed
+#define DEFAULT_SNAPSHOT_SYNC_MS 500 // batch fdatasync for process snapshot updates
 
 #define JWT_USER_KEY "User123"
 #define JWT_USER_NAME "user"
@@ -116,6 +125,9 @@ std::shared_ptr<T> make_shared_array(size_t size)
 #define APPMESH_PASSWD_MIN_LENGTH 3
 #define DEFAULT_RUN_APP_RETENTION_DURATION 10
 #define DEFAULT_HEALTH_CHECK_INTERVAL 10
+#define DEFAULT_HEALTH_CHECK_CONCURRENCY 8 // max health check probes run at the same time
+#define DEFAULT_HEALTH_CHECK_POLL_MS 200 // poll socket health check probes
+#define DEFAULT_HEALTH_CHECK_JITTER_PERCENT 10 // randomize health check interval to spread probes
 #define MAX_COMMAND_LINE_LENGTH 2048
 
 #define DEFAULT_LABEL_HOST_NAME "HOST_NAME"
@@ -161,6 +173,10 @@ public:
 	static std::string humanReadableDuration(const std::chrono::system_clock::time_point &time);
 	static std::string prettyJson(const std::string &jsonStr);
 	static std::string hash(const std::string &str);
+	// CRC32 checksum in 8 hex chars, used for file transfer chunk verification
+	static std::string checksum(const char *data, std::size_t length);
+	// CRC32 checksum of whole file content, identify the file of a resumable upload
+	static std::string fileChecksum(const std::string &path) noexcept(false);
 	static std::string stringFormat(const std::string fmt_str, ...);
 	static std::string strToupper(std::string s);
 	static std::string strTolower(std::string s);
@@ -195,12 +211,24 @@ public:
 #define ENV_APP_MANAGER_DOCKER_IMG_PULL_TIMEOUT "APP_DOCKER_IMG_PULL_TIMEOUT" // app manager pull docker image timeout seconds
 #define ENV_APPMESH_PREFIX "APPMESH_"
 #define DEFAULT_TOKEN_EXPIRE_SECONDS 7 * (60 * 60 * 24) // default 7 days
+#define DEFAULT_TOKEN_CACHE_SIZE 1024						// verified JWT token LRU cache size
+#define DEFAULT_TOKEN_CACHE_TTL_SECONDS 60					// verified JWT token max cache time
+#define DEFAULT_ADMISSION_BUCKET_SIZE 10240				// rate limit token bucket count, evict least recently used when exceed
 #define DEFAULT_RUN_APP_TIMEOUT_SECONDS 10				// run app default timeout
+#define DEFAULT_EVENT_BUS_SIZE 4096						// application event ring buffer size
+#define DEFAULT_EVENT_WAIT_SECONDS 30					// event long poll default wait
+#define MAX_EVENT_WAIT_SECONDS 300						// event long poll max wait
 #define MAX_RUN_APP_TIMEOUT_SECONDS 3 * (60 * 60 * 24)	// run app max timeout 3 days
 #define SECURIRE_USER_KEY "******"
 #define CONSUL_SESSION_DEFAULT_TTL 30
+#define CONSUL_CONNECTION_POOL_DEFAULT_SIZE 4 // keep-alive connections for short Consul requests
 #define APP_STD_OUT_MAX_FILE_SIZE 1024 * 1024 * 100	  // 100M
 #define APP_STD_OUT_VIEW_DEFAULT_SIZE 1024 * 1024 * 3 // 3M
+#define FILE_TRANSFER_CHUNK_SIZE 1024 * 1024 * 8	  // 8M, appc get/put ranged transfer chunk size
+#define FILE_TRANSFER_MAX_CHUNK_SIZE 1024 * 1024 * 64 // 64M, max upload chunk accepted by server
+#define FILE_TRANSFER_RETRY_TIMES 3
+#define FILE_UPLOAD_PART_SUFFIX ".appmesh.part"
+#define FILE_UPLOAD_INDEX_SUFFIX ".appmesh.idx"
 #define DEFAULT_EXEC_USER "appmesh"
 #define SEPARATE_REST_APP_NAME "apprest"
 #define SEPARATE_DOCKER_PROXY_APP_NAME "dockerrest"
@@ -234,6 +262,16 @@ public:
 #define JSON_KEY_SECURITY_Interface "SecurityInterface"
 
 #define JSON_KEY_HttpThreadPoolSize "HttpThreadPoolSize"
+#define JSON_KEY_CompressionLevel "CompressionLevel"
+#define JSON_KEY_CompressionMinSize "CompressionMinSize"
+
+#define JSON_KEY_Admission "Admission"
+#define JSON_KEY_AdmissionRequestPerSecond "RequestPerSecond"
+#define JSON_KEY_AdmissionRequestBurst "RequestBurst"
+#define JSON_KEY_AdmissionRunConcurrency "RunConcurrency"
+#define JSON_KEY_AdmissionQueueSize "QueueSize"
+#define JSON_KEY_AdmissionUserLimits "UserLimits"
+#define JSON_KEY_AdmissionRoleLimits "RoleLimits"
 #define JSON_KEY_Roles "Roles"
 #define JSON_KEY_Groups "Groups"
 #define JSON_KEY_Applications "Applications"
@@ -250,6 +288,9 @@ public:
 #define JSON_KEY_CONSUL_AUTH_PASS "Pass"
 #define JSON_KEY_CONSUL_SECURITY "EnableConsulSecurity"
 #define JSON_KEY_CONSUL_APPMESH_PROXY_URL "AppmeshProxyUrl"
+#define JSON_KEY_CONSUL_CONNECTION_POOL "ConnectionPoolSize"
+#define JSON_KEY_CONSUL_SCHEDULE_STRATEGY "ScheduleStrategy"
+#define JSON_KEY_CONSUL_SCHEDULE_MAX_MOVES "ScheduleMaxMoves"
 #define JSON_KEY_JWT_Users "Users"
 #define JSON_KEY_APP_name "name"
 #define JSON_KEY_APP_owner "owner"
@@ -259,6 +300,7 @@ public:
 #define JSON_KEY_APP_command "command"
 #define JSON_KEY_APP_stdout_cache_num "stdout_cache_num"
 #define JSON_KEY_APP_health_check_cmd "health_check_cmd"
+#define JSON_KEY_APP_health_check "health_check"
 #define JSON_KEY_APP_working_dir "working_dir"
 #define JSON_KEY_APP_REG_TIME "register_time"
 #define JSON_KEY_APP_status "status"
@@ -292,6 +334,42 @@ public:
 #define JSON_KEY_APP_health "health"
 #define JSON_KEY_APP_version "version"
 
+// chunked file upload status
+#define JSON_KEY_FILE_size "file_size"
+#define JSON_KEY_FILE_received "received"
+#define JSON_KEY_FILE_checksum "file_checksum"
+
+// batch application operation
+#define JSON_KEY_BATCH_action "action"
+#define JSON_KEY_BATCH_name "name"
+#define JSON_KEY_BATCH_app "app"
+#define JSON_KEY_BATCH_success "success"
+#define JSON_KEY_BATCH_action_add "add"
+#define JSON_KEY_BATCH_action_enable "enable"
+#define JSON_KEY_BATCH_action_disable "disable"
+#define JSON_KEY_BATCH_action_remove "remove"
+
+#define JSON_KEY_CONFIG_DIFF_changed "changed"
+#define JSON_KEY_CONFIG_DIFF_added "added"
+#define JSON_KEY_CONFIG_DIFF_updated "updated"
+#define JSON_KEY_CONFIG_DIFF_removed "removed"
+
+// application lifecycle event
+#define JSON_KEY_EVENT_seq "seq"
+#define JSON_KEY_EVENT_type "type"
+#define JSON_KEY_EVENT_app "app"
+#define JSON_KEY_EVENT_time "time"
+#define JSON_KEY_EVENT_detail "detail"
+#define JSON_KEY_EVENT_events "events"
+#define JSON_KEY_EVENT_cursor "cursor"
+#define JSON_KEY_EVENT_truncated "truncated"
+#define APP_EVENT_start "start"
+#define APP_EVENT_exit "exit"
+#define APP_EVENT_health "health"
+#define APP_EVENT_enable "enable"
+#define APP_EVENT_disable "disable"
+#define APP_EVENT_remove "remove"
+
 #define JSON_KEY_APP_retention "retention" // short running: extra timeout seconds, long running: remove behavior retention
 #define JSON_KEY_SHORT_APP_start_interval_seconds "start_interval_seconds"
 #define JSON_KEY_SHORT_APP_start_time "start_time"
@@ -300,6 +378,12 @@ public:
 
 #define JSON_KEY_SHORT_APP_next_start_time "next_start_time"
 
+#define JSON_KEY_HEALTH_CHECK_interval "interval"
+#define JSON_KEY_HEALTH_CHECK_timeout "timeout"
+#define JSON_KEY_HEALTH_CHECK_initial_delay "initial_delay"
+#define JSON_KEY_HEALTH_CHECK_success_threshold "success_threshold"
+#define JSON_KEY_HEALTH_CHECK_failure_threshold "failure_threshold"
+
 #define JSON_KEY_DAILY_LIMITATION_daily_start "daily_start"
 #define JSON_KEY_DAILY_LIMITATION_daily_end "daily_end"
 
@@ -339,6 +423,19 @@ public:
 #define HTTP_HEADER_KEY_file_mode "File-Mode"
 #define HTTP_HEADER_KEY_file_user "File-User"
 #define HTTP_HEADER_KEY_file_group "File-Group"
+#define HTTP_HEADER_KEY_etag "ETag"
+#define HTTP_HEADER_KEY_if_none_match "If-None-Match"
+#define HTTP_HEADER_KEY_next_cursor "Next-Cursor"
+#define HTTP_HEADER_KEY_range "Range"
+#define HTTP_HEADER_KEY_if_range "If-Range"
+#define HTTP_HEADER_KEY_content_range "Content-Range"
+#define HTTP_HEADER_KEY_accept_ranges "Accept-Ranges"
+#define HTTP_HEADER_KEY_file_size "File-Size"
+#define HTTP_HEADER_KEY_file_checksum "File-Checksum"
+#define HTTP_HEADER_KEY_upload_offset "Upload-Offset"
+#define HTTP_HEADER_KEY_upload_checksum "Upload-Checksum"
+#define HTTP_HEADER_KEY_upload_complete "Upload-Complete"
+#define HTTP_HEADER_KEY_config_changed "Config-Changed"
 
 #define HTTP_QUERY_KEY_stdout_position "stdout_position"
 #define HTTP_QUERY_KEY_stdout_index "stdout_index"
@@ -349,6 +446,13 @@ public:
 #define HTTP_QUERY_KEY_action_stop "disable"
 #define HTTP_QUERY_KEY_loglevel "level"
 #define HTTP_QUERY_KEY_label_value "value"
+#define HTTP_QUERY_KEY_app_name "name"
+#define HTTP_QUERY_KEY_app_status "status"
+#define HTTP_QUERY_KEY_app_owner "owner"
+#define HTTP_QUERY_KEY_app_label "label"
+#define HTTP_QUERY_KEY_app_fields "fields"
+#define HTTP_QUERY_KEY_app_limit "limit"
+#define HTTP_QUERY_KEY_app_cursor "cursor"
 
 #define PERMISSION_KEY_view_app "app-view"
 #define PERMISSION_KEY_view_app_output "app-output-view"
@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+#include "../common/JsonWriter.h"
+#include "../common/Utility.h"
+#include "ConfigJournal.h"
+#include "Configuration.h"
+#include "application/Application.h"
+
+#define JOURNAL_JSON_KEY_op "op"
+#define JOURNAL_JSON_KEY_name "name"
+#define JOURNAL_JSON_KEY_value "value"
+#define JOURNAL_JSON_KEY_app "app"
+#define JOURNAL_JSON_KEY_status "status"
+#define JOURNAL_OP_app_add "app_add"
+#define JOURNAL_OP_app_remove "app_remove"
+#define JOURNAL_OP_app_status "app_status"
+#define JOURNAL_OP_label_set "label_set"
+#define JOURNAL_OP_label_remove "label_remove"
+
+ConfigJournal::ConfigJournal()
+	: m_fd(-1), m_size(0), m_records(0)
+{
+	m_syncPending.clear();
+}
+
+ConfigJournal::~ConfigJournal()
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+	closeJournal();
+}
+
+std::shared_ptr<ConfigJournal> &ConfigJournal::instance()
+{
+	static auto singleton = std::make_shared<ConfigJournal>();
+	return singleton;
+}
+
+std::string ConfigJournal::journalPath()
+{
+	return Utility::getParentDir() + ACE_DIRECTORY_SEPARATOR_STR + APPMESH_CONFIG_JOURNAL_FILE;
+}
+
+void ConfigJournal::init()
+{
+	const static char fname[] = "ConfigJournal::init() ";
+
+	bool replayed = false;
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		openJournal();
+		replayed = (m_size > 0);
+	}
+	if (replayed)
+	{
+		LOG_INF << fname << "fold journal records into checkpoint";
+		compact();
+	}
+}
+
+void ConfigJournal::appendApp(const std::shared_ptr<Application> &app)
+{
+	// internal applications are not persisted
+	if (app->getName() == SEPARATE_REST_APP_NAME || app->getName() == SEPARATE_DOCKER_PROXY_APP_NAME)
+		return;
+
+	std::string record;
+	JsonWriter writer(record);
+	writer.startObject();
+	writer.member(JOURNAL_JSON_KEY_op, JOURNAL_OP_app_add);
+	writer.member(JOURNAL_JSON_KEY_name, app->getName());
+	writer.key(JOURNAL_JSON_KEY_app);
+	app->writeJson(writer, false);
+	writer.endObject();
+	append(record);
+}
+
+void ConfigJournal::appendAppRemove(const std::string &appName)
+{
+	std::string record;
+	JsonWriter writer(record);
+	writer.startObject();
+	writer.member(JOURNAL_JSON_KEY_op, JOURNAL_OP_app_remove);
+	writer.member(JOURNAL_JSON_KEY_name, appName);
+	writer.endObject();
+	append(record);
+}
+
+void ConfigJournal::appendAppStatus(const std::string &appName, int status)
+{
+	std::string record;
+	JsonWriter writer(record);
+	writer.startObject();
+	writer.member(JOURNAL_JSON_KEY_op, JOURNAL_OP_app_status);
+	writer.member(JOURNAL_JSON_KEY_name, appName);
+	writer.member(JOURNAL_JSON_KEY_status, status);
+	writer.endObject();
+	append(record);
+}
+
+void ConfigJournal::appendLabel(const std::string &name, const std::string &value)
+{
+	std::string record;
+	JsonWriter writer(record);
+	writer.startObject();
+	writer.member(JOURNAL_JSON_KEY_op, JOURNAL_OP_label_set);
+	writer.member(JOURNAL_JSON_KEY_name, name);
+	writer.member(JOURNAL_JSON_KEY_value, value);
+	writer.endObject();
+	append(record);
+}
+
+void ConfigJournal::appendLabelRemove(const std::string &name)
+{
+	std::string record;
+	JsonWriter writer(record);
+	writer.startObject();
+	writer.member(JOURNAL_JSON_KEY_op, JOURNAL_OP_label_remove);
+	writer.member(JOURNAL_JSON_KEY_name, name);
+	writer.endObject();
+	append(record);
+}
+
+void ConfigJournal::append(const std::string &record)
+{
+	const static char fname[] = "ConfigJournal::append() ";
+
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		if (m_fd < 0 && !openJournal())
+		{
+			return;
+		}
+		const auto line = record + "\n";
+		std::size_t written = 0;
+		while (written < line.length())
+		{
+			const auto ret = ::write(m_fd, line.data() + written, line.length() - written);
+			if (ret < 0 && errno == EINTR)
+				continue;
+			if (ret <= 0)
+			{
+				LOG_ERR << fname << "write journal failed with error: " << std::strerror(errno);
+				// drop partial record, otherwise next record is joined to it and both are lost on replay
+				if (written && ::ftruncate(m_fd, m_size) != 0)
+				{
+					LOG_ERR << fname << "truncate journal failed with error: " << std::strerror(errno);
+				}
+				return;
+			}
+			written += ret;
+		}
+		m_size += written;
+		m_records++;
+	}
+	LOG_DBG << fname << record;
+
+	// batch fdatasync for records appended in a short window
+	if (!m_syncPending.test_and_set())
+	{
+		this->registerTimer(DEFAULT_CONFIG_JOURNAL_SYNC_MS, 0, std::bind(&ConfigJournal::sync, this, std::placeholders::_1), fname);
+	}
+}
+
+void ConfigJournal::sync(int timerId)
+{
+	const static char fname[] = "ConfigJournal::sync() ";
+
+	m_syncPending.clear();
+	bool needCompact = false;
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		if (m_fd >= 0 && ::fdatasync(m_fd) != 0)
+		{
+			LOG_ERR << fname << "fdatasync failed with error: " << std::strerror(errno);
+		}
+		needCompact = (m_records >= DEFAULT_CONFIG_JOURNAL_COMPACT_RECORDS || m_size >= DEFAULT_CONFIG_JOURNAL_COMPACT_SIZE);
+	}
+	if (needCompact)
+	{
+		compact();
+	}
+}
+
+void ConfigJournal::compact()
+{
+	const static char fname[] = "ConfigJournal::compact() ";
+
+	std::lock_guard<std::mutex> compactGuard(m_compactMutex);
+	std::size_t offset = 0;
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		offset = m_size;
+	}
+
+	// records before offset are already applied to memory, checkpoint snapshot include them
+	if (!Configuration::instance()->writeCheckpoint())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(m_mutex);
+	// keep records appended during checkpoint
+	std::string tail;
+	const auto path = journalPath();
+	if (m_size > offset)
+	{
+		std::ifstream ifs(path, std::ios::binary);
+		ifs.seekg(offset);
+		std::ostringstream oss;
+		oss << ifs.rdbuf();
+		tail = oss.str();
+	}
+	const auto tmpFile = path + ".tmp";
+	const int fd = ::open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0 || (tail.length() && ::write(fd, tail.data(), tail.length()) != static_cast<ssize_t>(tail.length())) || ::fdatasync(fd) != 0)
+	{
+		LOG_ERR << fname << "write journal <" << tmpFile << "> failed with error: " << std::strerror(errno);
+		if (fd >= 0)
+			::close(fd);
+		return;
+	}
+	::close(fd);
+	if (ACE_OS::rename(tmpFile.c_str(), path.c_str()) != 0)
+	{
+		LOG_ERR << fname << "rename journal <" << tmpFile << "> failed with error: " << std::strerror(errno);
+		return;
+	}
+	closeJournal();
+	openJournal();
+	m_records = std::count(tail.begin(), tail.end(), '\n');
+	LOG_INF << fname << "checkpoint written, " << m_records << " journal records kept";
+}
+
+std::size_t ConfigJournal::replay(web::json::value &config, const std::string &journal)
+{
+	const static char fname[] = "ConfigJournal::replay() ";
+
+	if (!config.has_field(JSON_KEY_Applications) || !config.at(JSON_KEY_Applications).is_array())
+		config[JSON_KEY_Applications] = web::json::value::array();
+	if (!config.has_field(JSON_KEY_Labels) || !config.at(JSON_KEY_Labels).is_object())
+		config[JSON_KEY_Labels] = web::json::value::object();
+	auto &apps = config[JSON_KEY_Applications].as_array();
+	auto &labels = config[JSON_KEY_Labels];
+	const auto findApp = [&apps](const std::string &name)
+	{
+		return std::find_if(apps.begin(), apps.end(), [&name](const web::json::value &app)
+							{ return GET_JSON_STR_VALUE(app, JSON_KEY_APP_name) == name; });
+	};
+
+	std::size_t applied = 0;
+	std::istringstream iss(journal);
+	std::string line;
+	while (std::getline(iss, line))
+	{
+		if (line.empty())
+			continue;
+		try
+		{
+			const auto record = web::json::value::parse(line);
+			const auto op = GET_JSON_STR_VALUE(record, JOURNAL_JSON_KEY_op);
+			const auto name = GET_JSON_STR_VALUE(record, JOURNAL_JSON_KEY_name);
+			if (op == JOURNAL_OP_app_add)
+			{
+				auto iter = findApp(name);
+				if (iter != apps.end())
+					*iter = record.at(JOURNAL_JSON_KEY_app);
+				else
+					apps[apps.size()] = record.at(JOURNAL_JSON_KEY_app);
+			}
+			else if (op == JOURNAL_OP_app_remove)
+			{
+				auto iter = findApp(name);
+				if (iter != apps.end())
+					apps.erase(iter);
+			}
+			else if (op == JOURNAL_OP_app_status)
+			{
+				auto iter = findApp(name);
+				if (iter != apps.end())
+					(*iter)[JSON_KEY_APP_status] = record.at(JOURNAL_JSON_KEY_status);
+			}
+			else if (op == JOURNAL_OP_label_set)
+			{
+				labels[name] = record.at(JOURNAL_JSON_KEY_value);
+			}
+			else if (op == JOURNAL_OP_label_remove)
+			{
+				if (labels.has_field(name))
+					labels.erase(name);
+			}
+			else
+			{
+				LOG_WAR << fname << "unknown journal record: " << line;
+				continue;
+			}
+			applied++;
+		}
+		catch (const std::exception &e)
+		{
+			// last record may be partially written when crash
+			LOG_WAR << fname << "skip invalid journal record <" << line << "> with error: " << e.what();
+		}
+	}
+	return applied;
+}
+
+bool ConfigJournal::openJournal()
+{
+	const static char fname[] = "ConfigJournal::openJournal() ";
+
+	const auto path = journalPath();
+	m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	if (m_fd < 0)
+	{
+		LOG_ERR << fname << "open journal <" << path << "> failed with error: " << std::strerror(errno);
+		return false;
+	}
+	m_size = ::lseek(m_fd, 0, SEEK_END);
+	// last record partially written when crash, terminate it so new records start from a new line
+	char last = '\n';
+	if (m_size > 0 && ::pread(m_fd, &last, 1, m_size - 1) == 1 && last != '\n' && ::write(m_fd, "\n", 1) == 1)
+	{
+		LOG_WAR << fname << "terminate partial record at the end of journal <" << path << ">";
+		m_size++;
+	}
+	return true;
+}
+
+void ConfigJournal::closeJournal()
+{
+	if (m_fd >= 0)
+	{
+		::close(m_fd);
+		m_fd = -1;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <cpprest/json.h>
+
+#include "TimerHandler.h"
+
+class Application;
+
+//////////////////////////////////////////////////////////////////////////
+/// Append-only configuration journal
+///  1. Configuration mutations (application add/remove/status, label set/remove)
+///     are appended to <appsvc.journal> as one compact JSON line, fdatasync is
+///     batched by a short timer
+///  2. Startup replay journal records on top of checkpoint <appsvc.json>
+///  3. Compaction rewrite checkpoint and keep only records appended after the
+///     checkpoint snapshot begin, records are idempotent so replay twice is safe
+//////////////////////////////////////////////////////////////////////////
+class ConfigJournal : public TimerHandler
+{
+public:
+	ConfigJournal();
+	virtual ~ConfigJournal();
+	static std::shared_ptr<ConfigJournal> &instance();
+
+	/// <summary>
+	/// Open journal and fold records replayed during startup into checkpoint
+	/// </summary>
+	void init();
+
+	void appendApp(const std::shared_ptr<Application> &app);
+	void appendAppRemove(const std::string &appName);
+	void appendAppStatus(const std::string &appName, int status);
+	void appendLabel(const std::string &name, const std::string &value);
+	void appendLabelRemove(const std::string &name);
+
+	/// <summary>
+	/// Write full checkpoint and truncate journal
+	/// </summary>
+	void compact();
+
+	/// <summary>
+	/// Apply journal records to checkpoint JSON
+	/// </summary>
+	/// <param name="config">checkpoint configuration JSON</param>
+	/// <param name="journal">journal file content</param>
+	/// <returns>applied record number</returns>
+	static std::size_t replay(web::json::value &config, const std::string &journal);
+	static std::string journalPath();
+
+private:
+	void append(const std::string &record);
+	void sync(int timerId = 0);
+	// need lock
+	bool openJournal();
+	void closeJournal();
+
+private:
+	int m_fd;
+	// journal size and record number since last compaction
+	std::size_t m_size;
+	std::size_t m_records;
+	std::atomic_flag m_syncPending;
+	std::mutex m_mutex;
+	std::mutex m_compactMutex;
+};
@@ -1,21 +1,29 @@
+#include <atomic>
 #include <set>
 #include <unistd.h> //environ
 
 #include <ace/Signal.h>
 #include <boost/algorithm/string_regex.hpp>
 
+#include "ConfigJournal.h"
 #include "Configuration.h"
 #include "Label.h"
 #include "ResourceCollection.h"
+#include "application/AppFilter.h"
 #include "application/Application.h"
+#include "application/EventBus.h"
 #include "consul/ConsulConnection.h"
+#include "consul/ResourceScheduler.h"
+#include "rest/AdmissionControl.h"
 #include "rest/PrometheusRest.h"
 #include "rest/RestHandler.h"
 #include "security/Security.h"
+#include "security/TokenCache.h"
 #include "security/User.h"
 
 #include "../common/DateTime.h"
 #include "../common/DurationParse.h"
+#include "../common/JsonWriter.h"
 #include "../common/Utility.h"
 
 extern char **environ; // unistd.h
@@ -114,8 +122,20 @@ std::shared_ptr<Configuration> Configuration::FromJson(const std::string &str, b
 
 std::string Configuration::readConfiguration()
 {
+	const static char fname[] = "Configuration::readConfiguration() ";
+
 	std::string jsonPath = Utility::getParentDir() + ACE_DIRECTORY_SEPARATOR_STR + APPMESH_CONFIG_JSON_FILE;
-	return Utility::readFileCpp(jsonPath);
+	auto content = Utility::readFileCpp(jsonPath);
+	// replay journal records on top of checkpoint
+	const auto journal = Utility::readFileCpp(ConfigJournal::journalPath());
+	if (journal.length())
+	{
+		auto config = web::json::value::parse(content);
+		const auto applied = ConfigJournal::replay(config, journal);
+		LOG_INF << fname << "replayed " << applied << " configuration journal records";
+		content = config.serialize();
+	}
+	return content;
 }
 
 void SigHupHandler(int signo)
@@ -128,7 +148,7 @@ void SigHupHandler(int signo)
 	{
 		try
 		{
-			config->hotUpdate(web::json::value::parse(Configuration::readConfiguration()));
+			config->hotUpdate(web::json::value::parse(Configuration::readConfiguration()), true);
 		}
 		catch (const std::exception &e)
 		{
@@ -189,26 +209,56 @@ web::json::value Configuration::AsJson(bool returnRuntimeInfo, const std::string
 	return result;
 }
 
-std::vector<std::shared_ptr<Application>> Configuration::getApps() const
+void Configuration::writeJson(JsonWriter &writer, const std::string &user)
 {
-	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
-	return m_apps;
+	// keep same fields with AsJson()
+	writer.startObject();
+
+	// Applications
+	writer.key(JSON_KEY_Applications).startArray();
+	for (const auto &app : *getApps())
+	{
+		if (checkOwnerPermission(user, app->getOwner(), app->getOwnerPermission(), false) &&
+			(app->getName() != SEPARATE_REST_APP_NAME) && (app->getName() != SEPARATE_DOCKER_PROXY_APP_NAME))
+		{
+			app->writeJson(writer, false);
+		}
+	}
+	writer.endArray();
+
+	std::lock_guard<std::recursive_mutex> guard(m_hotupdateMutex);
+
+	// Global parameters
+	writer.member(JSON_KEY_Description, m_hostDescription);
+	writer.member(JSON_KEY_DefaultExecUser, m_defaultExecUser);
+	writer.member(JSON_KEY_WorkingDirectory, m_defaultWorkDir);
+	writer.member(JSON_KEY_ScheduleIntervalSeconds, m_scheduleInterval);
+	writer.member(JSON_KEY_LogLevel, m_logLevel);
+
+	// REST, Labels and Consul are small, reuse DOM
+	writer.member(JSON_KEY_REST, m_rest->AsJson());
+	writer.member(JSON_KEY_Labels, m_label->AsJson());
+	writer.member(JSON_KEY_CONSUL, m_consul->AsJson());
+
+	// Build version
+	writer.member(JSON_KEY_VERSION, std::string(__MICRO_VAR__(BUILD_TAG)));
+
+	writer.endObject();
+}
+
+Configuration::AppSnapshot Configuration::getApps() const
+{
+	return m_apps.snapshot();
 }
 
 void Configuration::addApp2Map(std::shared_ptr<Application> app)
 {
 	const static char fname[] = "Configuration::addApp2Map() ";
 
-	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
-	for (std::size_t i = 0; i < m_apps.size(); i++)
+	if (!m_apps.add(app->getName(), app))
 	{
-		if (m_apps[i]->getName() == app->getName())
-		{
-			LOG_INF << fname << "Application <" << app->getName() << "> already exist.";
-			return;
-		}
+		LOG_INF << fname << "Application <" << app->getName() << "> already exist.";
 	}
-	m_apps.push_back(app);
 }
 
 int Configuration::getScheduleInterval()
@@ -249,9 +299,9 @@ int Configuration::getSeparateRestInternalPort()
 
 web::json::value Configuration::serializeApplication(bool returnRuntimeInfo, const std::string &user) const
 {
-	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
+	const auto snapshot = getApps();
 	std::vector<std::shared_ptr<Application>> apps;
-	std::copy_if(m_apps.begin(), m_apps.end(), std::back_inserter(apps),
+	std::copy_if(snapshot->begin(), snapshot->end(), std::back_inserter(apps),
 				 [this, &user](std::shared_ptr<Application> app)
 				 {
 					 return (checkOwnerPermission(user, app->getOwner(), app->getOwnerPermission(), false) &&					// access permission check
@@ -267,6 +317,64 @@ web::json::value Configuration::serializeApplication(bool returnRuntimeInfo, con
 	return result;
 }
 
+std::tuple<std::string, std::string, std::string> Configuration::serializeApplicationCached(const std::string &user, const std::string &ifNoneMatch, const std::shared_ptr<AppFilter> &filter) const
+{
+	std::vector<std::shared_ptr<Application>> apps;
+	const auto snapshot = getApps();
+	std::copy_if(snapshot->begin(), snapshot->end(), std::back_inserter(apps),
+				 [this, &user, &filter](std::shared_ptr<Application> app)
+				 {
+					 return (checkOwnerPermission(user, app->getOwner(), app->getOwnerPermission(), false) &&
+							 (app->getName() != SEPARATE_REST_APP_NAME) && (app->getName() != SEPARATE_DOCKER_PROXY_APP_NAME) &&
+							 (filter == nullptr || filter->match(app)));
+				 });
+
+	// Pagination: stable order by name, start after cursor
+	std::string nextCursor;
+	if (filter && filter->hasPagination())
+	{
+		std::sort(apps.begin(), apps.end(), [](const std::shared_ptr<Application> &a, const std::shared_ptr<Application> &b)
+				  { return a->getName() < b->getName(); });
+		if (filter->m_cursor.length())
+		{
+			apps.erase(apps.begin(), std::upper_bound(apps.begin(), apps.end(), filter->m_cursor,
+													  [](const std::string &cursor, const std::shared_ptr<Application> &app)
+													  { return cursor < app->getName(); }));
+		}
+		if (filter->m_limit > 0 && apps.size() > filter->m_limit)
+		{
+			apps.resize(filter->m_limit);
+			nextCursor = apps.back()->getName();
+		}
+	}
+
+	// ETag: query, application name and runtime version, version sequence is global, so re-added app get new ETag
+	std::string versions = filter ? filter->queryString() : "";
+	for (const auto &app : apps)
+	{
+		versions.append(app->getName()).append(":").append(std::to_string(app->getRuntimeVersion())).append(",");
+	}
+	const auto etag = Utility::stringFormat("\"%s\"", Utility::hash(versions).c_str());
+	if (!ifNoneMatch.empty() && (ifNoneMatch == "*" || ifNoneMatch.find(etag) != std::string::npos))
+	{
+		return std::make_tuple(etag, std::string(), nextCursor);
+	}
+
+	// Build Json from cached fragment without hold configuration lock
+	std::string result = "[";
+	for (std::size_t i = 0; i < apps.size(); ++i)
+	{
+		if (i)
+			result.append(",");
+		if (filter && filter->hasProjection())
+			result.append(filter->project(apps[i]->AsJson(true)).serialize());
+		else
+			result.append(*(apps[i]->AsJsonCached()));
+	}
+	result.append("]");
+	return std::make_tuple(etag, result, nextCursor);
+}
+
 void Configuration::deSerializeApp(const web::json::value &jsonObj)
 {
 	for (auto jsonApp : jsonObj.as_array())
@@ -278,16 +386,22 @@ void Configuration::deSerializeApp(const web::json::value &jsonObj)
 	}
 }
 
-void Configuration::disableApp(const std::string &appName)
+void Configuration::disableApp(const std::string &appName, bool persist)
 {
-	getApp(appName)->disable();
-	saveConfigToDisk();
+	// status change and journal record are in the same order for concurrent requests
+	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
+	auto app = getApp(appName);
+	app->disable();
+	if (persist)
+		ConfigJournal::instance()->appendAppStatus(appName, static_cast<int>(app->getStatus()));
 }
-void Configuration::enableApp(const std::string &appName)
+void Configuration::enableApp(const std::string &appName, bool persist)
 {
+	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
 	auto app = getApp(appName);
 	app->enable();
-	saveConfigToDisk();
+	if (persist)
+		ConfigJournal::instance()->appendAppStatus(appName, static_cast<int>(app->getStatus()));
 }
 
 const std::string Configuration::getLogLevel() const
@@ -346,6 +460,18 @@ std::size_t Configuration::getThreadPoolSize() const
 	return m_rest->m_httpThreadPoolSize;
 }
 
+int Configuration::getCompressionLevel() const
+{
+	std::lock_guard<std::recursive_mutex> guard(m_hotupdateMutex);
+	return m_rest->m_compressionLevel;
+}
+
+int Configuration::getCompressionMinSize() const
+{
+	std::lock_guard<std::recursive_mutex> guard(m_hotupdateMutex);
+	return m_rest->m_compressionMinSize;
+}
+
 const std::string Configuration::getDescription() const
 {
 	std::lock_guard<std::recursive_mutex> guard(m_hotupdateMutex);
@@ -364,6 +490,12 @@ const std::shared_ptr<Configuration::JsonJwt> Configuration::getJwt() const
 	return m_rest->m_jwt;
 }
 
+const std::shared_ptr<Configuration::JsonAdmission> Configuration::getAdmission() const
+{
+	std::lock_guard<std::recursive_mutex> guard(m_hotupdateMutex);
+	return m_rest->m_admission;
+}
+
 bool Configuration::checkOwnerPermission(const std::string &user, const std::shared_ptr<User> &appOwner, int appPermission, bool requestWrite) const
 {
 	// if app has not defined user, return true
@@ -415,39 +547,29 @@ void Configuration::dump()
 	LOG_DBG << fname << '\n'
 			<< Utility::prettyJson(this->AsJson(false, "").serialize());
 
-	auto apps = getApps();
-	for (auto app : apps)
+	for (const auto &app : *getApps())
 	{
 		app->dump();
 	}
 }
 
-std::shared_ptr<Application> Configuration::addApp(const web::json::value &jsonApp)
+std::shared_ptr<Application> Configuration::addApp(const web::json::value &jsonApp, bool persist)
 {
 	auto app = parseApp(jsonApp);
-	bool update = false;
 	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
-	std::for_each(m_apps.begin(), m_apps.end(), [&app, &update](std::shared_ptr<Application> &mapApp)
-				  {
-					  if (mapApp->getName() == app->getName())
-					  {
-						  // Stop existing app and replace
-						  mapApp->disable();
-						  mapApp = app;
-						  update = true;
-						  return;
-					  }
-				  });
-
-	if (!update)
-	{
-		// Register app
-		addApp2Map(app);
+	auto existApp = m_apps.find(app->getName());
+	if (existApp)
+	{
+		// Stop existing app and replace
+		existApp->disable();
 	}
+	// Register app, publish new registry version
+	m_apps.put(app->getName(), app);
 	// Write to disk
 	{
 		app->initMetrics(PrometheusRest::instance());
-		saveConfigToDisk();
+		if (persist)
+			ConfigJournal::instance()->appendApp(app);
 		// invoke immediately
 		app->execute();
 	}
@@ -455,7 +577,7 @@ std::shared_ptr<Application> Configuration::addApp(const web::json::value &jsonA
 	return app;
 }
 
-void Configuration::removeApp(const std::string &appName)
+void Configuration::removeApp(const std::string &appName, bool persist)
 {
 	const static char fname[] = "Configuration::removeApp() ";
 
@@ -464,33 +586,103 @@ void Configuration::removeApp(const std::string &appName)
 	{
 		std::lock_guard<std::recursive_mutex> guard(m_appMutex);
 		// Update in-memory app
-		for (auto iterA = m_apps.begin(); iterA != m_apps.end();)
+		app = m_apps.remove(appName);
+		if (app)
 		{
-			if ((*iterA)->getName() == appName)
-			{
-				app = (*iterA);
-				iterA = m_apps.erase(iterA);
-				// Write to disk
-				saveConfigToDisk();
-				LOG_DBG << fname << "removed " << appName;
-			}
-			else
-			{
-				iterA++;
-			}
+			// Write to disk
+			if (persist)
+				ConfigJournal::instance()->appendAppRemove(appName);
+			LOG_DBG << fname << "removed " << appName;
 		}
 	}
 	if (app)
 	{
 		app->destroy();
+		EventBus::instance()->publish(APP_EVENT_remove, *app);
+	}
+}
+
+web::json::value Configuration::batchApps(const web::json::value &operations, const std::function<void(const std::string &, const std::string &, web::json::value &)> &validator)
+{
+	const static char fname[] = "Configuration::batchApps() ";
+
+	auto result = web::json::value::array(operations.size());
+	std::size_t succeeded = 0;
+	{
+		std::lock_guard<std::recursive_mutex> guard(m_appMutex);
+		for (std::size_t i = 0; i < operations.size(); ++i)
+		{
+			auto operation = operations.at(i);
+			auto itemResult = web::json::value::object();
+			try
+			{
+				if (!operation.is_object())
+					throw std::invalid_argument("operation should be JSON object");
+				const auto action = GET_JSON_STR_VALUE(operation, JSON_KEY_BATCH_action);
+				auto appName = GET_JSON_STR_VALUE(operation, JSON_KEY_BATCH_name);
+				if (appName.empty() && HAS_JSON_FIELD(operation, JSON_KEY_BATCH_app))
+					appName = GET_JSON_STR_VALUE(operation.at(JSON_KEY_BATCH_app), JSON_KEY_APP_name);
+				itemResult[JSON_KEY_BATCH_action] = web::json::value::string(action);
+				itemResult[JSON_KEY_BATCH_name] = web::json::value::string(appName);
+				if (appName.empty())
+					throw std::invalid_argument("application name not specified");
+
+				validator(action, appName, operation);
+				if (action == JSON_KEY_BATCH_action_add)
+				{
+					if (!HAS_JSON_FIELD(operation, JSON_KEY_BATCH_app))
+						throw std::invalid_argument("application JSON not specified");
+					auto jsonApp = operation.at(JSON_KEY_BATCH_app);
+					jsonApp[JSON_KEY_APP_name] = web::json::value::string(appName);
+					this->addApp(jsonApp);
+				}
+				else if (action == JSON_KEY_BATCH_action_enable)
+				{
+					this->enableApp(appName);
+				}
+				else if (action == JSON_KEY_BATCH_action_disable)
+				{
+					this->disableApp(appName);
+				}
+				else if (action == JSON_KEY_BATCH_action_remove)
+				{
+					this->removeApp(appName);
+				}
+				else
+				{
+					throw std::invalid_argument(Utility::stringFormat("unsupported action <%s>", action.c_str()));
+				}
+				itemResult[JSON_KEY_BATCH_success] = web::json::value::boolean(true);
+				succeeded++;
+			}
+			catch (const std::exception &e)
+			{
+				itemResult[JSON_KEY_BATCH_success] = web::json::value::boolean(false);
+				itemResult[REST_TEXT_MESSAGE_JSON_KEY] = web::json::value::string(e.what());
+			}
+			result[i] = itemResult;
+		}
 	}
+	LOG_INF << fname << succeeded << " of " << operations.size() << " operations applied";
+	return result;
 }
 
 void Configuration::saveConfigToDisk()
 {
-	const static char fname[] = "Configuration::saveConfigToDisk() ";
+	ConfigJournal::instance()->compact();
+}
 
-	auto content = GET_STD_STRING(this->AsJson(false, "").serialize());
+bool Configuration::writeCheckpoint()
+{
+	const static char fname[] = "Configuration::writeCheckpoint() ";
+
+	// stream configuration to text directly, avoid build DOM for all applications
+	static std::atomic<std::size_t> lastSize(0);
+	std::string content;
+	content.reserve(lastSize);
+	JsonWriter writer(content, true);
+	this->writeJson(writer, "");
+	lastSize = content.length();
 	if (content.length())
 	{
 		std::lock_guard<std::recursive_mutex> guard(m_hotupdateMutex);
@@ -498,12 +690,19 @@ void Configuration::saveConfigToDisk()
 		std::ofstream ofs(tmpFile, ios::trunc);
 		if (ofs.is_open())
 		{
-			auto formatJson = Utility::prettyJson(content);
-			ofs << formatJson;
+			ofs << content;
 			ofs.close();
+			// journal is truncated after checkpoint, make sure checkpoint is on disk
+			const int fd = ACE_OS::open(tmpFile.c_str(), O_RDONLY);
+			if (fd >= 0)
+			{
+				ACE_OS::fsync(fd);
+				ACE_OS::close(fd);
+			}
 			if (ACE_OS::rename(tmpFile.c_str(), m_jsonFilePath.c_str()) == 0)
 			{
-				LOG_DBG << fname << formatJson;
+				LOG_DBG << fname << content;
+				return true;
 			}
 			else
 			{
@@ -515,103 +714,213 @@ void Configuration::saveConfigToDisk()
 	{
 		LOG_ERR << fname << "Configuration content is empty";
 	}
+	return false;
 }
 
-void Configuration::hotUpdate(const web::json::value &jsonValue)
+// apply changed value and record key path for diff report
+#define HOT_UPDATE(key, x, y)                                        \
+	if ((x) != (y))                                                  \
+	{                                                                \
+		(x) = (y);                                                   \
+		changes.push_back(key);                                      \
+		LOG_INF << fname << "Configuration value updated : " << key; \
+	}
+
+// configuration sections are compared by content instead of object address
+template <typename T>
+static bool sectionChanged(const std::shared_ptr<T> &current, const std::shared_ptr<T> &update)
+{
+	if (current == nullptr || update == nullptr)
+		return current != update;
+	return current->AsJson() != update->AsJson();
+}
+
+web::json::value Configuration::hotUpdate(const web::json::value &jsonValue, bool updateApps)
 {
 	const static char fname[] = "Configuration::hotUpdate() ";
 
 	LOG_DBG << fname << "Entered";
+	std::vector<std::string> changes;
 	bool consulUpdated = false;
+	bool labelUpdated = false;
 	{
-		std::lock_guard<std::recursive_mutex> guard(m_hotupdateMutex);
-
 		// parse
 		auto newConfig = Configuration::FromJson(GET_STD_STRING(jsonValue.serialize()));
 
+		std::lock_guard<std::recursive_mutex> guard(m_hotupdateMutex);
+
 		// update
 		if (HAS_JSON_FIELD(jsonValue, JSON_KEY_Description))
-			SET_COMPARE(this->m_hostDescription, newConfig->m_hostDescription);
-		if (HAS_JSON_FIELD(jsonValue, JSON_KEY_LogLevel))
+			HOT_UPDATE(JSON_KEY_Description, this->m_hostDescription, newConfig->m_hostDescription);
+		if (HAS_JSON_FIELD(jsonValue, JSON_KEY_LogLevel) && this->m_logLevel != newConfig->m_logLevel)
 		{
-			if (this->m_logLevel != newConfig->m_logLevel)
-			{
-				Utility::setLogLevel(newConfig->m_logLevel);
-				SET_COMPARE(this->m_logLevel, newConfig->m_logLevel);
-			}
+			Utility::setLogLevel(newConfig->m_logLevel);
+			HOT_UPDATE(JSON_KEY_LogLevel, this->m_logLevel, newConfig->m_logLevel);
 		}
-
 		if (HAS_JSON_FIELD(jsonValue, JSON_KEY_ScheduleIntervalSeconds))
-			SET_COMPARE(this->m_scheduleInterval, newConfig->m_scheduleInterval);
+			HOT_UPDATE(JSON_KEY_ScheduleIntervalSeconds, this->m_scheduleInterval, newConfig->m_scheduleInterval);
 		if (HAS_JSON_FIELD(jsonValue, JSON_KEY_DefaultExecUser))
-			SET_COMPARE(this->m_defaultExecUser, newConfig->m_defaultExecUser);
+			HOT_UPDATE(JSON_KEY_DefaultExecUser, this->m_defaultExecUser, newConfig->m_defaultExecUser);
 		if (HAS_JSON_FIELD(jsonValue, JSON_KEY_WorkingDirectory))
-			SET_COMPARE(this->m_defaultWorkDir, newConfig->m_defaultWorkDir);
+			HOT_UPDATE(JSON_KEY_WorkingDirectory, this->m_defaultWorkDir, newConfig->m_defaultWorkDir);
 		// REST
 		if (HAS_JSON_FIELD(jsonValue, JSON_KEY_REST))
 		{
+			const auto restPort = this->m_rest->m_restListenPort;
+			const auto sslEnabled = this->m_rest->m_ssl->m_sslEnabled;
 			auto rest = jsonValue.at(JSON_KEY_REST);
 			if (HAS_JSON_FIELD(rest, JSON_KEY_RestEnabled))
-				SET_COMPARE(this->m_rest->m_restEnabled, newConfig->m_rest->m_restEnabled);
+				HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_RestEnabled, this->m_rest->m_restEnabled, newConfig->m_rest->m_restEnabled);
 			if (HAS_JSON_FIELD(rest, JSON_KEY_RestListenPort))
-				SET_COMPARE(this->m_rest->m_restListenPort, newConfig->m_rest->m_restListenPort);
+				HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_RestListenPort, this->m_rest->m_restListenPort, newConfig->m_rest->m_restListenPort);
 			if (HAS_JSON_FIELD(rest, JSON_KEY_SeparateRestInternalPort))
-				SET_COMPARE(this->m_rest->m_separateRestInternalPort, newConfig->m_rest->m_separateRestInternalPort);
+				HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_SeparateRestInternalPort, this->m_rest->m_separateRestInternalPort, newConfig->m_rest->m_separateRestInternalPort);
 			if (HAS_JSON_FIELD(rest, JSON_KEY_DockerProxyListenAddr))
-				SET_COMPARE(this->m_rest->m_dockerProxyListenAddr, newConfig->m_rest->m_dockerProxyListenAddr);
+				HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_DockerProxyListenAddr, this->m_rest->m_dockerProxyListenAddr, newConfig->m_rest->m_dockerProxyListenAddr);
 			if (HAS_JSON_FIELD(rest, JSON_KEY_RestListenAddress))
-				SET_COMPARE(this->m_rest->m_restListenAddress, newConfig->m_rest->m_restListenAddress);
+				HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_RestListenAddress, this->m_rest->m_restListenAddress, newConfig->m_rest->m_restListenAddress);
 			if (HAS_JSON_FIELD(rest, JSON_KEY_HttpThreadPoolSize))
-				SET_COMPARE(this->m_rest->m_httpThreadPoolSize, newConfig->m_rest->m_httpThreadPoolSize);
-			if (HAS_JSON_FIELD(rest, JSON_KEY_PrometheusExporterListenPort) && (this->m_rest->m_promListenPort != newConfig->m_rest->m_promListenPort))
-			{
-				SET_COMPARE(this->m_rest->m_promListenPort, newConfig->m_rest->m_promListenPort);
-			}
+				HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_HttpThreadPoolSize, this->m_rest->m_httpThreadPoolSize, newConfig->m_rest->m_httpThreadPoolSize);
+			// CompressionLevel and CompressionMinSize are read by REST process when start, not hot updated
+			if (HAS_JSON_FIELD(rest, JSON_KEY_PrometheusExporterListenPort))
+				HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_PrometheusExporterListenPort, this->m_rest->m_promListenPort, newConfig->m_rest->m_promListenPort);
 			// SSL
 			if (HAS_JSON_FIELD(rest, JSON_KEY_SSL))
 			{
 				auto ssl = rest.at(JSON_KEY_SSL);
 				if (HAS_JSON_FIELD(ssl, JSON_KEY_SSLCertificateFile))
-					SET_COMPARE(this->m_rest->m_ssl->m_certFile, newConfig->m_rest->m_ssl->m_certFile);
+					HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_SSL "." JSON_KEY_SSLCertificateFile, this->m_rest->m_ssl->m_certFile, newConfig->m_rest->m_ssl->m_certFile);
 				if (HAS_JSON_FIELD(ssl, JSON_KEY_SSLCertificateKeyFile))
-					SET_COMPARE(this->m_rest->m_ssl->m_certKeyFile, newConfig->m_rest->m_ssl->m_certKeyFile);
+					HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_SSL "." JSON_KEY_SSLCertificateKeyFile, this->m_rest->m_ssl->m_certKeyFile, newConfig->m_rest->m_ssl->m_certKeyFile);
 				if (HAS_JSON_FIELD(ssl, JSON_KEY_SSLEnabled))
-					SET_COMPARE(this->m_rest->m_ssl->m_sslEnabled, newConfig->m_rest->m_ssl->m_sslEnabled);
+					HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_SSL "." JSON_KEY_SSLEnabled, this->m_rest->m_ssl->m_sslEnabled, newConfig->m_rest->m_ssl->m_sslEnabled);
 			}
 
 			// JWT
 			if (HAS_JSON_FIELD(rest, JSON_KEY_JWT))
 			{
+				const auto changeCount = changes.size();
 				auto sec = rest.at(JSON_KEY_JWT);
 				if (HAS_JSON_FIELD(sec, JSON_KEY_JWTEnabled))
-					SET_COMPARE(this->m_rest->m_jwt->m_jwtEnabled, newConfig->m_rest->m_jwt->m_jwtEnabled);
+					HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_JWT "." JSON_KEY_JWTEnabled, this->m_rest->m_jwt->m_jwtEnabled, newConfig->m_rest->m_jwt->m_jwtEnabled);
 				if (HAS_JSON_FIELD(sec, JSON_KEY_JWTSalt))
-					SET_COMPARE(this->m_rest->m_jwt->m_jwtSalt, newConfig->m_rest->m_jwt->m_jwtSalt);
+					HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_JWT "." JSON_KEY_JWTSalt, this->m_rest->m_jwt->m_jwtSalt, newConfig->m_rest->m_jwt->m_jwtSalt);
 				if (HAS_JSON_FIELD(sec, JSON_KEY_SECURITY_Interface))
-					SET_COMPARE(this->m_rest->m_jwt->m_jwtInterface, newConfig->m_rest->m_jwt->m_jwtInterface);
+					HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_JWT "." JSON_KEY_SECURITY_Interface, this->m_rest->m_jwt->m_jwtInterface, newConfig->m_rest->m_jwt->m_jwtInterface);
+				// verified token depend on JWT salt, keep cache when nothing changed
+				if (changes.size() != changeCount)
+					TokenCache::instance()->invalidateAll();
 			}
+			// Admission
+			if (HAS_JSON_FIELD(rest, JSON_KEY_Admission) && sectionChanged(this->m_rest->m_admission, newConfig->m_rest->m_admission))
+			{
+				HOT_UPDATE(JSON_KEY_REST "." JSON_KEY_Admission, this->m_rest->m_admission, newConfig->m_rest->m_admission);
+				// token bucket parameters depend on admission configuration
+				AdmissionControl::instance()->reset();
+			}
+			// Consul register URL depend on REST port and SSL
+			consulUpdated = (restPort != this->m_rest->m_restListenPort || sslEnabled != this->m_rest->m_ssl->m_sslEnabled);
 		}
 
 		// Labels
-		if (HAS_JSON_FIELD(jsonValue, JSON_KEY_Labels))
-			SET_COMPARE(this->m_label, newConfig->m_label);
+		if (HAS_JSON_FIELD(jsonValue, JSON_KEY_Labels) && sectionChanged(this->m_label, newConfig->m_label))
+		{
+			HOT_UPDATE(JSON_KEY_Labels, this->m_label, newConfig->m_label);
+			labelUpdated = true;
+		}
 
-		// Consul
-		if (HAS_JSON_FIELD(jsonValue, JSON_KEY_CONSUL))
+		// Consul, re-connect only when Consul settings changed
+		if (HAS_JSON_FIELD(jsonValue, JSON_KEY_CONSUL) &&
+			(consulUpdated || sectionChanged(this->m_consul, newConfig->m_consul) || this->m_consul->appmeshUrl() != newConfig->m_consul->appmeshUrl()))
 		{
-			SET_COMPARE(this->m_consul, newConfig->m_consul);
+			HOT_UPDATE(JSON_KEY_CONSUL, this->m_consul, newConfig->m_consul);
 			consulUpdated = true;
 		}
+		else if (consulUpdated)
+		{
+			// REST port or SSL changed without Consul section, rebuild register URL
+			this->m_consul = JsonConsul::FromJson(this->m_consul->AsJson(), this->m_rest->m_restListenPort, this->m_rest->m_ssl->m_sslEnabled);
+			changes.push_back(JSON_KEY_CONSUL);
+		}
 	}
 	// do not hold Configuration lock to access timer, timer lock is higher level
 	if (consulUpdated)
 	{
 		ConsulConnection::instance()->init();
 	}
-	ResourceCollection::instance()->getHostName(true);
+	if (labelUpdated)
+	{
+		ResourceCollection::instance()->getHostName(true);
+	}
+
+	// report
+	auto result = web::json::value::object();
+	auto jsonChanges = web::json::value::array(changes.size());
+	for (std::size_t i = 0; i < changes.size(); ++i)
+	{
+		jsonChanges[i] = web::json::value::string(changes[i]);
+	}
+	result[JSON_KEY_CONFIG_DIFF_changed] = jsonChanges;
+	if (updateApps && HAS_JSON_FIELD(jsonValue, JSON_KEY_Applications))
+	{
+		hotUpdateApps(jsonValue.at(JSON_KEY_Applications), result);
+	}
+	LOG_INF << fname << "applied configuration diff: " << result.serialize();
+	return result;
+}
+#undef HOT_UPDATE
+
+void Configuration::hotUpdateApps(const web::json::value &jsonApps, web::json::value &result)
+{
+	const static char fname[] = "Configuration::hotUpdateApps() ";
+
+	std::vector<std::string> added, updated, removed;
+	std::set<std::string> names;
+	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
+	const auto current = getApps();
+	for (auto jsonApp : jsonApps.as_array())
+	{
+		const auto appName = GET_JSON_STR_VALUE(jsonApp, JSON_KEY_APP_name);
+		names.insert(appName);
+		auto app = current->find(appName);
+		// configuration file is written by the same serializer, identical text means identical definition
+		if (app && app->AsJson(false).serialize() == jsonApp.serialize())
+		{
+			continue;
+		}
+		try
+		{
+			// set recover flag used to decrypt confidential data
+			jsonApp[JSON_KEY_APP_from_recover] = web::json::value::boolean(true);
+			this->addApp(jsonApp);
+			(app ? updated : added).push_back(appName);
+		}
+		catch (const std::exception &e)
+		{
+			LOG_ERR << fname << "failed to apply application <" << appName << "> with error: " << e.what();
+		}
+	}
+	for (const auto &app : *current)
+	{
+		const auto &appName = app->getName();
+		if (!names.count(appName) && appName != SEPARATE_REST_APP_NAME && appName != SEPARATE_DOCKER_PROXY_APP_NAME)
+		{
+			this->removeApp(appName);
+			removed.push_back(appName);
+		}
+	}
 
-	this->dump();
-	ResourceCollection::instance()->dump();
+	auto toJson = [](const std::vector<std::string> &list) {
+		auto array = web::json::value::array(list.size());
+		for (std::size_t i = 0; i < list.size(); ++i)
+			array[i] = web::json::value::string(list[i]);
+		return array;
+	};
+	result[JSON_KEY_CONFIG_DIFF_added] = toJson(added);
+	result[JSON_KEY_CONFIG_DIFF_updated] = toJson(updated);
+	result[JSON_KEY_CONFIG_DIFF_removed] = toJson(removed);
+	LOG_INF << fname << added.size() << " added, " << updated.size() << " updated, " << removed.size() << " removed, "
+			<< (current->size() - updated.size() - removed.size()) << " unchanged";
 }
 
 void Configuration::readConfigFromEnv(web::json::value &jsonConfig)
@@ -695,9 +1004,10 @@ bool Configuration::applyEnvConfig(web::json::value &jsonValue, std::string envV
 
 void Configuration::registerPrometheus()
 {
-	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
-	std::for_each(m_apps.begin(), m_apps.end(), [](std::vector<std::shared_ptr<Application>>::reference p)
-				  { p->initMetrics(PrometheusRest::instance()); });
+	for (const auto &app : *getApps())
+	{
+		app->initMetrics(PrometheusRest::instance());
+	}
 }
 
 std::shared_ptr<Application> Configuration::parseApp(const web::json::value &jsonApp)
@@ -709,20 +1019,16 @@ std::shared_ptr<Application> Configuration::parseApp(const web::json::value &jso
 
 std::shared_ptr<Application> Configuration::getApp(const std::string &appName) const
 {
-	std::vector<std::shared_ptr<Application>> apps = getApps();
-	auto iter = std::find_if(apps.begin(), apps.end(), [&appName](const std::shared_ptr<Application> &app)
-							 { return app->getName() == appName; });
-	if (iter != apps.end())
-		return *iter;
+	auto app = m_apps.find(appName);
+	if (app)
+		return app;
 
 	throw std::invalid_argument(Utility::stringFormat("No such application <%s> found", appName.c_str()));
 }
 
 bool Configuration::isAppExist(const std::string &appName)
 {
-	std::vector<std::shared_ptr<Application>> apps = getApps();
-	return std::any_of(apps.begin(), apps.end(), [&appName](const std::shared_ptr<Application> &app)
-					   { return app->getName() == appName; });
+	return m_apps.find(appName) != nullptr;
 }
 
 const web::json::value Configuration::getDockerProxyAppJson() const
@@ -753,6 +1059,12 @@ std::shared_ptr<Configuration::JsonRest> Configuration::JsonRest::FromJson(const
 	{
 		rest->m_httpThreadPoolSize = threadpool;
 	}
+	SET_JSON_INT_VALUE(jsonValue, JSON_KEY_CompressionLevel, rest->m_compressionLevel);
+	SET_JSON_INT_VALUE(jsonValue, JSON_KEY_CompressionMinSize, rest->m_compressionMinSize);
+	if (rest->m_compressionLevel < 0 || rest->m_compressionLevel > 9)
+	{
+		throw std::invalid_argument(Utility::stringFormat("invalid %s <%d>, should be 0 ~ 9", JSON_KEY_CompressionLevel, rest->m_compressionLevel));
+	}
 	if (rest->m_restListenPort < 1000 || rest->m_restListenPort > 65534)
 	{
 		rest->m_restListenPort = DEFAULT_REST_LISTEN_PORT;
@@ -768,6 +1080,11 @@ std::shared_ptr<Configuration::JsonRest> Configuration::JsonRest::FromJson(const
 	{
 		rest->m_jwt = JsonJwt::FromJson(jsonValue.at(JSON_KEY_JWT));
 	}
+	// Admission
+	if (HAS_JSON_FIELD(jsonValue, JSON_KEY_Admission))
+	{
+		rest->m_admission = JsonAdmission::FromJson(jsonValue.at(JSON_KEY_Admission));
+	}
 	return rest;
 }
 
@@ -776,6 +1093,8 @@ web::json::value Configuration::JsonRest::AsJson() const
 	auto result = web::json::value::object();
 	result[JSON_KEY_RestEnabled] = web::json::value::boolean(m_restEnabled);
 	result[JSON_KEY_HttpThreadPoolSize] = web::json::value::number((uint32_t)m_httpThreadPoolSize);
+	result[JSON_KEY_CompressionLevel] = web::json::value::number(m_compressionLevel);
+	result[JSON_KEY_CompressionMinSize] = web::json::value::number(m_compressionMinSize);
 	result[JSON_KEY_RestListenPort] = web::json::value::number(m_restListenPort);
 	result[JSON_KEY_PrometheusExporterListenPort] = web::json::value::number(m_promListenPort);
 	result[JSON_KEY_RestListenAddress] = web::json::value::string(m_restListenAddress);
@@ -786,16 +1105,21 @@ web::json::value Configuration::JsonRest::AsJson() const
 
 	// JWT
 	result[JSON_KEY_JWT] = m_jwt->AsJson();
+
+	// Admission
+	result[JSON_KEY_Admission] = m_admission->AsJson();
 	return result;
 }
 
 Configuration::JsonRest::JsonRest()
 	: m_restEnabled(false), m_httpThreadPoolSize(DEFAULT_HTTP_THREAD_POOL_SIZE),
+	  m_compressionLevel(DEFAULT_COMPRESSION_LEVEL), m_compressionMinSize(DEFAULT_COMPRESSION_MIN_SIZE),
 	  m_restListenPort(DEFAULT_REST_LISTEN_PORT), m_promListenPort(DEFAULT_PROM_LISTEN_PORT),
 	  m_separateRestInternalPort(DEFAULT_TCP_REST_LISTEN_PORT)
 {
 	m_ssl = std::make_shared<JsonSsl>();
 	m_jwt = std::make_shared<JsonJwt>();
+	m_admission = std::make_shared<JsonAdmission>();
 }
 
 std::shared_ptr<Configuration::JsonSsl> Configuration::JsonSsl::FromJson(const web::json::value &jsonValue)
@@ -852,6 +1176,70 @@ web::json::value Configuration::JsonJwt::AsJson() const
 	return result;
 }
 
+Configuration::JsonAdmission::JsonAdmission()
+	: m_requestPerSecond(0), m_requestBurst(0), m_runConcurrency(0), m_queueSize(0)
+{
+}
+
+std::shared_ptr<Configuration::JsonAdmission> Configuration::JsonAdmission::FromJson(const web::json::value &jsonObj)
+{
+	const static auto parseLimits = [](const web::json::value &limits)
+	{
+		std::map<std::string, std::pair<double, int>> result;
+		for (const auto &limit : limits.as_object())
+		{
+			result[GET_STD_STRING(limit.first)] = std::make_pair(
+				GET_JSON_DOUBLE_VALUE(limit.second, JSON_KEY_AdmissionRequestPerSecond),
+				GET_JSON_INT_VALUE(limit.second, JSON_KEY_AdmissionRequestBurst));
+		}
+		return result;
+	};
+
+	auto admission = std::make_shared<Configuration::JsonAdmission>();
+	admission->m_requestPerSecond = GET_JSON_DOUBLE_VALUE(jsonObj, JSON_KEY_AdmissionRequestPerSecond);
+	SET_JSON_INT_VALUE(jsonObj, JSON_KEY_AdmissionRequestBurst, admission->m_requestBurst);
+	SET_JSON_INT_VALUE(jsonObj, JSON_KEY_AdmissionRunConcurrency, admission->m_runConcurrency);
+	SET_JSON_INT_VALUE(jsonObj, JSON_KEY_AdmissionQueueSize, admission->m_queueSize);
+	if (HAS_JSON_FIELD(jsonObj, JSON_KEY_AdmissionUserLimits))
+	{
+		admission->m_userLimits = parseLimits(jsonObj.at(JSON_KEY_AdmissionUserLimits));
+	}
+	if (HAS_JSON_FIELD(jsonObj, JSON_KEY_AdmissionRoleLimits))
+	{
+		admission->m_roleLimits = parseLimits(jsonObj.at(JSON_KEY_AdmissionRoleLimits));
+	}
+	if (admission->m_requestPerSecond < 0 || admission->m_requestBurst < 0 || admission->m_runConcurrency < 0 || admission->m_queueSize < 0)
+	{
+		throw std::invalid_argument("Admission limitation should not be negative");
+	}
+	return admission;
+}
+
+web::json::value Configuration::JsonAdmission::AsJson() const
+{
+	const static auto limitsJson = [](const std::map<std::string, std::pair<double, int>> &limits)
+	{
+		auto result = web::json::value::object();
+		for (const auto &limit : limits)
+		{
+			auto limitJson = web::json::value::object();
+			limitJson[JSON_KEY_AdmissionRequestPerSecond] = web::json::value::number(limit.second.first);
+			limitJson[JSON_KEY_AdmissionRequestBurst] = web::json::value::number(limit.second.second);
+			result[limit.first] = limitJson;
+		}
+		return result;
+	};
+
+	auto result = web::json::value::object();
+	result[JSON_KEY_AdmissionRequestPerSecond] = web::json::value::number(m_requestPerSecond);
+	result[JSON_KEY_AdmissionRequestBurst] = web::json::value::number(m_requestBurst);
+	result[JSON_KEY_AdmissionRunConcurrency] = web::json::value::number(m_runConcurrency);
+	result[JSON_KEY_AdmissionQueueSize] = web::json::value::number(m_queueSize);
+	result[JSON_KEY_AdmissionUserLimits] = limitsJson(m_userLimits);
+	result[JSON_KEY_AdmissionRoleLimits] = limitsJson(m_roleLimits);
+	return result;
+}
+
 std::shared_ptr<Configuration::JsonConsul> Configuration::JsonConsul::FromJson(const web::json::value &jsonObj, int appmeshRestPort, bool sslEnabled)
 {
 	auto consul = std::make_shared<JsonConsul>();
@@ -863,6 +1251,10 @@ std::shared_ptr<Configuration::JsonConsul> Configuration::JsonConsul::FromJson(c
 	consul->m_isWorker = GET_JSON_BOOL_VALUE(jsonObj, JSON_KEY_CONSUL_IS_WORKER);
 	SET_JSON_INT_VALUE(jsonObj, JSON_KEY_CONSUL_SESSION_TTL, consul->m_ttl);
 	SET_JSON_BOOL_VALUE(jsonObj, JSON_KEY_CONSUL_SECURITY, consul->m_securitySync);
+	SET_JSON_INT_VALUE(jsonObj, JSON_KEY_CONSUL_CONNECTION_POOL, consul->m_connectionPoolSize);
+	if (HAS_JSON_FIELD(jsonObj, JSON_KEY_CONSUL_SCHEDULE_STRATEGY))
+		consul->m_scheduleStrategy = GET_JSON_STR_VALUE(jsonObj, JSON_KEY_CONSUL_SCHEDULE_STRATEGY);
+	SET_JSON_INT_VALUE(jsonObj, JSON_KEY_CONSUL_SCHEDULE_MAX_MOVES, consul->m_scheduleMaxMoves);
 	const static boost::regex urlExpr("(http|https)://((\\w+\\.)*\\w+)(\\:[0-9]+)?");
 	if (consul->m_consulUrl.length() && !boost::regex_match(consul->m_consulUrl, urlExpr))
 	{
@@ -870,6 +1262,11 @@ std::shared_ptr<Configuration::JsonConsul> Configuration::JsonConsul::FromJson(c
 	}
 	if (consul->m_ttl < 5)
 		throw std::invalid_argument("session TTL should not less than 5s");
+	if (consul->m_connectionPoolSize < 1)
+		throw std::invalid_argument("Consul connection pool size should be positive");
+	ResourceScheduler::parseStrategy(consul->m_scheduleStrategy);
+	if (consul->m_scheduleMaxMoves < 0)
+		throw std::invalid_argument("schedule max moves should not be negative");
 
 	{
 		auto hostname = ResourceCollection::instance()->getHostName();
@@ -888,6 +1285,9 @@ web::json::value Configuration::JsonConsul::AsJson() const
 	result[JSON_KEY_CONSUL_IS_WORKER] = web::json::value::boolean(m_isWorker);
 	result[JSON_KEY_CONSUL_SESSION_TTL] = web::json::value::number(m_ttl);
 	result[JSON_KEY_CONSUL_SECURITY] = web::json::value::boolean(m_securitySync);
+	result[JSON_KEY_CONSUL_CONNECTION_POOL] = web::json::value::number(m_connectionPoolSize);
+	result[JSON_KEY_CONSUL_SCHEDULE_STRATEGY] = web::json::value::string(m_scheduleStrategy);
+	result[JSON_KEY_CONSUL_SCHEDULE_MAX_MOVES] = web::json::value::number(m_scheduleMaxMoves);
 	if (m_proxyUrl.length())
 		result[JSON_KEY_CONSUL_APPMESH_PROXY_URL] = web::json::value::string(m_proxyUrl);
 	if (m_basicAuthUser.length())
@@ -916,6 +1316,6 @@ const std::string Configuration::JsonConsul::appmeshUrl() const
 }
 
 Configuration::JsonConsul::JsonConsul()
-	: m_isMaster(false), m_isWorker(false), m_ttl(CONSUL_SESSION_DEFAULT_TTL), m_securitySync(false)
+	: m_isMaster(false), m_isWorker(false), m_ttl(CONSUL_SESSION_DEFAULT_TTL), m_securitySync(false), m_connectionPoolSize(CONSUL_CONNECTION_POOL_DEFAULT_SIZE), m_scheduleStrategy(ResourceScheduler::strategyName(ResourceScheduler::Strategy::SPREAD)), m_scheduleMaxMoves(0)
 {
 }
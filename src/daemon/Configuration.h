@@ -1,16 +1,23 @@
 #pragma once
 
 #include <cpprest/json.h>
+#include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <string>
+#include <tuple>
 #include <vector>
 
+#include "../common/RcuRegistry.h"
+
 class RestHandler;
 class User;
 class Label;
 class Application;
+class AppFilter;
+class JsonWriter;
 
 /// <summary>
 /// Configuration file <appsvc.json> parse/update
@@ -39,6 +46,22 @@ public:
 		std::string m_jwtInterface;
 	};
 
+	struct JsonAdmission
+	{
+		JsonAdmission();
+		static std::shared_ptr<JsonAdmission> FromJson(const web::json::value &jsonObj);
+		web::json::value AsJson() const;
+
+		// 0 means no limitation
+		double m_requestPerSecond;
+		int m_requestBurst;
+		int m_runConcurrency;
+		int m_queueSize;
+		// key: user name or role name; value: <request per second, request burst>
+		std::map<std::string, std::pair<double, int>> m_userLimits;
+		std::map<std::string, std::pair<double, int>> m_roleLimits;
+	};
+
 	struct JsonRest
 	{
 		JsonRest();
@@ -47,6 +70,8 @@ public:
 
 		bool m_restEnabled;
 		int m_httpThreadPoolSize;
+		int m_compressionLevel;
+		int m_compressionMinSize;
 		int m_restListenPort;
 		int m_promListenPort;
 		std::string m_restListenAddress;
@@ -54,6 +79,7 @@ public:
 		std::string m_dockerProxyListenAddr;
 		std::shared_ptr<JsonSsl> m_ssl;
 		std::shared_ptr<JsonJwt> m_jwt;
+		std::shared_ptr<JsonAdmission> m_admission;
 	};
 
 	struct JsonConsul
@@ -76,6 +102,12 @@ public:
 		// TTL (string: "") - Specifies the number of seconds (between 10s and 86400s).
 		int m_ttl;
 		bool m_securitySync;
+		// keep-alive connections for short requests, watches use dedicated connections
+		int m_connectionPoolSize;
+		// leader schedule strategy: spread, binpack, leastloaded
+		std::string m_scheduleStrategy;
+		// max replicas placed to new hosts in one schedule cycle, 0 is unlimited
+		int m_scheduleMaxMoves;
 		std::string m_basicAuthUser;
 		std::string m_basicAuthPass;
 	};
@@ -91,15 +123,45 @@ public:
 	static std::shared_ptr<Configuration> FromJson(const std::string &str, bool applyEnv = false) noexcept(false);
 	web::json::value AsJson(bool returnRuntimeInfo, const std::string &user);
 	void deSerializeApp(const web::json::value &jsonObj);
+	/// <summary>
+	/// Stream the same content of AsJson(false, user) into writer
+	/// </summary>
+	void writeJson(JsonWriter &writer, const std::string &user);
+	/// <summary>
+	/// Write full checkpoint and compact configuration journal,
+	/// single mutation should append ConfigJournal record instead
+	/// </summary>
 	void saveConfigToDisk();
-	void hotUpdate(const web::json::value &config);
+	/// <summary>
+	/// Write full configuration file, used by ConfigJournal::compact()
+	/// </summary>
+	bool writeCheckpoint();
+	/// <summary>
+	/// Apply only changed configuration items, Consul and token cache are
+	/// reset only when related settings changed
+	/// </summary>
+	/// <param name="config">full or partial configuration JSON</param>
+	/// <param name="updateApps">diff "Applications" with running applications, restart changed only</param>
+	/// <returns>applied diff: {"changed": [], "added": [], "updated": [], "removed": []}</returns>
+	web::json::value hotUpdate(const web::json::value &config, bool updateApps = false);
 	static void readConfigFromEnv(web::json::value &jsonConfig);
 	static bool applyEnvConfig(web::json::value &jsonValue, std::string envValue);
 	void registerPrometheus();
 
-	std::vector<std::shared_ptr<Application>> getApps() const;
-	std::shared_ptr<Application> addApp(const web::json::value &jsonApp);
-	void removeApp(const std::string &appName);
+	typedef RcuRegistry<Application>::SnapshotPtr AppSnapshot;
+	/// <summary>
+	/// Immutable application list snapshot, no lock and no copy
+	/// </summary>
+	AppSnapshot getApps() const;
+	std::shared_ptr<Application> addApp(const web::json::value &jsonApp, bool persist = true);
+	void removeApp(const std::string &appName, bool persist = true);
+	/// <summary>
+	/// Apply application operations under one configuration lock, each operation append one journal record
+	/// </summary>
+	/// <param name="operations">JSON array: [{"action": "add|enable|disable|remove", "name": "app1", "app": {...}}]</param>
+	/// <param name="validator">check each operation (permission, etc.), throw exception to reject the operation</param>
+	/// <returns>JSON array with result for each operation</returns>
+	web::json::value batchApps(const web::json::value &operations, const std::function<void(const std::string &action, const std::string &appName, web::json::value &operation)> &validator);
 	std::shared_ptr<Application> parseApp(const web::json::value &jsonApp);
 
 	int getScheduleInterval();
@@ -109,10 +171,18 @@ public:
 	std::string getDockerProxyAddress() const;
 	int getSeparateRestInternalPort();
 	web::json::value serializeApplication(bool returnRuntimeInfo, const std::string &user) const;
+	/// <summary>
+	/// Serialize runtime application list from per-application cached JSON
+	/// </summary>
+	/// <param name="user">request user used to filter applications</param>
+	/// <param name="ifNoneMatch">ETag from client, skip serialize when match</param>
+	/// <param name="filter">optional filter/projection/pagination, evaluated before serialize</param>
+	/// <returns>ETag, JSON array string (empty when ETag match) and next page cursor</returns>
+	std::tuple<std::string, std::string, std::string> serializeApplicationCached(const std::string &user, const std::string &ifNoneMatch, const std::shared_ptr<AppFilter> &filter = nullptr) const;
 	std::shared_ptr<Application> getApp(const std::string &appName) const noexcept(false);
 	bool isAppExist(const std::string &appName);
-	void disableApp(const std::string &appName);
-	void enableApp(const std::string &appName);
+	void disableApp(const std::string &appName, bool persist = true);
+	void enableApp(const std::string &appName, bool persist = true);
 	const web::json::value getDockerProxyAppJson() const;
 
 	std::shared_ptr<Label> getLabel() { return m_label; }
@@ -126,19 +196,24 @@ public:
 	bool getRestEnabled() const;
 	bool getJwtEnabled() const;
 	std::size_t getThreadPoolSize() const;
+	int getCompressionLevel() const;
+	int getCompressionMinSize() const;
 	const std::string getDescription() const;
 
 	const std::shared_ptr<Configuration::JsonConsul> getConsul() const;
 	const std::shared_ptr<JsonJwt> getJwt() const;
+	const std::shared_ptr<JsonAdmission> getAdmission() const;
 	bool checkOwnerPermission(const std::string &user, const std::shared_ptr<User> &appOwner, int appPermission, bool requestWrite) const;
 
 	void dump();
 
 private:
 	void addApp2Map(std::shared_ptr<Application> app);
+	void hotUpdateApps(const web::json::value &jsonApps, web::json::value &result);
 
 private:
-	std::vector<std::shared_ptr<Application>> m_apps;
+	// readers load snapshot, writers (serialized by m_appMutex) publish new version
+	RcuRegistry<Application> m_apps;
 	std::string m_hostDescription;
 	std::string m_defaultExecUser;
 	std::string m_defaultWorkDir;
@@ -1,53 +1,297 @@
+#include <poll.h>
+#include <vector>
+
 #include "HealthCheckTask.h"
 #include "../common/PerfLog.h"
 #include "../common/Utility.h"
 #include "Configuration.h"
+#include "HealthProbe.h"
 #include "application/Application.h"
 #include "process/AppProcess.h"
+#include "process/ProcessReaper.h"
 
 HealthCheckTask::HealthCheckTask()
+	: m_random(std::random_device()()), m_timerId(0)
 {
+	m_pollScheduled.clear();
 }
 
 HealthCheckTask::~HealthCheckTask()
 {
 }
 
-void HealthCheckTask::doHealthCheck()
+void HealthCheckTask::init()
+{
+	if (m_timerId == 0)
+	{
+		m_timerId = this->registerTimer(1000L, 1, std::bind(&HealthCheckTask::doHealthCheck, this, std::placeholders::_1), __FUNCTION__);
+	}
+}
+
+const HealthCheckPolicy &HealthCheckTask::policy(const std::shared_ptr<Application> &app)
+{
+	const static HealthCheckPolicy defaultPolicy;
+	return app->healthCheckPolicy() ? *app->healthCheckPolicy() : defaultPolicy;
+}
+
+bool HealthCheckTask::due(const std::shared_ptr<Application> &app, const std::chrono::steady_clock::time_point &now)
+{
+	const auto &healthPolicy = policy(app);
+	const int interval = healthPolicy.m_interval > 0 ? healthPolicy.m_interval : Configuration::instance()->getScheduleInterval();
+	const auto intervalMs = 1000L * interval;
+	auto iter = m_schedules.find(app->getName());
+	if (iter == m_schedules.end() || iter->second.m_app.lock() != app)
+	{
+		// new or re-registered application: first check at a random phase after initial delay
+		Schedule schedule;
+		schedule.m_app = app;
+		schedule.m_successes = schedule.m_failures = 0;
+		const auto phase = std::uniform_int_distribution<long>(0, intervalMs)(m_random);
+		schedule.m_next = now + std::chrono::seconds(healthPolicy.m_initialDelay) + std::chrono::milliseconds(phase);
+		m_schedules[app->getName()] = schedule;
+		return false;
+	}
+	auto &schedule = iter->second;
+	if (now < schedule.m_next)
+	{
+		return false;
+	}
+	const auto jitter = intervalMs * DEFAULT_HEALTH_CHECK_JITTER_PERCENT / 100;
+	schedule.m_next = now + std::chrono::milliseconds(intervalMs + std::uniform_int_distribution<long>(-jitter, jitter)(m_random));
+	return true;
+}
+
+void HealthCheckTask::report(const std::shared_ptr<Application> &app, bool healthy)
+{
+	auto iter = m_schedules.find(app->getName());
+	if (iter == m_schedules.end())
+	{
+		app->health(healthy);
+		return;
+	}
+	const auto &healthPolicy = policy(app);
+	auto &schedule = iter->second;
+	if (healthy)
+	{
+		schedule.m_failures = 0;
+		if (++schedule.m_successes >= healthPolicy.m_successThreshold)
+			app->health(true);
+	}
+	else
+	{
+		schedule.m_successes = 0;
+		if (++schedule.m_failures >= healthPolicy.m_failureThreshold)
+			app->health(false);
+	}
+}
+
+void HealthCheckTask::doHealthCheck(int timerId)
 {
 	const static char fname[] = "HealthCheckTask::doHealthCheck() ";
 	PerfLog perf(fname);
 	auto apps = Configuration::instance()->getApps();
-	for (auto &app : apps)
+	const auto now = std::chrono::steady_clock::now();
+	bool polling = false;
 	{
-		if (app->healthCheckCmd().empty())
-			continue;
-		try
+		std::lock_guard<std::mutex> guard(m_mutex);
+		// forget removed applications
+		for (auto iter = m_schedules.begin(); iter != m_schedules.end();)
 		{
-			if (app->available())
+			iter = iter->second.m_app.expired() ? m_schedules.erase(iter) : std::next(iter);
+		}
+		for (const auto &app : *apps)
+		{
+			if (app->healthCheckCmd().empty() || !due(app, now))
+				continue;
+			if (!app->available())
 			{
-				auto proc = std::make_shared<AppProcess>();
-				proc->spawnProcess(app->healthCheckCmd(), "", "", {}, nullptr, "", EMPTY_STR_JSON, 0);
-				proc->delayKill(DEFAULT_HEALTH_CHECK_INTERVAL, fname);
-				ACE_exitcode exitCode;
-				proc->wait(&exitCode);
-				app->health(0 == exitCode);
-				// proc->killgroup();
-				LOG_DBG << fname << app->getName() << " health check :" << app->healthCheckCmd() << ", return " << exitCode << ", last error: " << proc->startError();
+				app->health(false);
+				continue;
 			}
-			else
+			// previous probe still running or queued, its result is on the way
+			if (!m_scheduled.insert(app->getName()).second)
+				continue;
+			try
 			{
-				app->health(false);
+				auto probe = HealthProbe::parse(app->healthCheckCmd());
+				if (probe->native())
+				{
+					polling = startNative(app, probe) || polling;
+					continue;
+				}
+			}
+			catch (const std::exception &ex)
+			{
+				LOG_WAR << fname << app->getName() << " check got exception: " << ex.what();
+				m_scheduled.erase(app->getName());
+				continue;
+			}
+			m_pending.push_back(app);
+		}
+	}
+	if (polling)
+	{
+		schedulePoll();
+	}
+	dispatch();
+}
+
+bool HealthCheckTask::startNative(const std::shared_ptr<Application> &app, const std::shared_ptr<HealthProbe> &probe)
+{
+	const static char fname[] = "HealthCheckTask::startNative() ";
+
+	if (probe->start(app->getpid(), policy(app).m_timeout))
+	{
+		// file and pid probe finish immediately
+		m_scheduled.erase(app->getName());
+		report(app, probe->healthy());
+		LOG_DBG << fname << app->getName() << " health check :" << app->healthCheckCmd() << ", healthy " << probe->healthy() << " " << probe->error();
+		return false;
+	}
+	NativeProbe nativeProbe;
+	nativeProbe.m_app = app;
+	nativeProbe.m_probe = probe;
+	m_nativeProbes[app->getName()] = nativeProbe;
+	return true;
+}
+
+void HealthCheckTask::pollNative(int timerId)
+{
+	const static char fname[] = "HealthCheckTask::pollNative() ";
+
+	m_pollScheduled.clear();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_nativeProbes.empty())
+		return;
+	std::vector<struct pollfd> fds;
+	fds.reserve(m_nativeProbes.size());
+	for (const auto &probe : m_nativeProbes)
+	{
+		struct pollfd fd;
+		fd.fd = probe.second.m_probe->fd();
+		fd.events = probe.second.m_probe->events();
+		fd.revents = 0;
+		fds.push_back(fd);
+	}
+	if (::poll(fds.data(), fds.size(), 0) < 0)
+	{
+		LOG_WAR << fname << "poll failed with error: " << std::strerror(errno);
+		lock.unlock();
+		schedulePoll();
+		return;
+	}
+	const auto now = std::chrono::steady_clock::now();
+	std::size_t index = 0;
+	for (auto iter = m_nativeProbes.begin(); iter != m_nativeProbes.end(); ++index)
+	{
+		auto &probe = iter->second.m_probe;
+		const auto revents = fds[index].revents;
+		const bool finished = (revents && probe->onEvent(revents)) || probe->checkTimeout(now);
+		if (!finished)
+		{
+			++iter;
+			continue;
+		}
+		auto app = iter->second.m_app.lock();
+		if (app)
+		{
+			report(app, probe->healthy());
+			LOG_DBG << fname << iter->first << " health check :" << app->healthCheckCmd() << ", healthy " << probe->healthy() << " " << probe->error();
+		}
+		m_scheduled.erase(iter->first);
+		iter = m_nativeProbes.erase(iter);
+	}
+	const bool polling = !m_nativeProbes.empty();
+	lock.unlock();
+	if (polling)
+	{
+		schedulePoll();
+	}
+}
+
+void HealthCheckTask::dispatch()
+{
+	const static char fname[] = "HealthCheckTask::dispatch() ";
+
+	while (true)
+	{
+		std::shared_ptr<Application> app;
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			if (m_pending.empty() || m_probes.size() >= DEFAULT_HEALTH_CHECK_CONCURRENCY)
+				break;
+			app = m_pending.front().lock();
+			m_pending.pop_front();
+			if (app == nullptr)
+				continue;
+			if (app->healthCheckCmd().empty() || !app->available())
+			{
+				m_scheduled.erase(app->getName());
+				continue;
 			}
 		}
+
+		// fork and timer register do not hold probe lock
+		auto proc = std::make_shared<AppProcess>();
+		try
+		{
+			proc->spawnProcess(app->healthCheckCmd(), "", "", {}, nullptr, "", EMPTY_STR_JSON, 0);
+			// probe timeout is enforced by process kill timer, reaper get a none-zero exit code
+			proc->delayKill(policy(app).m_timeout, fname);
+		}
 		catch (const std::exception &ex)
 		{
-			LOG_WAR << fname << app->getName() << "check got exception: " << ex.what();
+			LOG_WAR << fname << app->getName() << " check got exception: " << ex.what();
+		}
+
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			if (proc->getpid() <= 0)
+			{
+				m_scheduled.erase(app->getName());
+				report(app, false);
+				LOG_WAR << fname << app->getName() << " start health check failed: " << proc->startError();
+				continue;
+			}
+			Probe probe;
+			probe.m_app = app;
+			probe.m_process = proc;
+			m_probes[app->getName()] = probe;
 		}
-		catch (...)
+		// registered after probe is recorded, exit callback always find it
+		ProcessReaper::instance()->watch(proc, std::bind(&HealthCheckTask::onProbeExit, this, app->getName(), proc));
+	}
+}
+
+void HealthCheckTask::onProbeExit(const std::string &appName, const std::shared_ptr<AppProcess> &process)
+{
+	const static char fname[] = "HealthCheckTask::onProbeExit() ";
+
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		auto iter = m_probes.find(appName);
+		if (iter == m_probes.end() || iter->second.m_process != process)
+			return;
+		// removed application probe is killed by timeout timer, result is dropped
+		auto app = iter->second.m_app.lock();
+		if (app)
 		{
-			LOG_WAR << fname << app->getName() << " exception";
+			const auto exitCode = process->returnValue();
+			report(app, 0 == exitCode);
+			LOG_DBG << fname << appName << " health check :" << app->healthCheckCmd() << ", return " << exitCode << ", last error: " << process->startError();
 		}
+		m_scheduled.erase(appName);
+		m_probes.erase(iter);
+	}
+	// free slot for queued probes
+	dispatch();
+}
+
+void HealthCheckTask::schedulePoll()
+{
+	if (!m_pollScheduled.test_and_set())
+	{
+		this->registerTimer(DEFAULT_HEALTH_CHECK_POLL_MS, 0, std::bind(&HealthCheckTask::pollNative, this, std::placeholders::_1), __FUNCTION__);
 	}
 }
 
@@ -1,14 +1,103 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+
+#include "TimerHandler.h"
+
+class Application;
+class AppProcess;
+class HealthProbe;
+struct HealthCheckPolicy;
 //////////////////////////////////////////////////////////////////////////
 /// Do health check for applications
+/// Each application is checked by its own HealthCheckPolicy (interval,
+/// timeout, initial delay and success/failure thresholds), first check is
+/// placed at a random phase of the interval and each interval is jittered
+/// to spread probes, a one second timer dispatch the due checks.
+/// Command probes are executed asynchronously with bounded concurrency, each
+/// probe is killed by its own delayKill timer when timeout, exited probes are
+/// reaped by ProcessReaper and result is published to application.
+/// Native probes (see HealthProbe) run in process, socket probes are driven
+/// by a short poll timer with non-blocking sockets.
 //////////////////////////////////////////////////////////////////////////
-class HealthCheckTask
+class HealthCheckTask : public TimerHandler
 {
 public:
 	HealthCheckTask();
 	virtual ~HealthCheckTask();
 	static std::shared_ptr<HealthCheckTask> &instance();
-	void doHealthCheck();
+	/// <summary>
+	/// Register schedule timer
+	/// </summary>
+	void init();
+	/// <summary>
+	/// Queue due health checks and start probes, never wait for a probe
+	/// </summary>
+	void doHealthCheck(int timerId = 0);
+
+private:
+	struct Probe
+	{
+		std::weak_ptr<Application> m_app;
+		std::shared_ptr<AppProcess> m_process;
+	};
+	struct NativeProbe
+	{
+		std::weak_ptr<Application> m_app;
+		std::shared_ptr<HealthProbe> m_probe;
+	};
+	struct Schedule
+	{
+		std::weak_ptr<Application> m_app;
+		std::chrono::steady_clock::time_point m_next;
+		int m_successes;
+		int m_failures;
+	};
+	/// <summary>
+	/// Check whether application is due and calculate next check time, need lock
+	/// </summary>
+	bool due(const std::shared_ptr<Application> &app, const std::chrono::steady_clock::time_point &now);
+	/// <summary>
+	/// Apply probe result with threshold, need lock
+	/// </summary>
+	void report(const std::shared_ptr<Application> &app, bool healthy);
+	static const HealthCheckPolicy &policy(const std::shared_ptr<Application> &app);
+	/// <summary>
+	/// Start native probe, need lock
+	/// </summary>
+	/// <returns>true if socket probe is waiting for events</returns>
+	bool startNative(const std::shared_ptr<Application> &app, const std::shared_ptr<HealthProbe> &probe);
+	/// <summary>
+	/// Poll socket probes without wait and publish health result
+	/// </summary>
+	void pollNative(int timerId = 0);
+	/// <summary>
+	/// Start queued probes until concurrency limitation reached
+	/// </summary>
+	void dispatch();
+	/// <summary>
+	/// Publish health result of exited command probe, called from ProcessReaper
+	/// </summary>
+	void onProbeExit(const std::string &appName, const std::shared_ptr<AppProcess> &process);
+	void schedulePoll();
+
+	std::mutex m_mutex;
+	// applications wait for a free probe slot
+	std::deque<std::weak_ptr<Application>> m_pending;
+	// application names queued or probing, avoid duplicate probe for one application
+	std::set<std::string> m_scheduled;
+	std::map<std::string, Probe> m_probes;
+	std::map<std::string, NativeProbe> m_nativeProbes;
+	std::map<std::string, Schedule> m_schedules;
+	std::mt19937 m_random;
+	int m_timerId;
+	std::atomic_flag m_pollScheduled;
 };
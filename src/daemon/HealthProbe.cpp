@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../common/Utility.h"
+#include "HealthProbe.h"
+
+HealthProbe::HealthProbe()
+	: m_type(Type::COMMAND), m_port(0), m_argument(0), m_state(State::FINISHED), m_fd(-1), m_sent(0), m_healthy(false)
+{
+}
+
+HealthProbe::~HealthProbe()
+{
+	closeSocket();
+}
+
+std::shared_ptr<HealthProbe> HealthProbe::parse(const std::string &spec)
+{
+	auto probe = std::make_shared<HealthProbe>();
+	const auto schemeEnd = spec.find("://");
+	if (schemeEnd == std::string::npos)
+	{
+		return probe;
+	}
+	const auto scheme = spec.substr(0, schemeEnd);
+	if (scheme == "http")
+		probe->m_type = Type::HTTP;
+	else if (scheme == "tcp")
+		probe->m_type = Type::TCP;
+	else if (scheme == "unix")
+		probe->m_type = Type::UNIX;
+	else if (scheme == "file")
+		probe->m_type = Type::FILE;
+	else if (scheme == "pid")
+		probe->m_type = Type::PID;
+	else if (scheme.length() && std::all_of(scheme.begin(), scheme.end(), ::isalnum))
+		throw std::invalid_argument(Utility::stringFormat("unsupported health check type <%s>", scheme.c_str()));
+	else
+		return probe; // a shell command contains "://"
+
+	// target and optional argument
+	auto target = spec.substr(schemeEnd + 3);
+	const auto space = target.find(' ');
+	if (space != std::string::npos)
+	{
+		const auto argument = Utility::stdStringTrim(target.substr(space + 1));
+		target = target.substr(0, space);
+		try
+		{
+			probe->m_argument = std::stoi(argument);
+		}
+		catch (...)
+		{
+			throw std::invalid_argument(Utility::stringFormat("invalid health check argument <%s>", argument.c_str()));
+		}
+	}
+
+	switch (probe->m_type)
+	{
+	case Type::HTTP:
+	case Type::TCP:
+	{
+		const auto slash = target.find('/');
+		const auto address = target.substr(0, slash);
+		probe->m_path = (slash == std::string::npos) ? "/" : target.substr(slash);
+		const auto bracket = address.rfind(']');
+		const auto colon = address.rfind(':');
+		if (colon == std::string::npos || (bracket != std::string::npos && colon < bracket))
+		{
+			probe->m_host = address;
+			probe->m_port = (probe->m_type == Type::HTTP) ? 80 : 0;
+		}
+		else
+		{
+			probe->m_host = address.substr(0, colon);
+			probe->m_port = std::atoi(address.substr(colon + 1).c_str());
+		}
+		// [::1]
+		if (probe->m_host.length() > 2 && probe->m_host.front() == '[' && probe->m_host.back() == ']')
+			probe->m_host = probe->m_host.substr(1, probe->m_host.length() - 2);
+		if (probe->m_host == "localhost")
+			probe->m_host = "127.0.0.1";
+		if (probe->m_host.empty() || probe->m_port <= 0 || probe->m_port > 65535)
+			throw std::invalid_argument(Utility::stringFormat("invalid health check address <%s>", address.c_str()));
+		// probe run on timer thread, host name is not resolved by DNS
+		struct in6_addr numeric;
+		if (::inet_pton(AF_INET, probe->m_host.c_str(), &numeric) != 1 && ::inet_pton(AF_INET6, probe->m_host.c_str(), &numeric) != 1)
+			throw std::invalid_argument(Utility::stringFormat("health check host <%s> should be IP address", probe->m_host.c_str()));
+		break;
+	}
+	case Type::UNIX:
+	case Type::FILE:
+		probe->m_path = target;
+		if (probe->m_path.empty() || probe->m_path[0] != '/')
+			throw std::invalid_argument(Utility::stringFormat("health check path <%s> should be absolute", target.c_str()));
+		if (probe->m_type == Type::UNIX && probe->m_path.length() >= sizeof(sockaddr_un::sun_path))
+			throw std::invalid_argument("health check unix socket path is too long");
+		break;
+	default:
+		break;
+	}
+	return probe;
+}
+
+bool HealthProbe::start(pid_t appPid, int timeoutSeconds)
+{
+	closeSocket();
+	m_buffer.clear();
+	m_sent = 0;
+	m_error.clear();
+	m_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeoutSeconds);
+
+	switch (m_type)
+	{
+	case Type::PID:
+		return finish(appPid > 0 && ::kill(appPid, 0) == 0, "process not running");
+	case Type::FILE:
+	{
+		struct stat st;
+		if (::stat(m_path.c_str(), &st) != 0)
+			return finish(false, std::strerror(errno));
+		const auto age = std::time(nullptr) - st.st_mtime;
+		return finish(m_argument <= 0 || age <= m_argument, Utility::stringFormat("file not updated in %ld seconds", static_cast<long>(age)));
+	}
+	case Type::HTTP:
+	case Type::TCP:
+	case Type::UNIX:
+		return connectSocket();
+	default:
+		return finish(false, "command should be executed by process");
+	}
+}
+
+bool HealthProbe::connectSocket()
+{
+	int rc = -1;
+	if (m_type == Type::UNIX)
+	{
+		struct sockaddr_un addr;
+		std::memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		std::strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+		m_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (m_fd < 0)
+			return finish(false, std::strerror(errno));
+		rc = ::connect(m_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+	}
+	else
+	{
+		// address is validated as numeric by parse(), never query DNS
+		struct addrinfo hints;
+		std::memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		hints.ai_flags = AI_NUMERICHOST | AI_NUMERICSERV;
+		struct addrinfo *result = nullptr;
+		if (::getaddrinfo(m_host.c_str(), std::to_string(m_port).c_str(), &hints, &result) != 0 || result == nullptr)
+			return finish(false, Utility::stringFormat("failed to resolve <%s>", m_host.c_str()));
+		m_fd = ::socket(result->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (m_fd >= 0)
+			rc = ::connect(m_fd, result->ai_addr, result->ai_addrlen);
+		::freeaddrinfo(result);
+		if (m_fd < 0)
+			return finish(false, std::strerror(errno));
+	}
+
+	if (rc == 0)
+	{
+		m_state = State::CONNECTING;
+		return onEvent(POLLOUT);
+	}
+	if (errno != EINPROGRESS)
+		return finish(false, std::strerror(errno));
+	m_state = State::CONNECTING;
+	return false;
+}
+
+short HealthProbe::events() const
+{
+	return (m_state == State::RECEIVING) ? POLLIN : POLLOUT;
+}
+
+bool HealthProbe::onEvent(short revents)
+{
+	if (m_state == State::CONNECTING)
+	{
+		int error = 0;
+		socklen_t length = sizeof(error);
+		if (::getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0 || error != 0)
+			return finish(false, std::strerror(error ? error : errno));
+		if (m_type != Type::HTTP)
+			return finish(true);
+		const auto host = (m_host.find(':') == std::string::npos) ? m_host : "[" + m_host + "]";
+		m_buffer = Utility::stringFormat("GET %s HTTP/1.0\r\nHost: %s\r\nUser-Agent: appmesh\r\nConnection: close\r\n\r\n", m_path.c_str(), host.c_str());
+		m_state = State::SENDING;
+	}
+	if (m_state == State::SENDING)
+	{
+		const auto sent = ::send(m_fd, m_buffer.data() + m_sent, m_buffer.length() - m_sent, MSG_NOSIGNAL);
+		if (sent < 0)
+			return (errno == EAGAIN || errno == EWOULDBLOCK) ? false : finish(false, std::strerror(errno));
+		m_sent += sent;
+		if (m_sent < m_buffer.length())
+			return false;
+		m_buffer.clear();
+		m_state = State::RECEIVING;
+		return false;
+	}
+	if (m_state == State::RECEIVING && (revents & (POLLIN | POLLHUP | POLLERR)))
+	{
+		char buffer[256];
+		const auto received = ::recv(m_fd, buffer, sizeof(buffer), 0);
+		if (received < 0)
+			return (errno == EAGAIN || errno == EWOULDBLOCK) ? false : finish(false, std::strerror(errno));
+		m_buffer.append(buffer, received);
+		// only status line is needed
+		if (m_buffer.find("\r\n") != std::string::npos || received == 0 || m_buffer.length() > 1024)
+			return checkStatusLine();
+	}
+	return m_state == State::FINISHED;
+}
+
+bool HealthProbe::checkStatusLine()
+{
+	// HTTP/1.1 200 OK
+	const auto space = m_buffer.find(' ');
+	if (!Utility::startWith(m_buffer, "HTTP/") || space == std::string::npos)
+		return finish(false, "invalid HTTP response");
+	const int status = std::atoi(m_buffer.c_str() + space + 1);
+	const bool healthy = m_argument > 0 ? (status == m_argument) : (status >= 200 && status < 400);
+	return finish(healthy, Utility::stringFormat("HTTP status %d", status));
+}
+
+bool HealthProbe::checkTimeout(const std::chrono::steady_clock::time_point &now)
+{
+	if (m_state != State::FINISHED && now >= m_deadline)
+	{
+		finish(false, "health check timeout");
+		return true;
+	}
+	return false;
+}
+
+bool HealthProbe::finish(bool healthy, const std::string &error)
+{
+	closeSocket();
+	m_state = State::FINISHED;
+	m_healthy = healthy;
+	m_error = healthy ? "" : error;
+	return true;
+}
+
+void HealthProbe::closeSocket()
+{
+	if (m_fd >= 0)
+	{
+		::close(m_fd);
+		m_fd = -1;
+	}
+}
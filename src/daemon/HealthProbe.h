@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <sys/types.h>
+
+//////////////////////////////////////////////////////////////////////////
+/// Native health probe, avoid fork a shell command for each check
+/// health_check_cmd format: <type>://<target>[ <argument>]
+///  1. http://127.0.0.1:8080/health [expected status], default 2xx/3xx
+///  2. tcp://127.0.0.1:8080
+///     host should be IPv4, [IPv6] or localhost, DNS name is not resolved
+///  3. unix:///var/run/app.sock
+///  4. file:///var/run/app.heartbeat [max age seconds]
+///  5. pid:// (application process is alive)
+/// Other value is executed as command, return 0 is health.
+/// Socket probes use non-blocking socket and are driven by poll from
+/// HealthCheckTask, they never block the caller.
+//////////////////////////////////////////////////////////////////////////
+class HealthProbe
+{
+public:
+	enum class Type
+	{
+		COMMAND,
+		HTTP,
+		TCP,
+		UNIX,
+		FILE,
+		PID
+	};
+
+	/// <summary>
+	/// Parse health_check_cmd
+	/// </summary>
+	/// <returns>COMMAND type probe if not a native probe</returns>
+	static std::shared_ptr<HealthProbe> parse(const std::string &spec) noexcept(false);
+
+	Type type() const { return m_type; };
+	bool native() const { return m_type != Type::COMMAND; };
+
+	/// <summary>
+	/// Start probe
+	/// </summary>
+	/// <param name="appPid">application process id, used by pid probe</param>
+	/// <param name="timeoutSeconds">socket probe deadline</param>
+	/// <returns>true if finished and result is ready</returns>
+	bool start(pid_t appPid, int timeoutSeconds);
+	/// <summary>
+	/// Socket file descriptor and poll events waiting for
+	/// </summary>
+	int fd() const { return m_fd; };
+	short events() const;
+	/// <summary>
+	/// Handle poll events
+	/// </summary>
+	/// <returns>true if finished and result is ready</returns>
+	bool onEvent(short revents);
+	/// <summary>
+	/// Finish as unhealthy when deadline reached
+	/// </summary>
+	/// <returns>true if timeout</returns>
+	bool checkTimeout(const std::chrono::steady_clock::time_point &now);
+	bool healthy() const { return m_healthy; };
+	const std::string &error() const { return m_error; };
+
+	HealthProbe();
+	virtual ~HealthProbe();
+
+private:
+	enum class State
+	{
+		CONNECTING,
+		SENDING,
+		RECEIVING,
+		FINISHED
+	};
+	bool connectSocket();
+	bool finish(bool healthy, const std::string &error = "");
+	void closeSocket();
+	bool checkStatusLine();
+
+	Type m_type;
+	std::string m_host;
+	int m_port;
+	std::string m_path;
+	int m_argument;
+
+	State m_state;
+	int m_fd;
+	std::string m_buffer;
+	std::size_t m_sent;
+	std::chrono::steady_clock::time_point m_deadline;
+	bool m_healthy;
+	std::string m_error;
+};
@@ -71,13 +71,15 @@ bool Label::match(const std::shared_ptr<Label> &condition) const
 		return false;
 	for (const auto &la : condition->m_labels)
 	{
-		const auto &key = la.first;
 		const auto &val = la.second;
+		const auto label = m_labels.find(la.first);
+		if (label == m_labels.end())
+			return false;
 #if __GNUC_PREREQ(5, 4)
 		// support wildcards for gcc version upper than 5.4
-		if (!(m_labels.count(key) && (m_labels.find(key)->second == val || wildcards::make_matcher(val).matches(m_labels.find(key)->second))))
+		if (!(label->second == val || wildcards::make_matcher(val).matches(label->second)))
 #else
-		if (!(m_labels.count(key) && (m_labels.find(key)->second == val)))
+		if (!(label->second == val))
 #endif
 		{
 			return false;
@@ -85,3 +87,9 @@ bool Label::match(const std::shared_ptr<Label> &condition) const
 	}
 	return true;
 }
+
+std::map<std::string, std::string> Label::getLabels() const
+{
+	std::lock_guard<std::recursive_mutex> guard(m_mutex);
+	return m_labels;
+}
@@ -24,6 +24,7 @@ public:
 	void delLabel(const std::string &name);
 
 	bool match(const std::shared_ptr<Label> &condition) const;
+	std::map<std::string, std::string> getLabels() const;
 
 private:
 	std::map<std::string, std::string> m_labels;
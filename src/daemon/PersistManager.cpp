@@ -1,129 +1,268 @@
-#include <fstream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 
+#include "../common/Utility.h"
 #include "../common/os/linux.hpp"
-#include "Configuration.h"
 #include "PersistManager.h"
-#include "application/Application.h"
-#include "consul/ConsulConnection.h"
-#include "process/AppProcess.h"
 
 #define SNAPSHOT_JSON_KEY_pid "pid"
 #define SNAPSHOT_JSON_KEY_starttime "starttime"
 
+#define SNAPSHOT_FILE_MAGIC "AMSN"
+#define SNAPSHOT_FILE_VERSION 1
+#define SNAPSHOT_SESSION_ID_SIZE 48
+#define SNAPSHOT_APP_NAME_SIZE 240
+
+/// <summary>
+/// Snapshot file header
+/// </summary>
+struct SnapshotFileHeader
+{
+	char m_magic[4];
+	uint32_t m_version;
+	uint32_t m_slotCount;
+	uint32_t m_reserved;
+	char m_consulSessionId[SNAPSHOT_SESSION_ID_SIZE];
+};
+
+/// <summary>
+/// Snapshot file slot, one for each application process
+/// </summary>
+struct SnapshotFileSlot
+{
+	uint32_t m_used;
+	int32_t m_pid;
+	int64_t m_startTime;
+	char m_appName[SNAPSHOT_APP_NAME_SIZE];
+};
+
+static_assert(sizeof(SnapshotFileHeader) == 64, "snapshot header size should be 64");
+static_assert(sizeof(SnapshotFileSlot) == 256, "snapshot slot size should be 256");
+
 //////////////////////////////////////////////////////////////////////////
 /// HA for app process recover
 //////////////////////////////////////////////////////////////////////////
 PersistManager::PersistManager()
-	: m_persistedSnapshot(std::make_shared<Snapshot>())
+	: m_fd(-1)
 {
+	m_syncPending.clear();
 }
 
 PersistManager::~PersistManager()
 {
+	if (m_fd >= 0)
+		::close(m_fd);
 }
 
-std::shared_ptr<Snapshot> PersistManager::captureSnapshot()
+std::shared_ptr<PersistManager> &PersistManager::instance()
 {
-	auto snap = std::make_shared<Snapshot>();
-	auto apps = Configuration::instance()->getApps();
-	for (auto &app : apps)
+	static auto singleton = std::make_shared<PersistManager>();
+	return singleton;
+}
+
+void PersistManager::init()
+{
+	const static char fname[] = "PersistManager::init() ";
+
+	std::lock_guard<std::mutex> guard(m_mutex);
+	// compact slots
+	std::vector<Record> records;
+	for (const auto &slot : m_slots)
 	{
-		if (!app->isEnabled())
-			continue;
+		if (slot.m_used)
+			records.push_back(slot);
+	}
+	m_slots = records;
+	m_freeSlots.clear();
+	m_slotIndex.clear();
+	for (std::size_t i = 0; i < m_slots.size(); ++i)
+		m_slotIndex[m_slots[i].m_appName] = i;
 
-		auto pid = app->getpid();
-		auto snapAppIter = m_persistedSnapshot->m_apps.find(app->getName());
-		if (snapAppIter != m_persistedSnapshot->m_apps.end() && snapAppIter->second.m_pid == pid)
-		{
-			// if application does not changed pid, do not need call stat
-			snap->m_apps.insert(std::pair<std::string, AppSnap>(
-				app->getName(),
-				AppSnap(snapAppIter->second.m_pid, snapAppIter->second.m_startTime)));
-		}
-		else
-		{
-			// application pid changed
-			auto stat = os::status(pid);
-			if (stat)
-			{
-				snap->m_apps.insert(std::pair<std::string, AppSnap>(
-					app->getName(),
-					AppSnap(pid, (int64_t)stat->starttime)));
-			}
-		}
+	const auto tmpFile = std::string(SNAPSHOT_FILE_NAME) + ".tmp";
+	m_fd = ::open(tmpFile.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (m_fd < 0)
+	{
+		LOG_ERR << fname << "Failed to open snapshot file <" << tmpFile << ">, error :" << std::strerror(errno);
+		return;
 	}
-	snap->m_consulSessionId = ConsulConnection::instance()->consulSessionId();
-	return snap;
+	writeHeader();
+	for (std::size_t i = 0; i < m_slots.size(); ++i)
+		writeSlot(i);
+	::fdatasync(m_fd);
+	if (ACE_OS::rename(tmpFile.c_str(), SNAPSHOT_FILE_NAME) != 0)
+	{
+		LOG_ERR << fname << "Failed to create snapshot file <" << SNAPSHOT_FILE_NAME << ">, error :" << std::strerror(errno);
+	}
+	LOG_INF << fname << "snapshot initialized with " << m_slots.size() << " application processes";
 }
 
-void PersistManager::persistSnapshot()
+void PersistManager::onProcessStart(const std::string &appName, pid_t pid)
 {
-	const static char fname[] = "HealthCheckTask::persistSnapshot() ";
+	const static char fname[] = "PersistManager::onProcessStart() ";
 
-	try
+	if (appName.length() >= SNAPSHOT_APP_NAME_SIZE)
 	{
-		auto snapshot = this->captureSnapshot();
-		if (snapshot->operator==(*m_persistedSnapshot))
-		{
-			return;
-		}
-		else
-		{
-			m_persistedSnapshot = snapshot;
-			m_persistedSnapshot->persist();
-		}
+		LOG_WAR << fname << "application name too long to persist <" << appName << ">";
+		return;
 	}
-	catch (const std::exception &ex)
+	// read process start time once when process start instead of every tick
+	auto stat = os::status(pid);
+	if (!stat)
 	{
-		LOG_WAR << fname << "got exception: " << ex.what();
+		onProcessExit(appName);
+		return;
 	}
-	catch (...)
+
+	std::lock_guard<std::mutex> guard(m_mutex);
+	std::size_t index = 0;
+	auto iter = m_slotIndex.find(appName);
+	if (iter != m_slotIndex.end())
+	{
+		index = iter->second;
+	}
+	else if (m_freeSlots.size())
+	{
+		index = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
 	{
-		LOG_WAR << fname << "exception";
+		index = m_slots.size();
+		m_slots.push_back(Record{appName, AppSnap(pid, 0), false});
 	}
+	m_slots[index] = Record{appName, AppSnap(pid, static_cast<int64_t>(stat->starttime)), true};
+	m_slotIndex[appName] = index;
+	writeSlot(index);
+	if (index + 1 == m_slots.size())
+		writeHeader();
+	scheduleSync();
 }
 
-std::unique_ptr<PersistManager> &PersistManager::instance()
+void PersistManager::onProcessExit(const std::string &appName)
 {
-	static auto singleton = std::make_unique<PersistManager>();
-	return singleton;
+	std::lock_guard<std::mutex> guard(m_mutex);
+	auto iter = m_slotIndex.find(appName);
+	if (iter == m_slotIndex.end())
+	{
+		return;
+	}
+	const auto index = iter->second;
+	m_slotIndex.erase(iter);
+	m_slots[index].m_used = false;
+	m_freeSlots.push_back(index);
+	writeSlot(index);
+	scheduleSync();
 }
 
-bool Snapshot::operator==(const Snapshot &snapshort) const
+void PersistManager::onConsulSession(const std::string &sessionId)
 {
-	if (snapshort.m_apps.size() != m_apps.size())
-		return false;
-	for (const auto &app : m_apps)
+	std::lock_guard<std::mutex> guard(m_mutex);
+	if (m_consulSessionId == sessionId)
 	{
-		if (0 == snapshort.m_apps.count(app.first))
-			return false;
-		if (app.second == snapshort.m_apps.find(app.first)->second)
-		{
-			// continue;
-		}
-		else
-		{
-			return false;
-		}
+		return;
 	}
-	return snapshort.m_consulSessionId == m_consulSessionId;
+	m_consulSessionId = sessionId;
+	writeHeader();
+	scheduleSync();
 }
 
-web::json::value Snapshot::AsJson() const
+void PersistManager::writeHeader()
 {
-	web::json::value result = web::json::value::object();
-	// Applications
-	web::json::value apps = web::json::value::object();
-	for (const auto &app : m_apps)
+	SnapshotFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.m_magic, SNAPSHOT_FILE_MAGIC, sizeof(header.m_magic));
+	header.m_version = SNAPSHOT_FILE_VERSION;
+	header.m_slotCount = static_cast<uint32_t>(m_slots.size());
+	std::strncpy(header.m_consulSessionId, m_consulSessionId.c_str(), SNAPSHOT_SESSION_ID_SIZE - 1);
+	writeAt(&header, sizeof(header), 0);
+}
+
+void PersistManager::writeSlot(std::size_t index)
+{
+	const auto &record = m_slots[index];
+	SnapshotFileSlot slot;
+	std::memset(&slot, 0, sizeof(slot));
+	slot.m_used = record.m_used ? 1 : 0;
+	slot.m_pid = record.m_snap.m_pid;
+	slot.m_startTime = record.m_snap.m_startTime;
+	std::strncpy(slot.m_appName, record.m_appName.c_str(), SNAPSHOT_APP_NAME_SIZE - 1);
+	writeAt(&slot, sizeof(slot), sizeof(SnapshotFileHeader) + index * sizeof(SnapshotFileSlot));
+}
+
+void PersistManager::writeAt(const void *data, std::size_t length, std::size_t offset)
+{
+	const static char fname[] = "PersistManager::writeAt() ";
+
+	// file is not opened before init(), only memory updated
+	if (m_fd >= 0 && ::pwrite(m_fd, data, length, offset) != static_cast<ssize_t>(length))
 	{
-		auto json = web::json::value::object();
-		json[SNAPSHOT_JSON_KEY_pid] = web::json::value::number(app.second.m_pid);
-		json[SNAPSHOT_JSON_KEY_starttime] = web::json::value::number(app.second.m_startTime);
-		apps[app.first] = json;
+		LOG_ERR << fname << "Failed to write snapshot file, error :" << std::strerror(errno);
 	}
-	result["Applications"] = apps;
-	result["ConsulSessionId"] = web::json::value::string(m_consulSessionId);
-	return result;
+}
+
+void PersistManager::scheduleSync()
+{
+	const static char fname[] = "PersistManager::scheduleSync() ";
+
+	if (m_fd >= 0 && !m_syncPending.test_and_set())
+	{
+		this->registerTimer(DEFAULT_SNAPSHOT_SYNC_MS, 0, std::bind(&PersistManager::sync, this, std::placeholders::_1), fname);
+	}
+}
+
+void PersistManager::sync(int timerId)
+{
+	m_syncPending.clear();
+	std::lock_guard<std::mutex> guard(m_mutex);
+	if (m_fd >= 0)
+		::fdatasync(m_fd);
+}
+
+std::shared_ptr<Snapshot> Snapshot::FromFile(const std::string &path)
+{
+	const static char fname[] = "Snapshot::FromFile() ";
+
+	auto snap = std::make_shared<Snapshot>();
+	const auto content = Utility::readFileCpp(path);
+	if (content.empty())
+	{
+		return snap;
+	}
+	if (content[0] == '{')
+	{
+		// legacy JSON snapshot
+		return Snapshot::FromJson(web::json::value::parse(content));
+	}
+	SnapshotFileHeader header;
+	if (content.length() < sizeof(header))
+	{
+		LOG_WAR << fname << "invalid snapshot file size: " << content.length();
+		return snap;
+	}
+	std::memcpy(&header, content.data(), sizeof(header));
+	if (std::memcmp(header.m_magic, SNAPSHOT_FILE_MAGIC, sizeof(header.m_magic)) != 0 || header.m_version != SNAPSHOT_FILE_VERSION)
+	{
+		LOG_WAR << fname << "unsupported snapshot file format";
+		return snap;
+	}
+	snap->m_consulSessionId = std::string(header.m_consulSessionId, strnlen(header.m_consulSessionId, SNAPSHOT_SESSION_ID_SIZE));
+	for (std::size_t i = 0; i < header.m_slotCount; ++i)
+	{
+		const auto offset = sizeof(header) + i * sizeof(SnapshotFileSlot);
+		if (offset + sizeof(SnapshotFileSlot) > content.length())
+			break;
+		SnapshotFileSlot slot;
+		std::memcpy(&slot, content.data() + offset, sizeof(slot));
+		if (slot.m_used)
+		{
+			snap->m_apps.insert(std::make_pair(
+				std::string(slot.m_appName, strnlen(slot.m_appName, SNAPSHOT_APP_NAME_SIZE)),
+				AppSnap(slot.m_pid, slot.m_startTime)));
+		}
+	}
+	return snap;
 }
 
 std::shared_ptr<Snapshot> Snapshot::FromJson(const web::json::value &obj)
@@ -149,31 +288,6 @@ std::shared_ptr<Snapshot> Snapshot::FromJson(const web::json::value &obj)
 	return snap;
 }
 
-void Snapshot::persist()
-{
-	const static char fname[] = "Snapshot::persist() ";
-
-	static auto tmpFile = std::string(SNAPSHOT_FILE_NAME) + "." + std::to_string(Utility::getThreadId());
-	std::ofstream ofs(tmpFile, std::ios::trunc);
-	if (ofs.is_open())
-	{
-		ofs << this->AsJson().serialize();
-		ofs.close();
-		if (ACE_OS::rename(tmpFile.c_str(), SNAPSHOT_FILE_NAME) == 0)
-		{
-			LOG_DBG << fname << "write snapshot success";
-		}
-		else
-		{
-			LOG_ERR << fname << "Failed to create snapshot file <" << SNAPSHOT_FILE_NAME << ">, error :" << std::strerror(errno);
-		}
-	}
-	else
-	{
-		LOG_WAR << fname << "Failed to open snapshot file";
-	}
-}
-
 AppSnap::AppSnap(pid_t pid, int64_t starttime)
 	: m_pid(pid), m_startTime(starttime)
 {
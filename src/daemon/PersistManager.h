@@ -1,11 +1,16 @@
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "cpprest/json.h"
 
+#include "TimerHandler.h"
+
 /// <summary>
 /// App Process Recover object
 /// </summary>
@@ -22,30 +27,66 @@ struct AppSnap
 /// </summary>
 struct Snapshot
 {
-	bool operator==(const Snapshot &snapshort) const;
-	web::json::value AsJson() const;
+	/// <summary>
+	/// Load snapshot file, support binary table and legacy JSON format
+	/// </summary>
+	static std::shared_ptr<Snapshot> FromFile(const std::string &path);
 	static std::shared_ptr<Snapshot> FromJson(const web::json::value &obj);
-	void persist();
 
 	std::map<std::string, AppSnap> m_apps;
 	std::string m_consulSessionId;
 };
 
-/// <summary>
+//////////////////////////////////////////////////////////////////////////
 /// App Mesh HA manager
-/// </summary>
-class PersistManager
+/// Snapshot file is a fixed-record binary table: a header with Consul session
+/// and one slot for each running application process, slots are updated in
+/// place by process start/exit events and fdatasync is batched by timer.
+//////////////////////////////////////////////////////////////////////////
+class PersistManager : public TimerHandler
 {
 public:
 	PersistManager();
 	virtual ~PersistManager();
+	static std::shared_ptr<PersistManager> &instance();
 
-	void persistSnapshot();
-	static std::unique_ptr<PersistManager> &instance();
+	/// <summary>
+	/// Rewrite snapshot file with current records, events before init only update memory
+	/// </summary>
+	void init();
+
+	/// <summary>
+	/// Application process started or attached
+	/// </summary>
+	void onProcessStart(const std::string &appName, pid_t pid);
+	/// <summary>
+	/// Application process exited or killed
+	/// </summary>
+	void onProcessExit(const std::string &appName);
+	void onConsulSession(const std::string &sessionId);
 
 private:
-	std::shared_ptr<Snapshot> captureSnapshot();
+	struct Record
+	{
+		std::string m_appName;
+		AppSnap m_snap;
+		bool m_used;
+	};
+	// need lock
+	void writeHeader();
+	void writeSlot(std::size_t index);
+	void writeAt(const void *data, std::size_t length, std::size_t offset);
+	void scheduleSync();
+	void sync(int timerId = 0);
 
 private:
-	std::shared_ptr<Snapshot> m_persistedSnapshot;
+	// in memory mirror of file slots
+	std::vector<Record> m_slots;
+	// key: application name, value: slot index
+	std::map<std::string, std::size_t> m_slotIndex;
+	std::vector<std::size_t> m_freeSlots;
+	std::string m_consulSessionId;
+	int m_fd;
+	std::atomic_flag m_syncPending;
+	std::mutex m_mutex;
 };
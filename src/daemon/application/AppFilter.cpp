@@ -0,0 +1,150 @@
+#ifdef __GNUC__
+#include <features.h>
+#if __GNUC_PREREQ(5, 4)
+#include "../../common/wildcards/wildcards.hpp"
+#endif
+#endif
+
+#include "../../common/Utility.h"
+#include "../security/User.h"
+#include "AppFilter.h"
+#include "Application.h"
+
+AppFilter::AppFilter()
+	: m_status(-1), m_limit(0)
+{
+}
+
+AppFilter::~AppFilter()
+{
+}
+
+std::shared_ptr<AppFilter> AppFilter::FromQuery(const std::map<std::string, std::string> &query)
+{
+	auto filter = std::make_shared<AppFilter>();
+	for (const auto &q : query)
+	{
+		if (q.second.empty())
+			continue;
+		if (q.first == HTTP_QUERY_KEY_app_name)
+		{
+			filter->m_namePattern = q.second;
+		}
+		else if (q.first == HTTP_QUERY_KEY_app_status)
+		{
+			if (q.second == "enabled")
+				filter->m_status = static_cast<int>(STATUS::ENABLED);
+			else if (q.second == "disabled")
+				filter->m_status = static_cast<int>(STATUS::DISABLED);
+			else if (Utility::isNumber(q.second))
+				filter->m_status = std::stoi(q.second);
+			else
+				throw std::invalid_argument(Utility::stringFormat("invalid status filter <%s>", q.second.c_str()));
+		}
+		else if (q.first == HTTP_QUERY_KEY_app_owner)
+		{
+			filter->m_owner = q.second;
+		}
+		else if (q.first == HTTP_QUERY_KEY_app_label)
+		{
+			const auto pos = q.second.find('=');
+			filter->m_labelKey = q.second.substr(0, pos);
+			filter->m_labelValue = (pos == std::string::npos) ? "" : q.second.substr(pos + 1);
+		}
+		else if (q.first == HTTP_QUERY_KEY_app_fields)
+		{
+			for (const auto &field : Utility::splitString(q.second, ","))
+			{
+				const auto f = Utility::stdStringTrim(field);
+				if (f.length())
+					filter->m_fields.insert(f);
+			}
+		}
+		else if (q.first == HTTP_QUERY_KEY_app_limit)
+		{
+			if (!Utility::isNumber(q.second))
+				throw std::invalid_argument(Utility::stringFormat("invalid limit <%s>", q.second.c_str()));
+			filter->m_limit = std::stoul(q.second);
+		}
+		else if (q.first == HTTP_QUERY_KEY_app_cursor)
+		{
+			filter->m_cursor = q.second;
+		}
+		else
+		{
+			continue;
+		}
+		filter->m_queryString.append(q.first).append("=").append(q.second).append("&");
+	}
+	return filter;
+}
+
+bool AppFilter::match(const std::shared_ptr<Application> &app) const
+{
+	if (m_status >= 0 && static_cast<int>(app->getStatus()) != m_status)
+	{
+		return false;
+	}
+	if (m_owner.length() && !(app->getOwner() && app->getOwner()->getName() == m_owner))
+	{
+		return false;
+	}
+	if (m_labelKey.empty())
+	{
+		return match(app->getName(), web::json::value::null());
+	}
+	return match(app->getName(), app->getMetadata());
+}
+
+bool AppFilter::match(const std::string &appName, const web::json::value &metadata) const
+{
+	if (m_namePattern.length() && appName != m_namePattern)
+	{
+#if __GNUC_PREREQ(5, 4)
+		// support wildcards for gcc version upper than 5.4
+		if (!wildcards::make_matcher(m_namePattern).matches(appName))
+#endif
+			return false;
+	}
+	if (m_labelKey.length())
+	{
+		if (!(metadata.is_object() && metadata.has_field(m_labelKey)))
+			return false;
+		if (m_labelValue.length())
+		{
+			const auto &value = metadata.at(m_labelKey);
+			if (!(value.is_string() ? value.as_string() == m_labelValue : value.serialize() == m_labelValue))
+				return false;
+		}
+	}
+	return true;
+}
+
+web::json::value AppFilter::project(const web::json::value &appJson) const
+{
+	if (m_fields.empty())
+		return appJson;
+
+	auto result = web::json::value::object();
+	for (const auto &field : m_fields)
+	{
+		if (appJson.has_field(field))
+			result[field] = appJson.at(field);
+	}
+	return result;
+}
+
+bool AppFilter::hasProjection() const
+{
+	return !m_fields.empty();
+}
+
+bool AppFilter::hasPagination() const
+{
+	return m_limit > 0 || m_cursor.length();
+}
+
+const std::string &AppFilter::queryString() const
+{
+	return m_queryString;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+#include <cpprest/json.h>
+
+class Application;
+//////////////////////////////////////////////////////////////////////////
+/// Application list query: filter, field projection and cursor pagination
+/// Evaluated before Application::AsJson() so skipped apps are never serialized
+//////////////////////////////////////////////////////////////////////////
+class AppFilter
+{
+public:
+	AppFilter();
+	virtual ~AppFilter();
+
+	/// <summary>
+	/// Parse from REST query parameters: name, status, owner, label, fields, limit, cursor
+	/// </summary>
+	static std::shared_ptr<AppFilter> FromQuery(const std::map<std::string, std::string> &query) noexcept(false);
+
+	bool match(const std::shared_ptr<Application> &app) const;
+	// name and label only, used for application events
+	bool match(const std::string &appName, const web::json::value &metadata) const;
+	web::json::value project(const web::json::value &appJson) const;
+
+	bool hasProjection() const;
+	bool hasPagination() const;
+	// used to distinguish ETag between different queries
+	const std::string &queryString() const;
+
+	// name wildcards pattern
+	std::string m_namePattern;
+	// -1: no status filter
+	int m_status;
+	std::string m_owner;
+	// metadata key/value, apps have no dedicated label, JSON object metadata used as label
+	std::string m_labelKey;
+	std::string m_labelValue;
+	std::set<std::string> m_fields;
+	// 0: no limit
+	std::size_t m_limit;
+	// return apps with name after cursor (sorted by name)
+	std::string m_cursor;
+
+private:
+	std::string m_queryString;
+};
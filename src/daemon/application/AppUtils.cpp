@@ -129,3 +129,47 @@ const std::string LogFileQueue::getFileName(int index)
 	}
 	throw std::invalid_argument(Utility::stringFormat("no such index <%d> of stdout file exist", index));
 }
+
+HealthCheckPolicy::HealthCheckPolicy()
+	: m_interval(0), m_timeout(DEFAULT_HEALTH_CHECK_INTERVAL), m_initialDelay(0), m_successThreshold(1), m_failureThreshold(1)
+{
+}
+
+std::shared_ptr<HealthCheckPolicy> HealthCheckPolicy::FromJson(const web::json::value &jsonObj)
+{
+	auto policy = std::make_shared<HealthCheckPolicy>();
+	SET_JSON_INT_VALUE(jsonObj, JSON_KEY_HEALTH_CHECK_interval, policy->m_interval);
+	SET_JSON_INT_VALUE(jsonObj, JSON_KEY_HEALTH_CHECK_timeout, policy->m_timeout);
+	SET_JSON_INT_VALUE(jsonObj, JSON_KEY_HEALTH_CHECK_initial_delay, policy->m_initialDelay);
+	SET_JSON_INT_VALUE(jsonObj, JSON_KEY_HEALTH_CHECK_success_threshold, policy->m_successThreshold);
+	SET_JSON_INT_VALUE(jsonObj, JSON_KEY_HEALTH_CHECK_failure_threshold, policy->m_failureThreshold);
+	if (policy->m_interval < 0 || policy->m_timeout < 1 || policy->m_initialDelay < 0)
+		throw std::invalid_argument("health check interval/initial_delay should not be negative and timeout should be positive");
+	if (policy->m_successThreshold < 1 || policy->m_failureThreshold < 1)
+		throw std::invalid_argument("health check threshold should be positive");
+	return policy;
+}
+
+web::json::value HealthCheckPolicy::AsJson() const
+{
+	auto result = web::json::value::object();
+	if (m_interval)
+		result[JSON_KEY_HEALTH_CHECK_interval] = web::json::value::number(m_interval);
+	result[JSON_KEY_HEALTH_CHECK_timeout] = web::json::value::number(m_timeout);
+	if (m_initialDelay)
+		result[JSON_KEY_HEALTH_CHECK_initial_delay] = web::json::value::number(m_initialDelay);
+	result[JSON_KEY_HEALTH_CHECK_success_threshold] = web::json::value::number(m_successThreshold);
+	result[JSON_KEY_HEALTH_CHECK_failure_threshold] = web::json::value::number(m_failureThreshold);
+	return result;
+}
+
+bool HealthCheckPolicy::operator==(const std::shared_ptr<HealthCheckPolicy> &policy) const
+{
+	if (!policy)
+		return false;
+	return (m_interval == policy->m_interval &&
+			m_timeout == policy->m_timeout &&
+			m_initialDelay == policy->m_initialDelay &&
+			m_successThreshold == policy->m_successThreshold &&
+			m_failureThreshold == policy->m_failureThreshold);
+}
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include <cpprest/json.h>
+
 /// <summary>
 /// Shell mode application manage (create/clean) shell script
 /// </summary>
@@ -55,6 +57,27 @@ private:
 	const int m_queueSize;
 };
 
+/// <summary>
+/// Health check schedule of an application
+/// </summary>
+struct HealthCheckPolicy
+{
+	HealthCheckPolicy();
+	static std::shared_ptr<HealthCheckPolicy> FromJson(const web::json::value &jsonObj) noexcept(false);
+	web::json::value AsJson() const;
+	bool operator==(const std::shared_ptr<HealthCheckPolicy> &policy) const;
+
+	// seconds between checks, 0 use global ScheduleIntervalSeconds
+	int m_interval;
+	// seconds before probe is killed and treat as failed
+	int m_timeout;
+	// seconds to wait before first check after application registered
+	int m_initialDelay;
+	// consecutive results required to change health status
+	int m_successThreshold;
+	int m_failureThreshold;
+};
+
 /// <summary>
 /// Application status
 /// </summary>
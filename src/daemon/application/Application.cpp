@@ -3,12 +3,15 @@
 
 #include "../../common/DateTime.h"
 #include "../../common/DurationParse.h"
+#include "../../common/JsonWriter.h"
 #include "../../common/Utility.h"
 #include "../../common/os/process.hpp"
 #include "../../prom_exporter/counter.h"
 #include "../../prom_exporter/gauge.h"
 #include "../Configuration.h"
+#include "../PersistManager.h"
 #include "../DailyLimitation.h"
+#include "../HealthProbe.h"
 #include "../ResourceCollection.h"
 #include "../ResourceLimitation.h"
 #include "../process/AppProcess.h"
@@ -20,14 +23,43 @@
 #include "../security/User.h"
 #include "AppTimer.h"
 #include "Application.h"
+#include "EventBus.h"
 
 ACE_Time_Value Application::m_waitTimeout = ACE_Time_Value(std::chrono::milliseconds(20));
+std::atomic<uint64_t> Application::m_runtimeVersionSeq(0);
+
+AppRuntimeStatus::AppRuntimeStatus()
+	: m_status(STATUS::ENABLED), m_pid(ACE_INVALID_PID), m_health(true), m_hasReturn(false), m_return(0),
+	  m_hasNextLaunchTime(false), m_usageValid(false), m_memory(0), m_cpu(0), m_openFileDesc(0), m_stdoutCacheNum(0), m_starts(0)
+{
+}
+
+bool AppRuntimeStatus::operator==(const AppRuntimeStatus &other) const
+{
+	return (m_status == other.m_status &&
+			m_pid == other.m_pid &&
+			m_health == other.m_health &&
+			m_hasReturn == other.m_hasReturn &&
+			m_return == other.m_return &&
+			m_procStartTime == other.m_procStartTime &&
+			m_hasNextLaunchTime == other.m_hasNextLaunchTime &&
+			m_nextLaunchTime == other.m_nextLaunchTime &&
+			m_usageValid == other.m_usageValid &&
+			m_memory == other.m_memory &&
+			m_cpu == other.m_cpu &&
+			m_openFileDesc == other.m_openFileDesc &&
+			m_stdoutCacheNum == other.m_stdoutCacheNum &&
+			m_starts == other.m_starts &&
+			m_containerId == other.m_containerId &&
+			m_lastError == other.m_lastError);
+}
 
 Application::Application()
 	: m_status(STATUS::ENABLED), m_ownerPermission(0), m_shellApp(false), m_stdoutCacheNum(0),
 	  m_startInterval(0), m_bufferTime(0), m_startIntervalValueIsCronExpr(false), m_nextStartTimerId(0),
 	  m_health(true), m_appId(Utility::createUUID()), m_version(0), m_pid(ACE_INVALID_PID),
-	  m_suicideTimerId(0), m_continueFails(0), m_starts(0)
+	  m_suicideTimerId(0), m_procUsage(false, 0, 0), m_openFileDesc(0), m_runtimeStatus(std::make_shared<AppRuntimeStatus>()),
+	  m_runtimeVersion(++m_runtimeVersionSeq), m_continueFails(0), m_starts(0)
 {
 	const static char fname[] = "Application::Application() ";
 	LOG_DBG << fname << "Entered.";
@@ -56,6 +88,11 @@ bool Application::operator==(const std::shared_ptr<Application> &app)
 	if (this->m_resourceLimit != nullptr && !this->m_resourceLimit->operator==(app->m_resourceLimit))
 		return false;
 
+	if (app->m_healthCheckPolicy != nullptr && !app->m_healthCheckPolicy->operator==(this->m_healthCheckPolicy))
+		return false;
+	if (this->m_healthCheckPolicy != nullptr && !this->m_healthCheckPolicy->operator==(app->m_healthCheckPolicy))
+		return false;
+
 	return (this->m_name == app->m_name &&
 			this->m_shellApp == app->m_shellApp &&
 			this->m_commandLine == app->m_commandLine &&
@@ -81,24 +118,30 @@ const std::string &Application::getName() const
 
 void Application::health(bool health)
 {
-	m_health = health; // health: 0-health, 1-unhealthy
+	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
+	if (m_health != health)
+	{
+		m_health = health; // health: 0-health, 1-unhealthy
+		publishRuntimeStatus();
+		auto detail = web::json::value::object();
+		detail[JSON_KEY_APP_health] = web::json::value::number(1 - m_health);
+		EventBus::instance()->publish(APP_EVENT_health, *this, detail);
+	}
 }
 
 pid_t Application::getpid() const
 {
-	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
-	return m_pid;
+	return getRuntimeStatus()->m_pid;
 }
 
 int Application::health() const
 {
-	return 1 - m_health;
+	return 1 - getRuntimeStatus()->m_health;
 }
 
 bool Application::isEnabled() const
 {
-	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
-	return (m_status == STATUS::ENABLED);
+	return (getRuntimeStatus()->m_status == STATUS::ENABLED);
 }
 
 const std::string &Application::healthCheckCmd() const
@@ -106,6 +149,11 @@ const std::string &Application::healthCheckCmd() const
 	return m_healthCheckCmd;
 }
 
+const std::shared_ptr<HealthCheckPolicy> &Application::healthCheckPolicy() const
+{
+	return m_healthCheckPolicy;
+}
+
 const std::shared_ptr<User> &Application::getOwner() const
 {
 	return m_owner;
@@ -121,9 +169,19 @@ bool Application::isCloudApp() const
 	return (m_metadata == CLOUD_STR_JSON);
 }
 
+STATUS Application::getStatus() const
+{
+	return getRuntimeStatus()->m_status;
+}
+
+const web::json::value &Application::getMetadata() const
+{
+	// definition field, only assigned in FromJson() before registration
+	return m_metadata;
+}
+
 bool Application::available(const std::chrono::system_clock::time_point &now)
 {
-	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
 	// check expired
 	if (m_endTimeValue != AppTimer::EPOCH_ZERO_TIME && now >= m_endTimeValue)
 	{
@@ -153,6 +211,10 @@ void Application::FromJson(const std::shared_ptr<Application> &app, const web::j
 	app->m_healthCheckCmd = Utility::stdStringTrim(GET_JSON_STR_VALUE(jsonObj, JSON_KEY_APP_health_check_cmd));
 	if (app->m_healthCheckCmd.length() >= MAX_COMMAND_LINE_LENGTH)
 		throw std::invalid_argument("health check length should less than 2048");
+	if (app->m_healthCheckCmd.length())
+		HealthProbe::parse(app->m_healthCheckCmd); // validate native probe
+	if (HAS_JSON_FIELD(jsonObj, JSON_KEY_APP_health_check))
+		app->m_healthCheckPolicy = HealthCheckPolicy::FromJson(jsonObj.at(JSON_KEY_APP_health_check));
 	app->m_workdir = Utility::stdStringTrim(GET_JSON_STR_VALUE(jsonObj, JSON_KEY_APP_working_dir));
 	if (HAS_JSON_FIELD(jsonObj, JSON_KEY_APP_status))
 	{
@@ -256,6 +318,8 @@ void Application::FromJson(const std::shared_ptr<Application> &app, const web::j
 		// long running
 		app->m_timer = std::make_shared<AppTimer>(app->m_startTimeValue, app->m_endTimeValue, app->m_dailyLimit);
 	}
+	std::lock_guard<std::recursive_mutex> guard(app->m_appMutex);
+	app->publishRuntimeStatus();
 }
 
 void Application::refreshStatus(void *ptree)
@@ -298,22 +362,96 @@ void Application::refreshStatus(void *ptree)
 	// health check
 	checkAndUpdateHealth();
 
+	// 3. Runtime sample, shared by REST view and Prometheus
+	sampleRuntime(ptree);
+
 	// 4. Prometheus
 	if (PrometheusRest::instance()->collected())
 	{
 		if (m_metricMemory && m_process)
 		{
-			auto usage = m_process->getProcUsage(ptree);
-			m_metricMemory->metric().Set(std::get<1>(usage));
-			m_metricCpu->metric().Set(std::get<2>(usage));
+			m_metricMemory->metric().Set(std::get<1>(m_procUsage));
+			m_metricCpu->metric().Set(std::get<2>(m_procUsage));
 		}
 		if (m_metricAppPid)
 			m_metricAppPid->metric().Set(m_pid);
 		if (m_metricFileDesc)
-			m_metricFileDesc->metric().Set(os::fileDescriptors(m_pid));
+			m_metricFileDesc->metric().Set(m_openFileDesc);
 	}
 }
 
+void Application::sampleRuntime(void *ptree)
+{
+	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
+	// read /proc once per tick, REST view only read the sample
+	m_procUsage = (m_process && m_process->running()) ? m_process->getProcUsage(ptree) : std::make_tuple(false, uint64_t(0), float(0));
+	m_openFileDesc = (m_pid > 0) ? os::fileDescriptors(m_pid) : 0;
+
+	publishRuntimeStatus();
+}
+
+void Application::increaseRuntimeVersion()
+{
+	m_runtimeVersion = ++m_runtimeVersionSeq;
+}
+
+uint64_t Application::getRuntimeVersion() const
+{
+	return m_runtimeVersion;
+}
+
+std::shared_ptr<const AppRuntimeStatus> Application::getRuntimeStatus() const
+{
+	return std::atomic_load(&m_runtimeStatus);
+}
+
+void Application::publishRuntimeStatus()
+{
+	auto status = std::make_shared<AppRuntimeStatus>();
+	status->m_status = m_status;
+	status->m_pid = m_pid;
+	status->m_health = m_health;
+	status->m_hasReturn = (m_return != nullptr);
+	status->m_return = m_return ? *m_return : 0;
+	status->m_procStartTime = m_procStartTime;
+	status->m_hasNextLaunchTime = (m_nextLaunchTime != nullptr);
+	if (m_nextLaunchTime)
+		status->m_nextLaunchTime = *m_nextLaunchTime;
+	status->m_usageValid = (m_process && m_process->running() && std::get<0>(m_procUsage));
+	status->m_memory = std::get<1>(m_procUsage);
+	status->m_cpu = std::get<2>(m_procUsage);
+	status->m_openFileDesc = m_openFileDesc;
+	status->m_stdoutCacheNum = m_stdoutFileQueue ? m_stdoutFileQueue->size() : 0;
+	status->m_starts = m_starts;
+	if (m_process)
+		status->m_containerId = m_process->containerId();
+	status->m_lastError = getLastError();
+
+	if (!(*getRuntimeStatus() == *status))
+	{
+		std::atomic_store(&m_runtimeStatus, std::shared_ptr<const AppRuntimeStatus>(status));
+		// increase version after publish, JSON cached with new version never contain old status
+		increaseRuntimeVersion();
+	}
+}
+
+const std::shared_ptr<const std::string> Application::AsJsonCached()
+{
+	const uint64_t version = m_runtimeVersion;
+	auto cache = std::atomic_load(&m_runtimeJson);
+	if (cache == nullptr || cache->m_version != version)
+	{
+		// concurrent readers may build the same version, the last one win
+		auto json = std::make_shared<RuntimeJsonCache>();
+		json->m_version = version;
+		JsonWriter writer(json->m_json);
+		this->writeJson(writer, true);
+		cache = json;
+		std::atomic_store(&m_runtimeJson, cache);
+	}
+	return std::shared_ptr<const std::string>(cache, &cache->m_json);
+}
+
 bool Application::attach(int pid)
 {
 	const static char fname[] = "Application::attach() ";
@@ -328,6 +466,8 @@ bool Application::attach(int pid)
 		m_process.reset(new AppProcess());
 		m_process->attach(pid);
 		m_pid = m_process->getpid();
+		publishRuntimeStatus();
+		PersistManager::instance()->onProcessStart(m_name, m_pid);
 		LOG_INF << fname << "attached pid <" << pid << "> to application " << m_name;
 	}
 	return true;
@@ -348,6 +488,7 @@ void Application::execute(void *ptree)
 			LOG_INF << fname << "Application <" << m_name << "> was not in start time";
 			m_process->killgroup();
 			m_pid = ACE_INVALID_PID;
+			PersistManager::instance()->onProcessExit(m_name);
 			setInvalidError();
 			m_nextLaunchTime = nullptr;
 		}
@@ -362,6 +503,7 @@ void Application::execute(void *ptree)
 			LOG_INF << fname << "Application <" << m_name << "> was not available";
 			m_process->killgroup();
 			m_pid = ACE_INVALID_PID;
+			PersistManager::instance()->onProcessExit(m_name);
 			setInvalidError();
 			m_nextLaunchTime = nullptr;
 		}
@@ -408,9 +550,15 @@ void Application::spawn(int timerId)
 		m_pid = m_process->spawnProcess(getCmdLine(), getExecUser(), m_workdir, getMergedEnvMap(), m_resourceLimit, m_stdoutFile, m_metadata);
 
 		// 3. post process
+		if (m_pid > 0)
+			PersistManager::instance()->onProcessStart(m_name, m_pid);
+		else
+			PersistManager::instance()->onProcessExit(m_name);
 		setLastError(m_process->startError());
 		if (m_metricStartCount)
 			m_metricStartCount->metric().Increment();
+		publishRuntimeStatus();
+		publishStartEvent();
 	}
 
 	// 4. schedule next run for period run
@@ -438,12 +586,15 @@ void Application::disable()
 	{
 		m_status = STATUS::DISABLED;
 		m_return = nullptr;
+		EventBus::instance()->publish(APP_EVENT_disable, *this);
 		LOG_INF << fname << "Application <" << m_name << "> disabled.";
 	}
 	// kill process
 	if (m_process != nullptr)
 		m_process->killgroup();
+	PersistManager::instance()->onProcessExit(m_name);
 	m_nextLaunchTime = nullptr;
+	publishRuntimeStatus();
 }
 
 void Application::enable()
@@ -452,6 +603,8 @@ void Application::enable()
 	if (m_status == STATUS::DISABLED)
 	{
 		m_status = STATUS::ENABLED;
+		publishRuntimeStatus();
+		EventBus::instance()->publish(APP_EVENT_enable, *this);
 	}
 }
 
@@ -497,6 +650,8 @@ std::string Application::runApp(int timeoutSeconds)
 	setLastError(m_process->startError());
 	if (m_metricStartCount)
 		m_metricStartCount->metric().Increment();
+	publishRuntimeStatus();
+	publishStartEvent();
 
 	if (m_pid > 0)
 	{
@@ -535,7 +690,7 @@ void Application::checkAndUpdateHealth()
 	if (m_healthCheckCmd.empty())
 	{
 		std::lock_guard<std::recursive_mutex> guard(m_appMutex);
-		auto health = (getpid() > 0) || (m_return && 0 == *m_return);
+		auto health = (m_pid > 0) || (m_return && 0 == *m_return);
 		this->health(health);
 	}
 }
@@ -605,7 +760,8 @@ web::json::value Application::AsJson(bool returnRuntimeInfo)
 {
 	web::json::value result = web::json::value::object();
 
-	std::lock_guard<std::recursive_mutex> guard(m_appMutex);
+	// definition is immutable after FromJson, runtime fields read from published status without lock
+	const auto runtime = getRuntimeStatus();
 	result[JSON_KEY_APP_name] = web::json::value::string(GET_STRING_T(m_name));
 	if (m_owner)
 		result[JSON_KEY_APP_owner] = web::json::value::string(m_owner->getName());
@@ -617,40 +773,39 @@ web::json::value Application::AsJson(bool returnRuntimeInfo)
 		result[GET_STRING_T(JSON_KEY_APP_command)] = web::json::value::string(GET_STRING_T(m_commandLine));
 	if (m_healthCheckCmd.length())
 		result[GET_STRING_T(JSON_KEY_APP_health_check_cmd)] = web::json::value::string(GET_STRING_T(m_healthCheckCmd));
+	if (m_healthCheckPolicy)
+		result[JSON_KEY_APP_health_check] = m_healthCheckPolicy->AsJson();
 	if (m_workdir.length())
 		result[JSON_KEY_APP_working_dir] = web::json::value::string(GET_STRING_T(m_workdir));
-	result[JSON_KEY_APP_status] = web::json::value::number(static_cast<int>(m_status));
+	result[JSON_KEY_APP_status] = web::json::value::number(static_cast<int>(runtime->m_status));
 	if (m_stdoutCacheNum)
 		result[JSON_KEY_APP_stdout_cache_num] = web::json::value::number(static_cast<int>(m_stdoutCacheNum));
 	if (m_metadata != EMPTY_STR_JSON)
 		result[JSON_KEY_APP_metadata] = m_metadata;
 	if (returnRuntimeInfo)
 	{
-		if (m_pid > 0)
+		// runtime usage from the per-tick sample, avoid scan /proc here
+		if (runtime->m_pid > 0)
 		{
-			result[JSON_KEY_APP_pid] = web::json::value::number(m_pid);
-			result[JSON_KEY_APP_open_fd] = web::json::value::number(os::fileDescriptors(m_pid));
+			result[JSON_KEY_APP_pid] = web::json::value::number(runtime->m_pid);
+			result[JSON_KEY_APP_open_fd] = web::json::value::number(runtime->m_openFileDesc);
 		}
-		if (m_return != nullptr)
-			result[JSON_KEY_APP_return] = web::json::value::number(*m_return);
-		if (m_process && m_process->running())
+		if (runtime->m_hasReturn)
+			result[JSON_KEY_APP_return] = web::json::value::number(runtime->m_return);
+		if (runtime->m_usageValid)
 		{
-			auto usage = m_process->getProcUsage();
-			if (std::get<0>(usage))
-			{
-				result[JSON_KEY_APP_memory] = web::json::value::number(std::get<1>(usage));
-				result[JSON_KEY_APP_cpu] = web::json::value::number(std::get<2>(usage));
-			}
+			result[JSON_KEY_APP_memory] = web::json::value::number(runtime->m_memory);
+			result[JSON_KEY_APP_cpu] = web::json::value::number(runtime->m_cpu);
 		}
-		if (std::chrono::time_point_cast<std::chrono::hours>(m_procStartTime).time_since_epoch().count() > 24) // avoid print 1970-01-01 08:00:00
-			result[JSON_KEY_APP_last_start] = web::json::value::string(DateTime::formatLocalTime(m_procStartTime));
-		if (m_process && !m_process->containerId().empty())
+		if (std::chrono::time_point_cast<std::chrono::hours>(runtime->m_procStartTime).time_since_epoch().count() > 24) // avoid print 1970-01-01 08:00:00
+			result[JSON_KEY_APP_last_start] = web::json::value::string(DateTime::formatLocalTime(runtime->m_procStartTime));
+		if (!runtime->m_containerId.empty())
 		{
-			result[JSON_KEY_APP_container_id] = web::json::value::string(GET_STRING_T(m_process->containerId()));
+			result[JSON_KEY_APP_container_id] = web::json::value::string(GET_STRING_T(runtime->m_containerId));
 		}
-		result[JSON_KEY_APP_health] = web::json::value::number(this->health());
-		if (m_stdoutFileQueue->size())
-			result[JSON_KEY_APP_stdout_cache_num] = web::json::value::number(m_stdoutFileQueue->size());
+		result[JSON_KEY_APP_health] = web::json::value::number(1 - runtime->m_health);
+		if (runtime->m_stdoutCacheNum)
+			result[JSON_KEY_APP_stdout_cache_num] = web::json::value::number(runtime->m_stdoutCacheNum);
 		//result[JSON_KEY_APP_id] = web::json::value::string(m_appId);
 	}
 	if (m_dailyLimit != nullptr)
@@ -693,10 +848,9 @@ web::json::value Application::AsJson(bool returnRuntimeInfo)
 	result[JSON_KEY_APP_REG_TIME] = web::json::value::string(DateTime::formatLocalTime(m_regTime));
 	if (returnRuntimeInfo)
 	{
-		auto err = getLastError();
-		if (err.length())
-			result[JSON_KEY_APP_last_error] = web::json::value::string(err);
-		result[JSON_KEY_APP_starts] = web::json::value::number(m_starts);
+		if (runtime->m_lastError.length())
+			result[JSON_KEY_APP_last_error] = web::json::value::string(runtime->m_lastError);
+		result[JSON_KEY_APP_starts] = web::json::value::number(runtime->m_starts);
 	}
 
 	result[JSON_KEY_APP_behavior] = this->behaviorAsJson();
@@ -709,13 +863,110 @@ web::json::value Application::AsJson(bool returnRuntimeInfo)
 		result[JSON_KEY_SHORT_APP_start_interval_seconds] = web::json::value::string(m_startIntervalValue);
 		if (returnRuntimeInfo)
 		{
-			if (m_nextLaunchTime != nullptr)
-				result[JSON_KEY_SHORT_APP_next_start_time] = web::json::value::string(DateTime::formatLocalTime(*m_nextLaunchTime));
+			if (runtime->m_hasNextLaunchTime)
+				result[JSON_KEY_SHORT_APP_next_start_time] = web::json::value::string(DateTime::formatLocalTime(runtime->m_nextLaunchTime));
 		}
 	}
 	return result;
 }
 
+void Application::writeJson(JsonWriter &writer, bool returnRuntimeInfo)
+{
+	// keep same fields with AsJson()
+	const auto runtime = getRuntimeStatus();
+	writer.startObject();
+	writer.member(JSON_KEY_APP_name, m_name);
+	if (m_owner)
+		writer.member(JSON_KEY_APP_owner, m_owner->getName());
+	if (m_ownerPermission)
+		writer.member(JSON_KEY_APP_owner_permission, m_ownerPermission);
+	if (m_shellApp)
+		writer.member(JSON_KEY_APP_shell_mode, m_shellApp);
+	if (m_commandLine.length())
+		writer.member(JSON_KEY_APP_command, m_commandLine);
+	if (m_healthCheckCmd.length())
+		writer.member(JSON_KEY_APP_health_check_cmd, m_healthCheckCmd);
+	if (m_healthCheckPolicy)
+		writer.member(JSON_KEY_APP_health_check, m_healthCheckPolicy->AsJson());
+	if (m_workdir.length())
+		writer.member(JSON_KEY_APP_working_dir, m_workdir);
+	writer.member(JSON_KEY_APP_status, static_cast<int>(runtime->m_status));
+	if (m_stdoutCacheNum && !(returnRuntimeInfo && runtime->m_stdoutCacheNum))
+		writer.member(JSON_KEY_APP_stdout_cache_num, m_stdoutCacheNum);
+	if (m_metadata != EMPTY_STR_JSON)
+		writer.member(JSON_KEY_APP_metadata, m_metadata);
+	if (returnRuntimeInfo)
+	{
+		if (runtime->m_pid > 0)
+		{
+			writer.member(JSON_KEY_APP_pid, static_cast<int>(runtime->m_pid));
+			writer.member(JSON_KEY_APP_open_fd, static_cast<uint64_t>(runtime->m_openFileDesc));
+		}
+		if (runtime->m_hasReturn)
+			writer.member(JSON_KEY_APP_return, runtime->m_return);
+		if (runtime->m_usageValid)
+		{
+			writer.member(JSON_KEY_APP_memory, runtime->m_memory);
+			writer.member(JSON_KEY_APP_cpu, static_cast<double>(runtime->m_cpu));
+		}
+		if (std::chrono::time_point_cast<std::chrono::hours>(runtime->m_procStartTime).time_since_epoch().count() > 24) // avoid print 1970-01-01 08:00:00
+			writer.member(JSON_KEY_APP_last_start, DateTime::formatLocalTime(runtime->m_procStartTime));
+		if (!runtime->m_containerId.empty())
+			writer.member(JSON_KEY_APP_container_id, runtime->m_containerId);
+		writer.member(JSON_KEY_APP_health, 1 - static_cast<int>(runtime->m_health));
+		if (runtime->m_stdoutCacheNum)
+			writer.member(JSON_KEY_APP_stdout_cache_num, static_cast<uint64_t>(runtime->m_stdoutCacheNum));
+	}
+	if (m_dailyLimit != nullptr)
+		writer.member(JSON_KEY_APP_daily_limitation, m_dailyLimit->AsJson());
+	if (m_resourceLimit != nullptr)
+		writer.member(JSON_KEY_APP_resource_limit, m_resourceLimit->AsJson());
+	if (m_envMap.size())
+	{
+		writer.key(JSON_KEY_APP_env).startObject();
+		for (const auto &env : m_envMap)
+			writer.member(env.first, env.second);
+		writer.endObject();
+	}
+	if (m_secEnvMap.size())
+	{
+		auto owner = getOwner();
+		writer.key(JSON_KEY_APP_sec_env).startObject();
+		for (const auto &env : m_secEnvMap)
+			writer.member(env.first, owner ? owner->encrypt(env.second) : env.second);
+		writer.endObject();
+	}
+	if (m_posixTimeZone.length() && m_posixTimeZone != DateTime::getLocalZoneUTCOffset())
+		writer.member(JSON_KEY_APP_posix_timezone, m_posixTimeZone);
+	if (m_dockerImage.length())
+		writer.member(JSON_KEY_APP_docker_image, m_dockerImage);
+	if (m_version)
+		writer.member(JSON_KEY_APP_version, static_cast<uint64_t>(m_version));
+	if (m_startTimeValue.time_since_epoch().count())
+		writer.member(JSON_KEY_SHORT_APP_start_time, m_startTime);
+	if (m_endTimeValue.time_since_epoch().count())
+		writer.member(JSON_KEY_SHORT_APP_end_time, m_endTime);
+	writer.member(JSON_KEY_APP_REG_TIME, DateTime::formatLocalTime(m_regTime));
+	if (returnRuntimeInfo)
+	{
+		if (runtime->m_lastError.length())
+			writer.member(JSON_KEY_APP_last_error, runtime->m_lastError);
+		writer.member(JSON_KEY_APP_starts, runtime->m_starts);
+	}
+	writer.member(JSON_KEY_APP_behavior, this->behaviorAsJson());
+	if (m_bufferTime)
+		writer.member(JSON_KEY_APP_retention, m_bufferTimeValue);
+	if (m_startIntervalValueIsCronExpr)
+		writer.member(JSON_KEY_SHORT_APP_cron_interval, m_startIntervalValueIsCronExpr);
+	if (m_startIntervalValue.length())
+	{
+		writer.member(JSON_KEY_SHORT_APP_start_interval_seconds, m_startIntervalValue);
+		if (returnRuntimeInfo && runtime->m_hasNextLaunchTime)
+			writer.member(JSON_KEY_SHORT_APP_next_start_time, DateTime::formatLocalTime(runtime->m_nextLaunchTime));
+	}
+	writer.endObject();
+}
+
 void Application::dump()
 {
 	const static char fname[] = "Application::dump() ";
@@ -801,6 +1052,7 @@ void Application::destroy()
 		std::lock_guard<std::recursive_mutex> guard(m_appMutex);
 		this->disable();
 		this->m_status = STATUS::NOTAVIALABLE;
+		publishRuntimeStatus();
 		suicideTimerId = m_suicideTimerId;
 		timerId = m_nextStartTimerId;
 		m_suicideTimerId = m_nextStartTimerId = 0;
@@ -827,10 +1079,25 @@ void Application::onSuicide(int timerId)
 	}
 }
 
+void Application::publishStartEvent()
+{
+	auto detail = web::json::value::object();
+	if (m_pid > 0)
+		detail[JSON_KEY_APP_pid] = web::json::value::number(m_pid);
+	else
+		detail[JSON_KEY_APP_last_error] = web::json::value::string(m_process->startError());
+	EventBus::instance()->publish(APP_EVENT_start, *this, detail);
+}
+
 void Application::onExit(int code)
 {
 	const static char fname[] = "Application::onExit() ";
 
+	PersistManager::instance()->onProcessExit(m_name);
+	auto detail = web::json::value::object();
+	detail[JSON_KEY_APP_return] = web::json::value::number(code);
+	EventBus::instance()->publish(APP_EVENT_exit, *this, detail);
+
 	switch (this->exitAction(code))
 	{
 	case AppBehavior::Action::STANDBY:
@@ -869,6 +1136,7 @@ void Application::scheduleNext(std::chrono::system_clock::time_point now)
 	{
 		std::lock_guard<std::recursive_mutex> guard(m_appMutex);
 		m_nextLaunchTime = std::make_unique<std::chrono::system_clock::time_point>(next);
+		publishRuntimeStatus();
 		LOG_DBG << fname << "next start for <" << m_name << "> is " << DateTime::formatLocalTime(*m_nextLaunchTime);
 	}
 
@@ -889,6 +1157,7 @@ void Application::scheduleNext(std::chrono::system_clock::time_point now)
 	else
 	{
 		m_nextLaunchTime = nullptr;
+		publishRuntimeStatus();
 	}
 }
 
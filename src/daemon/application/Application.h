@@ -21,6 +21,36 @@ class PrometheusRest;
 class AppProcess;
 class DailyLimitation;
 class ResourceLimitation;
+class JsonWriter;
+
+//////////////////////////////////////////////////////////////////////////
+/// Immutable runtime status of an Application, mutating path (hold
+/// application lock) publish a new copy and readers load it without lock
+//////////////////////////////////////////////////////////////////////////
+struct AppRuntimeStatus
+{
+	AppRuntimeStatus();
+	bool operator==(const AppRuntimeStatus &other) const;
+
+	STATUS m_status;
+	pid_t m_pid;
+	bool m_health;
+	bool m_hasReturn;
+	int m_return;
+	std::chrono::system_clock::time_point m_procStartTime;
+	bool m_hasNextLaunchTime;
+	std::chrono::system_clock::time_point m_nextLaunchTime;
+	// cpu/memory sample is valid only when process is running
+	bool m_usageValid;
+	uint64_t m_memory;
+	float m_cpu;
+	size_t m_openFileDesc;
+	size_t m_stdoutCacheNum;
+	int m_starts;
+	std::string m_containerId;
+	std::string m_lastError;
+};
+
 //////////////////////////////////////////////////////////////////////////
 /// An Application is used to define and manage a process job.
 //////////////////////////////////////////////////////////////////////////
@@ -36,9 +66,15 @@ public:
 	void health(bool health);
 	int health() const;
 	const std::string &healthCheckCmd() const;
+	/// <summary>
+	/// Health check schedule, nullptr use default policy
+	/// </summary>
+	const std::shared_ptr<HealthCheckPolicy> &healthCheckPolicy() const;
 	const std::shared_ptr<User> &getOwner() const;
 	int getOwnerPermission() const;
 	bool isCloudApp() const;
+	STATUS getStatus() const;
+	const web::json::value &getMetadata() const;
 
 	bool available(const std::chrono::system_clock::time_point &now = std::chrono::system_clock::now());
 	bool isEnabled() const;
@@ -46,7 +82,23 @@ public:
 
 	static void FromJson(const std::shared_ptr<Application> &app, const web::json::value &obj) noexcept(false);
 	virtual web::json::value AsJson(bool returnRuntimeInfo);
+	/// <summary>
+	/// Stream the same content of AsJson() into writer without build DOM
+	/// </summary>
+	void writeJson(JsonWriter &writer, bool returnRuntimeInfo);
 	virtual void dump();
+	/// <summary>
+	/// Serialized runtime JSON (AsJson(true)), cached until runtime version changed
+	/// </summary>
+	const std::shared_ptr<const std::string> AsJsonCached();
+	/// <summary>
+	/// Monotonically increasing version, changed when any field of AsJson(true) changed
+	/// </summary>
+	uint64_t getRuntimeVersion() const;
+	/// <summary>
+	/// Latest published runtime status, never block by process operations
+	/// </summary>
+	std::shared_ptr<const AppRuntimeStatus> getRuntimeStatus() const;
 
 	// operate
 	void execute(void *ptree = nullptr);
@@ -78,6 +130,13 @@ protected:
 	void spawn(int timerId);
 	void refreshStatus(void *ptree = nullptr);
 	void checkAndUpdateHealth();
+	void sampleRuntime(void *ptree);
+	void increaseRuntimeVersion();
+	/// <summary>
+	/// Publish runtime fields to readers, caller should hold m_appMutex
+	/// </summary>
+	void publishRuntimeStatus();
+	void publishStartEvent();
 
 	std::string runApp(int timeoutSeconds) noexcept(false);
 	const std::string getExecUser() const;
@@ -123,6 +182,7 @@ protected:
 	std::chrono::system_clock::time_point m_regTime;
 	bool m_health;
 	std::string m_healthCheckCmd;
+	std::shared_ptr<HealthCheckPolicy> m_healthCheckPolicy;
 	const std::string m_appId;
 	unsigned int m_version;
 	std::shared_ptr<AppProcess> m_process;
@@ -135,6 +195,21 @@ protected:
 	std::string m_dockerImage;
 	std::chrono::system_clock::time_point m_procStartTime;
 
+	// runtime sample, refreshed once per schedule tick
+	std::tuple<bool, uint64_t, float> m_procUsage;
+	size_t m_openFileDesc;
+	// runtime status published to lock free readers
+	std::shared_ptr<const AppRuntimeStatus> m_runtimeStatus;
+	// runtime JSON cache
+	static std::atomic<uint64_t> m_runtimeVersionSeq;
+	std::atomic<uint64_t> m_runtimeVersion;
+	struct RuntimeJsonCache
+	{
+		uint64_t m_version;
+		std::string m_json;
+	};
+	std::shared_ptr<const RuntimeJsonCache> m_runtimeJson;
+
 	// Prometheus
 	std::shared_ptr<CounterMetric> m_metricStartCount;
 	std::shared_ptr<GaugeMetric> m_metricMemory;
@@ -0,0 +1,198 @@
+#include <list>
+
+#include "../../common/DateTime.h"
+#include "../../common/Utility.h"
+#include "../Configuration.h"
+#include "AppFilter.h"
+#include "Application.h"
+#include "EventBus.h"
+
+web::json::value AppEvent::AsJson() const
+{
+	auto result = web::json::value::object();
+	result[JSON_KEY_EVENT_seq] = web::json::value::number(m_seq);
+	result[JSON_KEY_EVENT_type] = web::json::value::string(m_type);
+	result[JSON_KEY_EVENT_app] = web::json::value::string(m_app);
+	result[JSON_KEY_EVENT_time] = web::json::value::string(DateTime::formatISO8601Time(m_time));
+	result[JSON_KEY_EVENT_detail] = m_detail;
+	return result;
+}
+
+EventBus::EventBus()
+	: m_sequence(0), m_waiterIndex(0)
+{
+	m_flushPending.clear();
+}
+
+EventBus::~EventBus()
+{
+}
+
+std::shared_ptr<EventBus> &EventBus::instance()
+{
+	static auto singleton = std::make_shared<EventBus>();
+	return singleton;
+}
+
+void EventBus::publish(const std::string &type, const Application &app, const web::json::value &detail)
+{
+	const static char fname[] = "EventBus::publish() ";
+
+	const auto &appName = app.getName();
+	const auto &metadata = app.getMetadata();
+	bool hasWaiter = false;
+	{
+		std::lock_guard<std::recursive_mutex> guard(m_mutex);
+		AppEvent event;
+		event.m_seq = ++m_sequence;
+		event.m_type = type;
+		event.m_app = appName;
+		event.m_time = std::chrono::system_clock::now();
+		if (metadata.is_object())
+			event.m_metadata = metadata;
+		event.m_detail = detail;
+		event.m_owner = app.getOwner();
+		event.m_ownerPermission = app.getOwnerPermission();
+		m_events.push_back(std::move(event));
+		while (m_events.size() > DEFAULT_EVENT_BUS_SIZE)
+		{
+			m_events.pop_front();
+		}
+		hasWaiter = !m_waiters.empty();
+	}
+	LOG_DBG << fname << "application <" << appName << "> event <" << type << ">";
+
+	// publisher may hold application lock, reply waiters from timer thread
+	// and coalesce burst events to one flush
+	if (hasWaiter && !m_flushPending.test_and_set())
+	{
+		this->registerTimer(0, 0, std::bind(&EventBus::flushWaiters, this, std::placeholders::_1), fname);
+	}
+}
+
+void EventBus::subscribe(const std::shared_ptr<AppFilter> &filter, const std::string &user, int64_t cursor, int timeoutSeconds, const Callback &callback)
+{
+	const static char fname[] = "EventBus::subscribe() ";
+
+	uint64_t waiterId = 0;
+	web::json::value result;
+	{
+		std::lock_guard<std::recursive_mutex> guard(m_mutex);
+		const uint64_t from = (cursor < 0) ? m_sequence : static_cast<uint64_t>(cursor);
+		bool matched = false;
+		result = collect(filter, user, from, matched);
+		if (!matched && timeoutSeconds > 0)
+		{
+			waiterId = ++m_waiterIndex;
+			m_waiters[waiterId] = Waiter{filter, user, from, callback, 0};
+		}
+	}
+	if (waiterId == 0)
+	{
+		callback(result);
+		return;
+	}
+
+	const int timerId = this->registerTimer(1000L * timeoutSeconds, 0, [this, waiterId](int)
+											{ this->expireWaiter(waiterId); },
+											fname);
+	std::lock_guard<std::recursive_mutex> guard(m_mutex);
+	auto iter = m_waiters.find(waiterId);
+	if (iter != m_waiters.end())
+	{
+		iter->second.m_timerId = timerId;
+	}
+}
+
+web::json::value EventBus::collect(const std::shared_ptr<AppFilter> &filter, const std::string &user, uint64_t cursor, bool &matched) const
+{
+	auto events = web::json::value::array();
+	std::size_t index = 0;
+	uint64_t next = cursor;
+	// sequence is continuous in ring buffer, locate the first event after cursor directly
+	if (m_events.size() && cursor >= m_events.front().m_seq)
+	{
+		index = std::min<std::size_t>(cursor - m_events.front().m_seq + 1, m_events.size());
+	}
+	for (; index < m_events.size(); index++)
+	{
+		const auto &event = m_events[index];
+		next = event.m_seq;
+		if ((filter == nullptr || filter->match(event.m_app, event.m_metadata)) && viewable(event, user))
+		{
+			events[events.size()] = event.AsJson();
+		}
+	}
+	matched = events.size() > 0;
+
+	auto result = web::json::value::object();
+	result[JSON_KEY_EVENT_events] = events;
+	// filtered events also move cursor forward
+	result[JSON_KEY_EVENT_cursor] = web::json::value::number(std::max(next, cursor));
+	// events before cursor are dropped from ring buffer, subscriber should resync
+	result[JSON_KEY_EVENT_truncated] = web::json::value::boolean(m_events.size() && cursor + 1 < m_events.front().m_seq);
+	return result;
+}
+
+bool EventBus::viewable(const AppEvent &event, const std::string &user)
+{
+	try
+	{
+		// same owner permission check with application view API
+		return Configuration::instance()->checkOwnerPermission(user, event.m_owner, event.m_ownerPermission, false);
+	}
+	catch (...)
+	{
+		// subscriber user removed
+		return false;
+	}
+}
+
+void EventBus::flushWaiters(int timerId)
+{
+	m_flushPending.clear();
+
+	std::list<std::pair<Waiter, web::json::value>> replies;
+	{
+		std::lock_guard<std::recursive_mutex> guard(m_mutex);
+		for (auto iter = m_waiters.begin(); iter != m_waiters.end();)
+		{
+			bool matched = false;
+			auto result = collect(iter->second.m_filter, iter->second.m_user, iter->second.m_cursor, matched);
+			if (matched)
+			{
+				replies.push_back(std::make_pair(std::move(iter->second), std::move(result)));
+				iter = m_waiters.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+	for (auto &reply : replies)
+	{
+		this->cancelTimer(reply.first.m_timerId);
+		reply.first.m_callback(reply.second);
+	}
+}
+
+void EventBus::expireWaiter(uint64_t waiterId)
+{
+	Waiter waiter;
+	web::json::value result;
+	{
+		std::lock_guard<std::recursive_mutex> guard(m_mutex);
+		auto iter = m_waiters.find(waiterId);
+		if (iter == m_waiters.end())
+		{
+			// already replied
+			return;
+		}
+		waiter = std::move(iter->second);
+		m_waiters.erase(iter);
+		bool matched = false;
+		result = collect(waiter.m_filter, waiter.m_user, waiter.m_cursor, matched);
+	}
+	waiter.m_callback(result);
+}
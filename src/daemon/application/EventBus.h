@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <cpprest/json.h>
+
+#include "../TimerHandler.h"
+
+class AppFilter;
+class Application;
+class User;
+/// <summary>
+/// One application lifecycle event
+/// </summary>
+struct AppEvent
+{
+	web::json::value AsJson() const;
+
+	uint64_t m_seq;
+	std::string m_type;
+	std::string m_app;
+	std::chrono::system_clock::time_point m_time;
+	// application metadata when event happen, used for label filter
+	web::json::value m_metadata;
+	web::json::value m_detail;
+	// application owner when event happen, used for view permission check
+	std::shared_ptr<User> m_owner;
+	int m_ownerPermission;
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// Bounded application event bus, application lifecycle changes are published
+/// to a ring buffer with increasing sequence, subscribers long poll with the
+/// last received sequence as resume cursor and get replied when new matched
+/// events arrive or wait timeout.
+//////////////////////////////////////////////////////////////////////////
+class EventBus : public TimerHandler
+{
+public:
+	typedef std::function<void(const web::json::value &)> Callback;
+
+	EventBus();
+	virtual ~EventBus();
+	static std::shared_ptr<EventBus> &instance();
+
+	/// <summary>
+	/// Publish an application event
+	/// </summary>
+	/// <param name="type">APP_EVENT_xxx</param>
+	/// <param name="app">application, name, metadata and owner are recorded</param>
+	/// <param name="detail">event detail</param>
+	void publish(const std::string &type, const Application &app, const web::json::value &detail = web::json::value::object());
+
+	/// <summary>
+	/// Subscribe events after cursor, callback immediately if there are matched events,
+	/// otherwise wait for new events until timeout.
+	/// Callback json: {"events": [], "cursor": 10, "truncated": false}
+	/// </summary>
+	/// <param name="filter">app name and label filter</param>
+	/// <param name="user">subscriber user name, only events of applications the user can view are replied</param>
+	/// <param name="cursor">last received sequence, -1 means from now</param>
+	/// <param name="timeoutSeconds">max wait seconds</param>
+	/// <param name="callback">reply callback, called once</param>
+	void subscribe(const std::shared_ptr<AppFilter> &filter, const std::string &user, int64_t cursor, int timeoutSeconds, const Callback &callback);
+
+private:
+	struct Waiter
+	{
+		std::shared_ptr<AppFilter> m_filter;
+		std::string m_user;
+		uint64_t m_cursor;
+		Callback m_callback;
+		int m_timerId;
+	};
+
+	// collect matched events after cursor, need lock
+	web::json::value collect(const std::shared_ptr<AppFilter> &filter, const std::string &user, uint64_t cursor, bool &matched) const;
+	static bool viewable(const AppEvent &event, const std::string &user);
+	void flushWaiters(int timerId = 0);
+	void expireWaiter(uint64_t waiterId);
+
+private:
+	std::deque<AppEvent> m_events;
+	uint64_t m_sequence;
+	// key: waiter id
+	std::map<uint64_t, Waiter> m_waiters;
+	uint64_t m_waiterIndex;
+	std::atomic_flag m_flushPending;
+	mutable std::recursive_mutex m_mutex;
+};
@@ -6,11 +6,18 @@
 #include "../../common/PerfLog.h"
 #include "../../common/Utility.h"
 #include "../../common/os/linux.hpp"
+#include "../../prom_exporter/counter.h"
+#include "../../prom_exporter/gauge.h"
+#include "../../prom_exporter/histogram.h"
 #include "../Configuration.h"
+#include "../PersistManager.h"
 #include "../ResourceCollection.h"
 #include "../application/Application.h"
+#include "../rest/PrometheusRest.h"
 #include "../security/Security.h"
 #include "ConsulConnection.h"
+#include "ConsulHttpPool.h"
+#include "LabelIndex.h"
 #include "Scheduler.h"
 
 #define CONSUL_BASE_PATH "/v1/kv/appmesh/"
@@ -418,8 +425,11 @@ std::string ConsulConnection::consulSessionId()
 
 void ConsulConnection::consulSessionId(const std::string &sessionId)
 {
-	std::lock_guard<std::recursive_mutex> guard(m_consulMutex);
-	m_sessionId = sessionId;
+	{
+		std::lock_guard<std::recursive_mutex> guard(m_consulMutex);
+		m_sessionId = sessionId;
+	}
+	PersistManager::instance()->onConsulSession(sessionId);
 }
 
 void ConsulConnection::doSchedule()
@@ -441,7 +451,8 @@ void ConsulConnection::doSchedule()
 			findTaskAvailableHost(taskList, nodes);
 
 			// schedule task
-			auto newTopology = Scheduler::scheduleTask(taskList, oldTopology);
+			// running replicas are kept, only new, orphaned and over-replicated replicas are moved
+			auto newTopology = Scheduler::scheduleTask(taskList, oldTopology, ResourceScheduler::parseStrategy(getConfig()->m_scheduleStrategy), getConfig()->m_scheduleMaxMoves);
 
 			// apply schedule result
 			compareTopologyAndDispatch(oldTopology, newTopology);
@@ -466,6 +477,7 @@ void ConsulConnection::syncTopology()
 {
 	const static char fname[] = "ConsulConnection::syncTopology() ";
 
+	std::lock_guard<std::mutex> guard(m_syncTopologyMutex);
 	auto currentAllApps = Configuration::instance()->getApps();
 	std::shared_ptr<ConsulTopology> newTopology;
 	auto topology = retrieveTopology(MY_HOST_NAME);
@@ -475,23 +487,25 @@ void ConsulConnection::syncTopology()
 
 	if (newTopology)
 	{
-		auto task = retrieveTask();
+		const bool taskReady = refreshTask();
 		for (const auto &hostApp : newTopology->m_scheduleApps)
 		{
 			const auto &appName = hostApp.first;
-			if (task.count(appName))
+			long long taskIndex = 0;
+			auto consulTask = taskReady ? m_taskCache.find(appName, taskIndex) : nullptr;
+			if (consulTask)
 			{
-				auto &consulTask = task[appName];
 				std::shared_ptr<Application> topologyAppObj = consulTask->m_app;
-				auto it = std::find_if(currentAllApps.begin(), currentAllApps.end(), [&appName](std::shared_ptr<Application> const &obj)
-									   { return obj->getName() == appName; });
-				if (it != currentAllApps.end())
+				auto currentRunningApp = currentAllApps->find(appName);
+				if (currentRunningApp)
 				{
+					// only task with advanced ModifyIndex need to be compared
+					if (m_syncedTasks.count(appName) && m_syncedTasks[appName] == taskIndex)
+						continue;
 					// Update app
-					auto &currentRunningApp = *it;
 					if (!currentRunningApp->operator==(topologyAppObj))
 					{
-						Configuration::instance()->addApp(currentRunningApp->AsJson(false));
+						Configuration::instance()->addApp(topologyAppObj->AsJson(false));
 						LOG_INF << fname << "Consul application <" << currentRunningApp->getName() << "> updated";
 
 						registerService(appName, consulTask->m_consulServicePort);
@@ -505,10 +519,11 @@ void ConsulConnection::syncTopology()
 
 					registerService(appName, consulTask->m_consulServicePort);
 				}
+				m_syncedTasks[appName] = taskIndex;
 			}
 		}
 
-		for (const auto &currentApp : currentAllApps)
+		for (const auto &currentApp : *currentAllApps)
 		{
 			if (currentApp->isCloudApp())
 			{
@@ -518,6 +533,7 @@ void ConsulConnection::syncTopology()
 					Configuration::instance()->removeApp(currentApp->getName());
 					LOG_INF << fname << "Consul application <" << currentApp->getName() << "> removed";
 					deregisterService(currentApp->getName());
+					m_syncedTasks.erase(currentApp->getName());
 				}
 			}
 		}
@@ -525,7 +541,7 @@ void ConsulConnection::syncTopology()
 	else
 	{
 		// retrieveTopology will throw if connection was not reached
-		for (const auto &currentApp : currentAllApps)
+		for (const auto &currentApp : *currentAllApps)
 		{
 			if (currentApp->isCloudApp())
 			{
@@ -535,6 +551,7 @@ void ConsulConnection::syncTopology()
 				deregisterService(currentApp->getName());
 			}
 		}
+		m_syncedTasks.clear();
 	}
 }
 
@@ -551,7 +568,13 @@ bool ConsulConnection::electionLeader()
 	auto body = web::json::value::string(MY_HOST_NAME);
 	auto timestamp = std::to_string(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
 	auto resp = requestHttp(web::http::methods::PUT, path, {{"acquire", sessionId}, {"flags", timestamp}}, {}, &body);
-	m_leader = (resp.status_code() == web::http::status_codes::OK);
+	// Consul return 200 with JSON false when the lock is held by other session
+	m_leader = false;
+	if (resp.status_code() == web::http::status_codes::OK)
+	{
+		const auto result = resp.extract_json(true).get();
+		m_leader = (result.is_boolean() && result.as_bool());
+	}
 	LOG_DBG << fname << " m_leader = " << m_leader;
 	return m_leader;
 }
@@ -567,7 +590,7 @@ void ConsulConnection::offlineNode()
 	requestHttp(web::http::methods::DEL, path, {}, {}, nullptr);
 
 	auto currentAllApps = Configuration::instance()->getApps();
-	for (const auto &currentApp : currentAllApps)
+	for (const auto &currentApp : *currentAllApps)
 	{
 		if (currentApp->isCloudApp())
 		{
@@ -663,57 +686,62 @@ void ConsulConnection::findTaskAvailableHost(const std::map<std::string, std::sh
 {
 	const static char fname[] = "ConsulConnection::findTaskAvailableHost() ";
 
+	// inverted label index of available hosts, task condition match by posting list intersection
+	LabelIndex index;
+	std::vector<std::pair<std::string, std::shared_ptr<ConsulNode>>> indexedHosts;
+	indexedHosts.reserve(hosts.size());
+	for (const auto &host : hosts)
+	{
+		if (!host.second->full())
+		{
+			index.addNode(host.second->m_label->getLabels());
+			indexedHosts.push_back(host);
+		}
+	}
+
 	for (const auto &task : taskMap)
 	{
-		auto taskName = task.first;
 		task.second->m_matchedHosts.clear();
-		for (const auto &host : hosts)
+		for (const auto node : index.match(*task.second->m_conditionMatcher))
 		{
-			auto &hostName = host.first;
-			auto &consulHost = host.second;
-			auto &taskCondition = task.second->m_condition;
-			if (consulHost->m_label->match(taskCondition) && !consulHost->full())
-			{
-				task.second->m_matchedHosts[hostName] = consulHost;
-				LOG_DBG << fname << "task <" << taskName << "> match host <" << hostName << ">";
-			}
+			task.second->m_matchedHosts.insert(indexedHosts[node]);
 		}
+		LOG_DBG << fname << "task <" << task.first << "> match <" << task.second->m_matchedHosts.size() << "> hosts";
 	}
 }
 
-void ConsulConnection::compareTopologyAndDispatch(const std::map<std::string, std::shared_ptr<ConsulTopology>> &oldT, const std::map<std::string, std::shared_ptr<ConsulTopology>> &newT)
+std::size_t ConsulConnection::compareTopologyAndDispatch(const std::map<std::string, std::shared_ptr<ConsulTopology>> &oldT, const std::map<std::string, std::shared_ptr<ConsulTopology>> &newT)
 {
-	for (const auto &newHost : newT)
+	const static char fname[] = "ConsulConnection::compareTopologyAndDispatch() ";
+
+	const static std::map<std::string, std::chrono::system_clock::time_point> emptyApps;
+	std::size_t added = 0;
+	std::size_t removed = 0;
+	std::size_t written = 0;
+	auto diff = [&added, &removed](const std::map<std::string, std::chrono::system_clock::time_point> &oldApps, const std::map<std::string, std::chrono::system_clock::time_point> &newApps)
 	{
-		if (oldT.count(newHost.first))
+		const auto before = added + removed;
+		for (const auto &app : newApps)
 		{
-			auto equal = true;
-			if (newHost.second->m_scheduleApps.size() == oldT.find(newHost.first)->second->m_scheduleApps.size())
-			{
-				for (const auto &app : newHost.second->m_scheduleApps)
-				{
-					if (!oldT.find(newHost.first)->second->m_scheduleApps.count(app.first))
-					{
-						equal = false;
-						break;
-					}
-				}
-				// equal, do nothing here
-			}
-			else
-			{
-				equal = false;
-			}
-			if (!equal)
-			{
-				// update
-				writeTopology(newHost.first, newHost.second);
-			}
+			if (!oldApps.count(app.first))
+				added++;
 		}
-		else
+		for (const auto &app : oldApps)
+		{
+			if (!newApps.count(app.first))
+				removed++;
+		}
+		return added + removed != before;
+	};
+
+	for (const auto &newHost : newT)
+	{
+		auto oldHost = oldT.find(newHost.first);
+		// add or update, host with the same app set is not written
+		if (diff(oldHost == oldT.end() ? emptyApps : oldHost->second->m_scheduleApps, newHost.second->m_scheduleApps))
 		{
-			// add
 			writeTopology(newHost.first, newHost.second);
+			written++;
 		}
 	}
 
@@ -722,9 +750,24 @@ void ConsulConnection::compareTopologyAndDispatch(const std::map<std::string, st
 		if (!newT.count(oldHost.first))
 		{
 			// delete
+			diff(oldHost.second->m_scheduleApps, emptyApps);
 			writeTopology(oldHost.first, nullptr);
+			written++;
 		}
 	}
+
+	if (written)
+	{
+		LOG_INF << fname << "moved replicas <" << (added + removed) << "> added <" << added << "> removed <" << removed << "> hosts written <" << written << ">";
+	}
+	{
+		std::lock_guard<std::recursive_mutex> guard(m_consulMutex);
+		if (m_metricAddedReplicas)
+			m_metricAddedReplicas->metric().Set(added);
+		if (m_metricRemovedReplicas)
+			m_metricRemovedReplicas->metric().Set(removed);
+	}
+	return added + removed;
 }
 
 bool ConsulConnection::writeTopology(std::string hostName, const std::shared_ptr<ConsulTopology> topology)
@@ -733,12 +776,12 @@ bool ConsulConnection::writeTopology(std::string hostName, const std::shared_ptr
 
 	//topology: /appmesh/topology/myhost
 	std::string path = std::string(CONSUL_BASE_PATH).append("topology/").append(hostName);
-	auto body = web::json::value::object();
+	std::string body = "{}";
 	auto timestamp = std::to_string(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
 	if (topology && topology->m_scheduleApps.size())
-		body = topology->AsJson();
-	web::http::http_response resp = requestHttp(web::http::methods::PUT, path, {{"flags", timestamp}}, {}, &body);
-	LOG_INF << fname << "write <" << body.serialize() << "> to <" << hostName << ">";
+		body = topology->serialize();
+	web::http::http_response resp = requestHttpRaw(web::http::methods::PUT, path, {{"flags", timestamp}}, {}, &body);
+	LOG_INF << fname << "write <" << body << "> to <" << hostName << ">";
 
 	if (resp.status_code() == web::http::status_codes::OK)
 	{
@@ -779,38 +822,32 @@ std::map<std::string, std::shared_ptr<ConsulTopology>> ConsulConnection::retriev
 	const static char fname[] = "ConsulConnection::retrieveTopology() ";
 
 	// /appmesh/topology/myhost
-	std::map<std::string, std::shared_ptr<ConsulTopology>> topology;
+	auto &cache = host.empty() ? m_topologyCache : m_localTopologyCache;
 	auto path = std::string(CONSUL_BASE_PATH).append("topology");
 	if (host.length())
 		path.append("/").append(host);
-	auto resp = requestHttp(web::http::methods::GET, path, {{"recurse", "true"}}, {}, nullptr);
-	if (resp.status_code() == web::http::status_codes::OK)
+	web::json::value listing;
+	long long index = 0;
+	if (!fetchKvListing(path, cache.index(), listing, index))
 	{
-		auto json = resp.extract_json(true).get();
-		if (json.is_array())
-		{
-			for (const auto &section : json.as_array())
-			{
-				if (HAS_JSON_FIELD(section, "Value"))
-				{
-					// int consulIndex = GET_JSON_INT_VALUE(section, "ModifyIndex");
-					auto hostText = Utility::decode64(GET_JSON_STR_VALUE(section, "Value"));
-					if (hostText.empty())
-						continue;
-					auto consulKey = GET_JSON_STR_VALUE(section, "Key");
-					auto vec = Utility::splitString(consulKey, "/");
-					auto hostName = vec[vec.size() - 1];
-					auto appArrayJson = web::json::value::parse(hostText);
-					if (appArrayJson.is_array())
-					{
-						topology[hostName] = ConsulTopology::FromJson(appArrayJson, hostName);
-						LOG_DBG << fname << "get <" << appArrayJson.size() << "> task for <" << hostName << ">";
-					}
-				}
-			}
-		}
+		return std::map<std::string, std::shared_ptr<ConsulTopology>>();
+	}
+	if (!listing.is_null())
+	{
+		auto parsed = cache.apply(listing, index, [](const std::string &key, const std::string &value, std::string &hostName) -> std::shared_ptr<ConsulTopology>
+								  {
+									  auto vec = Utility::splitString(key, "/");
+									  hostName = vec[vec.size() - 1];
+									  auto appArrayJson = web::json::value::parse(value);
+									  if (!appArrayJson.is_array())
+										  return nullptr;
+									  LOG_DBG << fname << "get <" << appArrayJson.size() << "> task for <" << hostName << ">";
+									  return ConsulTopology::FromJson(appArrayJson, hostName);
+								  });
+		LOG_DBG << fname << "parsed <" << parsed << "> changed topology";
 	}
 
+	auto topology = cache.items();
 	LOG_DBG << fname << "get topology size : " << topology.size();
 	return topology;
 }
@@ -819,35 +856,47 @@ std::map<std::string, std::shared_ptr<ConsulTask>> ConsulConnection::retrieveTas
 {
 	const static char fname[] = "ConsulConnection::retrieveTask() ";
 
-	std::map<std::string, std::shared_ptr<ConsulTask>> result;
-	// /appmesh/cluster/tasks/myapp
-	std::string path = std::string(CONSUL_BASE_PATH).append("cluster/tasks");
-	auto resp = requestHttp(web::http::methods::GET, path, {{"recurse", "true"}}, {}, nullptr);
-	if (resp.status_code() == web::http::status_codes::OK)
+	if (!refreshTask())
 	{
-		auto json = resp.extract_json(true).get();
-		if (json.is_array())
-		{
-			for (const auto &section : json.as_array())
-			{
-				if (HAS_JSON_FIELD(section, "Value") && GET_JSON_STR_VALUE(section, "Key") != "appmesh/cluster/tasks")
-				{
-					auto appText = Utility::decode64(GET_JSON_STR_VALUE(section, "Value"));
-					auto appJson = web::json::value::parse(appText);
-					auto task = ConsulTask::FromJson(appJson);
-					if (task->m_app && task->m_app->getName().length() && task->m_replication)
-					{
-						result[task->m_app->getName()] = task;
-						LOG_DBG << fname << "get task <" << task->m_app->getName() << ">";
-					}
-				}
-			}
-		}
+		return std::map<std::string, std::shared_ptr<ConsulTask>>();
 	}
+	auto result = m_taskCache.items();
 	LOG_DBG << fname << "get tasks size : " << result.size();
 	return result;
 }
 
+bool ConsulConnection::refreshTask()
+{
+	const static char fname[] = "ConsulConnection::refreshTask() ";
+
+	// /appmesh/cluster/tasks/myapp
+	std::string path = std::string(CONSUL_BASE_PATH).append("cluster/tasks");
+	web::json::value listing;
+	long long index = 0;
+	if (!fetchKvListing(path, m_taskCache.index(), listing, index))
+	{
+		return false;
+	}
+	if (!listing.is_null())
+	{
+		auto parsed = m_taskCache.apply(listing, index, [](const std::string &key, const std::string &value, std::string &taskName) -> std::shared_ptr<ConsulTask>
+										{
+											if (key == "appmesh/cluster/tasks")
+												return nullptr;
+											auto task = ConsulTask::FromJson(web::json::value::parse(value));
+											if (task->m_app && task->m_app->getName().length() && task->m_replication)
+											{
+												taskName = task->m_app->getName();
+												LOG_DBG << fname << "get task <" << taskName << ">";
+												return task;
+											}
+											return nullptr;
+										});
+		LOG_DBG << fname << "parsed <" << parsed << "> changed tasks";
+	}
+	return true;
+}
+
 /*
 [
 	"appmesh/cluster/nodes/cents"
@@ -857,34 +906,56 @@ std::map<std::string, std::shared_ptr<ConsulNode>> ConsulConnection::retrieveNod
 {
 	const static char fname[] = "ConsulConnection::retrieveNode() ";
 
-	std::map<std::string, std::shared_ptr<ConsulNode>> result;
 	// /appmesh/cluster/nodes
 	std::string path = std::string(CONSUL_BASE_PATH).append("cluster/nodes");
-	auto resp = requestHttp(web::http::methods::GET, path, {{"recurse", "true"}}, {}, nullptr);
-	if (resp.status_code() == web::http::status_codes::OK)
+	web::json::value listing;
+	long long index = 0;
+	if (!fetchKvListing(path, m_nodeCache.index(), listing, index))
 	{
-		auto json = resp.extract_json(true).get();
-		if (json.is_array())
-		{
-			for (const auto &section : json.as_array())
-			{
-				if (section.has_string_field("Key") && section.has_string_field("Value") && section.at("Value").as_string().length())
-				{
-					auto key = GET_JSON_STR_VALUE(section, "Key");
-					if (Utility::startWith(key, "appmesh/cluster/nodes/"))
-					{
-						auto host = Utility::stringReplace(key, "appmesh/cluster/nodes/", "");
-						auto value = web::json::value::parse(Utility::decode64(section.at("Value").as_string()));
-						result[host] = ConsulNode::FromJson(value, host);
-					}
-				}
-			}
-		}
+		return std::map<std::string, std::shared_ptr<ConsulNode>>();
+	}
+	if (!listing.is_null())
+	{
+		auto parsed = m_nodeCache.apply(listing, index, [](const std::string &key, const std::string &value, std::string &host) -> std::shared_ptr<ConsulNode>
+										{
+											if (!Utility::startWith(key, "appmesh/cluster/nodes/"))
+												return nullptr;
+											host = Utility::stringReplace(key, "appmesh/cluster/nodes/", "");
+											return ConsulNode::FromJson(web::json::value::parse(value), host);
+										});
+		LOG_DBG << fname << "parsed <" << parsed << "> changed nodes";
 	}
+	auto result = m_nodeCache.items();
 	LOG_DBG << fname << "get nodes size : " << result.size();
 	return result;
 }
 
+bool ConsulConnection::fetchKvListing(const std::string &path, long long cachedIndex, web::json::value &listing, long long &index)
+{
+	const static char fname[] = "ConsulConnection::fetchKvListing() ";
+
+	listing = web::json::value::null();
+	auto resp = requestHttp(web::http::methods::GET, path, {{"recurse", "true"}}, {}, nullptr);
+	// NotFound means no key under the prefix
+	if (resp.status_code() != web::http::status_codes::OK && resp.status_code() != web::http::status_codes::NotFound)
+	{
+		return false;
+	}
+	index = 0;
+	if (resp.headers().has("X-Consul-Index"))
+	{
+		index = std::atoll(resp.headers().find("X-Consul-Index")->second.c_str());
+	}
+	if (index > 0 && index == cachedIndex)
+	{
+		// nothing changed under the prefix, skip parse response body
+		LOG_DBG << fname << path << " not changed from index " << index;
+		return true;
+	}
+	listing = (resp.status_code() == web::http::status_codes::OK) ? resp.extract_json(true).get() : web::json::value::array();
+	return true;
+}
+
 web::json::value ConsulConnection::retrieveNode(const std::string &host)
 {
 	const static char fname[] = "ConsulConnection::retrieveNode() ";
@@ -914,7 +985,22 @@ void ConsulConnection::init(std::string recoverSsnId)
 	{
 		std::lock_guard<std::recursive_mutex> guard(m_consulMutex);
 		m_config = Configuration::instance()->getConsul();
+		// keep the pool and its alive connections if endpoint is not changed
+		if (!m_config->consulEnabled())
+		{
+			m_httpPool = nullptr;
+		}
+		else if (m_httpPool == nullptr || !m_httpPool->sameEndpoint(m_config->m_consulUrl, m_config->m_basicAuthUser, m_config->m_basicAuthPass, m_config->m_connectionPoolSize))
+		{
+			m_httpPool = std::make_shared<ConsulHttpPool>(m_config->m_consulUrl, m_config->m_basicAuthUser, m_config->m_basicAuthPass, m_config->m_connectionPoolSize);
+			// ModifyIndex is meaningless for another Consul
+			m_topologyCache.clear();
+			m_localTopologyCache.clear();
+			m_taskCache.clear();
+			m_nodeCache.clear();
+		}
 	}
+	initMetrics();
 
 	if (getConfig()->consulEnabled())
 	{
@@ -972,20 +1058,25 @@ void ConsulConnection::init(std::string recoverSsnId)
 
 web::http::http_response ConsulConnection::requestHttp(const web::http::method &mtd, const std::string &path, std::map<std::string, std::string> query, std::map<std::string, std::string> header, web::json::value *body)
 {
-	const static char fname[] = "ConsulConnection::requestHttp() ";
+	if (body != nullptr)
+	{
+		// Consul KV and agent APIs accept compact JSON, no need to format
+		const auto content = body->serialize();
+		return requestHttpRaw(mtd, path, std::move(query), std::move(header), &content);
+	}
+	return requestHttpRaw(mtd, path, std::move(query), std::move(header), nullptr);
+}
 
-	auto restURL = getConfig()->m_consulUrl;
+web::http::http_response ConsulConnection::requestHttpRaw(const web::http::method &mtd, const std::string &path, std::map<std::string, std::string> query, std::map<std::string, std::string> header, const std::string *body)
+{
+	const static char fname[] = "ConsulConnection::requestHttpRaw() ";
 
-	// Create http_client to send the request.
-	web::http::client::http_client_config config;
-	//config.set_timeout(std::chrono::seconds(5));
-	web::credentials cred(getConfig()->m_basicAuthUser, getConfig()->m_basicAuthPass);
-	if (getConfig()->m_basicAuthUser.length())
+	auto pool = getHttpPool();
+	if (pool == nullptr)
 	{
-		config.set_credentials(cred);
+		LOG_WAR << fname << path << " Consul is not enabled";
+		return web::http::http_response(web::http::status_codes::ResetContent);
 	}
-	config.set_validate_certificates(false);
-	web::http::client::http_client client(restURL, config);
 
 	// Build request URI and start the request.
 	web::uri_builder builder(GET_STRING_T(path));
@@ -1000,14 +1091,17 @@ web::http::http_response ConsulConnection::requestHttp(const web::http::method &
 	request.set_request_uri(builder.to_uri());
 	if (body != nullptr)
 	{
-		request.set_body(Utility::prettyJson(body->serialize()));
+		request.set_body(*body, "application/json");
 	}
 
+	const auto start = std::chrono::steady_clock::now();
+	bool warm = false;
 	try
 	{
 		// In case of REST server crash or block query timeout, will throw exception:
 		// "Failed to read HTTP status line"
-		web::http::http_response response = client.request(request).get();
+		web::http::http_response response = pool->request(request, warm);
+		observeHttp(false, true, warm, start);
 		LOG_DBG << fname << mtd << " " << path << " return " << response.status_code();
 		return response;
 	}
@@ -1019,6 +1113,7 @@ web::http::http_response ConsulConnection::requestHttp(const web::http::method &
 	{
 		LOG_WAR << fname << path << " exception";
 	}
+	observeHttp(false, false, warm, start);
 
 	web::http::http_response response(web::http::status_codes::ResetContent);
 	return response;
@@ -1060,19 +1155,16 @@ std::tuple<bool, long long> ConsulConnection::blockWatchKv(const std::string &kv
 {
 	const static char fname[] = "ConsulConnection::blockWatchKv() ";
 
-	auto restURL = getConfig()->m_consulUrl;
-
-	int waitTimeout = 30;
-	// Create http_client to send the request.
-	web::http::client::http_client_config config;
-	web::credentials cred(getConfig()->m_basicAuthUser, getConfig()->m_basicAuthPass);
-	if (getConfig()->m_basicAuthUser.length())
+	auto pool = getHttpPool();
+	if (pool == nullptr)
 	{
-		config.set_credentials(cred);
+		return std::make_tuple(false, 0);
 	}
-	config.set_timeout(std::chrono::seconds(waitTimeout)); // set block pull to 30s timeout
-	config.set_validate_certificates(false);
-	web::http::client::http_client client(restURL, config);
+
+	const int waitTimeout = 30;
+	// Consul add random jitter up to wait/16 to block query,
+	// client timeout longer than that to keep the watch connection alive
+	const int clientTimeout = waitTimeout + waitTimeout / 16 + 5;
 
 	// Build request URI and start the request.
 	web::uri_builder builder(GET_STRING_T(kvPath));
@@ -1087,9 +1179,12 @@ std::tuple<bool, long long> ConsulConnection::blockWatchKv(const std::string &kv
 	web::http::http_request request(web::http::methods::GET);
 	request.set_request_uri(builder.to_uri());
 
+	const auto start = std::chrono::steady_clock::now();
+	bool warm = false;
 	try
 	{
-		web::http::http_response response = client.request(request).get();
+		web::http::http_response response = pool->watch(kvPath, request, clientTimeout, warm);
+		observeHttp(true, true, warm, start);
 		long long index = 0;
 		if (response.headers().has("X-Consul-Index"))
 		{
@@ -1105,10 +1200,68 @@ std::tuple<bool, long long> ConsulConnection::blockWatchKv(const std::string &kv
 		// "Failed to read HTTP status line"
 		// LOG_DBG << fname << "exception";
 	}
+	observeHttp(true, false, warm, start);
 	// timeout
 	return std::make_tuple(false, 0);
 }
 
+std::shared_ptr<ConsulHttpPool> ConsulConnection::getHttpPool()
+{
+	std::lock_guard<std::recursive_mutex> guard(m_consulMutex);
+	return m_httpPool;
+}
+
+void ConsulConnection::initMetrics()
+{
+	// bucket boundaries in seconds, watch block up to wait time
+	const static std::vector<double> buckets = {0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60};
+
+	auto prom = PrometheusRest::instance();
+	std::lock_guard<std::recursive_mutex> guard(m_consulMutex);
+	// metrics are created once, replace them would race with running requests
+	if (prom == nullptr || m_metricRequestLatency != nullptr)
+	{
+		return;
+	}
+	m_metricColdClient = prom->createPromCounter(
+		PROM_METRIC_NAME_appmesh_consul_request_count, PROM_METRIC_HELP_appmesh_consul_request_count,
+		{{"client", "cold"}});
+	m_metricWarmClient = prom->createPromCounter(
+		PROM_METRIC_NAME_appmesh_consul_request_count, PROM_METRIC_HELP_appmesh_consul_request_count,
+		{{"client", "warm"}});
+	m_metricFailedRequest = prom->createPromCounter(
+		PROM_METRIC_NAME_appmesh_consul_request_count, PROM_METRIC_HELP_appmesh_consul_request_count,
+		{{"client", "failed"}});
+	m_metricRequestLatency = prom->createPromHistogram(
+		PROM_METRIC_NAME_appmesh_consul_request_latency_seconds, PROM_METRIC_HELP_appmesh_consul_request_latency_seconds,
+		{{"type", "request"}}, buckets);
+	m_metricWatchLatency = prom->createPromHistogram(
+		PROM_METRIC_NAME_appmesh_consul_request_latency_seconds, PROM_METRIC_HELP_appmesh_consul_request_latency_seconds,
+		{{"type", "watch"}}, buckets);
+	m_metricAddedReplicas = prom->createPromGauge(
+		PROM_METRIC_NAME_appmesh_consul_schedule_moved_replicas, PROM_METRIC_HELP_appmesh_consul_schedule_moved_replicas,
+		{{"action", "added"}});
+	m_metricRemovedReplicas = prom->createPromGauge(
+		PROM_METRIC_NAME_appmesh_consul_schedule_moved_replicas, PROM_METRIC_HELP_appmesh_consul_schedule_moved_replicas,
+		{{"action", "removed"}});
+}
+
+void ConsulConnection::observeHttp(bool watch, bool success, bool warm, const std::chrono::steady_clock::time_point &start)
+{
+	std::shared_ptr<CounterMetric> counter;
+	std::shared_ptr<HistogramMetric> latency;
+	{
+		std::lock_guard<std::recursive_mutex> guard(m_consulMutex);
+		counter = success ? (warm ? m_metricWarmClient : m_metricColdClient) : m_metricFailedRequest;
+		latency = success ? (watch ? m_metricWatchLatency : m_metricRequestLatency) : nullptr;
+	}
+	PROM_COUNTER_INCREASE(counter)
+	if (latency)
+	{
+		latency->metric().Observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+}
+
 void ConsulConnection::watchSecurityThread()
 {
 	const static char fname[] = "ConsulConnection::watchSecurityThread() ";
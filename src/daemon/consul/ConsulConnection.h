@@ -1,7 +1,9 @@
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <thread>
@@ -13,6 +15,12 @@
 #include "../TimerHandler.h"
 #include "../process/AppProcess.h"
 #include "ConsulEntity.h"
+#include "ConsulKvCache.h"
+
+class ConsulHttpPool;
+class CounterMetric;
+class HistogramMetric;
+class GaugeMetric;
 
 /// <summary>
 /// Connect to Consul service
@@ -45,8 +53,15 @@ private:
 	std::shared_ptr<Configuration::JsonConsul> getConfig();
 
 	web::http::http_response requestHttp(const web::http::method &mtd, const std::string &path, std::map<std::string, std::string> query, std::map<std::string, std::string> header, web::json::value *body);
+	// send serialized JSON body directly
+	web::http::http_response requestHttpRaw(const web::http::method &mtd, const std::string &path, std::map<std::string, std::string> query, std::map<std::string, std::string> header, const std::string *body);
 	web::http::http_response requestHttp(const web::uri &baseUri, const std::string &requestPath, const web::http::method &mtd);
 
+	// pooled keep-alive connections, rebuilt when Consul endpoint changes
+	std::shared_ptr<ConsulHttpPool> getHttpPool();
+	void initMetrics();
+	void observeHttp(bool watch, bool success, bool warm, const std::chrono::steady_clock::time_point &start);
+
 	std::tuple<bool, long long> blockWatchKv(const std::string &kvPath, long long lastIndex, bool recurse = false);
 	void watchSecurityThread();
 	void watchTopologyThread();
@@ -66,13 +81,18 @@ private:
 	bool deregisterService(const std::string &appName);
 
 	void findTaskAvailableHost(const std::map<std::string, std::shared_ptr<ConsulTask>> &task, const std::map<std::string, std::shared_ptr<ConsulNode>> &hosts);
-	void compareTopologyAndDispatch(const std::map<std::string, std::shared_ptr<ConsulTopology>> &oldT, const std::map<std::string, std::shared_ptr<ConsulTopology>> &newT);
+	// write changed hosts only, return number of replicas added and removed
+	std::size_t compareTopologyAndDispatch(const std::map<std::string, std::shared_ptr<ConsulTopology>> &oldT, const std::map<std::string, std::shared_ptr<ConsulTopology>> &newT);
 	bool writeTopology(std::string hostName, const std::shared_ptr<ConsulTopology> topology);
 	// key: host name, value: topology
+	// host: empty for all hosts or local host name
 	std::map<std::string, std::shared_ptr<ConsulTopology>> retrieveTopology(std::string host);
 	std::map<std::string, std::shared_ptr<ConsulTask>> retrieveTask();
+	bool refreshTask();
 	std::map<std::string, std::shared_ptr<ConsulNode>> retrieveNode();
 	web::json::value retrieveNode(const std::string &host);
+	// recurse GET KV prefix, listing keep null if X-Consul-Index not advanced from cachedIndex
+	bool fetchKvListing(const std::string &path, long long cachedIndex, web::json::value &listing, long long &index);
 
 private:
 	mutable std::recursive_mutex m_consulMutex;
@@ -80,8 +100,35 @@ private:
 	int m_ssnRenewTimerId;
 	bool m_leader;
 	std::shared_ptr<Configuration::JsonConsul> m_config;
+	std::shared_ptr<ConsulHttpPool> m_httpPool;
 
 	std::shared_ptr<std::thread> m_securityWatch;
 	std::shared_ptr<std::thread> m_topologyWatch;
 	std::shared_ptr<std::thread> m_scheduleWatch;
+
+	// parsed KV entries, only entries with advanced ModifyIndex are parsed again
+	ConsulKvCache<ConsulTopology> m_topologyCache;
+	ConsulKvCache<ConsulTopology> m_localTopologyCache;
+	ConsulKvCache<ConsulTask> m_taskCache;
+	ConsulKvCache<ConsulNode> m_nodeCache;
+	// key: cloud app name, value: ModifyIndex of task applied to local app
+	std::map<std::string, long long> m_syncedTasks;
+	std::mutex m_syncTopologyMutex;
+
+	// Consul http metrics, created once and never replaced
+	std::shared_ptr<CounterMetric> m_metricColdClient;
+	std::shared_ptr<CounterMetric> m_metricWarmClient;
+	std::shared_ptr<CounterMetric> m_metricFailedRequest;
+	std::shared_ptr<HistogramMetric> m_metricRequestLatency;
+	std::shared_ptr<HistogramMetric> m_metricWatchLatency;
+	// replicas changed by last schedule
+	std::shared_ptr<GaugeMetric> m_metricAddedReplicas;
+	std::shared_ptr<GaugeMetric> m_metricRemovedReplicas;
 };
+
+#define PROM_METRIC_NAME_appmesh_consul_request_count "appmesh_consul_request_count"
+#define PROM_METRIC_HELP_appmesh_consul_request_count "app mesh requests to Consul by client state: warm (client completed a keep-alive request before), cold or failed"
+#define PROM_METRIC_NAME_appmesh_consul_request_latency_seconds "appmesh_consul_request_latency_seconds"
+#define PROM_METRIC_HELP_appmesh_consul_request_latency_seconds "app mesh request to Consul latency, watch include block wait time"
+#define PROM_METRIC_NAME_appmesh_consul_schedule_moved_replicas "appmesh_consul_schedule_moved_replicas"
+#define PROM_METRIC_HELP_appmesh_consul_schedule_moved_replicas "app mesh replicas added to or removed from hosts by last leader schedule"
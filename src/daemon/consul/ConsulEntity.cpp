@@ -5,15 +5,17 @@
 #include <cpprest/json.h>
 
 #include "../../common/DateTime.h"
+#include "../../common/JsonWriter.h"
 #include "../../common/Utility.h"
 #include "../Configuration.h"
 #include "../Label.h"
 #include "../ResourceCollection.h"
 #include "../application/Application.h"
 #include "ConsulConnection.h"
+#include "LabelIndex.h"
 
 ConsulTask::ConsulTask()
-	: m_replication(0), m_condition(std::make_shared<Label>()), m_priority(0), m_consulServicePort(0), m_requestMemMega(0)
+	: m_replication(0), m_condition(std::make_shared<Label>()), m_conditionMatcher(std::make_shared<LabelMatcher>(std::map<std::string, std::string>())), m_priority(0), m_consulServicePort(0), m_requestMemMega(0), m_requestCpu(0)
 {
 }
 
@@ -32,10 +34,12 @@ std::shared_ptr<ConsulTask> ConsulTask::FromJson(const web::json::value &jsonObj
 		SET_JSON_INT_VALUE(jsonObj, "priority", consul->m_priority);
 		SET_JSON_INT_VALUE(jsonObj, "port", consul->m_consulServicePort);
 		SET_JSON_INT_VALUE(jsonObj, "memoryMB", consul->m_requestMemMega);
+		consul->m_requestCpu = GET_JSON_DOUBLE_VALUE(jsonObj, "cpu");
 		if (HAS_JSON_FIELD(jsonObj, "condition"))
 		{
 			consul->m_condition = Label::FromJson(jsonObj.at("condition"));
 		}
+		consul->m_conditionMatcher = std::make_shared<LabelMatcher>(consul->m_condition->getLabels());
 		// for schedule runtime
 		for (std::size_t i = 1; i <= consul->m_replication; i++)
 		{
@@ -52,6 +56,8 @@ web::json::value ConsulTask::AsJson() const
 	result["priority"] = web::json::value::number(m_priority);
 	result["port"] = web::json::value::number(m_consulServicePort);
 	result["memoryMB"] = web::json::value::number(m_requestMemMega);
+	if (m_requestCpu > 0)
+		result["cpu"] = web::json::value::number(m_requestCpu);
 	result["content"] = m_app->AsJson(false);
 	if (m_condition != nullptr)
 		result["condition"] = m_condition->AsJson();
@@ -66,6 +72,7 @@ void ConsulTask::dump()
 	LOG_DBG << fname << "m_replication=" << m_replication;
 	LOG_DBG << fname << "m_consulServicePort=" << m_consulServicePort;
 	LOG_DBG << fname << "m_requestMemMega=" << m_requestMemMega;
+	LOG_DBG << fname << "m_requestCpu=" << m_requestCpu;
 	m_app->dump();
 }
 
@@ -110,6 +117,22 @@ web::json::value ConsulTopology::AsJson() const
 	return result;
 }
 
+std::string ConsulTopology::serialize() const
+{
+	std::string result;
+	JsonWriter writer(result);
+	writer.startArray();
+	for (const auto &app : m_scheduleApps)
+	{
+		writer.startObject();
+		writer.member("app", app.first);
+		writer.member("schedule_time", DateTime::formatLocalTime(app.second));
+		writer.endObject();
+	}
+	writer.endArray();
+	return result;
+}
+
 bool ConsulTopology::operator==(const std::shared_ptr<ConsulTopology> &topology)
 {
 	if (!topology)
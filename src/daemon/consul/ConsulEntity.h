@@ -11,6 +11,7 @@
 
 class Application;
 class Label;
+class LabelMatcher;
 
 struct ConsulTask;
 /// <summary>
@@ -60,6 +61,8 @@ struct ConsulTask
 
 	// schedule parameters
 	std::shared_ptr<Label> m_condition;
+	// m_condition compiled once when task is parsed
+	std::shared_ptr<LabelMatcher> m_conditionMatcher;
 	int m_priority;
 
 	// consul service port
@@ -67,6 +70,8 @@ struct ConsulTask
 
 	// request memory, MB
 	uint64_t m_requestMemMega;
+	// request CPU cores, 0 means not limited by CPU
+	double m_requestCpu;
 
 	// used for schedule fill
 	std::map<std::string, std::shared_ptr<ConsulNode>> m_matchedHosts;
@@ -82,6 +87,8 @@ struct ConsulTopology
 {
 	static std::shared_ptr<ConsulTopology> FromJson(const web::json::value &jsonObj, const std::string &hostName);
 	web::json::value AsJson() const;
+	/// @brief Compact JSON text same with AsJson().serialize(), streamed without DOM
+	std::string serialize() const;
 	bool operator==(const std::shared_ptr<ConsulTopology> &topology);
 	void dump();
 
@@ -0,0 +1,118 @@
+#include <algorithm>
+
+#include "ConsulHttpPool.h"
+
+ConsulHttpPool::ConsulHttpPool(const std::string &url, const std::string &user, const std::string &passwd, std::size_t poolSize)
+	: m_url(url), m_user(user), m_passwd(passwd), m_clients(std::max<std::size_t>(poolSize, 1))
+{
+	// http_client connect lazily, no connection is created here
+	for (std::size_t i = 0; i < m_clients.size(); ++i)
+	{
+		m_clients[i].m_client = createClient(0);
+		m_idle.push_back(i);
+	}
+}
+
+ConsulHttpPool::~ConsulHttpPool()
+{
+}
+
+bool ConsulHttpPool::sameEndpoint(const std::string &url, const std::string &user, const std::string &passwd, std::size_t poolSize) const
+{
+	return m_url == url && m_user == user && m_passwd == passwd && m_clients.size() == std::max<std::size_t>(poolSize, 1);
+}
+
+web::http::http_response ConsulHttpPool::request(web::http::http_request &request, bool &warm)
+{
+	std::size_t index = 0;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cv.wait(lock, [this]()
+				  { return !m_idle.empty(); });
+		// last released client is most likely to hold a live connection
+		index = m_idle.back();
+		m_idle.pop_back();
+	}
+	auto release = [this, index]()
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			m_idle.push_back(index);
+		}
+		m_cv.notify_one();
+	};
+
+	// m_clients is never resized, leased client is accessed by this thread only
+	try
+	{
+		auto response = send(m_clients[index], request, warm);
+		release();
+		return response;
+	}
+	catch (...)
+	{
+		release();
+		throw;
+	}
+}
+
+web::http::http_response ConsulHttpPool::watch(const std::string &key, web::http::http_request &request, int timeoutSeconds, bool &warm)
+{
+	std::shared_ptr<PooledClient> client;
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		auto &watchClient = m_watchClients[key];
+		if (watchClient == nullptr)
+		{
+			watchClient = std::make_shared<PooledClient>();
+			watchClient->m_client = createClient(timeoutSeconds);
+		}
+		client = watchClient;
+	}
+	// each watch key is polled by one thread
+	return send(*client, request, warm);
+}
+
+std::shared_ptr<web::http::client::http_client> ConsulHttpPool::createClient(int timeoutSeconds) const
+{
+	web::http::client::http_client_config config;
+	if (timeoutSeconds > 0)
+	{
+		config.set_timeout(std::chrono::seconds(timeoutSeconds));
+	}
+	if (m_user.length())
+	{
+		config.set_credentials(web::credentials(m_user, m_passwd));
+	}
+	config.set_validate_certificates(false);
+	return std::make_shared<web::http::client::http_client>(m_url, config);
+}
+
+web::http::http_response ConsulHttpPool::send(PooledClient &client, web::http::http_request &request, bool &warm)
+{
+	// http_client may drop an idle keep-alive socket, warm client does not guarantee connection reuse
+	warm = (client.m_requests > 0);
+	try
+	{
+		auto response = client.m_client->request(request).get();
+		// connection go back to http_client keep-alive pool after body is received,
+		// wait here so that next request on this client can reuse it
+		response.content_ready().wait();
+		const auto connection = response.headers().find(web::http::header_names::connection);
+		if (connection != response.headers().end() && connection->second == "close")
+		{
+			client.m_requests = 0;
+		}
+		else
+		{
+			client.m_requests++;
+		}
+		return response;
+	}
+	catch (...)
+	{
+		// failed connection is dropped by http_client
+		client.m_requests = 0;
+		throw;
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cpprest/http_client.h>
+
+//////////////////////////////////////////////////////////////////////////
+/// Keep-alive HTTP client pool for one Consul endpoint
+///  1. short requests lease one of the pooled clients exclusively,
+///     each client keeps its connection open between requests
+///  2. blocking watch of each KV path owns a dedicated client,
+///     long poll never occupies a pooled connection
+///  3. ConsulConnection rebuild the pool when endpoint changes
+//////////////////////////////////////////////////////////////////////////
+class ConsulHttpPool
+{
+public:
+	ConsulHttpPool(const std::string &url, const std::string &user, const std::string &passwd, std::size_t poolSize);
+	virtual ~ConsulHttpPool();
+
+	/// <summary>
+	/// Whether the pool can be kept for new configuration
+	/// </summary>
+	bool sameEndpoint(const std::string &url, const std::string &user, const std::string &passwd, std::size_t poolSize) const;
+
+	/// <summary>
+	/// Send request with a pooled connection, wait when all connections are busy
+	/// </summary>
+	/// <param name="warm">output, request was sent on a client which completed a keep-alive request before, the socket may still be reconnected by http_client</param>
+	/// <returns>throw exception for connection error</returns>
+	web::http::http_response request(web::http::http_request &request, bool &warm) noexcept(false);
+
+	/// <summary>
+	/// Send long poll request with the dedicated connection of the watch key
+	/// </summary>
+	/// <param name="warm">output, request was sent on a client which completed a keep-alive request before, the socket may still be reconnected by http_client</param>
+	/// <returns>throw exception for connection error or timeout</returns>
+	web::http::http_response watch(const std::string &key, web::http::http_request &request, int timeoutSeconds, bool &warm) noexcept(false);
+
+private:
+	struct PooledClient
+	{
+		PooledClient() : m_requests(0) {}
+		std::shared_ptr<web::http::client::http_client> m_client;
+		// requests finished on current connection, 0 means a new connection is needed
+		std::size_t m_requests;
+	};
+	std::shared_ptr<web::http::client::http_client> createClient(int timeoutSeconds) const;
+	web::http::http_response send(PooledClient &client, web::http::http_request &request, bool &warm);
+
+	const std::string m_url;
+	const std::string m_user;
+	const std::string m_passwd;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::vector<PooledClient> m_clients;
+	// index of idle clients in m_clients
+	std::vector<std::size_t> m_idle;
+	// key: watch KV path
+	std::map<std::string, std::shared_ptr<PooledClient>> m_watchClients;
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <cpprest/json.h>
+
+#include "../../common/Utility.h"
+
+//////////////////////////////////////////////////////////////////////////
+/// Local cache of Consul KV entries under one prefix
+///  1. each entry remember its ModifyIndex and the parsed item
+///  2. only entries with advanced ModifyIndex are decoded and parsed again
+///  3. listing with unchanged X-Consul-Index is not walked at all
+/// Cached items are never exposed, readers get copies to modify.
+//////////////////////////////////////////////////////////////////////////
+template <typename T>
+class ConsulKvCache
+{
+public:
+	/// <summary>
+	/// Parse decoded KV value to item, set item name used as result key
+	/// </summary>
+	/// <returns>nullptr to ignore the entry</returns>
+	typedef std::function<std::shared_ptr<T>(const std::string &key, const std::string &value, std::string &name)> Parser;
+
+	ConsulKvCache() : m_index(0) {}
+
+	/// <summary>
+	/// X-Consul-Index of last applied listing
+	/// </summary>
+	long long index() const
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		return m_index;
+	}
+
+	/// <summary>
+	/// Apply recurse KV listing
+	/// </summary>
+	/// <param name="listing">JSON array return from recurse GET</param>
+	/// <param name="index">X-Consul-Index of the listing</param>
+	/// <returns>number of entries parsed (added or updated)</returns>
+	std::size_t apply(const web::json::value &listing, long long index, const Parser &parser)
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		if (index > 0 && index < m_index)
+		{
+			// listing fetched by another thread is newer
+			return 0;
+		}
+		std::map<std::string, Entry> entries;
+		std::map<std::string, std::string> names;
+		std::size_t parsed = 0;
+		if (listing.is_array())
+		{
+			for (const auto &section : listing.as_array())
+			{
+				const auto key = GET_JSON_STR_VALUE(section, "Key");
+				const long long modifyIndex = HAS_JSON_FIELD(section, "ModifyIndex") ? section.at("ModifyIndex").as_number().to_int64() : 0;
+				auto cached = m_entries.find(key);
+				if (cached != m_entries.end() && modifyIndex && cached->second.m_modifyIndex == modifyIndex)
+				{
+					entries[key] = cached->second;
+					if (cached->second.m_item)
+						names[cached->second.m_name] = key;
+					continue;
+				}
+				Entry entry;
+				entry.m_modifyIndex = modifyIndex;
+				if (section.has_string_field("Value"))
+				{
+					const auto value = Utility::decode64(section.at("Value").as_string());
+					if (value.length())
+					{
+						entry.m_item = parser(key, value, entry.m_name);
+						parsed++;
+						if (entry.m_item)
+							names[entry.m_name] = key;
+					}
+				}
+				// remember ignored entry as well, avoid parse it again
+				entries[key] = entry;
+			}
+		}
+		m_entries = std::move(entries);
+		m_names = std::move(names);
+		m_index = index;
+		return parsed;
+	}
+
+	/// <summary>
+	/// Copy of cached items, key is item name
+	/// </summary>
+	std::map<std::string, std::shared_ptr<T>> items() const
+	{
+		std::map<std::string, std::shared_ptr<T>> result;
+		std::lock_guard<std::mutex> guard(m_mutex);
+		for (const auto &entry : m_entries)
+		{
+			if (entry.second.m_item)
+				result[entry.second.m_name] = std::make_shared<T>(*entry.second.m_item);
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// Copy of one cached item
+	/// </summary>
+	/// <param name="modifyIndex">output, ModifyIndex of the item, used to identify item version</param>
+	/// <returns>nullptr if not exist</returns>
+	std::shared_ptr<T> find(const std::string &name, long long &modifyIndex) const
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		auto key = m_names.find(name);
+		if (key == m_names.end())
+		{
+			modifyIndex = 0;
+			return nullptr;
+		}
+		const auto &entry = m_entries.find(key->second)->second;
+		modifyIndex = entry.m_modifyIndex;
+		return std::make_shared<T>(*entry.m_item);
+	}
+
+	void clear()
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		m_entries.clear();
+		m_names.clear();
+		m_index = 0;
+	}
+
+private:
+	struct Entry
+	{
+		Entry() : m_modifyIndex(0) {}
+		long long m_modifyIndex;
+		std::string m_name;
+		std::shared_ptr<const T> m_item;
+	};
+
+	mutable std::mutex m_mutex;
+	long long m_index;
+	// key: Consul KV key
+	std::map<std::string, Entry> m_entries;
+	// key: item name, value: Consul KV key
+	std::map<std::string, std::string> m_names;
+};
@@ -0,0 +1,141 @@
+#ifdef __GNUC__
+#include <features.h>
+#if __GNUC_PREREQ(5, 4)
+#include "../../common/wildcards/wildcards.hpp"
+#endif
+#endif
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <numeric>
+
+#include "LabelIndex.h"
+
+LabelMatcher::LabelMatcher(const std::map<std::string, std::string> &condition)
+{
+	for (const auto &label : condition)
+	{
+		Term term;
+		term.m_key = label.first;
+		term.m_value = label.second;
+#if __GNUC_PREREQ(5, 4)
+		// support wildcards for gcc version upper than 5.4
+		if (isWildcard(label.second))
+		{
+			// matcher keep iterators of pattern, pattern is owned by the closure
+			auto pattern = std::make_shared<const std::string>(label.second);
+			auto matcher = wildcards::make_matcher(*pattern);
+			term.m_wildcard = [pattern, matcher](const std::string &value)
+			{ return static_cast<bool>(matcher.matches(value)); };
+		}
+#endif
+		m_terms.push_back(std::move(term));
+	}
+}
+
+bool LabelMatcher::isWildcard(const std::string &pattern)
+{
+	// special characters of wildcards::cards<char>
+	return pattern.find_first_of("*?\\[]()|") != std::string::npos;
+}
+
+bool LabelMatcher::Term::matches(const std::string &value) const
+{
+	return value == m_value || (m_wildcard && m_wildcard(value));
+}
+
+bool LabelMatcher::match(const std::map<std::string, std::string> &labels) const
+{
+	for (const auto &term : m_terms)
+	{
+		auto label = labels.find(term.m_key);
+		if (label == labels.end() || !term.matches(label->second))
+			return false;
+	}
+	return true;
+}
+
+LabelIndex::LabelIndex()
+	: m_nodes(0)
+{
+}
+
+std::size_t LabelIndex::addNode(const std::map<std::string, std::string> &labels)
+{
+	const auto node = m_nodes++;
+	for (const auto &label : labels)
+	{
+		// node id increase, push_back keep list ascending
+		m_postings[label.first][label.second].push_back(node);
+	}
+	return node;
+}
+
+std::vector<std::size_t> LabelIndex::match(const LabelMatcher &matcher) const
+{
+	std::vector<std::size_t> result;
+	if (matcher.empty())
+	{
+		result.resize(m_nodes);
+		std::iota(result.begin(), result.end(), 0);
+		return result;
+	}
+
+	// node list of each term, wildcard term is merged to a new list
+	std::vector<const Postings *> lists;
+	std::vector<Postings> merged;
+	merged.reserve(matcher.m_terms.size());
+	for (const auto &term : matcher.m_terms)
+	{
+		auto key = m_postings.find(term.m_key);
+		if (key == m_postings.end())
+			return result;
+		if (!term.m_wildcard)
+		{
+			auto value = key->second.find(term.m_value);
+			if (value == key->second.end())
+				return result;
+			lists.push_back(&value->second);
+			continue;
+		}
+		// pattern is checked once per distinct value instead of once per node,
+		// node has one value of a key, lists of different values are disjoint
+		Postings postings;
+		for (const auto &value : key->second)
+		{
+			if (term.matches(value.first))
+				postings.insert(postings.end(), value.second.begin(), value.second.end());
+		}
+		if (postings.empty())
+			return result;
+		std::sort(postings.begin(), postings.end());
+		merged.push_back(std::move(postings));
+		lists.push_back(&merged.back());
+	}
+
+	// intersect from the shortest list, result never grow
+	std::sort(lists.begin(), lists.end(), [](const Postings *left, const Postings *right)
+			  { return left->size() < right->size(); });
+	result = *lists.front();
+	for (std::size_t i = 1; i < lists.size() && result.size(); ++i)
+	{
+		const auto &list = *lists[i];
+		Postings intersection;
+		if (list.size() / 16 > result.size())
+		{
+			// much longer list, binary search each remaining node
+			for (const auto node : result)
+			{
+				if (std::binary_search(list.begin(), list.end(), node))
+					intersection.push_back(node);
+			}
+		}
+		else
+		{
+			std::set_intersection(result.begin(), result.end(), list.begin(), list.end(), std::back_inserter(intersection));
+		}
+		result.swap(intersection);
+	}
+	return result;
+}
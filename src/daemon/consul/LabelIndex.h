@@ -0,0 +1,70 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+/// Task condition compiled once, same semantic as Label::match:
+/// node should have every condition key, node value equals condition
+/// value or match it as wildcard pattern
+//////////////////////////////////////////////////////////////////////////
+class LabelMatcher
+{
+public:
+	explicit LabelMatcher(const std::map<std::string, std::string> &condition);
+
+	bool match(const std::map<std::string, std::string> &labels) const;
+	bool empty() const { return m_terms.empty(); };
+
+	/// <summary>
+	/// Whether value contains wildcard special characters
+	/// </summary>
+	static bool isWildcard(const std::string &pattern);
+
+private:
+	friend class LabelIndex;
+	struct Term
+	{
+		bool matches(const std::string &value) const;
+
+		std::string m_key;
+		std::string m_value;
+		// compiled pattern, empty for exact value
+		std::function<bool(const std::string &)> m_wildcard;
+	};
+	std::vector<Term> m_terms;
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// Inverted index of node labels: label key -> label value -> node ids
+/// Nodes match a condition are the intersection of the node id lists of
+/// each condition term, wildcard term merge lists of all matched values.
+//////////////////////////////////////////////////////////////////////////
+class LabelIndex
+{
+public:
+	LabelIndex();
+
+	/// <summary>
+	/// Add node labels
+	/// </summary>
+	/// <returns>node id, increase from 0</returns>
+	std::size_t addNode(const std::map<std::string, std::string> &labels);
+
+	/// <summary>
+	/// Nodes match condition
+	/// </summary>
+	/// <returns>ascending node ids</returns>
+	std::vector<std::size_t> match(const LabelMatcher &matcher) const;
+
+	std::size_t size() const { return m_nodes; };
+
+private:
+	typedef std::vector<std::size_t> Postings;
+	// key: label key, value: (key: label value, value: ascending node ids)
+	std::unordered_map<std::string, std::map<std::string, Postings>> m_postings;
+	std::size_t m_nodes;
+};
@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "ResourceScheduler.h"
+
+ResourceScheduler::Strategy ResourceScheduler::parseStrategy(const std::string &strategy)
+{
+	if (strategy.empty() || strategy == "spread")
+		return Strategy::SPREAD;
+	if (strategy == "binpack")
+		return Strategy::BINPACK;
+	if (strategy == "leastloaded")
+		return Strategy::LEAST_LOADED;
+	throw std::invalid_argument("unsupported schedule strategy <" + strategy + ">, should be spread, binpack or leastloaded");
+}
+
+std::string ResourceScheduler::strategyName(Strategy strategy)
+{
+	switch (strategy)
+	{
+	case Strategy::BINPACK:
+		return "binpack";
+	case Strategy::LEAST_LOADED:
+		return "leastloaded";
+	default:
+		return "spread";
+	}
+}
+
+ResourceScheduler::ResourceScheduler(Strategy strategy, std::size_t moveLimit)
+	: m_strategy(strategy), m_moveLimit(moveLimit), m_moves(0), m_minCpu(0), m_minMemory(0)
+{
+}
+
+std::size_t ResourceScheduler::addNode(const std::string &name, double cpuCores, uint64_t memoryBytes, double cpuUsed, uint64_t memoryUsed, std::size_t apps)
+{
+	Node node;
+	node.m_name = name;
+	node.m_cpuCores = cpuCores;
+	node.m_memoryBytes = memoryBytes;
+	node.m_cpuUsed = cpuUsed;
+	node.m_memoryUsed = memoryUsed;
+	node.m_apps = apps;
+	m_nodes.push_back(node);
+	m_scores.push_back(score(node));
+	return m_nodes.size() - 1;
+}
+
+std::size_t ResourceScheduler::addRequest(const std::string &name, int priority, std::size_t replicas, double cpuCores, uint64_t memoryBytes, std::vector<std::size_t> candidates, std::vector<std::size_t> running)
+{
+	// sorted candidates identify the group and used for lookup of running nodes
+	if (!std::is_sorted(candidates.begin(), candidates.end()))
+		std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+	// requests with the same candidates share one group
+	std::size_t hash = candidates.size();
+	for (const auto node : candidates)
+		hash = hash * 31 + node;
+	const auto index = m_requests.size();
+	auto group = m_groups.size();
+	const auto range = m_groupIndex.equal_range(hash);
+	for (auto iter = range.first; iter != range.second; ++iter)
+	{
+		if (m_requests[m_groups[iter->second].m_request].m_candidates == candidates)
+		{
+			group = iter->second;
+			break;
+		}
+	}
+	if (group == m_groups.size())
+	{
+		Group newGroup;
+		newGroup.m_request = index;
+		newGroup.m_pending = 0;
+		newGroup.m_built = false;
+		m_groups.push_back(newGroup);
+		m_groupIndex.insert(std::make_pair(hash, group));
+	}
+
+	Request request;
+	request.m_name = name;
+	request.m_priority = priority;
+	request.m_replicas = replicas;
+	request.m_cpuCores = cpuCores;
+	request.m_memoryBytes = memoryBytes;
+	request.m_candidates = std::move(candidates);
+	request.m_running = std::move(running);
+	request.m_kept = 0;
+	m_requests.push_back(std::move(request));
+	m_requestGroup.push_back(group);
+	return index;
+}
+
+void ResourceScheduler::schedule()
+{
+	// higher priority first, name make the order stable between leaders
+	std::vector<std::size_t> order(m_requests.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [this](std::size_t left, std::size_t right)
+			  {
+				  const auto &l = m_requests[left];
+				  const auto &r = m_requests[right];
+				  return l.m_priority != r.m_priority ? l.m_priority > r.m_priority : l.m_name < r.m_name;
+			  });
+
+	// mark[node] == stamp means node already got a replica of current request
+	std::vector<std::size_t> mark(m_nodes.size(), 0);
+	std::size_t stamp = 0;
+	m_moves = 0;
+	m_positions.assign(m_nodes.size(), std::vector<std::pair<std::size_t, std::size_t>>());
+
+	// keep replicas still running on matched node before any new placement
+	for (const auto index : order)
+	{
+		auto &request = m_requests[index];
+		request.m_placement.clear();
+		++stamp;
+		for (const auto node : request.m_running)
+		{
+			if (request.m_placement.size() >= request.m_replicas)
+				break;
+			if (node >= m_nodes.size() || mark[node] == stamp || !std::binary_search(request.m_candidates.begin(), request.m_candidates.end(), node))
+				continue;
+			mark[node] = stamp;
+			assign(node, request);
+			request.m_placement.push_back(node);
+		}
+		request.m_kept = request.m_placement.size();
+	}
+
+	// place new replicas from the group heap of each request
+	for (auto &group : m_groups)
+	{
+		group.m_pending = 0;
+		group.m_built = false;
+		group.m_heap.clear();
+	}
+	// node can not fit the smallest request is dropped from heap
+	m_minCpu = m_minMemory = 0;
+	bool first = true;
+	for (std::size_t index = 0; index < m_requests.size(); ++index)
+	{
+		const auto &request = m_requests[index];
+		if (request.m_placement.size() < request.m_replicas)
+		{
+			m_groups[m_requestGroup[index]].m_pending++;
+			m_minCpu = first ? request.m_cpuCores : std::min(m_minCpu, request.m_cpuCores);
+			m_minMemory = first ? request.m_memoryBytes : std::min(m_minMemory, request.m_memoryBytes);
+			first = false;
+		}
+	}
+	for (const auto index : order)
+	{
+		auto &request = m_requests[index];
+		if (request.m_placement.size() >= request.m_replicas)
+			continue;
+		++stamp;
+		for (const auto node : request.m_placement)
+			mark[node] = stamp;
+
+		const auto group = m_requestGroup[index];
+		const auto placed = request.m_placement.size();
+		if (m_moveLimit == 0 || m_moves < m_moveLimit)
+		{
+			if (!m_groups[group].m_built)
+				buildGroup(group);
+			const auto replicas = m_moveLimit ? std::min(request.m_replicas, placed + m_moveLimit - m_moves) : request.m_replicas;
+			place(group, request, replicas, stamp, mark, request.m_placement);
+			m_moves += request.m_placement.size() - placed;
+		}
+		if (--m_groups[group].m_pending == 0)
+			releaseGroup(group);
+	}
+}
+
+ResourceScheduler::Score ResourceScheduler::score(const Node &node) const
+{
+	const double cpuShare = node.m_cpuCores > 0 ? node.m_cpuUsed / node.m_cpuCores : 0;
+	const double memoryShare = node.m_memoryBytes > 0 ? static_cast<double>(node.m_memoryUsed) / node.m_memoryBytes : 1;
+	const double dominantShare = std::max(cpuShare, memoryShare);
+	const double apps = static_cast<double>(node.m_apps);
+	switch (m_strategy)
+	{
+	case Strategy::BINPACK:
+		return Score(-dominantShare, -apps);
+	case Strategy::LEAST_LOADED:
+		return Score(dominantShare, apps);
+	default:
+		return Score(apps, dominantShare);
+	}
+}
+
+bool ResourceScheduler::full(const Node &node) const
+{
+	// smallest request can not fit, see fit()
+	if (node.m_memoryUsed + m_minMemory >= node.m_memoryBytes)
+		return true;
+	return m_minCpu > 0 && node.m_cpuUsed + m_minCpu > node.m_cpuCores;
+}
+
+bool ResourceScheduler::fit(const Node &node, const Request &request) const
+{
+	// same as ConsulNode::tryAssignApp, node without free memory is full
+	if (node.m_memoryUsed + request.m_memoryBytes >= node.m_memoryBytes)
+		return false;
+	if (request.m_cpuCores > 0 && node.m_cpuUsed + request.m_cpuCores > node.m_cpuCores)
+		return false;
+	return true;
+}
+
+void ResourceScheduler::assign(std::size_t nodeIndex, const Request &request)
+{
+	auto &node = m_nodes[nodeIndex];
+	node.m_cpuUsed += request.m_cpuCores;
+	node.m_memoryUsed += request.m_memoryBytes;
+	node.m_apps++;
+	m_scores[nodeIndex] = score(node);
+	updateNode(nodeIndex);
+}
+
+void ResourceScheduler::place(std::size_t group, const Request &request, std::size_t replicas, std::size_t stamp, std::vector<std::size_t> &mark, std::vector<std::size_t> &placement)
+{
+	// nodes popped from heap, push back after placement with updated score
+	std::vector<std::size_t> taken;
+	while (placement.size() < replicas && m_groups[group].m_heap.size())
+	{
+		const auto node = popGroup(group);
+		if (full(m_nodes[node]))
+			continue; // drop from group, full node never fit any request
+		taken.push_back(node);
+		if (mark[node] != stamp && fit(m_nodes[node], request))
+		{
+			mark[node] = stamp;
+			assign(node, request);
+			placement.push_back(node);
+		}
+	}
+	for (const auto node : taken)
+	{
+		if (!full(m_nodes[node]))
+			pushGroup(group, node);
+	}
+}
+
+bool ResourceScheduler::before(std::size_t left, std::size_t right) const
+{
+	// node index make the order deterministic for the same score
+	return m_scores[left] != m_scores[right] ? m_scores[left] < m_scores[right] : left < right;
+}
+
+void ResourceScheduler::buildGroup(std::size_t group)
+{
+	auto &heap = m_groups[group].m_heap;
+	heap.clear();
+	for (const auto node : m_requests[m_groups[group].m_request].m_candidates)
+	{
+		if (node < m_nodes.size() && !full(m_nodes[node]))
+			heap.push_back(node);
+	}
+	for (std::size_t position = 0; position < heap.size(); ++position)
+		setPosition(group, position);
+	// bottom-up heapify, O(k)
+	for (std::size_t position = heap.size() / 2; position > 0; --position)
+		siftDown(group, position - 1);
+	m_groups[group].m_built = true;
+}
+
+void ResourceScheduler::releaseGroup(std::size_t group)
+{
+	auto &heap = m_groups[group].m_heap;
+	for (const auto node : heap)
+		removePosition(node, group);
+	std::vector<std::size_t>().swap(heap);
+}
+
+void ResourceScheduler::updateNode(std::size_t node)
+{
+	// sift changes position value only, the membership list is not resized
+	auto &positions = m_positions[node];
+	for (std::size_t i = 0; i < positions.size(); ++i)
+	{
+		const auto group = positions[i].first;
+		siftUp(group, positions[i].second);
+		siftDown(group, positions[i].second);
+	}
+}
+
+std::size_t ResourceScheduler::popGroup(std::size_t group)
+{
+	auto &heap = m_groups[group].m_heap;
+	const auto top = heap.front();
+	removePosition(top, group);
+	heap.front() = heap.back();
+	heap.pop_back();
+	if (heap.size())
+	{
+		setPosition(group, 0);
+		siftDown(group, 0);
+	}
+	return top;
+}
+
+void ResourceScheduler::pushGroup(std::size_t group, std::size_t node)
+{
+	auto &heap = m_groups[group].m_heap;
+	heap.push_back(node);
+	setPosition(group, heap.size() - 1);
+	siftUp(group, heap.size() - 1);
+}
+
+void ResourceScheduler::siftUp(std::size_t group, std::size_t position)
+{
+	auto &heap = m_groups[group].m_heap;
+	while (position > 0)
+	{
+		const auto parent = (position - 1) / 2;
+		if (!before(heap[position], heap[parent]))
+			break;
+		std::swap(heap[position], heap[parent]);
+		setPosition(group, position);
+		setPosition(group, parent);
+		position = parent;
+	}
+}
+
+void ResourceScheduler::siftDown(std::size_t group, std::size_t position)
+{
+	auto &heap = m_groups[group].m_heap;
+	while (true)
+	{
+		auto best = position;
+		const auto left = position * 2 + 1;
+		const auto right = left + 1;
+		if (left < heap.size() && before(heap[left], heap[best]))
+			best = left;
+		if (right < heap.size() && before(heap[right], heap[best]))
+			best = right;
+		if (best == position)
+			break;
+		std::swap(heap[position], heap[best]);
+		setPosition(group, position);
+		setPosition(group, best);
+		position = best;
+	}
+}
+
+void ResourceScheduler::setPosition(std::size_t group, std::size_t position)
+{
+	auto &positions = m_positions[m_groups[group].m_heap[position]];
+	for (auto &entry : positions)
+	{
+		if (entry.first == group)
+		{
+			entry.second = position;
+			return;
+		}
+	}
+	positions.push_back(std::make_pair(group, position));
+}
+
+void ResourceScheduler::removePosition(std::size_t node, std::size_t group)
+{
+	auto &positions = m_positions[node];
+	for (std::size_t i = 0; i < positions.size(); ++i)
+	{
+		if (positions[i].first == group)
+		{
+			positions[i] = positions.back();
+			positions.pop_back();
+			return;
+		}
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+/// Multi-resource placement of task replicas to nodes
+///  1. requests are placed by priority (higher first), then by name
+///  2. replicas already running on a candidate node are kept first
+///  3. one replica of a request per node, node must fit CPU and memory
+///  4. candidate nodes are picked from a heap ordered by strategy score,
+///     requests with the same candidate nodes share one heap, the heap
+///     is updated incrementally when a node score changed
+///  5. replicas placed to new nodes in one run can be limited, pending
+///     replicas are placed by the next run
+/// Plain resource view, no dependency to Consul entities.
+//////////////////////////////////////////////////////////////////////////
+class ResourceScheduler
+{
+public:
+	enum class Strategy
+	{
+		// fewest apps first, spread replicas to all nodes
+		SPREAD,
+		// most utilized node that fits first, keep other nodes empty
+		BINPACK,
+		// lowest dominant resource (CPU or memory) share first
+		LEAST_LOADED
+	};
+	static Strategy parseStrategy(const std::string &strategy) noexcept(false);
+	static std::string strategyName(Strategy strategy);
+
+	struct Node
+	{
+		std::string m_name;
+		// capacity
+		double m_cpuCores;
+		uint64_t m_memoryBytes;
+		// allocated
+		double m_cpuUsed;
+		uint64_t m_memoryUsed;
+		std::size_t m_apps;
+	};
+
+	struct Request
+	{
+		std::string m_name;
+		int m_priority;
+		std::size_t m_replicas;
+		double m_cpuCores;
+		uint64_t m_memoryBytes;
+		// index of nodes match request condition
+		std::vector<std::size_t> m_candidates;
+		// index of nodes already running this request
+		std::vector<std::size_t> m_running;
+		// result: index of nodes this request placed to, kept replicas first
+		std::vector<std::size_t> m_placement;
+		std::size_t m_kept;
+	};
+
+	explicit ResourceScheduler(Strategy strategy, std::size_t moveLimit = 0);
+
+	/// <summary>
+	/// Add node with capacity and existing allocation
+	/// </summary>
+	/// <returns>node index</returns>
+	std::size_t addNode(const std::string &name, double cpuCores, uint64_t memoryBytes, double cpuUsed = 0, uint64_t memoryUsed = 0, std::size_t apps = 0);
+	/// <summary>
+	/// Add request to be placed
+	/// </summary>
+	/// <returns>request index</returns>
+	std::size_t addRequest(const std::string &name, int priority, std::size_t replicas, double cpuCores, uint64_t memoryBytes, std::vector<std::size_t> candidates, std::vector<std::size_t> running = std::vector<std::size_t>());
+
+	/// <summary>
+	/// Place all requests, result is saved in Request::m_placement
+	/// </summary>
+	void schedule();
+
+	const std::vector<Node> &nodes() const { return m_nodes; };
+	const std::vector<Request> &requests() const { return m_requests; };
+	/// <summary>
+	/// Replicas placed to nodes not running them by last schedule()
+	/// </summary>
+	std::size_t moves() const { return m_moves; };
+
+private:
+	// lower score is preferred
+	typedef std::pair<double, double> Score;
+	Score score(const Node &node) const;
+	bool full(const Node &node) const;
+	bool fit(const Node &node, const Request &request) const;
+	void assign(std::size_t nodeIndex, const Request &request);
+
+	// min heap of candidate nodes shared by requests with the same candidates
+	struct Group
+	{
+		std::vector<std::size_t> m_heap;
+		// first request of the group, identify candidates
+		std::size_t m_request;
+		// requests not placed yet, heap is released when it is 0
+		std::size_t m_pending;
+		bool m_built;
+	};
+	bool before(std::size_t left, std::size_t right) const;
+	void buildGroup(std::size_t group);
+	void releaseGroup(std::size_t group);
+	void updateNode(std::size_t node);
+	void removePosition(std::size_t node, std::size_t group);
+	std::size_t popGroup(std::size_t group);
+	void pushGroup(std::size_t group, std::size_t node);
+	void place(std::size_t group, const Request &request, std::size_t replicas, std::size_t stamp, std::vector<std::size_t> &mark, std::vector<std::size_t> &placement);
+	void siftUp(std::size_t group, std::size_t position);
+	void siftDown(std::size_t group, std::size_t position);
+	void setPosition(std::size_t group, std::size_t position);
+
+	Strategy m_strategy;
+	// max new placements of one schedule(), 0 is unlimited
+	const std::size_t m_moveLimit;
+	std::size_t m_moves;
+	std::vector<Node> m_nodes;
+	// cached score of each node
+	std::vector<Score> m_scores;
+	std::vector<Request> m_requests;
+	// group index of each request
+	std::vector<std::size_t> m_requestGroup;
+	std::vector<Group> m_groups;
+	// key: hash of candidates, value: group index
+	std::unordered_multimap<std::size_t, std::size_t> m_groupIndex;
+	// smallest request, node can not fit it is full
+	double m_minCpu;
+	uint64_t m_minMemory;
+	// key: group index, value: position in group heap
+	std::vector<std::vector<std::pair<std::size_t, std::size_t>>> m_positions;
+};
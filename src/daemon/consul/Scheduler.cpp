@@ -2,120 +2,99 @@
 
 #include "../../common/Utility.h"
 #include "ConsulEntity.h"
+#include "ResourceScheduler.h"
 #include "Scheduler.h"
 
-std::map<std::string, std::shared_ptr<ConsulTopology>> Scheduler::scheduleTask(const std::map<std::string, std::shared_ptr<ConsulTask>> &taskMap, const std::map<std::string, std::shared_ptr<ConsulTopology>> &oldTopology)
+std::map<std::string, std::shared_ptr<ConsulTopology>> Scheduler::scheduleTask(const std::map<std::string, std::shared_ptr<ConsulTask>> &taskMap, const std::map<std::string, std::shared_ptr<ConsulTopology>> &oldTopology, ResourceScheduler::Strategy strategy, std::size_t maxMoves)
 {
 	const static char fname[] = "Scheduler::scheduleTask() ";
-	LOG_DBG << fname;
+	LOG_DBG << fname << "strategy: " << ResourceScheduler::strategyName(strategy);
 
 	// key: hostname, value: task list
 	std::map<std::string, std::shared_ptr<ConsulTopology>> newTopology;
 
-	// ignore old schedule
+	// resource view of all matched hosts
+	ResourceScheduler scheduler(strategy, maxMoves);
+	std::map<std::string, std::size_t> nodeIndex;
+	std::vector<std::shared_ptr<ConsulNode>> nodes;
 	for (const auto &task : taskMap)
 	{
-		const auto &taskName = task.first;
-		auto &taskDedicateHosts = task.second->m_matchedHosts;
-		auto &tasksSet = task.second->m_tasksSet;
-		if (tasksSet.empty())
-			continue;
-
-		for (const auto &oldHost : oldTopology)
+		for (const auto &host : task.second->m_matchedHosts)
 		{
-			auto &oldHostName = oldHost.first;
-			auto &oldTaskSet = oldHost.second->m_scheduleApps;
-			// if task already running on a host
-			if (taskDedicateHosts.count(oldHostName) && oldTaskSet.count(taskName))
+			if (nodeIndex.count(host.first) == 0)
 			{
-				auto consulNode = taskDedicateHosts[oldHostName];
-				// found app running on old host still match
-				if (tasksSet.empty())
-				{
-					LOG_DBG << fname << "task <" << taskName << "> over running";
-					break;
-				}
-				taskDedicateHosts.erase(oldHostName);
-				assert(tasksSet.size());
-				// remove one task from schedule pool
-				tasksSet.erase(tasksSet.begin());
-
-				LOG_DBG << fname << "task <" << taskName << "> already running on host <" << oldHostName << ">";
-
-				{
-					// save to topology
-					if (!newTopology.count(oldHostName))
-						newTopology[oldHostName] = std::make_shared<ConsulTopology>();
-					newTopology[oldHostName]->m_scheduleApps[taskName] = oldTaskSet[taskName];
-					consulNode->assignApp(task.second);
-				}
+				const auto &node = host.second;
+				nodeIndex[host.first] = scheduler.addNode(host.first, node->m_cores, node->m_total_bytes, 0, node->m_occupyMemoryBytes, node->m_assignedApps.size());
+				nodes.push_back(node);
 			}
 		}
 	}
 
-	// do schedule
-	for (const auto &task : taskMap)
+	// key: task name, value: matched hosts already running the task
+	std::map<std::string, std::vector<std::size_t>> runningHosts;
+	for (const auto &oldHost : oldTopology)
 	{
-		// get current task
-		const auto &taskDedicateHosts = task.second->m_matchedHosts;
-		auto &tasksSet = task.second->m_tasksSet;
-		const auto &taskName = task.first;
-		std::vector<std::shared_ptr<ConsulNode>> taskDedicateHostsVec;
+		auto node = nodeIndex.find(oldHost.first);
+		if (node == nodeIndex.end())
+			continue;
+		for (const auto &app : oldHost.second->m_scheduleApps)
+		{
+			runningHosts[app.first].push_back(node->second);
+		}
+	}
 
-		LOG_DBG << fname << "schedule task <" << taskName << ">";
+	std::vector<std::shared_ptr<ConsulTask>> tasks;
+	for (const auto &task : taskMap)
+	{
+		const auto &tasksSet = task.second->m_tasksSet;
 		if (tasksSet.empty())
 			continue;
-
-		// copy to vector
-		std::transform(taskDedicateHosts.begin(), taskDedicateHosts.end(), std::back_inserter(taskDedicateHostsVec),
-					   [](const std::pair<std::string, std::shared_ptr<ConsulNode>> host) { return host.second; });
-		// sort hosts
-		// return left < right is Ascending
-		// return left > right is Descending
-		std::sort(taskDedicateHostsVec.begin(), taskDedicateHostsVec.end(),
-				  [](const std::shared_ptr<ConsulNode> &left, const std::shared_ptr<ConsulNode> &right) {
-					  if (left->m_assignedApps.size() < right->m_assignedApps.size())
-					  {
-						  return true;
-					  }
-					  else if (left->m_assignedApps.size() == right->m_assignedApps.size())
-					  {
-						  return (left->getAssignedAppMem() < right->getAssignedAppMem());
-					  }
-					  else
-					  {
-						  return false;
-					  }
-				  });
-
-		if (tasksSet.size() > taskDedicateHostsVec.size())
+		std::vector<std::size_t> candidates;
+		candidates.reserve(task.second->m_matchedHosts.size());
+		for (const auto &host : task.second->m_matchedHosts)
 		{
-			LOG_WAR << fname << taskName << " : Replication <" << tasksSet.size() << "> Dedicate Host <" << taskDedicateHostsVec.size() << ">";
+			candidates.push_back(nodeIndex[host.first]);
 		}
-		// assign host to task
-		while (tasksSet.size() && taskDedicateHostsVec.size())
+		auto running = runningHosts.find(task.first);
+		scheduler.addRequest(task.first, task.second->m_priority, tasksSet.size(), task.second->m_requestCpu, task.second->m_requestMemMega * 1024 * 1024,
+							 std::move(candidates), running == runningHosts.end() ? std::vector<std::size_t>() : running->second);
+		tasks.push_back(task.second);
+	}
+
+	scheduler.schedule();
+	if (maxMoves && scheduler.moves() >= maxMoves)
+	{
+		LOG_INF << fname << "reached max moves <" << maxMoves << ">, pending replicas are scheduled next time";
+	}
+
+	// apply schedule result
+	for (std::size_t i = 0; i < tasks.size(); ++i)
+	{
+		const auto &request = scheduler.requests()[i];
+		const auto &task = tasks[i];
+		const auto &taskName = request.m_name;
+		for (std::size_t replica = 0; replica < request.m_placement.size(); ++replica)
 		{
-			auto selectedNode = *(taskDedicateHostsVec.begin());
-			taskDedicateHostsVec.erase(taskDedicateHostsVec.begin());
-			const auto &hostname = selectedNode->m_hostName;
-			// save to topology
-			if (!selectedNode->full() && selectedNode->tryAssignApp(task.second))
+			const auto &hostname = scheduler.nodes()[request.m_placement[replica]].m_name;
+			if (!newTopology.count(hostname))
+				newTopology[hostname] = std::make_shared<ConsulTopology>();
+			if (replica < request.m_kept)
 			{
-				if (!newTopology.count(hostname))
-					newTopology[hostname] = std::make_shared<ConsulTopology>();
-				assert(tasksSet.size());
-				// remove one task from schedule pool
-				tasksSet.erase(tasksSet.begin());
-
-				newTopology[hostname]->m_scheduleApps[taskName] = std::chrono::system_clock::now();
-				selectedNode->assignApp(task.second);
-				LOG_DBG << fname << "task <" << taskName << "> assigned to host <" << hostname << ">";
+				newTopology[hostname]->m_scheduleApps[taskName] = oldTopology.find(hostname)->second->m_scheduleApps.find(taskName)->second;
+				LOG_DBG << fname << "task <" << taskName << "> already running on host <" << hostname << ">";
 			}
 			else
 			{
-				LOG_INF << fname << "task <" << taskName << "> failed assigned to host <" << hostname << "> due to full with total bytes: " << selectedNode->getAssignedAppMem();
+				newTopology[hostname]->m_scheduleApps[taskName] = std::chrono::system_clock::now();
+				LOG_DBG << fname << "task <" << taskName << "> assigned to host <" << hostname << ">";
 			}
-			//task.second->dump();
+			nodes[request.m_placement[replica]]->assignApp(task);
+			// remove one task from schedule pool
+			task->m_tasksSet.erase(task->m_tasksSet.begin());
+		}
+		if (task->m_tasksSet.size())
+		{
+			LOG_WAR << fname << taskName << " : Replication <" << request.m_replicas << "> scheduled <" << request.m_placement.size() << "> from candidate hosts <" << request.m_candidates.size() << ">";
 		}
 	}
 
@@ -2,6 +2,9 @@
 
 #include <map>
 #include <memory>
+#include <string>
+
+#include "ResourceScheduler.h"
 
 struct ConsulTopology;
 struct ConsulTask;
@@ -12,5 +15,13 @@ struct ConsulTask;
 class Scheduler
 {
 public:
-	static std::map<std::string, std::shared_ptr<ConsulTopology>> scheduleTask(const std::map<std::string, std::shared_ptr<ConsulTask>> &taskMap, const std::map<std::string, std::shared_ptr<ConsulTopology>> &oldTopology);
+	/// <summary>
+	/// Schedule task replicas to matched hosts, keep replicas on old topology first
+	/// </summary>
+	/// <param name="taskMap">tasks with matched hosts</param>
+	/// <param name="oldTopology">current schedule result</param>
+	/// <param name="strategy">node selection strategy</param>
+	/// <param name="maxMoves">max replicas placed to new hosts, 0 is unlimited</param>
+	/// <returns>new topology, key: hostname</returns>
+	static std::map<std::string, std::shared_ptr<ConsulTopology>> scheduleTask(const std::map<std::string, std::shared_ptr<ConsulTask>> &taskMap, const std::map<std::string, std::shared_ptr<ConsulTopology>> &oldTopology, ResourceScheduler::Strategy strategy = ResourceScheduler::Strategy::SPREAD, std::size_t maxMoves = 0);
 };
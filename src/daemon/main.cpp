@@ -12,6 +12,7 @@
 #include "../common/Utility.h"
 #include "../common/os/linux.hpp"
 #include "../common/os/pstree.hpp"
+#include "ConfigJournal.h"
 #include "Configuration.h"
 #include "HealthCheckTask.h"
 #include "PersistManager.h"
@@ -98,6 +99,8 @@ int main(int argc, char *argv[])
 		{
 			config->deSerializeApp(configJsonValue.at(JSON_KEY_Applications));
 		}
+		// fold journal records replayed by readConfiguration() into checkpoint
+		ConfigJournal::instance()->init();
 
 		// working dir
 		Utility::createDirectory(config->getDefaultWorkDir(), 00655);
@@ -127,16 +130,15 @@ int main(int argc, char *argv[])
 		// HA attach process to App
 		auto snap = std::make_shared<Snapshot>();
 		auto apps = config->getApps();
-		auto snapfile = Utility::readFileCpp(SNAPSHOT_FILE_NAME);
 		try
 		{
-			snap = Snapshot::FromJson(web::json::value::parse(snapfile.length() ? snapfile : std::string("{}")));
+			snap = Snapshot::FromFile(SNAPSHOT_FILE_NAME);
 		}
 		catch (...)
 		{
 			LOG_ERR << "Recover from snapshot failed with error " << std::strerror(errno);
 		}
-		std::for_each(apps.begin(), apps.end(), [&snap](std::vector<std::shared_ptr<Application>>::reference p)
+		std::for_each(apps->begin(), apps->end(), [&snap](const std::shared_ptr<Application> &p)
 					  {
 						  if (snap && snap->m_apps.count(p->getName()))
 						  {
@@ -146,6 +148,10 @@ int main(int argc, char *argv[])
 								  p->attach(appSnapshot.m_pid);
 						  }
 					  });
+		// snapshot is updated by process start/exit events from now on
+		PersistManager::instance()->init();
+		// health check is scheduled by timer with per application policy
+		HealthCheckTask::instance()->init();
 		// reg prometheus
 		config->registerPrometheus();
 
@@ -170,7 +176,7 @@ int main(int argc, char *argv[])
 			// monitor application
 			const std::list<os::Process> ptree = os::processes();
 			auto allApp = Configuration::instance()->getApps();
-			for (const auto &app : allApp)
+			for (const auto &app : *allApp)
 			{
 				PerfLog perf1(app->getName());
 				try
@@ -182,10 +188,6 @@ int main(int argc, char *argv[])
 					LOG_ERR << "Recover from snapshot failed with error " << std::strerror(errno);
 				}
 			}
-
-			PersistManager::instance()->persistSnapshot();
-			// health-check
-			HealthCheckTask::instance()->doHealthCheck();
 		}
 	}
 	catch (const std::exception &e)
@@ -1,11 +1,9 @@
-#include <fstream>
-#include <thread>
-
 #include <ace/Process.h>
 
 #include "../../common/Utility.h"
 #include "../rest/HttpRequest.h"
 #include "MonitoredProcess.h"
+#include "ProcessReaper.h"
 
 MonitoredProcess::MonitoredProcess() : m_httpRequest(nullptr)
 {
@@ -17,8 +15,6 @@ MonitoredProcess::~MonitoredProcess()
 
 	if (m_httpRequest)
 		m_httpRequest = nullptr;
-	if (m_thread != nullptr)
-		m_thread->join();
 
 	LOG_DBG << fname << "Process <" << this->getpid() << "> released";
 }
@@ -27,33 +23,20 @@ pid_t MonitoredProcess::spawn(ACE_Process_Options &option)
 {
 	auto rt = AppProcess::spawn(option);
 
-	// Start thread to read stdout/stderr stream
-	m_thread = std::make_unique<std::thread>(std::bind(&MonitoredProcess::runPipeReaderThread, this));
-
-	return rt;
-}
-
-void MonitoredProcess::waitThread(int timerId)
-{
-	if (nullptr != m_thread)
+	if (rt > 0)
 	{
-		// crash will happen if thread join itself
-		m_thread->join();
-		m_thread = nullptr;
+		// reaper hold self point to avoid release before reply
+		auto self = std::dynamic_pointer_cast<AppProcess>(this->shared_from_this());
+		ProcessReaper::instance()->watch(self, std::bind(&MonitoredProcess::replyHttpRequest, this));
 	}
+	return rt;
 }
 
-void MonitoredProcess::runPipeReaderThread()
+void MonitoredProcess::replyHttpRequest()
 {
-	const static char fname[] = "MonitoredProcess::runPipeReaderThread() ";
+	const static char fname[] = "MonitoredProcess::replyHttpRequest() ";
 	LOG_DBG << fname << "Entered";
 
-	// hold self point to avoid release
-	auto self = this->shared_from_this();
-
-	/// @brief if no wait, there will be no exit_code
-	this->wait();
-
 	///////////////////////////////////////////////////////////////////////
 	if (m_httpRequest)
 	{
@@ -78,5 +61,4 @@ void MonitoredProcess::runPipeReaderThread()
 	}
 	///////////////////////////////////////////////////////////////////////
 	LOG_DBG << fname << "Exited";
-	this->registerTimer(0, 0, std::bind(&MonitoredProcess::waitThread, this, std::placeholders::_1), fname);
 }
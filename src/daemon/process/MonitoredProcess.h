@@ -3,13 +3,13 @@
 #include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
 
 #include "AppProcess.h"
 
 class ACE_Process_Options;
 /// <summary>
-/// Monitor process and reply http request when finished
+/// Monitor process and reply http request when finished,
+/// process exit is watched by shared ProcessReaper
 /// <summary>
 class MonitoredProcess : public AppProcess
 {
@@ -22,10 +22,8 @@ public:
 	void setAsyncHttpRequest(void *httpRequest) { m_httpRequest = httpRequest; }
 
 protected:
-	virtual void waitThread(int timerId = 0);
-	void runPipeReaderThread();
+	void replyHttpRequest();
 
 private:
 	void *m_httpRequest;
-	std::unique_ptr<std::thread> m_thread;
 };
@@ -0,0 +1,213 @@
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../../common/Utility.h"
+#include "AppProcess.h"
+#include "ProcessReaper.h"
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
+ProcessReaper::ProcessReaper()
+	: m_epollFd(-1), m_eventFd(-1)
+{
+}
+
+ProcessReaper::~ProcessReaper()
+{
+	// singleton live with process, threads are not joined
+	for (auto &thread : m_threads)
+	{
+		thread->detach();
+	}
+}
+
+std::shared_ptr<ProcessReaper> &ProcessReaper::instance()
+{
+	static auto singleton = std::make_shared<ProcessReaper>();
+	return singleton;
+}
+
+void ProcessReaper::start()
+{
+	const static char fname[] = "ProcessReaper::start() ";
+
+	m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+	m_eventFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (m_epollFd < 0 || m_eventFd < 0)
+	{
+		throw std::runtime_error(Utility::stringFormat("failed to create epoll with error <%s>", std::strerror(errno)));
+	}
+	struct epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.fd = m_eventFd;
+	::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_eventFd, &event);
+
+	m_threads.push_back(std::make_unique<std::thread>(std::bind(&ProcessReaper::epollThread, this)));
+	for (int i = 0; i < DEFAULT_PROCESS_REAPER_POOL_SIZE; i++)
+	{
+		m_threads.push_back(std::make_unique<std::thread>(std::bind(&ProcessReaper::workerThread, this)));
+	}
+	LOG_INF << fname << "started with <" << DEFAULT_PROCESS_REAPER_POOL_SIZE << "> worker threads";
+}
+
+void ProcessReaper::watch(const std::shared_ptr<AppProcess> &process, const std::function<void()> &onExit)
+{
+	const static char fname[] = "ProcessReaper::watch() ";
+
+	std::call_once(m_startFlag, std::bind(&ProcessReaper::start, this));
+
+	WatchEntry entry{process, onExit};
+	const auto pid = process->getpid();
+	const int pidFd = static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+	std::lock_guard<std::mutex> guard(m_watchMutex);
+	if (pidFd >= 0)
+	{
+		struct epoll_event event = {};
+		event.events = EPOLLIN;
+		event.data.fd = pidFd;
+		if (::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, pidFd, &event) == 0)
+		{
+			m_watching[pidFd] = std::move(entry);
+			LOG_DBG << fname << "watch process <" << pid << "> with pidfd <" << pidFd << ">";
+			return;
+		}
+		::close(pidFd);
+	}
+	// pidfd_open not supported (kernel < 5.3) or process already reaped
+	LOG_DBG << fname << "watch process <" << pid << "> by poll";
+	m_polling.push_back(std::move(entry));
+	wakeup();
+}
+
+std::size_t ProcessReaper::watchingCount() const
+{
+	std::lock_guard<std::mutex> guard(m_watchMutex);
+	return m_watching.size() + m_polling.size();
+}
+
+void ProcessReaper::wakeup()
+{
+	uint64_t value = 1;
+	if (::write(m_eventFd, &value, sizeof(value)) < 0)
+	{
+		// counter overflow only, epoll is already signaled
+	}
+}
+
+void ProcessReaper::epollThread()
+{
+	const static char fname[] = "ProcessReaper::epollThread() ";
+	LOG_INF << fname << "Entered";
+
+	const int maxEvents = 64;
+	struct epoll_event events[maxEvents];
+	while (true)
+	{
+		int timeout = -1;
+		{
+			std::lock_guard<std::mutex> guard(m_watchMutex);
+			if (m_polling.size())
+				timeout = DEFAULT_PROCESS_REAPER_POLL_MS;
+		}
+		const int ready = ::epoll_wait(m_epollFd, events, maxEvents, timeout);
+		if (ready < 0 && errno != EINTR)
+		{
+			LOG_ERR << fname << "epoll_wait failed with error: " << std::strerror(errno);
+			std::this_thread::sleep_for(std::chrono::milliseconds(DEFAULT_PROCESS_REAPER_POLL_MS));
+		}
+		for (int i = 0; i < ready; i++)
+		{
+			const int fd = events[i].data.fd;
+			if (fd == m_eventFd)
+			{
+				uint64_t value;
+				while (::read(m_eventFd, &value, sizeof(value)) > 0)
+					;
+				continue;
+			}
+			// pidfd readable means process exited
+			WatchEntry entry;
+			{
+				std::lock_guard<std::mutex> guard(m_watchMutex);
+				auto iter = m_watching.find(fd);
+				if (iter == m_watching.end())
+					continue;
+				entry = std::move(iter->second);
+				m_watching.erase(iter);
+				::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+				::close(fd);
+			}
+			dispatch(std::move(entry));
+		}
+		pollExited();
+	}
+}
+
+void ProcessReaper::pollExited()
+{
+	std::list<WatchEntry> exited;
+	{
+		std::lock_guard<std::mutex> guard(m_watchMutex);
+		for (auto iter = m_polling.begin(); iter != m_polling.end();)
+		{
+			auto &process = iter->m_process;
+			// running() is false after the process is reaped by others
+			if (!process->running() || process->wait(ACE_Time_Value::zero) > 0)
+			{
+				exited.splice(exited.end(), m_polling, iter++);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+	for (auto &entry : exited)
+	{
+		dispatch(std::move(entry));
+	}
+}
+
+void ProcessReaper::dispatch(WatchEntry &&entry)
+{
+	{
+		std::lock_guard<std::mutex> guard(m_exitedMutex);
+		m_exited.push_back(std::move(entry));
+	}
+	m_exitedCondition.notify_one();
+}
+
+void ProcessReaper::workerThread()
+{
+	const static char fname[] = "ProcessReaper::workerThread() ";
+
+	while (true)
+	{
+		WatchEntry entry;
+		{
+			std::unique_lock<std::mutex> lock(m_exitedMutex);
+			m_exitedCondition.wait(lock, [this]()
+								   { return !m_exited.empty(); });
+			entry = std::move(m_exited.front());
+			m_exited.pop_front();
+		}
+		try
+		{
+			// reap zombie and get exit code, process already exited so this does not block
+			entry.m_process->wait();
+			entry.m_onExit();
+		}
+		catch (const std::exception &e)
+		{
+			LOG_ERR << fname << "exit callback failed with error: " << e.what();
+		}
+		catch (...)
+		{
+			LOG_ERR << fname << "exit callback failed with unknown error";
+		}
+	}
+}
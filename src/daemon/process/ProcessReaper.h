@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class AppProcess;
+//////////////////////////////////////////////////////////////////////////
+/// Shared process exit watcher, one epoll thread waits all watched
+/// processes by pidfd (fallback to WNOHANG poll when pidfd is not
+/// supported by kernel), exit callbacks run in a small worker pool.
+/// Thread count does not grow with watched process number.
+//////////////////////////////////////////////////////////////////////////
+class ProcessReaper
+{
+private:
+	struct WatchEntry
+	{
+		std::shared_ptr<AppProcess> m_process;
+		std::function<void()> m_onExit;
+	};
+
+public:
+	ProcessReaper();
+	virtual ~ProcessReaper();
+	static std::shared_ptr<ProcessReaper> &instance();
+
+	/// <summary>
+	/// Watch a spawned process, onExit is called from worker thread after process exited and reaped
+	/// </summary>
+	/// <param name="process">process object, reference is hold until onExit finished</param>
+	/// <param name="onExit">exit callback</param>
+	void watch(const std::shared_ptr<AppProcess> &process, const std::function<void()> &onExit);
+
+	/// <summary>
+	/// Number of processes being watched
+	/// </summary>
+	std::size_t watchingCount() const;
+
+private:
+	void start();
+	void epollThread();
+	void workerThread();
+	void pollExited();
+	void dispatch(WatchEntry &&entry);
+	void wakeup();
+
+private:
+	int m_epollFd;
+	int m_eventFd;
+	// key: pidfd
+	std::map<int, WatchEntry> m_watching;
+	// process watched without pidfd
+	std::list<WatchEntry> m_polling;
+	mutable std::mutex m_watchMutex;
+
+	std::list<WatchEntry> m_exited;
+	std::mutex m_exitedMutex;
+	std::condition_variable m_exitedCondition;
+
+	std::once_flag m_startFlag;
+	std::vector<std::unique_ptr<std::thread>> m_threads;
+};
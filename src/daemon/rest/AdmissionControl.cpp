@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <cmath>
+
+#include "../../common/Utility.h"
+#include "../../prom_exporter/counter.h"
+#include "../Configuration.h"
+#include "../application/Application.h"
+#include "../security/Role.h"
+#include "../security/Security.h"
+#include "../security/User.h"
+#include "AdmissionControl.h"
+#include "PrometheusRest.h"
+
+//////////////////////////////////////////////////////////////////////
+/// TokenBucket
+//////////////////////////////////////////////////////////////////////
+TokenBucket::TokenBucket(double rate, double burst)
+    : m_rate(rate), m_burst(burst), m_tokens(burst), m_lastRefill(std::chrono::steady_clock::now())
+{
+}
+
+bool TokenBucket::tryAcquire()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto elapsed = std::chrono::duration<double>(now - m_lastRefill).count();
+    m_lastRefill = now;
+    m_tokens = std::min(m_burst, m_tokens + elapsed * m_rate);
+    if (m_tokens < 1.0)
+    {
+        return false;
+    }
+    m_tokens -= 1.0;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// AdmissionControl
+//////////////////////////////////////////////////////////////////////
+AdmissionControl::AdmissionControl()
+    : m_reservedRunSlots(0)
+{
+}
+
+AdmissionControl::~AdmissionControl()
+{
+}
+
+std::shared_ptr<AdmissionControl> &AdmissionControl::instance()
+{
+    static auto singleton = std::make_shared<AdmissionControl>();
+    return singleton;
+}
+
+void AdmissionControl::initMetrics(PrometheusRest *prom)
+{
+    m_rateLimitRejectCounter = prom->createPromCounter(
+        PROM_METRIC_NAME_appmesh_http_request_rejected_count, PROM_METRIC_HELP_appmesh_http_request_rejected_count,
+        {{"reason", "rate_limit"}});
+    m_runConcurrencyRejectCounter = prom->createPromCounter(
+        PROM_METRIC_NAME_appmesh_http_request_rejected_count, PROM_METRIC_HELP_appmesh_http_request_rejected_count,
+        {{"reason", "run_concurrency"}});
+    m_queueFullRejectCounter = prom->createPromCounter(
+        PROM_METRIC_NAME_appmesh_http_request_rejected_count, PROM_METRIC_HELP_appmesh_http_request_rejected_count,
+        {{"reason", "queue_full"}});
+}
+
+bool AdmissionControl::rateLimitEnabled() const
+{
+    const auto admission = Configuration::instance()->getAdmission();
+    return admission->m_requestPerSecond > 0 || admission->m_userLimits.size() || admission->m_roleLimits.size();
+}
+
+bool AdmissionControl::admitRequest(const std::string &userName, const std::string &remoteAddress)
+{
+    const static char fname[] = "AdmissionControl::admitRequest() ";
+
+    const auto key = userName.empty() ? remoteAddress : userName;
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto iter = m_buckets.find(key);
+    if (iter == m_buckets.end())
+    {
+        // avoid unlimited growth from random remote address, evict the least recently used bucket,
+        // an idle bucket is refilled to burst and is equal to a new one
+        if (m_buckets.size() >= DEFAULT_ADMISSION_BUCKET_SIZE)
+        {
+            m_buckets.erase(m_bucketLru.back());
+            m_bucketLru.pop_back();
+        }
+        m_bucketLru.push_front(key);
+        iter = m_buckets.insert(std::make_pair(key, std::make_pair(createBucket(userName), m_bucketLru.begin()))).first;
+    }
+    else
+    {
+        m_bucketLru.splice(m_bucketLru.begin(), m_bucketLru, iter->second.second);
+    }
+    // null bucket means no limitation
+    const auto &bucket = iter->second.first;
+    if (bucket == nullptr || bucket->tryAcquire())
+    {
+        return true;
+    }
+    LOG_WAR << fname << "rate limit exceeded for <" << key << ">";
+    PROM_COUNTER_INCREASE(m_rateLimitRejectCounter);
+    return false;
+}
+
+std::shared_ptr<TokenBucket> AdmissionControl::createBucket(const std::string &userName) const
+{
+    const auto admission = Configuration::instance()->getAdmission();
+    auto limit = std::make_pair(admission->m_requestPerSecond, admission->m_requestBurst);
+    if (userName.length())
+    {
+        if (admission->m_userLimits.count(userName))
+        {
+            limit = admission->m_userLimits.find(userName)->second;
+        }
+        else if (admission->m_roleLimits.size())
+        {
+            try
+            {
+                // use the most generous limitation from user roles
+                bool roleMatched = false;
+                for (const auto &role : Security::instance()->getUserInfo(userName)->getRoles())
+                {
+                    auto roleLimit = admission->m_roleLimits.find(role->getName());
+                    if (roleLimit != admission->m_roleLimits.end() && (!roleMatched || roleLimit->second.first > limit.first))
+                    {
+                        limit = roleLimit->second;
+                        roleMatched = true;
+                    }
+                }
+            }
+            catch (...)
+            {
+                // user not exist, use default limitation
+            }
+        }
+    }
+    if (limit.first <= 0)
+    {
+        return nullptr;
+    }
+    const double burst = limit.second > 0 ? limit.second : std::max(1.0, std::ceil(limit.first));
+    return std::make_shared<TokenBucket>(limit.first, burst);
+}
+
+bool AdmissionControl::reserveRunSlot()
+{
+    const static char fname[] = "AdmissionControl::reserveRunSlot() ";
+
+    const auto runConcurrency = Configuration::instance()->getAdmission()->m_runConcurrency;
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (runConcurrency <= 0)
+    {
+        // unlimited, run processes are not tracked
+        m_runSlots.clear();
+        return true;
+    }
+    releaseExitedRunSlots();
+    if (m_runSlots.size() + m_reservedRunSlots >= static_cast<std::size_t>(runConcurrency))
+    {
+        LOG_WAR << fname << "run application concurrency <" << runConcurrency << "> reached";
+        PROM_COUNTER_INCREASE(m_runConcurrencyRejectCounter);
+        return false;
+    }
+    m_reservedRunSlots++;
+    return true;
+}
+
+void AdmissionControl::commitRunSlot(const std::shared_ptr<Application> &app)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    // no slot reserved when run concurrency is unlimited
+    if (m_reservedRunSlots == 0)
+    {
+        return;
+    }
+    m_reservedRunSlots--;
+    const auto pid = app->getpid();
+    if (pid > 0)
+    {
+        m_runSlots[pid] = app;
+    }
+}
+
+void AdmissionControl::cancelRunSlot()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (m_reservedRunSlots)
+    {
+        m_reservedRunSlots--;
+    }
+}
+
+void AdmissionControl::releaseExitedRunSlots()
+{
+    for (auto iter = m_runSlots.begin(); iter != m_runSlots.end();)
+    {
+        // application removed or its process exited (a new run get a new pid)
+        auto app = iter->second.lock();
+        const bool running = app && app->getpid() == iter->first;
+        iter = running ? std::next(iter) : m_runSlots.erase(iter);
+    }
+}
+
+bool AdmissionControl::admitQueue(std::size_t queueDepth)
+{
+    const static char fname[] = "AdmissionControl::admitQueue() ";
+
+    const auto queueSize = Configuration::instance()->getAdmission()->m_queueSize;
+    if (queueSize > 0 && queueDepth >= static_cast<std::size_t>(queueSize))
+    {
+        LOG_WAR << fname << "REST request queue size <" << queueSize << "> reached";
+        PROM_COUNTER_INCREASE(m_queueFullRejectCounter);
+        return false;
+    }
+    return true;
+}
+
+void AdmissionControl::reset()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_buckets.clear();
+    m_bucketLru.clear();
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <sys/types.h>
+
+class Application;
+class CounterMetric;
+class PrometheusRest;
+
+/// <summary>
+/// Token bucket, refill tokens by elapsed time
+/// </summary>
+class TokenBucket
+{
+public:
+    explicit TokenBucket(double rate, double burst);
+
+    /// <summary>
+    /// Consume one token
+    /// </summary>
+    /// <returns>false if no token left</returns>
+    bool tryAcquire();
+
+private:
+    const double m_rate;
+    const double m_burst;
+    double m_tokens;
+    std::chrono::steady_clock::time_point m_lastRefill;
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// REST admission control, reject request with 429 before it consume resource:
+///  1. per user (or role) token bucket rate limit
+///  2. concurrency limit for run application APIs
+///  3. TCP REST task queue size limit
+//////////////////////////////////////////////////////////////////////////
+class AdmissionControl
+{
+public:
+    AdmissionControl();
+    virtual ~AdmissionControl();
+    static std::shared_ptr<AdmissionControl> &instance();
+
+    /// <summary>
+    /// Create reject metrics
+    /// </summary>
+    void initMetrics(PrometheusRest *prom);
+
+    bool rateLimitEnabled() const;
+    /// <summary>
+    /// Check rate limit for a request
+    /// </summary>
+    /// <param name="userName">verified user name, empty for unauthenticated request</param>
+    /// <param name="remoteAddress">used as rate limit key for unauthenticated request</param>
+    /// <returns>false if exceed rate limit</returns>
+    bool admitRequest(const std::string &userName, const std::string &remoteAddress);
+
+    /// <summary>
+    /// Reserve a run application slot before register the run application, nothing is reserved when run concurrency is unlimited
+    /// </summary>
+    /// <returns>false if exceed run concurrency</returns>
+    bool reserveRunSlot();
+    /// <summary>
+    /// Bind reserved slot to the started process, slot is released when the process exit or application removed
+    /// </summary>
+    void commitRunSlot(const std::shared_ptr<Application> &app);
+    /// <summary>
+    /// Release reserved slot when failed to run application
+    /// </summary>
+    void cancelRunSlot();
+
+    /// <summary>
+    /// Check TCP REST task queue depth
+    /// </summary>
+    /// <returns>false if queue is full</returns>
+    bool admitQueue(std::size_t queueDepth);
+
+    /// <summary>
+    /// Remove all token buckets, used for configuration update
+    /// </summary>
+    void reset();
+
+private:
+    std::shared_ptr<TokenBucket> createBucket(const std::string &userName) const;
+    void releaseExitedRunSlots();
+
+private:
+    // key: user name or remote address, value: (token bucket, position in m_bucketLru)
+    std::map<std::string, std::pair<std::shared_ptr<TokenBucket>, std::list<std::string>::iterator>> m_buckets;
+    // bucket keys, most recently used first
+    std::list<std::string> m_bucketLru;
+    // key: process id of run application, value: application
+    std::map<pid_t, std::weak_ptr<Application>> m_runSlots;
+    std::size_t m_reservedRunSlots;
+    mutable std::mutex m_mutex;
+
+    std::shared_ptr<CounterMetric> m_rateLimitRejectCounter;
+    std::shared_ptr<CounterMetric> m_runConcurrencyRejectCounter;
+    std::shared_ptr<CounterMetric> m_queueFullRejectCounter;
+};
+
+#define HTTP_STATUS_TOO_MANY_REQUESTS web::http::status_code(429)
+#define HTTP_HEADER_KEY_retry_after "Retry-After"
+
+// App Mesh HTTP request rejected by admission control
+#define PROM_METRIC_NAME_appmesh_http_request_rejected_count "appmesh_http_request_rejected_count"
+#define PROM_METRIC_HELP_appmesh_http_request_rejected_count "app mesh http request rejected by admission control"
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+#include "../../common/Utility.h"
+#include "FileTransfer.h"
+
+std::mutex FileTransfer::m_mutex;
+
+bool FileTransfer::parseRange(const std::string &range, std::size_t fileSize, std::size_t &start, std::size_t &length)
+{
+    const std::string unit = "bytes=";
+    if (!Utility::startWith(range, unit) || range.find(',') != std::string::npos || fileSize == 0)
+    {
+        // multiple ranges are not supported
+        return false;
+    }
+    const auto spec = Utility::stdStringTrim(range.substr(unit.length()));
+    const auto dash = spec.find('-');
+    if (dash == std::string::npos)
+    {
+        return false;
+    }
+    const auto first = spec.substr(0, dash);
+    const auto last = spec.substr(dash + 1);
+    try
+    {
+        std::size_t end = fileSize - 1;
+        if (first.empty())
+        {
+            // suffix range: last N bytes
+            const auto suffix = std::stoull(last);
+            if (suffix == 0)
+                return false;
+            start = suffix >= fileSize ? 0 : fileSize - suffix;
+        }
+        else
+        {
+            start = std::stoull(first);
+            if (last.length())
+                end = std::min<std::size_t>(std::stoull(last), fileSize - 1);
+        }
+        if (start >= fileSize || end < start)
+        {
+            return false;
+        }
+        length = end - start + 1;
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool FileTransfer::resolveRange(const std::map<std::string, std::string> &headers, const std::string &etag, std::size_t fileSize,
+                                std::size_t &start, std::size_t &length, bool &partial)
+{
+    start = 0;
+    length = fileSize;
+    partial = false;
+    const auto range = headers.find(HTTP_HEADER_KEY_range);
+    const auto ifRange = headers.find(HTTP_HEADER_KEY_if_range);
+    // empty file has no satisfiable range, reply whole (empty) content
+    if (range == headers.end() || fileSize == 0 || (ifRange != headers.end() && ifRange->second != etag))
+    {
+        return true;
+    }
+    if (!parseRange(range->second, fileSize, start, length))
+    {
+        return false;
+    }
+    partial = true;
+    return true;
+}
+
+std::pair<std::size_t, std::string> FileTransfer::fileStat(const std::string &path)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0)
+    {
+        throw std::invalid_argument(Utility::stringFormat("failed to stat file <%s>", path.c_str()));
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    return std::make_pair(size, Utility::stringFormat("\"%zu-%ld\"", size, static_cast<long>(st.st_mtime)));
+}
+
+void FileTransfer::createIndex(const std::string &path, std::size_t fileSize, const std::string &fileChecksum)
+{
+    std::ofstream part(path + FILE_UPLOAD_PART_SUFFIX, std::ios::out | std::ios::binary | std::ios::trunc);
+    std::ofstream index(path + FILE_UPLOAD_INDEX_SUFFIX, std::ios::out | std::ios::trunc);
+    index << fileSize << " " << fileChecksum << std::endl;
+}
+
+bool FileTransfer::writeChunk(const std::string &path, std::size_t offset, std::size_t fileSize, const std::string &fileChecksum, const char *data, std::size_t length)
+{
+    const static char fname[] = "FileTransfer::writeChunk() ";
+
+    const auto partFile = path + FILE_UPLOAD_PART_SUFFIX;
+    const auto indexFile = path + FILE_UPLOAD_INDEX_SUFFIX;
+    // avoid offset + length overflow
+    if (offset > fileSize || length > fileSize - offset)
+    {
+        throw std::invalid_argument("chunk exceed file size");
+    }
+    if (fileChecksum.find_first_of(" \r\n") != std::string::npos)
+    {
+        throw std::invalid_argument("invalid file checksum");
+    }
+
+    // prepare part file and index file
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (Utility::isFileExist(indexFile))
+        {
+            std::size_t uploadingSize = 0;
+            std::string uploadingChecksum;
+            readIndex(indexFile, uploadingSize, uploadingChecksum);
+            if (uploadingSize != fileSize || uploadingChecksum != fileChecksum)
+            {
+                // received chunks belong to another file, never mix them into this one
+                LOG_WAR << fname << "restart upload <" << path << ">, unfinished upload size <" << uploadingSize << "> checksum <" << uploadingChecksum
+                        << "> mismatch with size <" << fileSize << "> checksum <" << fileChecksum << ">";
+                createIndex(path, fileSize, fileChecksum);
+            }
+        }
+        else
+        {
+            createIndex(path, fileSize, fileChecksum);
+        }
+    }
+
+    // write chunk without lock, chunks from parallel requests write to different region
+    {
+        std::fstream part(partFile, std::ios::in | std::ios::out | std::ios::binary);
+        if (!part.is_open())
+        {
+            throw std::invalid_argument(Utility::stringFormat("failed to open <%s>", partFile.c_str()));
+        }
+        part.seekp(offset);
+        part.write(data, length);
+        part.flush();
+        if (!part.good())
+        {
+            throw std::invalid_argument(Utility::stringFormat("failed to write <%s>", partFile.c_str()));
+        }
+    }
+
+    // record received range and check complete
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (!Utility::isFileExist(indexFile))
+    {
+        // finished by another chunk with the same range
+        return Utility::isFileExist(path);
+    }
+    std::size_t uploadingSize = 0;
+    std::string uploadingChecksum;
+    readIndex(indexFile, uploadingSize, uploadingChecksum);
+    if (uploadingSize != fileSize || uploadingChecksum != fileChecksum)
+    {
+        // restarted by another file while writing, this chunk is overwritten or not recorded
+        throw std::invalid_argument("upload restarted by another file");
+    }
+    {
+        std::ofstream index(indexFile, std::ios::out | std::ios::app);
+        index << offset << " " << length << std::endl;
+    }
+    const auto ranges = readIndex(indexFile, uploadingSize, uploadingChecksum);
+    const bool complete = (fileSize == 0) || (ranges.size() == 1 && ranges.front().first == 0 && ranges.front().second == fileSize);
+    if (complete)
+    {
+        if (std::rename(partFile.c_str(), path.c_str()) != 0)
+        {
+            throw std::invalid_argument(Utility::stringFormat("failed to rename <%s>", partFile.c_str()));
+        }
+        std::remove(indexFile.c_str());
+        LOG_INF << fname << "upload file <" << path << "> finished with size: " << fileSize;
+    }
+    return complete;
+}
+
+FileTransfer::Ranges FileTransfer::receivedRanges(const std::string &path, std::size_t &fileSize, std::string &fileChecksum)
+{
+    fileSize = 0;
+    fileChecksum.clear();
+    const auto indexFile = path + FILE_UPLOAD_INDEX_SUFFIX;
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (!Utility::isFileExist(indexFile))
+    {
+        return Ranges();
+    }
+    return readIndex(indexFile, fileSize, fileChecksum);
+}
+
+FileTransfer::Ranges FileTransfer::readIndex(const std::string &indexFile, std::size_t &fileSize, std::string &fileChecksum)
+{
+    Ranges ranges;
+    std::ifstream index(indexFile);
+    // first line: <file size> <file checksum>
+    std::string header;
+    std::getline(index, header);
+    std::istringstream headerStream(header);
+    fileSize = 0;
+    fileChecksum.clear();
+    headerStream >> fileSize >> fileChecksum;
+    std::size_t offset, length;
+    while (index >> offset >> length)
+    {
+        ranges.push_back(std::make_pair(offset, length));
+    }
+    return mergeRanges(std::move(ranges));
+}
+
+FileTransfer::Ranges FileTransfer::mergeRanges(Ranges ranges)
+{
+    std::sort(ranges.begin(), ranges.end());
+    Ranges merged;
+    for (const auto &range : ranges)
+    {
+        if (range.second == 0)
+            continue;
+        if (merged.size() && range.first <= merged.back().first + merged.back().second)
+        {
+            const auto end = std::max(merged.back().first + merged.back().second, range.first + range.second);
+            merged.back().second = end - merged.back().first;
+        }
+        else
+        {
+            merged.push_back(range);
+        }
+    }
+    return merged;
+}
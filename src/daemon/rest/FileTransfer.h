@@ -0,0 +1,78 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+/// File transfer helper for REST file APIs:
+///  1. HTTP Range parse for partial download
+///  2. Chunked resumable upload, chunks are written to <file>.appmesh.part
+///     and received ranges are recorded in <file>.appmesh.idx, the part
+///     file is renamed to target file when all ranges are received
+///  3. The index starts with file size and whole file checksum, a chunk of
+///     another file (size or checksum mismatch) restarts the upload
+//////////////////////////////////////////////////////////////////////////
+class FileTransfer
+{
+public:
+    typedef std::vector<std::pair<std::size_t, std::size_t>> Ranges; // offset, length
+
+    /// <summary>
+    /// Parse single range header: "bytes=start-end", "bytes=start-", "bytes=-suffix"
+    /// </summary>
+    /// <param name="range">Range header value</param>
+    /// <param name="fileSize">total file size</param>
+    /// <param name="start">output start offset</param>
+    /// <param name="length">output range length</param>
+    /// <returns>false if range is not satisfiable</returns>
+    static bool parseRange(const std::string &range, std::size_t fileSize, std::size_t &start, std::size_t &length);
+
+    /// <summary>
+    /// Resolve download content from Range and If-Range headers, Range is ignored
+    /// when If-Range does not match current file or the file is empty
+    /// </summary>
+    /// <param name="headers">request headers</param>
+    /// <param name="etag">current file ETag</param>
+    /// <param name="fileSize">total file size</param>
+    /// <param name="start">output start offset</param>
+    /// <param name="length">output content length</param>
+    /// <param name="partial">output whether reply partial content</param>
+    /// <returns>false if range is not satisfiable</returns>
+    static bool resolveRange(const std::map<std::string, std::string> &headers, const std::string &etag, std::size_t fileSize,
+                             std::size_t &start, std::size_t &length, bool &partial);
+
+    /// <summary>
+    /// File size and ETag (quoted "size-mtime"), ETag is used to validate If-Range
+    /// </summary>
+    static std::pair<std::size_t, std::string> fileStat(const std::string &path) noexcept(false);
+
+    /// <summary>
+    /// Write an upload chunk
+    /// </summary>
+    /// <param name="path">target file path</param>
+    /// <param name="offset">chunk offset</param>
+    /// <param name="fileSize">total file size</param>
+    /// <param name="fileChecksum">whole file checksum from client</param>
+    /// <param name="data">chunk data</param>
+    /// <param name="length">chunk length</param>
+    /// <returns>true if all chunks received and target file is ready</returns>
+    static bool writeChunk(const std::string &path, std::size_t offset, std::size_t fileSize, const std::string &fileChecksum, const char *data, std::size_t length) noexcept(false);
+
+    /// <summary>
+    /// Get merged received ranges of an unfinished upload
+    /// </summary>
+    /// <param name="path">target file path</param>
+    /// <param name="fileSize">output total file size, 0 if no unfinished upload</param>
+    /// <param name="fileChecksum">output whole file checksum of unfinished upload</param>
+    static Ranges receivedRanges(const std::string &path, std::size_t &fileSize, std::string &fileChecksum);
+
+private:
+    static Ranges readIndex(const std::string &indexFile, std::size_t &fileSize, std::string &fileChecksum);
+    static void createIndex(const std::string &path, std::size_t fileSize, const std::string &fileChecksum);
+    static Ranges mergeRanges(Ranges ranges);
+
+    static std::mutex m_mutex;
+};
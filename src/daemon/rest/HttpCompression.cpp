@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include <zlib.h>
+
+#include "../../common/Utility.h"
+#include "HttpCompression.h"
+
+HttpCompression::Encoding HttpCompression::negotiate(const std::string &acceptEncoding)
+{
+    Encoding selected = Encoding::IDENTITY;
+    double selectedQ = 0;
+    for (const auto &item : Utility::splitString(acceptEncoding, ","))
+    {
+        // "gzip;q=0.8"
+        const auto params = Utility::splitString(item, ";");
+        if (params.empty())
+            continue;
+        auto coding = Utility::stdStringTrim(params.front());
+        std::transform(coding.begin(), coding.end(), coding.begin(), ::tolower);
+        double q = 1.0;
+        for (std::size_t i = 1; i < params.size(); i++)
+        {
+            const auto param = Utility::stdStringTrim(params[i]);
+            if (Utility::startWith(param, "q="))
+            {
+                try
+                {
+                    q = std::stod(param.substr(2));
+                }
+                catch (...)
+                {
+                    q = 0;
+                }
+            }
+        }
+        Encoding encoding;
+        if (coding == "gzip" || coding == "x-gzip" || coding == "*")
+            encoding = Encoding::GZIP;
+        else if (coding == "deflate")
+            encoding = Encoding::DEFLATE;
+        else
+            continue;
+        // q=0 means not acceptable
+        if (q > selectedQ || (q == selectedQ && q > 0 && encoding == Encoding::GZIP))
+        {
+            selected = encoding;
+            selectedQ = q;
+        }
+    }
+    return selected;
+}
+
+const char *HttpCompression::name(Encoding encoding)
+{
+    switch (encoding)
+    {
+    case Encoding::GZIP:
+        return "gzip";
+    case Encoding::DEFLATE:
+        return "deflate";
+    default:
+        return "identity";
+    }
+}
+
+std::vector<unsigned char> HttpCompression::compress(const std::string &data, Encoding encoding, int level)
+{
+    z_stream stream = {};
+    // windowBits 15, +16 for gzip header and trailer
+    const int windowBits = (encoding == Encoding::GZIP) ? (15 + 16) : 15;
+    if (deflateInit2(&stream, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw std::runtime_error("deflateInit2 failed");
+    }
+    std::vector<unsigned char> output(deflateBound(&stream, data.size()));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = output.data();
+    stream.avail_out = static_cast<uInt>(output.size());
+    const auto rt = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (rt != Z_STREAM_END)
+    {
+        throw std::runtime_error(Utility::stringFormat("deflate failed with error <%d>", rt));
+    }
+    return output;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+/// HTTP response body compression with zlib, used by REST child process
+/// to reply client with Content-Encoding negotiated from Accept-Encoding
+//////////////////////////////////////////////////////////////////////////
+class HttpCompression
+{
+public:
+    enum class Encoding
+    {
+        IDENTITY,
+        GZIP,
+        DEFLATE
+    };
+
+    /// <summary>
+    /// Select encoding from Accept-Encoding header, respect q-value, prefer gzip when equal
+    /// </summary>
+    /// <param name="acceptEncoding">Accept-Encoding header value, e.g. "gzip;q=0.8, deflate"</param>
+    static Encoding negotiate(const std::string &acceptEncoding);
+
+    /// <summary>
+    /// Content-Encoding header value
+    /// </summary>
+    static const char *name(Encoding encoding);
+
+    /// <summary>
+    /// Compress data
+    /// </summary>
+    /// <param name="data">raw data</param>
+    /// <param name="encoding">GZIP or DEFLATE (zlib format)</param>
+    /// <param name="level">zlib compression level 1 ~ 9</param>
+    /// <returns>compressed data</returns>
+    static std::vector<unsigned char> compress(const std::string &data, Encoding encoding, int level) noexcept(false);
+};
@@ -1,3 +1,5 @@
+#include <chrono>
+
 #include <ace/CDR_Stream.h>
 
 #include "../../common/Utility.h"
@@ -6,7 +8,8 @@
 #include "RestTcpServer.h"
 
 HttpRequest::HttpRequest(const web::http::http_request &message)
-	: http_request(message), m_uuid(Utility::createUUID()), m_forwardResponse2RestServer(false)
+	: http_request(message), m_uuid(Utility::createUUID()), m_forwardResponse2RestServer(false),
+	  m_receiveTime(monotonicNanoseconds()), m_forwardTime(0), m_enqueueTime(0), m_dequeueTime(0)
 {
 	this->m_method = message.method();
 	this->m_relative_uri = message.relative_uri().path();
@@ -24,7 +27,9 @@ HttpRequest::HttpRequest(const web::http::http_request &message)
 }
 
 HttpRequest::HttpRequest(const HttpRequest &message)
-	: http_request(message), m_uuid(message.m_uuid), m_forwardResponse2RestServer(message.m_forwardResponse2RestServer)
+	: http_request(message), m_uuid(message.m_uuid), m_forwardResponse2RestServer(message.m_forwardResponse2RestServer),
+	  m_receiveTime(message.m_receiveTime), m_forwardTime(message.m_forwardTime),
+	  m_enqueueTime(message.m_enqueueTime), m_dequeueTime(message.m_dequeueTime), m_matchedRoute(message.m_matchedRoute)
 {
 	this->m_method = message.m_method;
 	this->m_relative_uri = message.m_relative_uri;
@@ -40,7 +45,10 @@ HttpRequest::HttpRequest(const std::string &uuid,
 						 const std::string &address,
 						 const std::string &body,
 						 const std::string &headers,
-						 const std::string &query)
+						 const std::string &query,
+						 int64_t receiveTime,
+						 int64_t forwardTime)
+	: m_receiveTime(receiveTime), m_forwardTime(forwardTime), m_enqueueTime(0), m_dequeueTime(0)
 {
 	//const static char fname[] = "HttpRequest::HttpRequest() ";
 	this->m_uuid = uuid;
@@ -78,14 +86,15 @@ void HttpRequest::reply(http_response &response) const
 	}
 }
 
-void HttpRequest::reply(http_response &response, const std::string &body_data) const
+void HttpRequest::reply(http_response &response, const std::string &body_data, const utf8string &content_type) const
 {
 	if (m_forwardResponse2RestServer)
 	{
-		RestTcpServer::instance()->backforwardResponse(m_uuid, body_data, response.headers(), response.status_code(), "text/plain; charset=utf-8");
+		RestTcpServer::instance()->backforwardResponse(m_uuid, body_data, response.headers(), response.status_code(), content_type);
 	}
 	else
 	{
+		response.set_body(body_data, content_type);
 		http_request::reply(response).wait();
 	}
 }
@@ -235,7 +244,8 @@ const std::shared_ptr<ACE_OutputCDR> HttpRequest::serialize() const
 		m_body.length() +
 		headerStr.length() +
 		m_query.length() +
-		8 + 7 * ACE_CDR::MAX_ALIGNMENT; // each item need one padding
+		sizeof(ACE_CDR::LongLong) * 2 +
+		8 + 9 * ACE_CDR::MAX_ALIGNMENT; // each item need one padding
 
 	// Insert contents into payload stream.
 	auto payload = std::make_shared<ACE_OutputCDR>(max_payload_size);
@@ -246,6 +256,8 @@ const std::shared_ptr<ACE_OutputCDR> HttpRequest::serialize() const
 	*payload << m_body;
 	*payload << headerStr;
 	*payload << m_query;
+	*payload << ACE_CDR::LongLong(m_receiveTime);
+	*payload << ACE_CDR::LongLong(m_forwardTime);
 
 	// LOG_DBG << "HttpRequest::serialize() headers: " << headerStr;
 	return payload;
@@ -254,20 +266,28 @@ const std::shared_ptr<ACE_OutputCDR> HttpRequest::serialize() const
 std::shared_ptr<HttpRequest> HttpRequest::deserialize(ACE_InputCDR &input)
 {
 	std::string uuid, method, uri, address, body, headerStr, query;
+	ACE_CDR::LongLong receiveTime, forwardTime;
 	if (input >> uuid &&
 		input >> method &&
 		input >> uri &&
 		input >> address &&
 		input >> body &&
 		input >> headerStr &&
-		input >> query)
+		input >> query &&
+		input >> receiveTime &&
+		input >> forwardTime)
 	{
 		// use std::make_shared call private constructor will face compile error
-		return std::shared_ptr<HttpRequest>(new HttpRequest(uuid, method, uri, address, body, headerStr, query));
+		return std::shared_ptr<HttpRequest>(new HttpRequest(uuid, method, uri, address, body, headerStr, query, receiveTime, forwardTime));
 	}
 	return nullptr;
 }
 
+int64_t HttpRequest::monotonicNanoseconds()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // HttpTcpResponse transfer REST response from RestTcpServer to RestChildObject
 ////////////////////////////////////////////////////////////////////////////////
@@ -32,7 +32,9 @@ private:
 				const std::string &address,
 				const std::string &body,
 				const std::string &headers,
-				const std::string &query);
+				const std::string &query,
+				int64_t receiveTime,
+				int64_t forwardTime);
 
 public:
 	HttpRequest(const web::http::http_request &message);
@@ -61,8 +63,10 @@ public:
 	/// Asynchronously responses to this HTTP request.
 	/// </summary>
 	/// <param name="response">Response to send.</param>
+	/// <param name="body_data">UTF-8 string containing the text to use in the response body.</param>
+	/// <param name="content_type">Content type of the body.</param>
 	/// <returns>An asynchronous operation that is completed once response is sent.</returns>
-	void reply(http_response &response, const std::string &body_data) const;
+	void reply(http_response &response, const std::string &body_data, const utf8string &content_type = "text/plain; charset=utf-8") const;
 
 	/// <summary>
 	/// Asynchronously responses to this HTTP request.
@@ -158,6 +162,11 @@ public:
 	const std::shared_ptr<ACE_OutputCDR> serialize() const;
 	static std::shared_ptr<HttpRequest> deserialize(ACE_InputCDR &input);
 
+	/// <summary>
+	/// Monotonic clock in nanoseconds, comparable between REST process and App Mesh process on the same host
+	/// </summary>
+	static int64_t monotonicNanoseconds();
+
 	// serializeable, always use those variables intead of method(), headers()
 	std::string m_uuid;
 	web::http::method m_method;
@@ -169,6 +178,13 @@ public:
 
 	bool m_forwardResponse2RestServer; // not directly reply this endpoint, just forward to child rest side
 
+	// request timestamps (monotonicNanoseconds) used for REST latency metrics
+	int64_t m_receiveTime;		   // REST process received request (serialized)
+	mutable int64_t m_forwardTime; // REST process forward request to TCP server (serialized)
+	int64_t m_enqueueTime;		   // TCP server put request to task queue
+	int64_t m_dequeueTime;		   // TCP server get request from task queue
+	mutable std::string m_matchedRoute; // REST path pattern matched by handleRest()
+
 private:
 	// hide bellow extract functions, note extract_X function can only be called once, otherwise will hang
 	pplx::task<utf8string> extract_utf8string(bool ignore_content_type = false)
@@ -4,17 +4,19 @@
 #include "../../common/Utility.h"
 #include "../../common/os/process.hpp"
 #include "../../prom_exporter/counter.h"
+#include "../../prom_exporter/histogram.h"
 #include "../../prom_exporter/registry.h"
 #include "../../prom_exporter/text_serializer.h"
 #include "../Configuration.h"
 #include "../ResourceCollection.h"
+#include "AdmissionControl.h"
 #include "PrometheusRest.h"
 #include "RestBase.h"
 
 std::shared_ptr<PrometheusRest> PrometheusRest::m_instance;
 
 PrometheusRest::PrometheusRest(bool forward2TcpServer)
-	: RestBase(forward2TcpServer), m_promEnabled(true), m_scrapeCounter(0)
+	: RestBase(forward2TcpServer), m_promEnabled(true), m_scrapeCounter(0), m_restLatencyEnabled(false)
 {
 	m_promRegistry = std::make_shared<prometheus::Registry>();
 	bindRestMethod(web::http::methods::GET, "/metrics", std::bind(&PrometheusRest::apiMetrics, this, std::placeholders::_1));
@@ -112,6 +114,16 @@ void PrometheusRest::initMetrics()
 	m_restPostCounter = createPromCounter(
 		PROM_METRIC_NAME_appmesh_http_request_count, PROM_METRIC_HELP_appmesh_http_request_count,
 		{{"method", web::http::methods::POST}, {"listen", listenAddress}});
+
+	m_restInflightGauge = createPromGauge(
+		PROM_METRIC_NAME_appmesh_http_request_inflight, PROM_METRIC_HELP_appmesh_http_request_inflight,
+		{{"listen", listenAddress}});
+	m_restQueueDepthGauge = createPromGauge(
+		PROM_METRIC_NAME_appmesh_http_request_queue_depth, PROM_METRIC_HELP_appmesh_http_request_queue_depth,
+		{{"listen", listenAddress}});
+	m_restLatencyEnabled = true;
+
+	AdmissionControl::instance()->initMetrics(this);
 }
 
 std::shared_ptr<CounterMetric> PrometheusRest::createPromCounter(const std::string &metricName, const std::string &metricHelp, const std::map<std::string, std::string> &labels)
@@ -128,6 +140,13 @@ std::shared_ptr<GaugeMetric> PrometheusRest::createPromGauge(const std::string &
 	return std::make_shared<GaugeMetric>(m_promRegistry, metricName, metricHelp, labels);
 }
 
+std::shared_ptr<HistogramMetric> PrometheusRest::createPromHistogram(const std::string &metricName, const std::string &metricHelp, const std::map<std::string, std::string> &labels, const std::vector<double> &buckets)
+{
+	if (!m_promEnabled)
+		return nullptr;
+	return std::make_shared<HistogramMetric>(m_promRegistry, metricName, metricHelp, labels, buckets);
+}
+
 void PrometheusRest::handleRest(const HttpRequest &message, const std::map<std::string, std::function<void(const HttpRequest &)>> &restFunctions)
 {
 	if (message.m_method == web::http::methods::GET)
@@ -139,7 +158,66 @@ void PrometheusRest::handleRest(const HttpRequest &message, const std::map<std::
 	else if (message.m_method == web::http::methods::DEL)
 		PROM_COUNTER_INCREASE(m_restDelCounter)
 
+	const auto handleStart = HttpRequest::monotonicNanoseconds();
 	RestBase::handleRest(message, restFunctions);
+	observeRestLatency(message, handleStart);
+}
+
+void PrometheusRest::observeRestLatency(const HttpRequest &message, int64_t handleStart)
+{
+	// only observe bound routes, avoid unbounded label values from unknown path
+	if (!m_restLatencyEnabled || message.m_matchedRoute.empty())
+		return;
+
+	auto routeMetric = getRestRouteMetric(message.m_method, message.m_matchedRoute);
+	if (routeMetric == nullptr)
+		return;
+
+	const auto handleEnd = HttpRequest::monotonicNanoseconds();
+	const auto seconds = [](int64_t start, int64_t end)
+	{ return std::max(int64_t(0), end - start) / 1e9; };
+
+	routeMetric->m_handler->metric().Observe(seconds(handleStart, handleEnd));
+	if (message.m_receiveTime)
+	{
+		routeMetric->m_total->metric().Observe(seconds(message.m_receiveTime, handleEnd));
+	}
+	if (message.m_forwardTime && message.m_enqueueTime)
+	{
+		routeMetric->m_transit->metric().Observe(seconds(message.m_forwardTime, message.m_enqueueTime));
+	}
+	if (message.m_enqueueTime && message.m_dequeueTime)
+	{
+		routeMetric->m_queueWait->metric().Observe(seconds(message.m_enqueueTime, message.m_dequeueTime));
+	}
+}
+
+std::shared_ptr<RestRouteMetric> PrometheusRest::getRestRouteMetric(const std::string &method, const std::string &route)
+{
+	// bucket boundaries in seconds, from sub-millisecond to ten seconds
+	const static std::vector<double> buckets = {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+
+	const auto key = method + " " + route;
+	std::lock_guard<std::mutex> guard(m_restRouteMetricsMutex);
+	auto iter = m_restRouteMetrics.find(key);
+	if (iter != m_restRouteMetrics.end())
+		return iter->second;
+
+	if (!m_promEnabled)
+		return nullptr;
+
+	const std::map<std::string, std::string> labels = {{"method", method}, {"route", route}};
+	auto routeMetric = std::make_shared<RestRouteMetric>();
+	routeMetric->m_total = createPromHistogram(
+		PROM_METRIC_NAME_appmesh_http_request_latency_seconds, PROM_METRIC_HELP_appmesh_http_request_latency_seconds, labels, buckets);
+	routeMetric->m_transit = createPromHistogram(
+		PROM_METRIC_NAME_appmesh_http_request_transit_seconds, PROM_METRIC_HELP_appmesh_http_request_transit_seconds, labels, buckets);
+	routeMetric->m_queueWait = createPromHistogram(
+		PROM_METRIC_NAME_appmesh_http_request_queue_seconds, PROM_METRIC_HELP_appmesh_http_request_queue_seconds, labels, buckets);
+	routeMetric->m_handler = createPromHistogram(
+		PROM_METRIC_NAME_appmesh_http_request_handler_seconds, PROM_METRIC_HELP_appmesh_http_request_handler_seconds, labels, buckets);
+	m_restRouteMetrics[key] = routeMetric;
+	return routeMetric;
 }
 
 const std::string PrometheusRest::collectData()
@@ -234,3 +312,34 @@ prometheus::Gauge &GaugeMetric::metric()
 {
 	return *m_metric;
 }
+
+HistogramMetric::HistogramMetric(std::shared_ptr<prometheus::Registry> registry, const std::string &name, const std::string &help,
+								 std::map<std::string, std::string> label, const std::vector<double> &buckets)
+	: m_metric(nullptr), m_family(nullptr), m_promRegistry(registry), m_name(name), m_help(help), m_label(label)
+{
+	const static char fname[] = "HistogramMetric::HistogramMetric() ";
+
+	std::map<std::string, std::string> commonLabels = {{"host", MY_HOST_NAME}, {"pid", std::to_string(ResourceCollection::instance()->getPid())}};
+	commonLabels.insert(label.begin(), label.end());
+
+	auto &family = prometheus::BuildHistogram()
+					   .Name(m_name)
+					   .Help(help)
+					   .Register(*m_promRegistry);
+	m_family = &family;
+	m_metric = &((family.Add(commonLabels, buckets)));
+
+	LOG_DBG << fname << "metric " << m_name << " added";
+}
+
+HistogramMetric::~HistogramMetric()
+{
+	const static char fname[] = "HistogramMetric::~HistogramMetric() ";
+	m_family->Remove(m_metric);
+	LOG_DBG << fname << "metric " << m_name << " removed";
+}
+
+prometheus::Histogram &HistogramMetric::metric()
+{
+	return *m_metric;
+}
@@ -2,6 +2,8 @@
 
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <cpprest/http_listener.h> // HTTP server
 
@@ -13,6 +15,7 @@ namespace prometheus
 {
 	class Counter;
 	class Gauge;
+	class Histogram;
 	class Registry;
 }; // namespace prometheus
 
@@ -71,6 +74,41 @@ private:
 	const std::map<std::string, std::string> m_label;
 };
 
+/// <summary>
+/// Metric Wrapper for reg/unreg metric automaticaly
+/// </summary>
+class HistogramMetric
+{
+public:
+	explicit HistogramMetric(std::shared_ptr<prometheus::Registry> registry,
+							 const std::string &name, const std::string &help,
+							 std::map<std::string, std::string> label,
+							 const std::vector<double> &buckets);
+
+	virtual ~HistogramMetric();
+
+	prometheus::Histogram &metric();
+
+private:
+	prometheus::Histogram *m_metric;
+	prometheus::Family<prometheus::Histogram> *m_family;
+	std::shared_ptr<prometheus::Registry> m_promRegistry;
+	const std::string m_name;
+	const std::string m_help;
+	const std::map<std::string, std::string> m_label;
+};
+
+/// <summary>
+/// Latency histograms for one REST route and method
+/// </summary>
+struct RestRouteMetric
+{
+	std::shared_ptr<HistogramMetric> m_total;	  // REST process receive to handler finish
+	std::shared_ptr<HistogramMetric> m_transit;	  // REST process forward to TCP server enqueue
+	std::shared_ptr<HistogramMetric> m_queueWait; // TCP server task queue wait
+	std::shared_ptr<HistogramMetric> m_handler;	  // handler execution
+};
+
 /// <summary>
 /// Prometheus Exporter REST service
 /// </summary>
@@ -96,6 +134,15 @@ public:
 	/// <param name="labels"></param>
 	/// <returns>return null if exporter was not enabled</returns>
 	std::shared_ptr<GaugeMetric> createPromGauge(const std::string &metricName, const std::string &metricHelp, const std::map<std::string, std::string> &labels) noexcept(false);
+	/// <summary>
+	/// Create a Histogram Metric
+	/// </summary>
+	/// <param name="metricName"></param>
+	/// <param name="metricHelp"></param>
+	/// <param name="labels"></param>
+	/// <param name="buckets">bucket boundaries</param>
+	/// <returns>return null if exporter was not enabled</returns>
+	std::shared_ptr<HistogramMetric> createPromHistogram(const std::string &metricName, const std::string &metricHelp, const std::map<std::string, std::string> &labels, const std::vector<double> &buckets) noexcept(false);
 
 	/// <summary>
 	/// Collect all metrics
@@ -121,6 +168,12 @@ protected:
 	/// <param name="restFunctions"></param>
 	virtual void handleRest(const HttpRequest &message, const std::map<std::string, std::function<void(const HttpRequest &)>> &restFunctions) override;
 
+protected:
+	// REST requests not replied yet
+	std::shared_ptr<GaugeMetric> m_restInflightGauge;
+	// TCP REST task queue depth
+	std::shared_ptr<GaugeMetric> m_restQueueDepthGauge;
+
 private:
 	/// <summary>
 	/// REST API function
@@ -131,6 +184,19 @@ private:
 	/// Create metrics
 	/// </summary>
 	void initMetrics();
+	/// <summary>
+	/// Observe REST latency histograms for matched route
+	/// </summary>
+	/// <param name="message"></param>
+	/// <param name="handleStart">handleRest() start time</param>
+	void observeRestLatency(const HttpRequest &message, int64_t handleStart);
+	/// <summary>
+	/// Get or create latency histograms for route and method
+	/// </summary>
+	/// <param name="method"></param>
+	/// <param name="route"></param>
+	/// <returns></returns>
+	std::shared_ptr<RestRouteMetric> getRestRouteMetric(const std::string &method, const std::string &route);
 
 private:
 	bool m_promEnabled;
@@ -152,6 +218,11 @@ private:
 	std::shared_ptr<CounterMetric> m_restPostCounter;
 	std::shared_ptr<GaugeMetric> m_appmeshFileDesc;
 
+	// prometheus rest latency histogram metric, key: method + route
+	bool m_restLatencyEnabled;
+	std::map<std::string, std::shared_ptr<RestRouteMetric>> m_restRouteMetrics;
+	std::mutex m_restRouteMetricsMutex;
+
 public:
 	static std::shared_ptr<PrometheusRest> instance() { return m_instance; }
 	static void instance(std::shared_ptr<PrometheusRest> instance) { m_instance = instance; };
@@ -163,6 +234,12 @@ public:
 			counter->metric().Increment(); \
 	}
 
+#define PROM_GAUGE_SET(gauge, value)       \
+	{                                      \
+		if (gauge)                         \
+			gauge->metric().Set(value);    \
+	}
+
 // Prometheus scrap counter
 #define PROM_METRIC_NAME_appmesh_prom_scrape_count "appmesh_prom_scrape_count"
 #define PROM_METRIC_HELP_appmesh_prom_scrape_count "prometheus scrape count"
@@ -175,6 +252,26 @@ public:
 // App Mesh HTTP request count
 #define PROM_METRIC_NAME_appmesh_http_request_count "appmesh_http_request_count"
 #define PROM_METRIC_HELP_appmesh_http_request_count "app mesh http request count"
+// App Mesh HTTP request latency
+#define PROM_METRIC_NAME_appmesh_http_request_latency_seconds "appmesh_http_request_latency_seconds"
+#define PROM_METRIC_HELP_appmesh_http_request_latency_seconds "app mesh http request latency from REST process receive to handler finish"
+#define PROM_METRIC_NAME_appmesh_http_request_transit_seconds "appmesh_http_request_transit_seconds"
+#define PROM_METRIC_HELP_appmesh_http_request_transit_seconds "app mesh http request transit time from REST process to TCP server"
+#define PROM_METRIC_NAME_appmesh_http_request_queue_seconds "appmesh_http_request_queue_seconds"
+#define PROM_METRIC_HELP_appmesh_http_request_queue_seconds "app mesh http request wait time in TCP server queue"
+#define PROM_METRIC_NAME_appmesh_http_request_handler_seconds "appmesh_http_request_handler_seconds"
+#define PROM_METRIC_HELP_appmesh_http_request_handler_seconds "app mesh http request handler execution time"
+// App Mesh HTTP request in-flight
+#define PROM_METRIC_NAME_appmesh_http_request_inflight "appmesh_http_request_inflight"
+#define PROM_METRIC_HELP_appmesh_http_request_inflight "app mesh http request forwarded and not replied"
+// App Mesh HTTP request queue depth
+#define PROM_METRIC_NAME_appmesh_http_request_queue_depth "appmesh_http_request_queue_depth"
+#define PROM_METRIC_HELP_appmesh_http_request_queue_depth "app mesh http request pending in TCP server queue"
+// App Mesh HTTP response compression (REST process)
+#define PROM_METRIC_NAME_appmesh_http_response_compressed_count "appmesh_http_response_compressed_count"
+#define PROM_METRIC_HELP_appmesh_http_response_compressed_count "app mesh http response compressed count"
+#define PROM_METRIC_NAME_appmesh_http_response_compress_bytes "appmesh_http_response_compress_bytes"
+#define PROM_METRIC_HELP_appmesh_http_response_compress_bytes "app mesh http response bytes before (input) and after (output) compression"
 // Application process start count
 #define PROM_METRIC_NAME_appmesh_prom_process_start_count "appmesh_prom_process_start_count"
 #define PROM_METRIC_HELP_appmesh_prom_process_start_count "application process spawn count"
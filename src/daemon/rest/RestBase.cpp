@@ -6,6 +6,8 @@
 #include "../../common/jwt-cpp/jwt.h"
 #include "../Configuration.h"
 #include "../security/Security.h"
+#include "../security/TokenCache.h"
+#include "AdmissionControl.h"
 #include "HttpRequest.h"
 #include "RestBase.h"
 #include "RestChildObject.h"
@@ -94,6 +96,7 @@ void RestBase::handleRest(const HttpRequest &message, const std::map<std::string
         {
             findRest = true;
             stdFunction = kvp.second;
+            message.m_matchedRoute = kvp.first;
             break;
         }
     }
@@ -102,6 +105,11 @@ void RestBase::handleRest(const HttpRequest &message, const std::map<std::string
         message.reply(status_codes::NotFound, convertText2Json("Path not found"));
         return;
     }
+    if (!admitRequest(message))
+    {
+        replyTooManyRequests(message, "Request rate limit exceeded");
+        return;
+    }
 
     try
     {
@@ -131,6 +139,35 @@ void RestBase::handleRest(const HttpRequest &message, const std::map<std::string
     }
 }
 
+bool RestBase::admitRequest(const HttpRequest &message)
+{
+    if (!AdmissionControl::instance()->rateLimitEnabled())
+    {
+        return true;
+    }
+
+    std::string userName;
+    if (Configuration::instance()->getJwtEnabled())
+    {
+        try
+        {
+            userName = verifyAndCacheToken(getJwtToken(message))->m_userName;
+        }
+        catch (...)
+        {
+            // unauthenticated request limited by remote address
+        }
+    }
+    return AdmissionControl::instance()->admitRequest(userName, message.m_remote_address);
+}
+
+void RestBase::replyTooManyRequests(const HttpRequest &message, const std::string &msg)
+{
+    web::http::http_response resp(HTTP_STATUS_TOO_MANY_REQUESTS);
+    resp.headers().add(HTTP_HEADER_KEY_retry_after, 1);
+    message.reply(resp, convertText2Json(msg).serialize(), CONTENT_TYPE_APPLICATION_JSON);
+}
+
 void RestBase::bindRestMethod(const web::http::method &method, const std::string &path, std::function<void(const HttpRequest &)> func)
 {
     const static char fname[] = "RestHandler::bindRest() ";
@@ -236,7 +273,19 @@ void RestBase::tranverseJsonTree(web::json::value &val)
 
 const std::tuple<std::string, std::string> RestBase::verifyToken(const HttpRequest &message)
 {
-    const auto token = getJwtToken(message);
+    const auto entry = verifyAndCacheToken(getJwtToken(message));
+    return std::make_tuple(entry->m_userName, entry->m_userGroup);
+}
+
+const std::shared_ptr<const TokenCacheEntry> RestBase::verifyAndCacheToken(const std::string &token)
+{
+    // hot path: verified token cache
+    auto entry = TokenCache::instance()->get(token);
+    if (entry)
+    {
+        return entry;
+    }
+
     const auto decoded_token = jwt::decode(token);
     if (decoded_token.has_payload_claim(HTTP_HEADER_JWT_name))
     {
@@ -260,7 +309,12 @@ const std::tuple<std::string, std::string> RestBase::verifyToken(const HttpReque
 
         verifier.verify(decoded_token);
 
-        return std::make_tuple(userName.as_string(), userGroup.as_string());
+        // cache verified token with compiled permission mask
+        const auto expireTime = decoded_token.has_expires_at() ? decoded_token.get_expires_at() : std::chrono::system_clock::time_point::max();
+        const auto permissions = Security::instance()->getUserPermissionMask(userName.as_string(), userGroup.as_string());
+        entry = std::make_shared<TokenCacheEntry>(token, userName.as_string(), userGroup.as_string(), expireTime, permissions);
+        TokenCache::instance()->put(entry);
+        return entry;
     }
     else
     {
@@ -271,6 +325,11 @@ const std::tuple<std::string, std::string> RestBase::verifyToken(const HttpReque
 const std::string RestBase::getJwtUserName(const HttpRequest &message)
 {
     const auto token = getJwtToken(message);
+    const auto entry = TokenCache::instance()->get(token);
+    if (entry)
+    {
+        return entry->m_userName;
+    }
     const auto decoded_token = jwt::decode(token);
     if (decoded_token.has_payload_claim(HTTP_HEADER_JWT_name))
     {
@@ -293,11 +352,13 @@ bool RestBase::permissionCheck(const HttpRequest &message, const std::string &pe
         return true;
     }
 
-    const auto result = verifyToken(message);
-    const auto userName = std::get<0>(result);
-    const auto groupName = std::get<1>(result);
-    // check user role permission
-    if (Security::instance()->getUserPermissions(userName, groupName).count(permission))
+    const auto token = verifyAndCacheToken(getJwtToken(message));
+    const auto &userName = token->m_userName;
+    // check user role permission: bit test for known permission, role walk for customized permission
+    const auto permissionBit = Security::permissionBit(permission);
+    const bool granted = (permissionBit >= 0) ? token->hasPermission(permissionBit)
+                                              : Security::instance()->getUserPermissions(userName, token->m_userGroup).count(permission) > 0;
+    if (granted)
     {
         LOG_DBG << fname << "authentication success for remote: " << message.m_remote_address << " with user : " << userName << " and permission : " << permission;
         return true;
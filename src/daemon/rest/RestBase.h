@@ -6,6 +6,7 @@
 #include <cpprest/http_listener.h> // HTTP server
 
 class HttpRequest;
+struct TokenCacheEntry;
 
 /// <summary>
 /// REST Base class, provide:
@@ -50,9 +51,21 @@ protected:
     void handle_post(const HttpRequest &message);
     void handle_delete(const HttpRequest &message);
     void handle_options(const HttpRequest &message);
+    /// <summary>
+    /// Rate limit check by JWT user (remote address for unauthenticated request)
+    /// </summary>
+    /// <param name="message"></param>
+    /// <returns>false if request should be rejected</returns>
+    bool admitRequest(const HttpRequest &message);
+    /// <summary>
+    /// Reply 429 with Retry-After header
+    /// </summary>
+    void replyTooManyRequests(const HttpRequest &message, const std::string &msg);
 
     // tuple: username, usergroup
     const std::tuple<std::string, std::string> verifyToken(const HttpRequest &message);
+    // verify token from TokenCache first, decode and verify signature for cache miss
+    const std::shared_ptr<const TokenCacheEntry> verifyAndCacheToken(const std::string &token);
     const std::string getJwtUserName(const HttpRequest &message);
     bool permissionCheck(const HttpRequest &message, const std::string &permission);
     const std::string getJwtToken(const HttpRequest &message);
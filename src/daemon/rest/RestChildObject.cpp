@@ -4,12 +4,28 @@
 #include <ace/SOCK_Stream.h>
 
 #include "../../common/Utility.h"
+#include "../../prom_exporter/counter.h"
+#include "../../prom_exporter/registry.h"
+#include "../../prom_exporter/text_serializer.h"
+#include "../Configuration.h"
+#include "PrometheusRest.h"
 #include "RestChildObject.h"
 
 std::shared_ptr<RestChildObject> RestChildObject::m_instance = nullptr;
 RestChildObject::RestChildObject()
-    : RestHandler(true)
+    : RestHandler(true), m_compressionEnabled(Configuration::instance()->getCompressionLevel() > 0)
 {
+    if (Configuration::instance()->getPromListenPort())
+    {
+        // REST child process own metrics, daemon registry is the one scraped
+        m_childPromRegistry = std::make_shared<prometheus::Registry>();
+        m_compressCounter = std::make_shared<CounterMetric>(m_childPromRegistry,
+                                                            PROM_METRIC_NAME_appmesh_http_response_compressed_count, PROM_METRIC_HELP_appmesh_http_response_compressed_count, std::map<std::string, std::string>());
+        m_compressInputBytes = std::make_shared<CounterMetric>(m_childPromRegistry,
+                                                               PROM_METRIC_NAME_appmesh_http_response_compress_bytes, PROM_METRIC_HELP_appmesh_http_response_compress_bytes, std::map<std::string, std::string>{{"stage", "input"}});
+        m_compressOutputBytes = std::make_shared<CounterMetric>(m_childPromRegistry,
+                                                                PROM_METRIC_NAME_appmesh_http_response_compress_bytes, PROM_METRIC_HELP_appmesh_http_response_compress_bytes, std::map<std::string, std::string>{{"stage", "output"}});
+    }
 }
 
 RestChildObject::~RestChildObject()
@@ -64,6 +80,7 @@ void RestChildObject::sendRequest2Server(const HttpRequest &message)
 {
     const static char fname[] = "RestChildObject::sendRequest2Server() ";
 
+    message.m_forwardTime = HttpRequest::monotonicNanoseconds();
     IoVector io(message.serialize());
     auto msgLength = io.length();
 
@@ -88,54 +105,115 @@ void RestChildObject::replyResponse(ACE_Message_Block *response)
     auto respData = HttpTcpResponse::deserialize(cdrData);
     if (respData)
     {
-        std::lock_guard<std::recursive_mutex> guard(m_mutex);
-        if (m_sentMessages.count(respData->m_uuid))
+        std::shared_ptr<HttpRequest> msg;
         {
-            auto &msg = m_sentMessages.find(respData->m_uuid)->second;
-            web::http::http_response resp(respData->m_status);
-            resp.set_status_code(respData->m_status);
-            if (respData->m_bodyType == CONTENT_TYPE_APPLICATION_JSON && respData->m_body.length())
-            {
-                try
-                {
-                    resp.set_body(web::json::value::parse(respData->m_body));
-                }
-                catch (...)
-                {
-                    LOG_ERR << fname << "failed to parse body to JSON :" << respData->m_body;
-                    resp.set_body(respData->m_body);
-                }
-            }
-            else
+            std::lock_guard<std::recursive_mutex> guard(m_mutex);
+            auto iter = m_sentMessages.find(respData->m_uuid);
+            if (iter != m_sentMessages.end())
             {
-                resp.set_body(respData->m_body);
-            }
-            for (const auto &h : respData->m_headers)
-            {
-                resp.headers().add(h.first, h.second);
+                msg = std::make_shared<HttpRequest>(iter->second);
+                m_sentMessages.erase(iter);
+                LOG_DBG << fname << "reply message: " << respData->m_uuid << " left pending request size: " << m_sentMessages.size();
             }
+        }
+        if (msg)
+        {
+            // build (compress) and send response in REST worker thread, keep this socket read thread free
+            pplx::create_task([this, msg, respData]()
+                              { this->replyClient(*msg, *respData); });
+        }
+    }
+    else
+    {
+        LOG_ERR << fname << "deserialize response failed, failed to reply to client and clean related memory";
+    }
+}
+
+void RestChildObject::replyClient(const HttpRequest &msg, const HttpTcpResponse &respData)
+{
+    const static char fname[] = "RestChildObject::replyClient() ";
+
+    try
+    {
+        web::http::http_response resp(respData.m_status);
+        resp.set_status_code(respData.m_status);
+        auto body = respData.m_body;
+        if (m_childPromRegistry && respData.m_status == web::http::status_codes::OK &&
+            (msg.m_relative_uri == "/metrics" || msg.m_relative_uri == "/appmesh/metrics"))
+        {
+            // REST child process metrics are attached to daemon metrics
+            static auto promSerializer = std::unique_ptr<prometheus::Serializer>(new prometheus::TextSerializer());
+            body.append(promSerializer->Serialize(m_childPromRegistry->Collect()));
+        }
 
+        const auto encoding = selectEncoding(msg, respData, body);
+        if (encoding != HttpCompression::Encoding::IDENTITY)
+        {
+            const auto level = Configuration::instance()->getCompressionLevel();
+            auto compressed = HttpCompression::compress(body, encoding, level);
+            PROM_COUNTER_INCREASE(m_compressCounter);
+            if (m_compressInputBytes)
+                m_compressInputBytes->metric().Increment(body.size());
+            if (m_compressOutputBytes)
+                m_compressOutputBytes->metric().Increment(compressed.size());
+            LOG_DBG << fname << "compressed " << body.size() << " to " << compressed.size() << " with " << HttpCompression::name(encoding);
+            resp.set_body(std::move(compressed));
+            resp.headers().set_content_type(respData.m_bodyType.length() ? respData.m_bodyType : std::string("text/plain; charset=utf-8"));
+            resp.headers().add(web::http::header_names::content_encoding, HttpCompression::name(encoding));
+        }
+        else if (respData.m_bodyType == CONTENT_TYPE_APPLICATION_JSON && body.length())
+        {
             try
             {
-                msg.reply(resp);
-            }
-            catch (const std::exception &e)
-            {
-                LOG_ERR << fname << "reply to client failed: " << e.what();
+                resp.set_body(web::json::value::parse(body));
             }
             catch (...)
             {
-                LOG_ERR << fname << "reply to client failed";
+                LOG_ERR << fname << "failed to parse body to JSON :" << body;
+                resp.set_body(body);
             }
-
-            m_sentMessages.erase(respData->m_uuid);
-            LOG_DBG << fname << "reply message success: " << respData->m_uuid << " left pending request size: " << m_sentMessages.size();
         }
+        else
+        {
+            resp.set_body(body);
+        }
+        if (m_compressionEnabled)
+        {
+            resp.headers().add(web::http::header_names::vary, "Accept-Encoding");
+        }
+        for (const auto &h : respData.m_headers)
+        {
+            resp.headers().add(h.first, h.second);
+        }
+
+        msg.reply(resp);
     }
-    else
+    catch (const std::exception &e)
     {
-        LOG_ERR << fname << "deserialize response failed, failed to reply to client and clean related memory";
+        LOG_ERR << fname << "reply to client failed: " << e.what();
+    }
+    catch (...)
+    {
+        LOG_ERR << fname << "reply to client failed";
+    }
+}
+
+HttpCompression::Encoding RestChildObject::selectEncoding(const HttpRequest &msg, const HttpTcpResponse &respData, const std::string &body) const
+{
+    if (!m_compressionEnabled ||
+        body.size() < static_cast<std::size_t>(Configuration::instance()->getCompressionMinSize()) ||
+        respData.m_headers.count(web::http::header_names::content_encoding) ||
+        respData.m_status == web::http::status_codes::NotModified ||
+        respData.m_status == web::http::status_codes::NoContent)
+    {
+        return HttpCompression::Encoding::IDENTITY;
+    }
+    // use cpprest headers for case-insensitive lookup
+    if (!msg.headers().has(web::http::header_names::accept_encoding))
+    {
+        return HttpCompression::Encoding::IDENTITY;
     }
+    return HttpCompression::negotiate(msg.headers().find(web::http::header_names::accept_encoding)->second);
 }
 
 ACE_Message_Block *RestChildObject::readMessageBlock(const ACE_SOCK_Stream &socket)
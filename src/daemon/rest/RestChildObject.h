@@ -9,9 +9,16 @@
 #include <ace/SOCK_Connector.h>
 #include <ace/SOCK_Stream.h>
 
+#include "HttpCompression.h"
 #include "HttpRequest.h"
 #include "RestHandler.h"
 
+class CounterMetric;
+namespace prometheus
+{
+    class Registry;
+}
+
 /// <summary>
 /// REST Server Object, forward http REST request to TCP Server side
 /// </summary>
@@ -49,10 +56,23 @@ public:
     /// <returns></returns>
     static ACE_Message_Block *readMessageBlock(const ACE_SOCK_Stream &socket);
 
+private:
+    /// <summary>
+    /// Build response from TCP response and reply to REST client, compress body when client accept
+    /// </summary>
+    void replyClient(const HttpRequest &msg, const HttpTcpResponse &respData);
+    HttpCompression::Encoding selectEncoding(const HttpRequest &msg, const HttpTcpResponse &respData, const std::string &body) const;
+
 private:
     ACE_SOCK_Stream m_socketStream;
     // key: message uuid; value: message
     std::map<std::string, HttpRequest> m_sentMessages;
     mutable std::recursive_mutex m_mutex;
     static std::shared_ptr<RestChildObject> m_instance;
+
+    const bool m_compressionEnabled;
+    std::shared_ptr<prometheus::Registry> m_childPromRegistry;
+    std::shared_ptr<CounterMetric> m_compressCounter;
+    std::shared_ptr<CounterMetric> m_compressInputBytes;
+    std::shared_ptr<CounterMetric> m_compressOutputBytes;
 };
@@ -1,6 +1,7 @@
 #include <chrono>
 
 #include <boost/algorithm/string_regex.hpp>
+#include <cpprest/containerstream.h>
 #include <cpprest/filestream.h>
 #include <cpprest/http_listener.h> // HTTP server
 
@@ -8,13 +9,18 @@
 #include "../../common/Utility.h"
 #include "../../common/os/chown.hpp"
 #include "../../common/os/linux.hpp"
+#include "../ConfigJournal.h"
 #include "../Configuration.h"
 #include "../Label.h"
 #include "../ResourceCollection.h"
+#include "../application/AppFilter.h"
+#include "../application/EventBus.h"
 #include "../application/Application.h"
 #include "../consul/ConsulConnection.h"
 #include "../security/Security.h"
 #include "../security/User.h"
+#include "AdmissionControl.h"
+#include "FileTransfer.h"
 #include "HttpRequest.h"
 #include "PrometheusRest.h"
 #include "RestHandler.h"
@@ -28,6 +34,7 @@ constexpr auto REST_PATH_APP_VIEW = R"(/appmesh/app/([^/\*]+))";
 constexpr auto REST_PATH_APP_OUT_VIEW = R"(/appmesh/app/([^/\*]+)/output)";
 constexpr auto REST_PATH_APP_ALL_VIEW = "/appmesh/applications";
 constexpr auto REST_PATH_APP_HEALTH = R"(/appmesh/app/([^/\*]+)/health)";
+constexpr auto REST_PATH_APP_EVENTS = "/appmesh/events";
 
 // 3. Cloud Application
 constexpr auto REST_PATH_CLOUD_APP_VIEW = "/appmesh/cloud/applications";
@@ -40,6 +47,7 @@ constexpr auto REST_PATH_APP_ADD = R"(/appmesh/app/([^/\*]+))";
 constexpr auto REST_PATH_APP_ENABLE = R"(/appmesh/app/([^/\*]+)/enable)";
 constexpr auto REST_PATH_APP_DISABLE = R"(/appmesh/app/([^/\*]+)/disable)";
 constexpr auto REST_PATH_APP_DELETE = R"(/appmesh/app/([^/\*]+))";
+constexpr auto REST_PATH_APP_BATCH = "/appmesh/applications/batch";
 
 // 5. Operate Application
 constexpr auto REST_PATH_APP_RUN_ASYNC = "/appmesh/app/run";
@@ -87,6 +95,7 @@ RestHandler::RestHandler(bool forward2TcpServer) : PrometheusRest(forward2TcpSer
 	bindRestMethod(web::http::methods::GET, REST_PATH_APP_OUT_VIEW, std::bind(&RestHandler::apiAppOutputView, this, std::placeholders::_1));
 	bindRestMethod(web::http::methods::GET, REST_PATH_APP_ALL_VIEW, std::bind(&RestHandler::apiAppsView, this, std::placeholders::_1));
 	bindRestMethod(web::http::methods::GET, REST_PATH_APP_HEALTH, std::bind(&RestHandler::apiHealth, this, std::placeholders::_1));
+	bindRestMethod(web::http::methods::GET, REST_PATH_APP_EVENTS, std::bind(&RestHandler::apiAppEvents, this, std::placeholders::_1));
 
 	// 3. Cloud Application
 	bindRestMethod(web::http::methods::GET, REST_PATH_CLOUD_APP_VIEW, std::bind(&RestHandler::apiCloudAppsView, this, std::placeholders::_1));
@@ -99,6 +108,7 @@ RestHandler::RestHandler(bool forward2TcpServer) : PrometheusRest(forward2TcpSer
 	bindRestMethod(web::http::methods::POST, REST_PATH_APP_ENABLE, std::bind(&RestHandler::apiAppEnable, this, std::placeholders::_1));
 	bindRestMethod(web::http::methods::POST, REST_PATH_APP_DISABLE, std::bind(&RestHandler::apiAppDisable, this, std::placeholders::_1));
 	bindRestMethod(web::http::methods::DEL, REST_PATH_APP_DELETE, std::bind(&RestHandler::apiAppDelete, this, std::placeholders::_1));
+	bindRestMethod(web::http::methods::POST, REST_PATH_APP_BATCH, std::bind(&RestHandler::apiAppsBatch, this, std::placeholders::_1));
 
 	// 5. Operate Application
 	bindRestMethod(web::http::methods::POST, REST_PATH_APP_RUN_ASYNC, std::bind(&RestHandler::apiRunAsync, this, std::placeholders::_1));
@@ -107,6 +117,7 @@ RestHandler::RestHandler(bool forward2TcpServer) : PrometheusRest(forward2TcpSer
 	// 6. File Management
 	bindRestMethod(web::http::methods::GET, REST_PATH_FILE_DOWNLOAD, std::bind(&RestHandler::apiFileDownload, this, std::placeholders::_1));
 	bindRestMethod(web::http::methods::POST, REST_PATH_FILE_UPLOAD, std::bind(&RestHandler::apiFileUpload, this, std::placeholders::_1));
+	bindRestMethod(web::http::methods::GET, REST_PATH_FILE_UPLOAD, std::bind(&RestHandler::apiFileUploadStatus, this, std::placeholders::_1));
 
 	// 7. Label Management
 	bindRestMethod(web::http::methods::GET, REST_PATH_LABEL_VIEW_ALL, std::bind(&RestHandler::apiLabelsView, this, std::placeholders::_1));
@@ -359,6 +370,54 @@ void RestHandler::apiAppDelete(const HttpRequest &message)
 	message.reply(status_codes::OK, convertText2Json(Utility::stringFormat("Application <%s> removed.", appName.c_str())));
 }
 
+void RestHandler::apiAppsBatch(const HttpRequest &message)
+{
+	auto operations = message.extractJson();
+	if (!operations.is_array())
+	{
+		throw std::invalid_argument("batch operations should be JSON array");
+	}
+
+	// same permission check with single application API
+	auto validator = [this, &message](const std::string &action, const std::string &appName, web::json::value &operation)
+	{
+		const bool exist = Configuration::instance()->isAppExist(appName);
+		if (action == JSON_KEY_BATCH_action_add)
+		{
+			permissionCheck(message, PERMISSION_KEY_app_reg);
+			if (exist && Configuration::instance()->getApp(appName)->isCloudApp())
+			{
+				throw std::invalid_argument("Cloud Application is not allowed to override");
+			}
+			if (HAS_JSON_FIELD(operation, JSON_KEY_BATCH_app))
+				operation[JSON_KEY_BATCH_app][JSON_KEY_APP_owner] = web::json::value::string(getJwtUserName(message));
+		}
+		else if (action == JSON_KEY_BATCH_action_enable || action == JSON_KEY_BATCH_action_disable)
+		{
+			permissionCheck(message, PERMISSION_KEY_app_control);
+		}
+		else if (action == JSON_KEY_BATCH_action_remove)
+		{
+			auto app = Configuration::instance()->getApp(appName);
+			if (app->isCloudApp())
+			{
+				throw std::invalid_argument("not allowed for cloud application");
+			}
+			if (!(app->getOwner() && Configuration::instance()->getJwtEnabled() && app->getOwner()->getName() == getJwtUserName(message)))
+			{
+				// only check delete permission for none-self app
+				permissionCheck(message, PERMISSION_KEY_app_delete);
+			}
+		}
+		if (exist)
+		{
+			checkAppAccessPermission(message, appName, true);
+		}
+	};
+
+	message.reply(status_codes::OK, Configuration::instance()->batchApps(operations, validator));
+}
+
 void RestHandler::apiFileDownload(const HttpRequest &message)
 {
 	const static char fname[] = "RestHandler::apiFileDownload() ";
@@ -376,20 +435,36 @@ void RestHandler::apiFileDownload(const HttpRequest &message)
 		return;
 	}
 
-	LOG_DBG << fname << "Downloading file <" << file << ">";
+	const auto stat = FileTransfer::fileStat(file);
+	const auto fileSize = stat.first;
+	const auto &etag = stat.second;
+	std::size_t start = 0, length = fileSize;
+	bool partial = false;
+	if (!FileTransfer::resolveRange(message.m_headers, etag, fileSize, start, length, partial))
+	{
+		web::http::http_response resp(status_codes::RangeNotSatisfiable);
+		resp.headers().add(HTTP_HEADER_KEY_content_range, Utility::stringFormat("bytes */%zu", fileSize));
+		message.reply(resp, convertText2Json("range not satisfiable").serialize(), CONTENT_TYPE_APPLICATION_JSON);
+		return;
+	}
+
+	LOG_DBG << fname << "Downloading file <" << file << "> offset <" << start << "> length <" << length << ">";
 
 	concurrency::streams::fstream::open_istream(file, std::ios::in | std::ios::binary)
 		.then([=](concurrency::streams::istream fileStream)
 			  {
-				  // Get the content length, which is used to set the
-				  // Content-Length property
-				  fileStream.seek(0, std::ios::end);
-				  auto length = static_cast<std::size_t>(fileStream.tell());
-				  fileStream.seek(0, std::ios::beg);
+				  // only read requested range from file stream
+				  fileStream.seek(start, std::ios::beg);
 				  auto fileInfo = os::fileStat(file);
 
-				  web::http::http_response resp(status_codes::OK);
+				  web::http::http_response resp(partial ? status_codes::PartialContent : status_codes::OK);
 				  resp.set_body(fileStream, length);
+				  resp.headers().add(HTTP_HEADER_KEY_accept_ranges, "bytes");
+				  resp.headers().add(HTTP_HEADER_KEY_etag, etag);
+				  if (partial)
+				  {
+					  resp.headers().add(HTTP_HEADER_KEY_content_range, Utility::stringFormat("bytes %zu-%zu/%zu", start, start + length - 1, fileSize));
+				  }
 				  resp.headers().add(HTTP_HEADER_KEY_file_mode, std::get<0>(fileInfo));
 				  resp.headers().add(HTTP_HEADER_KEY_file_user, std::get<1>(fileInfo));
 				  resp.headers().add(HTTP_HEADER_KEY_file_group, std::get<2>(fileInfo));
@@ -427,12 +502,58 @@ void RestHandler::apiFileUpload(const HttpRequest &message)
 		return;
 	}
 
-	LOG_DBG << fname << "Uploading file <" << file << ">";
+	std::size_t fileSize = 0;
+	if (message.m_headers.count(HTTP_HEADER_KEY_upload_offset))
+	{
+		// chunked upload
+		if (message.m_headers.count(HTTP_HEADER_KEY_file_size) == 0)
+		{
+			message.reply(status_codes::BadRequest, convertText2Json("header 'File-Size' not found"));
+			return;
+		}
+		const auto offset = std::stoull(message.m_headers.find(HTTP_HEADER_KEY_upload_offset)->second);
+		fileSize = std::stoull(message.m_headers.find(HTTP_HEADER_KEY_file_size)->second);
+		// check chunk size before buffer the body
+		utility::size64_t contentLength = 0;
+		if (!message.headers().match(web::http::header_names::content_length, contentLength))
+		{
+			message.reply(status_codes::LengthRequired, convertText2Json("header 'Content-Length' not found"));
+			return;
+		}
+		if (contentLength > FILE_TRANSFER_MAX_CHUNK_SIZE)
+		{
+			message.reply(status_codes::RequestEntityTooLarge, convertText2Json("chunk size exceed limitation"));
+			return;
+		}
+		concurrency::streams::container_buffer<std::vector<uint8_t>> chunk;
+		message.body().read_to_end(chunk).get();
+		const auto &data = chunk.collection();
+		const auto chunkData = reinterpret_cast<const char *>(data.data());
+		if (message.m_headers.count(HTTP_HEADER_KEY_upload_checksum) &&
+			message.m_headers.find(HTTP_HEADER_KEY_upload_checksum)->second != Utility::checksum(chunkData, data.size()))
+		{
+			message.reply(status_codes::PreconditionFailed, convertText2Json("chunk checksum mismatch"));
+			return;
+		}
+		const auto fileChecksum = message.m_headers.count(HTTP_HEADER_KEY_file_checksum) ? message.m_headers.find(HTTP_HEADER_KEY_file_checksum)->second : std::string();
+		LOG_DBG << fname << "Uploading file <" << file << "> chunk offset <" << offset << "> length <" << data.size() << ">";
+		if (!FileTransfer::writeChunk(file, offset, fileSize, fileChecksum, chunkData, data.size()))
+		{
+			web::http::http_response resp(status_codes::OK);
+			resp.headers().add(HTTP_HEADER_KEY_upload_complete, "false");
+			message.reply(resp, convertText2Json(Utility::stringFormat("Success upload chunk with size %s", Utility::humanReadableSize(data.size()).c_str())).serialize(), CONTENT_TYPE_APPLICATION_JSON);
+			return;
+		}
+	}
+	else
+	{
+		LOG_DBG << fname << "Uploading file <" << file << ">";
 
-	auto stream = concurrency::streams::fstream::open_ostream(file, std::ios::out | std::ios::binary | std::ios::trunc).get();
-	message.body().read_to_end(stream.streambuf()).get();
-	auto fileSize = stream.streambuf().size();
-	stream.close();
+		auto stream = concurrency::streams::fstream::open_ostream(file, std::ios::out | std::ios::binary | std::ios::trunc).get();
+		message.body().read_to_end(stream.streambuf()).get();
+		fileSize = stream.streambuf().size();
+		stream.close();
+	}
 	if (message.m_headers.count(HTTP_HEADER_KEY_file_mode))
 	{
 		os::fileChmod(file, std::stoi(message.m_headers.find(HTTP_HEADER_KEY_file_mode)->second));
@@ -443,7 +564,36 @@ void RestHandler::apiFileUpload(const HttpRequest &message)
 				  std::stoi(message.m_headers.find(HTTP_HEADER_KEY_file_group)->second),
 				  file, false);
 	}
-	message.reply(status_codes::OK, convertText2Json(Utility::stringFormat("Success upload file with size %s", Utility::humanReadableSize(fileSize).c_str())));
+	web::http::http_response resp(status_codes::OK);
+	resp.headers().add(HTTP_HEADER_KEY_upload_complete, "true");
+	message.reply(resp, convertText2Json(Utility::stringFormat("Success upload file with size %s", Utility::humanReadableSize(fileSize).c_str())).serialize(), CONTENT_TYPE_APPLICATION_JSON);
+}
+
+void RestHandler::apiFileUploadStatus(const HttpRequest &message)
+{
+	permissionCheck(message, PERMISSION_KEY_file_upload);
+	if (!(message.headers().has(HTTP_HEADER_KEY_file_path)))
+	{
+		message.reply(status_codes::BadRequest, convertText2Json("header 'File-Path' not found"));
+		return;
+	}
+	const auto file = message.headers().find(HTTP_HEADER_KEY_file_path)->second;
+
+	std::size_t fileSize = 0;
+	std::string fileChecksum;
+	auto received = web::json::value::array();
+	for (const auto &range : FileTransfer::receivedRanges(file, fileSize, fileChecksum))
+	{
+		auto rangeJson = web::json::value::array(2);
+		rangeJson[0] = web::json::value::number(static_cast<uint64_t>(range.first));
+		rangeJson[1] = web::json::value::number(static_cast<uint64_t>(range.second));
+		received[received.size()] = rangeJson;
+	}
+	auto result = web::json::value::object();
+	result[JSON_KEY_FILE_size] = web::json::value::number(static_cast<uint64_t>(fileSize));
+	result[JSON_KEY_FILE_checksum] = web::json::value::string(fileChecksum);
+	result[JSON_KEY_FILE_received] = received;
+	message.reply(status_codes::OK, result);
 }
 
 void RestHandler::apiLabelsView(const HttpRequest &message)
@@ -465,7 +615,7 @@ void RestHandler::apiLabelAdd(const HttpRequest &message)
 		auto value = GET_STD_STRING(querymap.find(U(HTTP_QUERY_KEY_label_value))->second);
 
 		Configuration::instance()->getLabel()->addLabel(labelKey, value);
-		Configuration::instance()->saveConfigToDisk();
+		ConfigJournal::instance()->appendLabel(labelKey, value);
 
 		message.reply(status_codes::OK);
 	}
@@ -483,7 +633,7 @@ void RestHandler::apiLabelDel(const HttpRequest &message)
 	auto labelKey = regexSearch(path, REST_PATH_LABEL_DELETE);
 
 	Configuration::instance()->getLabel()->delLabel(labelKey);
-	Configuration::instance()->saveConfigToDisk();
+	ConfigJournal::instance()->appendLabelRemove(labelKey);
 
 	message.reply(status_codes::OK);
 }
@@ -524,11 +674,23 @@ void RestHandler::apiBasicConfigSet(const HttpRequest &message)
 	permissionCheck(message, PERMISSION_KEY_config_set);
 
 	auto json = message.extractJson();
-	Configuration::instance()->hotUpdate(json);
-
-	Configuration::instance()->saveConfigToDisk();
+	const auto diff = Configuration::instance()->hotUpdate(json);
+	const auto &changes = diff.at(JSON_KEY_CONFIG_DIFF_changed).as_array();
+	std::string changed;
+	for (const auto &change : changes)
+	{
+		changed += (changed.empty() ? "" : ",") + change.as_string();
+	}
+	// only write checkpoint when something changed
+	if (changes.size())
+	{
+		Configuration::instance()->saveConfigToDisk();
+	}
 
-	apiBasicConfigView(message);
+	permissionCheck(message, PERMISSION_KEY_config_view);
+	web::http::http_response resp(status_codes::OK);
+	resp.headers().add(HTTP_HEADER_KEY_config_changed, changed);
+	message.reply(resp, Configuration::instance()->AsJson(false, getJwtUserName(message)).serialize(), CONTENT_TYPE_APPLICATION_JSON);
 }
 
 void RestHandler::apiUserChangePwd(const HttpRequest &message)
@@ -879,11 +1041,26 @@ void RestHandler::apiRunAsync(const HttpRequest &message)
 	permissionCheck(message, PERMISSION_KEY_run_app_async);
 
 	int timeout = getHttpQueryValue(message, HTTP_QUERY_KEY_timeout, DEFAULT_RUN_APP_TIMEOUT_SECONDS, 1, 60 * 60 * 24);
-	auto appObj = parseAndRegRunApp(message);
-
-	if (timeout < 0)
-		timeout = MAX_RUN_APP_TIMEOUT_SECONDS;
-	auto processUuid = appObj->runAsyncrize(timeout);
+	if (!AdmissionControl::instance()->reserveRunSlot())
+	{
+		replyTooManyRequests(message, "Run application concurrency limit exceeded");
+		return;
+	}
+	std::shared_ptr<Application> appObj;
+	std::string processUuid;
+	try
+	{
+		appObj = parseAndRegRunApp(message);
+		if (timeout < 0)
+			timeout = MAX_RUN_APP_TIMEOUT_SECONDS;
+		processUuid = appObj->runAsyncrize(timeout);
+	}
+	catch (...)
+	{
+		AdmissionControl::instance()->cancelRunSlot();
+		throw;
+	}
+	AdmissionControl::instance()->commitRunSlot(appObj);
 	auto result = web::json::value::object();
 	result[JSON_KEY_APP_name] = web::json::value::string(appObj->getName());
 	result[HTTP_QUERY_KEY_process_uuid] = web::json::value::string(processUuid);
@@ -895,11 +1072,25 @@ void RestHandler::apiRunSync(const HttpRequest &message)
 	permissionCheck(message, PERMISSION_KEY_run_app_sync);
 
 	int timeout = getHttpQueryValue(message, HTTP_QUERY_KEY_timeout, DEFAULT_RUN_APP_TIMEOUT_SECONDS, 1, 60 * 60 * 24);
-	auto appObj = parseAndRegRunApp(message);
+	if (!AdmissionControl::instance()->reserveRunSlot())
+	{
+		replyTooManyRequests(message, "Run application concurrency limit exceeded");
+		return;
+	}
+	try
+	{
+		auto appObj = parseAndRegRunApp(message);
 
-	// Use async reply here
-	HttpRequest *asyncRequest = new HttpRequestWithAppRef(message, appObj);
-	appObj->runSyncrize(timeout, asyncRequest);
+		// Use async reply here
+		HttpRequest *asyncRequest = new HttpRequestWithAppRef(message, appObj);
+		appObj->runSyncrize(timeout, asyncRequest);
+		AdmissionControl::instance()->commitRunSlot(appObj);
+	}
+	catch (...)
+	{
+		AdmissionControl::instance()->cancelRunSlot();
+		throw;
+	}
 }
 
 void RestHandler::apiAppOutputView(const HttpRequest &message)
@@ -938,7 +1129,48 @@ void RestHandler::apiAppsView(const HttpRequest &message)
 {
 	permissionCheck(message, PERMISSION_KEY_view_all_app);
 	auto tokenUserName = getJwtUserName(message);
-	message.reply(status_codes::OK, Configuration::instance()->serializeApplication(true, tokenUserName));
+	const auto ifNoneMatch = message.m_headers.count(HTTP_HEADER_KEY_if_none_match) ? message.m_headers.find(HTTP_HEADER_KEY_if_none_match)->second : std::string();
+	const auto querymap = web::uri::split_query(web::http::uri::decode(message.m_query));
+	const auto filter = AppFilter::FromQuery(std::map<std::string, std::string>(querymap.begin(), querymap.end()));
+	const auto result = Configuration::instance()->serializeApplicationCached(tokenUserName, ifNoneMatch, filter);
+	const auto &etag = std::get<0>(result);
+	const auto &body = std::get<1>(result);
+	const auto &nextCursor = std::get<2>(result);
+
+	web::http::http_response resp(body.empty() ? status_codes::NotModified : status_codes::OK);
+	resp.headers().add(HTTP_HEADER_KEY_etag, etag);
+	if (nextCursor.length())
+	{
+		resp.headers().add(HTTP_HEADER_KEY_next_cursor, nextCursor);
+	}
+	message.reply(resp, body, CONTENT_TYPE_APPLICATION_JSON);
+}
+
+void RestHandler::apiAppEvents(const HttpRequest &message)
+{
+	permissionCheck(message, PERMISSION_KEY_view_all_app);
+	const int timeout = getHttpQueryValue(message, HTTP_QUERY_KEY_timeout, DEFAULT_EVENT_WAIT_SECONDS, 0, MAX_EVENT_WAIT_SECONDS);
+	const auto cursorStr = getHttpQueryString(message, HTTP_QUERY_KEY_app_cursor);
+	if (cursorStr.length() && !Utility::isNumber(cursorStr))
+	{
+		throw std::invalid_argument(Utility::stringFormat("invalid cursor <%s>", cursorStr.c_str()));
+	}
+	const int64_t cursor = cursorStr.length() ? std::stoll(cursorStr) : -1;
+	const auto querymap = web::uri::split_query(web::http::uri::decode(message.m_query));
+	// events are filtered by application name and label only
+	for (const auto &query : {HTTP_QUERY_KEY_app_status, HTTP_QUERY_KEY_app_owner, HTTP_QUERY_KEY_app_fields, HTTP_QUERY_KEY_app_limit})
+	{
+		if (querymap.count(query))
+		{
+			throw std::invalid_argument(Utility::stringFormat("query <%s> is not supported for application events", query));
+		}
+	}
+	const auto filter = AppFilter::FromQuery(std::map<std::string, std::string>(querymap.begin(), querymap.end()));
+
+	// long poll: hold a copy of request and reply when matched events arrive or timeout
+	auto asyncRequest = std::make_shared<HttpRequest>(message);
+	EventBus::instance()->subscribe(filter, getJwtUserName(message), cursor, timeout, [asyncRequest](const web::json::value &events)
+									{ asyncRequest->reply(status_codes::OK, events); });
 }
 
 void RestHandler::apiCloudAppsView(const HttpRequest &message)
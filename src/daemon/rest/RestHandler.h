@@ -30,6 +30,7 @@ protected:
 	void apiAppView(const HttpRequest &message);
 	void apiAppOutputView(const HttpRequest &message);
 	void apiAppsView(const HttpRequest &message);
+	void apiAppEvents(const HttpRequest &message);
 
 	std::shared_ptr<Application> parseAndRegRunApp(const HttpRequest &message);
 	void apiRunAsync(const HttpRequest &message);
@@ -46,9 +47,11 @@ protected:
 	void apiAppEnable(const HttpRequest &message);
 	void apiAppDisable(const HttpRequest &message);
 	void apiAppDelete(const HttpRequest &message);
+	void apiAppsBatch(const HttpRequest &message);
 
 	void apiFileDownload(const HttpRequest &message);
 	void apiFileUpload(const HttpRequest &message);
+	void apiFileUploadStatus(const HttpRequest &message);
 
 	void apiLabelsView(const HttpRequest &message);
 	void apiLabelAdd(const HttpRequest &message);
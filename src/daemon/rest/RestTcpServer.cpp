@@ -1,4 +1,5 @@
 #include <atomic>
+#include <cstring>
 
 #include <ace/CDR_Stream.h>
 #include <ace/INET_Addr.h>
@@ -6,15 +7,17 @@
 #include <ace/SOCK_Stream.h>
 
 #include "../../common/Utility.h"
+#include "../../prom_exporter/gauge.h"
 #include "../Configuration.h"
 #include "../application/AppBehavior.h"
+#include "AdmissionControl.h"
 #include "HttpRequest.h"
 #include "RestChildObject.h"
 #include "RestHandler.h"
 #include "RestTcpServer.h"
 
 std::shared_ptr<RestTcpServer> RestTcpServer::m_instance = nullptr;
-RestTcpServer::RestTcpServer() : RestHandler(false)
+RestTcpServer::RestTcpServer() : RestHandler(false), m_inflightRequests(0)
 {
 }
 
@@ -57,15 +60,23 @@ int RestTcpServer::svc(void)
         ACE_Message_Block *msg;
         while (this->getq(msg) > -1)
         {
-            ACE_InputCDR cdr(msg);
+            const auto dequeueTime = HttpRequest::monotonicNanoseconds();
+            PROM_GAUGE_SET(m_restQueueDepthGauge, this->msg_queue()->message_count());
+            // first block is enqueue timestamp set by socketThread(), request payload is the continuation
+            int64_t enqueueTime = 0;
+            std::memcpy(&enqueueTime, msg->rd_ptr(), sizeof(enqueueTime));
+            ACE_InputCDR cdr(msg->cont());
             auto message = HttpRequest::deserialize(cdr);
             if (message)
             {
+                message->m_enqueueTime = enqueueTime;
+                message->m_dequeueTime = dequeueTime;
                 handleTcpRest(*message);
             }
             else
             {
                 LOG_ERR << fname << "message deserialize failed";
+                PROM_GAUGE_SET(m_restInflightGauge, --m_inflightRequests);
             }
             msg->release();
         }
@@ -90,13 +101,44 @@ void RestTcpServer::socketThread()
     {
         while (auto msg = RestChildObject::readMessageBlock(m_socketStream))
         {
-            this->putq(msg);
+            if (!AdmissionControl::instance()->admitQueue(this->msg_queue()->message_count()))
+            {
+                rejectQueueFull(msg);
+                continue;
+            }
+            const auto enqueueTime = HttpRequest::monotonicNanoseconds();
+            auto stamp = new ACE_Message_Block(sizeof(enqueueTime));
+            stamp->copy(reinterpret_cast<const char *>(&enqueueTime), sizeof(enqueueTime));
+            stamp->cont(msg);
+            PROM_GAUGE_SET(m_restInflightGauge, ++m_inflightRequests);
+            this->putq(stamp);
+            PROM_GAUGE_SET(m_restQueueDepthGauge, this->msg_queue()->message_count());
         }
         m_socketStream.close();
     }
     LOG_ERR << fname << "socket listhen thread exited";
 }
 
+void RestTcpServer::rejectQueueFull(ACE_Message_Block *msg)
+{
+    const static char fname[] = "RestTcpServer::rejectQueueFull() ";
+
+    ACE_InputCDR cdr(msg);
+    auto message = HttpRequest::deserialize(cdr);
+    msg->release();
+    if (message)
+    {
+        web::http::http_headers headers;
+        headers.add(HTTP_HEADER_KEY_retry_after, 1);
+        PROM_GAUGE_SET(m_restInflightGauge, ++m_inflightRequests);
+        backforwardResponse(message->m_uuid, convertText2Json("REST request queue is full").serialize(), headers, HTTP_STATUS_TOO_MANY_REQUESTS, CONTENT_TYPE_APPLICATION_JSON);
+    }
+    else
+    {
+        LOG_ERR << fname << "message deserialize failed";
+    }
+}
+
 void RestTcpServer::startTcpServer()
 {
     const static char fname[] = "RestTcpServer::startTcpServer() ";
@@ -139,6 +181,7 @@ void RestTcpServer::backforwardResponse(const std::string &uuid, const std::stri
     HttpTcpResponse resp(uuid, body, bodyType, stdHeaders, status);
     IoVector io(resp.serialize());
     auto msgLength = io.length();
+    PROM_GAUGE_SET(m_restInflightGauge, --m_inflightRequests);
 
     std::lock_guard<std::recursive_mutex> guard(m_socketSendLock);
     size_t sendSize = 0;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -66,6 +67,12 @@ private:
     /// </summary>
     void socketThread();
 
+    /// <summary>
+    /// Reply 429 for request when task queue is full
+    /// </summary>
+    /// <param name="msg"></param>
+    void rejectQueueFull(ACE_Message_Block *msg);
+
     /// <summary>
     /// Process TCP request
     /// </summary>
@@ -77,4 +84,6 @@ private:
     ACE_SOCK_Stream m_socketStream;
     static std::shared_ptr<RestTcpServer> m_instance;
     std::thread m_socketThread;
+    // requests received from REST process and not replied
+    std::atomic<int64_t> m_inflightRequests;
 };
@@ -1,9 +1,12 @@
+#include <unordered_map>
+
 #include <ace/OS.h>
 
 #include "../../common/Utility.h"
 #include "../Configuration.h"
 #include "./ldapplugin/LdapImpl.h"
 #include "Security.h"
+#include "TokenCache.h"
 
 std::shared_ptr<Security> Security::m_instance = nullptr;
 std::recursive_mutex Security::m_mutex;
@@ -47,6 +50,7 @@ void Security::instance(std::shared_ptr<Security> instance)
 {
     std::lock_guard<std::recursive_mutex> guard(m_mutex);
     m_instance = instance;
+    TokenCache::instance()->invalidateAll();
 }
 
 bool Security::encryptKey()
@@ -131,6 +135,66 @@ std::set<std::string> Security::getUserPermissions(const std::string &userName,
     return permissionSet;
 }
 
+uint64_t Security::getUserPermissionMask(const std::string &userName, const std::string &userGroup)
+{
+    uint64_t mask = 0;
+    for (const auto &perm : this->getUserPermissions(userName, userGroup))
+    {
+        const auto bit = permissionBit(perm);
+        if (bit >= 0)
+            mask |= (uint64_t(1) << bit);
+    }
+    return mask;
+}
+
+int Security::permissionBit(const std::string &permission)
+{
+    // fixed permission table, the index is the bit position in permission mask (max 64)
+    static const std::unordered_map<std::string, int> permissionBits = []()
+    {
+        const char *permissions[] = {
+            PERMISSION_KEY_view_app,
+            PERMISSION_KEY_view_app_output,
+            PERMISSION_KEY_view_all_app,
+            PERMISSION_KEY_cloud_app_view,
+            PERMISSION_KEY_cloud_app_reg,
+            PERMISSION_KEY_cloud_app_delete,
+            PERMISSION_KEY_cloud_host_view,
+            PERMISSION_KEY_view_host_resource,
+            PERMISSION_KEY_app_reg,
+            PERMISSION_KEY_app_control,
+            PERMISSION_KEY_app_delete,
+            PERMISSION_KEY_run_app_async,
+            PERMISSION_KEY_run_app_sync,
+            PERMISSION_KEY_run_app_async_output,
+            PERMISSION_KEY_file_download,
+            PERMISSION_KEY_file_upload,
+            PERMISSION_KEY_label_view,
+            PERMISSION_KEY_label_set,
+            PERMISSION_KEY_label_delete,
+            PERMISSION_KEY_loglevel,
+            PERMISSION_KEY_config_view,
+            PERMISSION_KEY_config_set,
+            PERMISSION_KEY_change_passwd,
+            PERMISSION_KEY_lock_user,
+            PERMISSION_KEY_unlock_user,
+            PERMISSION_KEY_add_user,
+            PERMISSION_KEY_delete_user,
+            PERMISSION_KEY_get_users,
+            PERMISSION_KEY_role_update,
+            PERMISSION_KEY_role_delete,
+            PERMISSION_KEY_role_view,
+            PERMISSION_KEY_permission_list};
+        std::unordered_map<std::string, int> bits;
+        for (std::size_t i = 0; i < ARRAY_LEN(permissions); i++)
+            bits[permissions[i]] = static_cast<int>(i);
+        return bits;
+    }();
+
+    const auto iter = permissionBits.find(permission);
+    return (iter != permissionBits.end()) ? iter->second : -1;
+}
+
 std::set<std::string> Security::getAllPermissions()
 {
     std::set<std::string> permissionSet;
@@ -147,7 +211,9 @@ void Security::changeUserPasswd(const std::string &userName, const std::string &
     auto user = this->getUserInfo(userName);
     if (user)
     {
-        return user->updateKey(newPwd);
+        user->updateKey(newPwd);
+        TokenCache::instance()->invalidateUser(userName);
+        return;
     }
     throw std::invalid_argument(Utility::stringFormat("user %s not exist", userName.c_str()));
 }
@@ -174,22 +240,28 @@ web::json::value Security::getRolesJson() const
 
 std::shared_ptr<User> Security::addUser(const std::string &userName, const web::json::value &userJson)
 {
-    return m_securityConfig->m_users->addUser(userName, userJson, m_securityConfig->m_roles);
+    auto user = m_securityConfig->m_users->addUser(userName, userJson, m_securityConfig->m_roles);
+    TokenCache::instance()->invalidateUser(userName);
+    return user;
 }
 
 void Security::delUser(const std::string &name)
 {
     m_securityConfig->m_users->delUser(name);
+    TokenCache::instance()->invalidateUser(name);
 }
 
 void Security::addRole(const web::json::value &obj, std::string name)
 {
     m_securityConfig->m_roles->addRole(obj, name);
+    // role permission change impact all users
+    TokenCache::instance()->invalidateAll();
 }
 
 void Security::delRole(const std::string &name)
 {
     m_securityConfig->m_roles->delRole(name);
+    TokenCache::instance()->invalidateAll();
 }
 
 std::set<std::string> Security::getAllUserGroups() const
@@ -44,6 +44,12 @@ public:
     virtual std::set<std::string> getAllUserGroups() const;
     virtual std::set<std::string> getUserPermissions(const std::string &userName, const std::string &userGroup);
     virtual std::set<std::string> getAllPermissions();
+    virtual uint64_t getUserPermissionMask(const std::string &userName, const std::string &userGroup);
+
+    /// <summary>
+    /// Bit index of a permission key in permission bitmask, -1 for unknown permission
+    /// </summary>
+    static int permissionBit(const std::string &permission);
 
 private:
     std::shared_ptr<JsonSecurity> m_securityConfig;
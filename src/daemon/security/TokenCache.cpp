@@ -0,0 +1,118 @@
+#include <functional>
+
+#include "../../common/Utility.h"
+#include "TokenCache.h"
+
+//////////////////////////////////////////////////////////////////////
+/// TokenCacheEntry
+//////////////////////////////////////////////////////////////////////
+TokenCacheEntry::TokenCacheEntry(const std::string &token, const std::string &userName, const std::string &userGroup,
+                                 const std::chrono::system_clock::time_point &expireTime, uint64_t permissions)
+    : m_token(token), m_userName(userName), m_userGroup(userGroup), m_expireTime(expireTime), m_permissions(permissions)
+{
+}
+
+bool TokenCacheEntry::hasPermission(int permissionBit) const
+{
+    return permissionBit >= 0 && permissionBit < 64 && (m_permissions & (uint64_t(1) << permissionBit));
+}
+
+//////////////////////////////////////////////////////////////////////
+/// TokenCache
+//////////////////////////////////////////////////////////////////////
+TokenCache::TokenCache(std::size_t capacity, int ttlSeconds)
+    : m_capacity(capacity), m_ttl(ttlSeconds)
+{
+}
+
+TokenCache::~TokenCache()
+{
+}
+
+std::shared_ptr<TokenCache> &TokenCache::instance()
+{
+    static auto singleton = std::make_shared<TokenCache>(DEFAULT_TOKEN_CACHE_SIZE, DEFAULT_TOKEN_CACHE_TTL_SECONDS);
+    return singleton;
+}
+
+std::shared_ptr<const TokenCacheEntry> TokenCache::get(const std::string &token)
+{
+    const auto key = std::hash<std::string>()(token);
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto iter = m_index.find(key);
+    if (iter == m_index.end())
+    {
+        return nullptr;
+    }
+    const auto entry = iter->second->m_entry;
+    // hash conflict, token expired or cache TTL reached
+    if (entry->m_token != token || std::chrono::system_clock::now() >= entry->m_expireTime ||
+        (m_ttl.count() > 0 && std::chrono::steady_clock::now() >= iter->second->m_deadline))
+    {
+        m_lruList.erase(iter->second);
+        m_index.erase(iter);
+        return nullptr;
+    }
+    // move to front
+    m_lruList.splice(m_lruList.begin(), m_lruList, iter->second);
+    return entry;
+}
+
+void TokenCache::put(std::shared_ptr<const TokenCacheEntry> entry)
+{
+    if (m_capacity == 0 || entry == nullptr)
+        return;
+
+    const auto key = std::hash<std::string>()(entry->m_token);
+    std::lock_guard<std::mutex> guard(m_mutex);
+    auto iter = m_index.find(key);
+    if (iter != m_index.end())
+    {
+        m_lruList.erase(iter->second);
+        m_index.erase(iter);
+    }
+    m_lruList.push_front(LruItem{key, entry, std::chrono::steady_clock::now() + m_ttl});
+    m_index[key] = m_lruList.begin();
+    // evict least recently used
+    while (m_lruList.size() > m_capacity)
+    {
+        m_index.erase(m_lruList.back().m_key);
+        m_lruList.pop_back();
+    }
+}
+
+void TokenCache::invalidateUser(const std::string &userName)
+{
+    const static char fname[] = "TokenCache::invalidateUser() ";
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (auto iter = m_lruList.begin(); iter != m_lruList.end();)
+    {
+        if (iter->m_entry->m_userName == userName)
+        {
+            m_index.erase(iter->m_key);
+            iter = m_lruList.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    LOG_DBG << fname << "token cache for user <" << userName << "> removed";
+}
+
+void TokenCache::invalidateAll()
+{
+    const static char fname[] = "TokenCache::invalidateAll() ";
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_index.clear();
+    m_lruList.clear();
+    LOG_DBG << fname << "token cache cleared";
+}
+
+std::size_t TokenCache::size() const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_lruList.size();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/// <summary>
+/// Verified JWT token information
+/// </summary>
+struct TokenCacheEntry
+{
+    explicit TokenCacheEntry(const std::string &token, const std::string &userName, const std::string &userGroup,
+                             const std::chrono::system_clock::time_point &expireTime, uint64_t permissions);
+    bool hasPermission(int permissionBit) const;
+
+    const std::string m_token;
+    const std::string m_userName;
+    const std::string m_userGroup;
+    const std::chrono::system_clock::time_point m_expireTime;
+    // compiled permission bitmask, bit index from Security::permissionBit()
+    const uint64_t m_permissions;
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// Bounded LRU cache for verified JWT token, keyed by token hash
+/// Avoid decode/verify signature and walk user roles for each REST request
+/// Each entry also live at most ttlSeconds (<= 0 means no TTL), permission
+/// change without invalidate hook (e.g. LDAP group) take effect after TTL
+//////////////////////////////////////////////////////////////////////////
+class TokenCache
+{
+public:
+    explicit TokenCache(std::size_t capacity, int ttlSeconds);
+    virtual ~TokenCache();
+    static std::shared_ptr<TokenCache> &instance();
+
+    /// <summary>
+    /// Get verified token, return nullptr if not cached or already expired
+    /// </summary>
+    std::shared_ptr<const TokenCacheEntry> get(const std::string &token);
+    void put(std::shared_ptr<const TokenCacheEntry> entry);
+
+    /// <summary>
+    /// Remove all tokens belong to the user, used for user lock/password change/user update
+    /// </summary>
+    void invalidateUser(const std::string &userName);
+    /// <summary>
+    /// Remove all tokens, used for role update and security reload
+    /// </summary>
+    void invalidateAll();
+    std::size_t size() const;
+
+private:
+    struct LruItem
+    {
+        std::size_t m_key;
+        std::shared_ptr<const TokenCacheEntry> m_entry;
+        std::chrono::steady_clock::time_point m_deadline;
+    };
+    typedef std::list<LruItem> LruList;
+
+    const std::size_t m_capacity;
+    const std::chrono::seconds m_ttl;
+    // most recently used at front
+    LruList m_lruList;
+    std::unordered_map<std::size_t, LruList::iterator> m_index;
+    mutable std::mutex m_mutex;
+};
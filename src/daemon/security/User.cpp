@@ -3,6 +3,7 @@
 
 #include "../../common/Utility.h"
 #include "Security.h"
+#include "TokenCache.h"
 #include "User.h"
 
 //////////////////////////////////////////////////////////////////////
@@ -172,11 +173,13 @@ std::shared_ptr<User> User::FromJson(const std::string &userName, const web::jso
 void User::lock()
 {
 	this->m_locked = true;
+	TokenCache::instance()->invalidateUser(m_name);
 }
 
 void User::unlock()
 {
 	this->m_locked = false;
+	TokenCache::instance()->invalidateUser(m_name);
 }
 
 void User::updateUser(std::shared_ptr<User> user)
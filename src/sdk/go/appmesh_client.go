@@ -238,6 +238,25 @@ func (r *Client) AddApp(app Application) (*Application, error) {
 	return nil, err
 }
 
+// Apply application operations in batch, server write configuration once
+func (r *Client) BatchApps(operations []BatchOperation) ([]BatchResult, error) {
+	body, err := json.Marshal(operations)
+	if err == nil {
+		raw, code, err := r.post("/appmesh/applications/batch", nil, nil, body)
+		if code == http.StatusOK {
+			results := []BatchResult{}
+			err = json.Unmarshal(raw, &results)
+			return results, err
+		} else {
+			if err != nil {
+				return nil, err
+			}
+			return nil, fmt.Errorf("HTTP error: %s", string(raw))
+		}
+	}
+	return nil, err
+}
+
 // Remote run application
 func (r *Client) Run(app Application, syncrize bool, maxExectimeSeconds int, asyncRetentionSeconds int) (int, error) {
 	appJson, err := json.Marshal(app)
@@ -347,6 +366,21 @@ type Application struct {
 	SecEnv        *Environments       `json:"sec_env"`
 }
 
+// Batch application operation, Action: add, enable, disable, remove
+type BatchOperation struct {
+	Action string       `json:"action"`
+	Name   string       `json:"name"`
+	App    *Application `json:"app,omitempty"`
+}
+
+// Batch application operation result
+type BatchResult struct {
+	Action  string `json:"action"`
+	Name    string `json:"name"`
+	Success bool   `json:"success"`
+	Message string `json:"message"`
+}
+
 // Behavior
 type Behavior struct {
 	Exit string `json:"exit"`
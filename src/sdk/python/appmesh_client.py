@@ -135,19 +135,77 @@ class AppMeshClient:
         resp = self.__request_http(AppMeshClient.Method.GET, path="/appmesh/app/{0}".format(app_name))
         return (resp.status_code == HTTPStatus.OK), resp.json()
 
-    def get_apps(self):
+    def get_apps(self, name_pattern=None, status=None, owner=None, label=None, fields=None):
         """
         Get all application JSON information
 
+        Parameters
+        ----------
+            name_pattern : str
+                Application name wildcards pattern, e.g. "web*"
+            status : str
+                Application status: "enabled" or "disabled"
+            owner : str
+                Application owner name
+            label : str
+                Application metadata key=value
+            fields : list
+                Only return specified fields, e.g. ["name", "status", "pid"]
+
         Returns
         -------
             Array of application JSON
                 The application JSON both contain static configuration and runtime infomation
                 Only return applications that the user have permissions
         """
-        resp = self.__request_http(AppMeshClient.Method.GET, path="/appmesh/applications")
+        resp = self.__request_http(
+            AppMeshClient.Method.GET,
+            path="/appmesh/applications",
+            query=self.__app_query(name_pattern, status, owner, label, fields),
+        )
         return (resp.status_code == HTTPStatus.OK), resp.json()
 
+    def get_apps_page(self, limit, cursor="", name_pattern=None, status=None, owner=None, label=None, fields=None):
+        """
+        Get application JSON information by page, applications are sorted by name
+
+        Parameters
+        ----------
+            limit : int
+                Max application number for one page
+            cursor : str
+                Next page cursor returned from previous call, empty for the first page
+            Other parameters are same with get_apps()
+
+        Returns
+        -------
+            Success : bool
+            Array of application JSON
+            Next page cursor : None or str
+        """
+        query = self.__app_query(name_pattern, status, owner, label, fields)
+        query["limit"] = str(limit)
+        query["cursor"] = cursor
+        resp = self.__request_http(AppMeshClient.Method.GET, path="/appmesh/applications", query=query)
+        next_cursor = None if not resp.headers.__contains__("Next-Cursor") else resp.headers["Next-Cursor"]
+        return (resp.status_code == HTTPStatus.OK), resp.json(), next_cursor
+
+    @staticmethod
+    def __app_query(name_pattern, status, owner, label, fields):
+        """build application list query"""
+        query = {}
+        if name_pattern:
+            query["name"] = name_pattern
+        if status:
+            query["status"] = status
+        if owner:
+            query["owner"] = owner
+        if label:
+            query["label"] = label
+        if fields:
+            query["fields"] = ",".join(fields)
+        return query
+
     def get_app_output(self, app_name, output_position=0, stdout_index=0, stdout_maxsize=10240, process_uuid=""):
         """
         Get application stdout
@@ -270,6 +328,24 @@ class AppMeshClient:
         resp = self.__request_http(AppMeshClient.Method.POST, path="/appmesh/app/{0}/disable".format(app_name))
         return (resp.status_code == HTTPStatus.OK), resp.json()
 
+    def batch_apps(self, operations):
+        """
+        Apply application operations in batch, server side write configuration once
+
+        Parameters
+        ----------
+            operations : list
+                Operation list, action is one of "add", "enable", "disable", "remove":
+                [{"action": "add", "name": "app1", "app": {...}}, {"action": "disable", "name": "app2"}]
+        Returns
+        -------
+            Success : bool
+            Results : list
+                Result for each operation: {"action": "add", "name": "app1", "success": true, "message": ""}
+        """
+        resp = self.__request_http(AppMeshClient.Method.POST, path="/appmesh/applications/batch", body=operations)
+        return (resp.status_code == HTTPStatus.OK), resp.json()
+
     ########################################
     # Cloud API
     ########################################
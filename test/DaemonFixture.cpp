@@ -0,0 +1,16 @@
+#include <ace/Init_ACE.h>
+
+#include "../src/daemon/Configuration.h"
+#include "DaemonFixture.h"
+
+std::shared_ptr<Configuration> initConfig()
+{
+    static std::shared_ptr<Configuration> config;
+    if (config == nullptr)
+    {
+        ACE::init();
+        config = Configuration::FromJson("{\"Description\": \"unit test\", \"DefaultExecUser\": \"root\", \"WorkingDirectory\": \"/tmp\"}");
+        Configuration::instance(config);
+    }
+    return config;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <memory>
+
+class Configuration;
+
+//////////////////////////////////////////////////////////////////////////
+/// Shared fixture of tests linked with daemon objects (test_daemon):
+/// init ACE and register a minimal Configuration instance once, default
+/// exec user is root and working directory is /tmp.
+//////////////////////////////////////////////////////////////////////////
+std::shared_ptr<Configuration> initConfig();
@@ -0,0 +1,188 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include "../catch.hpp"
+#include <chrono>
+#include <csignal>
+#include <string>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cpprest/json.h>
+#include "../../src/common/Utility.h"
+#include "../../src/daemon/Configuration.h"
+#include "../../src/daemon/application/Application.h"
+#include "../../src/daemon/rest/AdmissionControl.h"
+#include "../../src/daemon/security/Security.h"
+
+#include "../DaemonFixture.h"
+
+static void setAdmission(const std::string &admission)
+{
+    auto update = web::json::value::object();
+    update[JSON_KEY_REST][JSON_KEY_Admission] = web::json::value::parse(admission);
+    initConfig()->hotUpdate(update);
+}
+
+// child process in its own process group, Application::attach() kill the previous process group
+static pid_t startChild()
+{
+    const auto pid = ::fork();
+    if (pid == 0)
+    {
+        ::setpgid(0, 0);
+        ::pause();
+        ::_exit(0);
+    }
+    ::setpgid(pid, pid);
+    return pid;
+}
+
+static void stopChild(pid_t pid)
+{
+    ::kill(pid, SIGKILL);
+    ::waitpid(pid, nullptr, 0);
+}
+
+TEST_CASE("TokenBucket refill", "[AdmissionControl]")
+{
+    TokenBucket bucket(2, 3);
+    // start with burst
+    REQUIRE(bucket.tryAcquire());
+    REQUIRE(bucket.tryAcquire());
+    REQUIRE(bucket.tryAcquire());
+    REQUIRE_FALSE(bucket.tryAcquire());
+
+    // refill 2 tokens per second
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    REQUIRE(bucket.tryAcquire());
+    REQUIRE_FALSE(bucket.tryAcquire());
+
+    // never exceed burst
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    REQUIRE(bucket.tryAcquire());
+    REQUIRE(bucket.tryAcquire());
+    REQUIRE(bucket.tryAcquire());
+    REQUIRE_FALSE(bucket.tryAcquire());
+}
+
+TEST_CASE("AdmissionControl request rate limit", "[AdmissionControl]")
+{
+    initConfig();
+    Security::instance(Security::FromJson(web::json::value::parse(R"({
+        "Roles": {"ops": ["app-view"]},
+        "Users": {"operator": {"key": "pwd", "roles": ["ops"]}}
+    })")));
+    setAdmission(R"({
+        "RequestPerSecond": 0.5,
+        "RequestBurst": 2,
+        "UserLimits": {"vip": {"RequestPerSecond": 100, "RequestBurst": 5}},
+        "RoleLimits": {"ops": {"RequestPerSecond": 100, "RequestBurst": 4}}
+    })");
+    AdmissionControl control;
+    REQUIRE(control.rateLimitEnabled());
+
+    SECTION("default limit per user and remote address")
+    {
+        REQUIRE(control.admitRequest("user", "127.0.0.1"));
+        REQUIRE(control.admitRequest("user", "127.0.0.1"));
+        REQUIRE_FALSE(control.admitRequest("user", "127.0.0.1"));
+        // unauthenticated request use remote address as key
+        REQUIRE(control.admitRequest("", "127.0.0.1"));
+        REQUIRE(control.admitRequest("", "127.0.0.1"));
+        REQUIRE_FALSE(control.admitRequest("", "127.0.0.1"));
+        REQUIRE(control.admitRequest("", "127.0.0.2"));
+
+        // reset drop exhausted buckets
+        control.reset();
+        REQUIRE(control.admitRequest("user", "127.0.0.1"));
+    }
+
+    SECTION("user and role limit")
+    {
+        for (int i = 0; i < 5; i++)
+            REQUIRE(control.admitRequest("vip", "127.0.0.1"));
+        REQUIRE_FALSE(control.admitRequest("vip", "127.0.0.1"));
+
+        for (int i = 0; i < 4; i++)
+            REQUIRE(control.admitRequest("operator", "127.0.0.1"));
+        REQUIRE_FALSE(control.admitRequest("operator", "127.0.0.1"));
+    }
+
+    SECTION("no limit")
+    {
+        setAdmission(R"({"RequestPerSecond": 0})");
+        control.reset();
+        REQUIRE_FALSE(control.rateLimitEnabled());
+        for (int i = 0; i < 100; i++)
+            REQUIRE(control.admitRequest("user", "127.0.0.1"));
+    }
+}
+
+TEST_CASE("AdmissionControl run slot", "[AdmissionControl]")
+{
+    auto app = initConfig()->parseApp(web::json::value::parse(R"({"name": "admission-run", "command": "sleep 60"})"));
+    AdmissionControl control;
+
+    SECTION("reserve and cancel")
+    {
+        setAdmission(R"({"RunConcurrency": 1})");
+        REQUIRE(control.reserveRunSlot());
+        // reserved slot count before process start
+        REQUIRE_FALSE(control.reserveRunSlot());
+        control.cancelRunSlot();
+        REQUIRE(control.reserveRunSlot());
+        // process not started, nothing to track
+        control.commitRunSlot(app);
+        REQUIRE(control.reserveRunSlot());
+        control.cancelRunSlot();
+    }
+
+    SECTION("unlimited run concurrency does not leak slot")
+    {
+        const auto pid = startChild();
+        app->attach(pid);
+        setAdmission(R"({"RunConcurrency": 0})");
+        for (int i = 0; i < 3; i++)
+        {
+            REQUIRE(control.reserveRunSlot());
+            control.commitRunSlot(app);
+        }
+        setAdmission(R"({"RunConcurrency": 1})");
+        REQUIRE(control.reserveRunSlot());
+        REQUIRE_FALSE(control.reserveRunSlot());
+        control.cancelRunSlot();
+        stopChild(pid);
+    }
+
+    SECTION("slot released when process exit or application removed")
+    {
+        setAdmission(R"({"RunConcurrency": 1})");
+        const auto pid1 = startChild();
+        app->attach(pid1);
+        REQUIRE(control.reserveRunSlot());
+        control.commitRunSlot(app);
+        REQUIRE_FALSE(control.reserveRunSlot());
+
+        // new run of the same application get a new pid, previous process is killed
+        const auto pid2 = startChild();
+        app->attach(pid2);
+        REQUIRE(control.reserveRunSlot());
+        control.commitRunSlot(app);
+        REQUIRE_FALSE(control.reserveRunSlot());
+
+        app.reset();
+        REQUIRE(control.reserveRunSlot());
+        control.cancelRunSlot();
+        stopChild(pid2);
+    }
+}
+
+TEST_CASE("AdmissionControl queue size", "[AdmissionControl]")
+{
+    AdmissionControl control;
+    setAdmission(R"({"QueueSize": 2})");
+    REQUIRE(control.admitQueue(0));
+    REQUIRE(control.admitQueue(1));
+    REQUIRE_FALSE(control.admitQueue(2));
+    setAdmission(R"({"QueueSize": 0})");
+    REQUIRE(control.admitQueue(100000));
+}
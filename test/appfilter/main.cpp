@@ -0,0 +1,173 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include "../catch.hpp"
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <cpprest/json.h>
+#include "../../src/common/Utility.h"
+#include "../../src/daemon/Configuration.h"
+#include "../../src/daemon/application/AppFilter.h"
+#include "../../src/daemon/application/Application.h"
+#include "../../src/daemon/security/Security.h"
+
+#include "../DaemonFixture.h"
+
+typedef std::map<std::string, std::string> Query;
+
+static std::shared_ptr<Application> parseApp(const std::string &json)
+{
+    return initConfig()->parseApp(web::json::value::parse(json));
+}
+
+static std::string names(const web::json::value &apps)
+{
+    std::string result;
+    for (const auto &app : apps.as_array())
+    {
+        result.append(GET_JSON_STR_VALUE(app, JSON_KEY_APP_name)).append(",");
+    }
+    return result;
+}
+
+TEST_CASE("AppFilter parse query", "[AppFilter]")
+{
+    auto filter = AppFilter::FromQuery(Query{{"name", "web-*"}, {"status", "disabled"}, {"owner", "user1"}, {"label", "team=ops"},
+                                             {"fields", " name, status ,,"}, {"limit", "10"}, {"cursor", "web-1"}, {"unknown", "x"}});
+    REQUIRE(filter->m_namePattern == "web-*");
+    REQUIRE(filter->m_status == static_cast<int>(STATUS::DISABLED));
+    REQUIRE(filter->m_owner == "user1");
+    REQUIRE(filter->m_labelKey == "team");
+    REQUIRE(filter->m_labelValue == "ops");
+    REQUIRE(filter->m_fields == std::set<std::string>{"name", "status"});
+    REQUIRE(filter->m_limit == 10);
+    REQUIRE(filter->m_cursor == "web-1");
+    REQUIRE(filter->hasProjection());
+    REQUIRE(filter->hasPagination());
+    // unknown query is not part of ETag
+    REQUIRE(filter->queryString().find("unknown") == std::string::npos);
+
+    REQUIRE(AppFilter::FromQuery(Query{{"status", "enabled"}})->m_status == static_cast<int>(STATUS::ENABLED));
+    REQUIRE(AppFilter::FromQuery(Query{{"status", "0"}})->m_status == static_cast<int>(STATUS::DISABLED));
+    REQUIRE(AppFilter::FromQuery(Query{{"label", "gpu"}})->m_labelValue.empty());
+    REQUIRE(AppFilter::FromQuery(Query{{"limit", "5"}})->queryString() != AppFilter::FromQuery(Query{{"limit", "6"}})->queryString());
+    REQUIRE_THROWS_AS(AppFilter::FromQuery(Query{{"status", "running"}}), std::invalid_argument);
+    REQUIRE_THROWS_AS(AppFilter::FromQuery(Query{{"limit", "-1"}}), std::invalid_argument);
+
+    auto empty = AppFilter::FromQuery(Query{{"name", ""}});
+    REQUIRE(empty->m_namePattern.empty());
+    REQUIRE(empty->m_status == -1);
+    REQUIRE_FALSE(empty->hasProjection());
+    REQUIRE_FALSE(empty->hasPagination());
+}
+
+TEST_CASE("AppFilter match", "[AppFilter]")
+{
+    initConfig();
+    Security::instance(Security::FromJson(web::json::value::parse(R"({
+        "Roles": {"viewer": ["app-view"]},
+        "Users": {"user1": {"key": "pwd1", "roles": ["viewer"]}, "user2": {"key": "pwd2", "roles": ["viewer"]}}
+    })")));
+    auto web = parseApp(R"({"name": "web-1", "command": "sleep 60", "status": 1, "owner": "user1",
+                            "metadata": {"team": "ops", "replica": 3}})");
+    auto db = parseApp(R"({"name": "db-1", "command": "sleep 60", "status": 0, "metadata": "not a label"})");
+
+    REQUIRE(AppFilter::FromQuery(Query())->match(web));
+    REQUIRE(AppFilter::FromQuery(Query())->match(db));
+
+    SECTION("name")
+    {
+        REQUIRE(AppFilter::FromQuery(Query{{"name", "web-1"}})->match(web));
+        REQUIRE(AppFilter::FromQuery(Query{{"name", "web-*"}})->match(web));
+        REQUIRE_FALSE(AppFilter::FromQuery(Query{{"name", "web-*"}})->match(db));
+    }
+
+    SECTION("status and owner")
+    {
+        REQUIRE(AppFilter::FromQuery(Query{{"status", "enabled"}})->match(web));
+        REQUIRE_FALSE(AppFilter::FromQuery(Query{{"status", "enabled"}})->match(db));
+        REQUIRE(AppFilter::FromQuery(Query{{"status", "disabled"}})->match(db));
+        REQUIRE(AppFilter::FromQuery(Query{{"owner", "user1"}})->match(web));
+        REQUIRE_FALSE(AppFilter::FromQuery(Query{{"owner", "user2"}})->match(web));
+        REQUIRE_FALSE(AppFilter::FromQuery(Query{{"owner", "user1"}})->match(db));
+    }
+
+    SECTION("label")
+    {
+        REQUIRE(AppFilter::FromQuery(Query{{"label", "team"}})->match(web));
+        REQUIRE(AppFilter::FromQuery(Query{{"label", "team=ops"}})->match(web));
+        REQUIRE_FALSE(AppFilter::FromQuery(Query{{"label", "team=dev"}})->match(web));
+        // non string value compare with serialized JSON
+        REQUIRE(AppFilter::FromQuery(Query{{"label", "replica=3"}})->match(web));
+        // non object metadata is not a label
+        REQUIRE_FALSE(AppFilter::FromQuery(Query{{"label", "team"}})->match(db));
+    }
+
+    SECTION("event")
+    {
+        auto filter = AppFilter::FromQuery(Query{{"name", "web-*"}, {"label", "team=ops"}});
+        REQUIRE(filter->match("web-2", web::json::value::parse(R"({"team": "ops"})")));
+        REQUIRE_FALSE(filter->match("web-2", web::json::value::null()));
+        REQUIRE_FALSE(filter->match("db-2", web::json::value::parse(R"({"team": "ops"})")));
+    }
+}
+
+TEST_CASE("AppFilter projection", "[AppFilter]")
+{
+    const auto app = web::json::value::parse(R"({"name": "web-1", "status": 1, "pid": 100, "command": "sleep 60"})");
+    REQUIRE(AppFilter::FromQuery(Query())->project(app) == app);
+
+    const auto result = AppFilter::FromQuery(Query{{"fields", "name,pid,no_such_field"}})->project(app);
+    REQUIRE(result.size() == 2);
+    REQUIRE(result.at("name").as_string() == "web-1");
+    REQUIRE(result.at("pid").as_integer() == 100);
+    REQUIRE_FALSE(result.has_field("command"));
+    REQUIRE_FALSE(result.has_field("no_such_field"));
+}
+
+TEST_CASE("AppFilter cursor pagination", "[AppFilter]")
+{
+    initConfig();
+    // isolated application set, not registered to Configuration::instance()
+    auto config = Configuration::FromJson(R"({"DefaultExecUser": "root", "WorkingDirectory": "/tmp"})");
+    config->deSerializeApp(web::json::value::parse(R"([
+        {"name": "app-4", "command": "sleep 60", "status": 1},
+        {"name": "app-2", "command": "sleep 60", "status": 1},
+        {"name": "app-5", "command": "sleep 60", "status": 0},
+        {"name": "app-1", "command": "sleep 60", "status": 1},
+        {"name": "app-3", "command": "sleep 60", "status": 1}
+    ])"));
+
+    auto page = [&config](const Query &query, std::string &nextCursor)
+    {
+        const auto result = config->serializeApplicationCached("", "", AppFilter::FromQuery(query));
+        nextCursor = std::get<2>(result);
+        return names(web::json::value::parse(std::get<1>(result)));
+    };
+
+    std::string cursor;
+    REQUIRE(page(Query{{"limit", "2"}}, cursor) == "app-1,app-2,");
+    REQUIRE(cursor == "app-2");
+    REQUIRE(page(Query{{"limit", "2"}, {"cursor", cursor}}, cursor) == "app-3,app-4,");
+    REQUIRE(cursor == "app-4");
+    REQUIRE(page(Query{{"limit", "2"}, {"cursor", cursor}}, cursor) == "app-5,");
+    REQUIRE(cursor.empty());
+
+    // cursor need not be an existing application
+    REQUIRE(page(Query{{"cursor", "app-2x"}}, cursor) == "app-3,app-4,app-5,");
+    REQUIRE(cursor.empty());
+
+    // filter apply before pagination
+    REQUIRE(page(Query{{"status", "enabled"}, {"limit", "3"}, {"cursor", "app-1"}}, cursor) == "app-2,app-3,app-4,");
+    REQUIRE(cursor == "app-4");
+    REQUIRE(page(Query{{"status", "enabled"}, {"limit", "3"}, {"cursor", cursor}}, cursor).empty());
+
+    // projection and ETag
+    const auto first = config->serializeApplicationCached("", "", AppFilter::FromQuery(Query{{"limit", "1"}, {"fields", "name"}}));
+    REQUIRE(web::json::value::parse(std::get<1>(first)).at(0).size() == 1);
+    const auto second = config->serializeApplicationCached("", "", AppFilter::FromQuery(Query{{"limit", "1"}, {"cursor", "app-1"}, {"fields", "name"}}));
+    REQUIRE(std::get<0>(first) != std::get<0>(second));
+    const auto notModified = config->serializeApplicationCached("", std::get<0>(first), AppFilter::FromQuery(Query{{"limit", "1"}, {"fields", "name"}}));
+    REQUIRE(std::get<0>(notModified) == std::get<0>(first));
+    REQUIRE(std::get<1>(notModified).empty());
+}
@@ -0,0 +1,364 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <cpprest/json.h>
+
+#include "../../src/common/Utility.h"
+#include "../../src/daemon/Configuration.h"
+#include "../../src/daemon/Label.h"
+#include "../../src/daemon/consul/ConsulConnection.h"
+#include "../../src/daemon/consul/ConsulEntity.h"
+#include "../DaemonFixture.h"
+#include "ConsulMock.h"
+
+//////////////////////////////////////////////////////////////////////////
+/// App Mesh cluster against ConsulMockServer:
+///  1. masters are real ConsulConnection instances init as main node,
+///     their schedule watch thread elect leader, run Scheduler::scheduleTask
+///     and dispatch changed appmesh/topology/<host> with Consul HTTP API
+///  2. workers are simulated, each hold a session (delete behavior) and
+///     report ConsulNode JSON to appmesh/cluster/nodes/<host> with acquire
+///  3. tasks are ConsulTask JSON put by ConsulConnection::addCloudApp()
+/// Schedule result is read back from KV by ConsulTopology::FromJson.
+/// Session renew timer need ACE reactor loop which is not run here, the
+/// TTL should cover the test, crash is simulated by destroy the session.
+//////////////////////////////////////////////////////////////////////////
+class ClusterSimulation
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Options
+    {
+        Options()
+            : m_nodes(10), m_masters(3), m_zones(2), m_ttl(300), m_lockDelay(std::chrono::milliseconds(0)),
+              m_strategy("spread"), m_scheduleMaxMoves(0)
+        {
+        }
+        // simulated workers
+        std::size_t m_nodes;
+        // ConsulConnection main nodes
+        std::size_t m_masters;
+        // worker i has label zone=zone<i % m_zones>
+        std::size_t m_zones;
+        // session TTL seconds of masters
+        int m_ttl;
+        // ConsulConnection request 15s lock delay, mock cap it to m_lockDelay
+        std::chrono::milliseconds m_lockDelay;
+        std::string m_strategy;
+        int m_scheduleMaxMoves;
+    };
+
+    ClusterSimulation(ConsulMock &consul, const std::string &consulUrl, const Options &options)
+        : m_consul(consul), m_options(options), m_startRequests(0)
+    {
+        initConfig();
+        auto consulJson = web::json::value::object();
+        consulJson[JSON_KEY_CONSUL_URL] = web::json::value::string(consulUrl);
+        consulJson[JSON_KEY_CONSUL_IS_MAIN] = web::json::value::boolean(true);
+        consulJson[JSON_KEY_CONSUL_IS_WORKER] = web::json::value::boolean(false);
+        consulJson[JSON_KEY_CONSUL_SESSION_TTL] = web::json::value::number(options.m_ttl);
+        consulJson[JSON_KEY_CONSUL_SCHEDULE_STRATEGY] = web::json::value::string(options.m_strategy);
+        consulJson[JSON_KEY_CONSUL_SCHEDULE_MAX_MOVES] = web::json::value::number(options.m_scheduleMaxMoves);
+        auto config = web::json::value::parse("{\"Description\": \"cluster simulation\", \"DefaultExecUser\": \"root\", \"WorkingDirectory\": \"/tmp\"}");
+        config[JSON_KEY_CONSUL] = consulJson;
+        m_config = Configuration::FromJson(config.serialize());
+        m_consul.lockDelayLimit(options.m_lockDelay);
+
+        for (std::size_t i = 0; i < options.m_nodes; ++i)
+        {
+            auto &node = m_nodes["node" + std::to_string(i)];
+            node.m_zone = "zone" + std::to_string(i % std::max<std::size_t>(options.m_zones, 1));
+            node.m_alive = false;
+        }
+    }
+
+    ~ClusterSimulation()
+    {
+        for (const auto &master : m_masters)
+            stop(master);
+        // answer blocking watches sent before masters stopped, stopped watch thread exit after that
+        for (int quiet = 0, i = 0; quiet < 10 && i < 500; ++i)
+        {
+            if (m_consul.waiters())
+            {
+                quiet = 0;
+                m_consul.kvPut(clusterPath() + "stop", "");
+            }
+            else
+            {
+                quiet++;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        Configuration::instance(initConfig());
+    }
+
+    /// <summary>
+    /// Report all workers then init masters, the first master elected is leader
+    /// </summary>
+    void start()
+    {
+        m_start = Clock::now();
+        m_startRequests = m_consul.totalRequests();
+        for (auto &node : m_nodes)
+            addNode(node.first);
+        // masters read Consul settings from Configuration instance
+        Configuration::instance(m_config);
+        for (std::size_t i = 0; i < m_options.m_masters; ++i)
+        {
+            auto master = std::make_shared<ConsulConnection>();
+            master->init();
+            m_masters.push_back(master);
+        }
+    }
+
+    /// <summary>
+    /// Define Consul task, empty zone match all nodes
+    /// </summary>
+    void putTask(const std::string &name, std::size_t replicas, uint64_t memoryMega, const std::string &zone = std::string())
+    {
+        auto task = web::json::value::object();
+        task["replication"] = web::json::value::number(replicas);
+        task["memoryMB"] = web::json::value::number(memoryMega);
+        task["content"] = web::json::value::parse("{\"name\": \"" + name + "\", \"command\": \"sleep 60\"}");
+        if (zone.length())
+            task["condition"]["zone"] = web::json::value::string(zone);
+        runningMaster()->addCloudApp(name, task);
+        m_tasks[name] = std::make_pair(replicas, zone);
+    }
+
+    void deleteTask(const std::string &name)
+    {
+        runningMaster()->deleteCloudApp(name);
+        m_tasks.erase(name);
+    }
+
+    /// <summary>
+    /// Wait until topology place exactly the expected replicas of all tasks on alive matched workers
+    /// </summary>
+    /// <returns>elapsed time, negative for timeout</returns>
+    std::chrono::milliseconds waitConverged(std::chrono::milliseconds timeout)
+    {
+        const auto start = Clock::now();
+        while (!converged())
+        {
+            if (Clock::now() - start > timeout)
+                return std::chrono::milliseconds(-1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+    }
+
+    /// <summary>
+    /// Wait until one running master hold the leader lock
+    /// </summary>
+    /// <returns>leader session ID, empty for timeout</returns>
+    std::string waitLeader(std::chrono::milliseconds timeout)
+    {
+        const auto start = Clock::now();
+        while (Clock::now() - start <= timeout)
+        {
+            const auto session = leaderSession();
+            if (session.length())
+                return session;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return std::string();
+    }
+
+    /// <summary>
+    /// Crash the leader master and worker node0 together: leader session is
+    /// invalidated as TTL expired and node0 key is deleted with its session,
+    /// standby masters watching appmesh/cluster/ retry the election
+    /// </summary>
+    /// <returns>elapsed time until another master hold the leader lock, negative for timeout</returns>
+    std::chrono::milliseconds failLeader(std::chrono::milliseconds timeout)
+    {
+        const auto leader = leaderSession();
+        if (leader.empty())
+            return std::chrono::milliseconds(-1);
+        const auto start = Clock::now();
+        for (const auto &master : m_masters)
+        {
+            if (master->consulSessionId() == leader)
+                stop(master);
+        }
+        m_consul.sessionDestroy(leader);
+        removeNode("node0");
+        while (Clock::now() - start <= timeout)
+        {
+            const auto session = leaderSession();
+            if (session.length() && session != leader)
+                return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return std::chrono::milliseconds(-1);
+    }
+
+    /// <summary>
+    /// Session of the running master holding appmesh/leader
+    /// </summary>
+    std::string leaderSession()
+    {
+        const auto leader = m_consul.kvPeek(leaderPath());
+        if (leader.m_entries.empty() || leader.m_entries.front().m_session.empty())
+            return std::string();
+        for (const auto &master : m_masters)
+        {
+            if (isRunning(master) && master->consulSessionId() == leader.m_entries.front().m_session)
+                return leader.m_entries.front().m_session;
+        }
+        return std::string();
+    }
+
+    // replicas placed in appmesh/topology/, key: task name
+    std::map<std::string, std::size_t> placedReplicas()
+    {
+        std::map<std::string, std::size_t> replicas;
+        for (const auto &topology : readTopology())
+        {
+            for (const auto &app : topology.second->m_scheduleApps)
+                replicas[app.first]++;
+        }
+        return replicas;
+    }
+
+    // Consul requests per second since start
+    double requestRate() const
+    {
+        const auto elapsed = std::chrono::duration<double>(Clock::now() - m_start).count();
+        return elapsed > 0 ? (m_consul.totalRequests() - m_startRequests) / elapsed : 0;
+    }
+
+private:
+    struct Node
+    {
+        std::string m_zone;
+        std::string m_session;
+        bool m_alive;
+    };
+
+    static std::string clusterPath() { return "appmesh/cluster/"; }
+    static std::string nodePath() { return clusterPath() + "nodes/"; }
+    static std::string topologyPath() { return "appmesh/topology/"; }
+    static std::string leaderPath() { return "appmesh/leader"; }
+
+    // stopped masters are kept until process exit, their detached watch thread use the instance until exit
+    static std::vector<std::shared_ptr<ConsulConnection>> &stoppedMasters()
+    {
+        static auto stopped = new std::vector<std::shared_ptr<ConsulConnection>>();
+        return *stopped;
+    }
+
+    void addNode(const std::string &host)
+    {
+        auto &node = m_nodes[host];
+        ConsulNode consulNode;
+        consulNode.m_hostName = host;
+        consulNode.m_appmeshProxyUrl = "https://" + host + ":6060";
+        consulNode.m_label->addLabel("zone", node.m_zone);
+        consulNode.m_cores = 16;
+        consulNode.m_total_bytes = 32ULL * 1024 * 1024 * 1024;
+        node.m_session = m_consul.sessionCreate("appmesh-lock-" + host, std::chrono::milliseconds(0), "delete");
+        node.m_alive = m_consul.kvPut(nodePath() + host, consulNode.AsJson().serialize(), 0, node.m_session);
+    }
+
+    void removeNode(const std::string &host)
+    {
+        auto &node = m_nodes[host];
+        node.m_alive = false;
+        m_consul.sessionDestroy(node.m_session);
+    }
+
+    // disable Consul for the master as hot update does, its schedule watch thread exit after current watch
+    void stop(const std::shared_ptr<ConsulConnection> &master)
+    {
+        if (!isRunning(master))
+            return;
+        auto update = web::json::value::object();
+        update[JSON_KEY_CONSUL][JSON_KEY_CONSUL_URL] = web::json::value::string("");
+        m_config->hotUpdate(update);
+        // init() wait running schedule, no more request after that
+        master->init();
+        stoppedMasters().push_back(master);
+    }
+
+    static bool isRunning(const std::shared_ptr<ConsulConnection> &master)
+    {
+        for (const auto &stopped : stoppedMasters())
+        {
+            if (stopped == master)
+                return false;
+        }
+        return true;
+    }
+
+    std::shared_ptr<ConsulConnection> runningMaster()
+    {
+        for (const auto &master : m_masters)
+        {
+            if (isRunning(master))
+                return master;
+        }
+        throw std::runtime_error("no running master");
+    }
+
+    // key: host name
+    std::map<std::string, std::shared_ptr<ConsulTopology>> readTopology()
+    {
+        std::map<std::string, std::shared_ptr<ConsulTopology>> topology;
+        for (const auto &entry : m_consul.kvPeek(topologyPath(), true).m_entries)
+        {
+            if (entry.m_value.empty())
+                continue;
+            const auto host = entry.m_key.substr(topologyPath().length());
+            topology[host] = ConsulTopology::FromJson(web::json::value::parse(entry.m_value), host);
+        }
+        return topology;
+    }
+
+    bool converged()
+    {
+        std::map<std::string, std::size_t> replicas;
+        for (const auto &topology : readTopology())
+        {
+            auto node = m_nodes.find(topology.first);
+            for (const auto &app : topology.second->m_scheduleApps)
+            {
+                auto task = m_tasks.find(app.first);
+                if (node == m_nodes.end() || !node->second.m_alive || task == m_tasks.end())
+                    return false;
+                if (task->second.second.length() && task->second.second != node->second.m_zone)
+                    return false;
+                replicas[app.first]++;
+            }
+        }
+        for (const auto &task : m_tasks)
+        {
+            if (replicas[task.first] != task.second.first)
+                return false;
+        }
+        return true;
+    }
+
+    ConsulMock &m_consul;
+    const Options m_options;
+    std::shared_ptr<Configuration> m_config;
+    std::vector<std::shared_ptr<ConsulConnection>> m_masters;
+    // key: host name
+    std::map<std::string, Node> m_nodes;
+    // key: task name, value: replicas and zone
+    std::map<std::string, std::pair<std::size_t, std::string>> m_tasks;
+    Clock::time_point m_start;
+    std::size_t m_startRequests;
+};
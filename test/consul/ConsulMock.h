@@ -0,0 +1,516 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//////////////////////////////////////////////////////////////////////////
+/// In-process stand-in of the Consul endpoints used by ConsulConnection
+///  1. KV: CreateIndex/ModifyIndex, recurse listing, acquire/release,
+///     blocking query with index and wait, X-Consul-Index of deleted keys
+///  2. session: TTL, lock delay, release or delete behavior
+///  3. agent service register and deregister
+/// Each public call counts as one Consul request, see requests().
+/// ConsulMockServer expose the same calls with Consul HTTP API.
+//////////////////////////////////////////////////////////////////////////
+class ConsulMock
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct KvEntry
+    {
+        std::string m_key;
+        std::string m_value;
+        uint64_t m_flags;
+        long long m_createIndex;
+        long long m_modifyIndex;
+        long long m_lockIndex;
+        std::string m_session;
+    };
+
+    struct KvResult
+    {
+        // X-Consul-Index
+        long long m_index;
+        // empty entries is 404
+        std::vector<KvEntry> m_entries;
+    };
+    typedef std::function<void(const KvResult &)> WatchCallback;
+
+    struct Service
+    {
+        std::string m_id;
+        std::string m_name;
+        std::string m_address;
+        int m_port;
+    };
+
+    ConsulMock() : m_index(0), m_sessionId(0), m_stop(false), m_lockDelayLimit(std::chrono::milliseconds::max())
+    {
+        m_reaper = std::thread(&ConsulMock::reap, this);
+    }
+
+    ~ConsulMock()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        m_reaper.join();
+        // answer pending blocking queries, HTTP clients should not hang on shutdown
+        std::vector<Ready> ready;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            for (auto &waiter : m_waiters)
+                ready.push_back(Ready(std::move(waiter.m_callback), read(waiter.m_key, waiter.m_recurse)));
+            m_waiters.clear();
+        }
+        fire(ready);
+    }
+
+    /// <summary>
+    /// GET /v1/kv/key[?recurse]
+    /// </summary>
+    KvResult kvGet(const std::string &key, bool recurse = false)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        count("kv_read");
+        return read(key, recurse);
+    }
+
+    /// <summary>
+    /// Same as kvGet, not counted as Consul request, used to check state from tests
+    /// </summary>
+    KvResult kvPeek(const std::string &key, bool recurse = false) const
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return read(key, recurse);
+    }
+
+    /// <summary>
+    /// Blocking GET /v1/kv/key?index=&wait=, callback is invoked once when
+    /// X-Consul-Index advanced from index or wait timeout
+    /// </summary>
+    void kvWatch(const std::string &key, bool recurse, long long index, std::chrono::milliseconds wait, WatchCallback callback)
+    {
+        KvResult result;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            count("kv_watch");
+            result = read(key, recurse);
+            if (index > 0 && result.m_index <= index && wait.count() > 0)
+            {
+                Waiter waiter;
+                waiter.m_key = key;
+                waiter.m_recurse = recurse;
+                waiter.m_index = index;
+                waiter.m_deadline = Clock::now() + wait;
+                waiter.m_callback = std::move(callback);
+                m_waiters.push_back(std::move(waiter));
+                m_cv.notify_all();
+                return;
+            }
+        }
+        callback(result);
+    }
+
+    /// <summary>
+    /// Blocking GET in the caller thread
+    /// </summary>
+    KvResult kvWatch(const std::string &key, bool recurse, long long index, std::chrono::milliseconds wait)
+    {
+        auto promise = std::make_shared<std::promise<KvResult>>();
+        auto future = promise->get_future();
+        kvWatch(key, recurse, index, wait, [promise](const KvResult &result)
+                { promise->set_value(result); });
+        return future.get();
+    }
+
+    /// <summary>
+    /// PUT /v1/kv/key[?acquire=|release=]
+    /// </summary>
+    /// <returns>false if lock is held by other session, in lock delay or session not exist</returns>
+    bool kvPut(const std::string &key, const std::string &value, uint64_t flags = 0, const std::string &acquire = std::string(), const std::string &release = std::string())
+    {
+        std::vector<Ready> ready;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            count("kv_write");
+            auto entry = m_entries.find(key);
+            const bool exist = (entry != m_entries.end());
+            if (acquire.length())
+            {
+                if (!m_sessions.count(acquire))
+                    return false;
+                if (exist && entry->second.m_session.length() && entry->second.m_session != acquire)
+                    return false;
+                const bool newLock = !exist || entry->second.m_session != acquire;
+                auto delay = m_lockDelay.find(key);
+                if (newLock && delay != m_lockDelay.end() && delay->second > Clock::now())
+                    return false;
+                auto &written = write(key, value, flags);
+                written.m_session = acquire;
+                if (newLock)
+                    written.m_lockIndex++;
+            }
+            else if (release.length())
+            {
+                if (!exist || entry->second.m_session != release)
+                    return false;
+                write(key, value, flags).m_session.clear();
+            }
+            else
+            {
+                write(key, value, flags);
+            }
+            collect(ready);
+        }
+        fire(ready);
+        return true;
+    }
+
+    /// <summary>
+    /// DELETE /v1/kv/key[?recurse]
+    /// </summary>
+    bool kvDelete(const std::string &key, bool recurse = false)
+    {
+        std::vector<Ready> ready;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            count("kv_write");
+            // all keys deleted by one request share one index
+            const auto index = ++m_index;
+            auto entry = m_entries.lower_bound(key);
+            while (entry != m_entries.end() && (recurse ? entry->first.compare(0, key.length(), key) == 0 : entry->first == key))
+            {
+                m_tombstones[entry->first] = index;
+                entry = m_entries.erase(entry);
+            }
+            collect(ready);
+        }
+        fire(ready);
+        return true;
+    }
+
+    /// <summary>
+    /// PUT /v1/session/create, ttl 0 never expire
+    /// </summary>
+    /// <returns>session ID</returns>
+    std::string sessionCreate(const std::string &name, std::chrono::milliseconds ttl, const std::string &behavior = "release", std::chrono::milliseconds lockDelay = std::chrono::milliseconds(15000))
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        count("session");
+        char id[40] = {0};
+        std::snprintf(id, sizeof(id), "00000000-0000-0000-0000-%012llu", ++m_sessionId);
+        Session session;
+        session.m_name = name;
+        session.m_behavior = behavior;
+        session.m_ttl = ttl;
+        session.m_lockDelay = std::min(lockDelay, m_lockDelayLimit);
+        session.m_expire = Clock::now() + ttl;
+        m_sessions[id] = session;
+        m_cv.notify_all();
+        return id;
+    }
+
+    /// <summary>
+    /// PUT /v1/session/renew/id
+    /// </summary>
+    /// <returns>false if session expired or destroyed (404)</returns>
+    bool sessionRenew(const std::string &id)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        count("session");
+        auto session = m_sessions.find(id);
+        if (session == m_sessions.end())
+            return false;
+        session->second.m_expire = Clock::now() + session->second.m_ttl;
+        return true;
+    }
+
+    /// <summary>
+    /// PUT /v1/session/destroy/id, locks held by session are released or deleted
+    /// </summary>
+    bool sessionDestroy(const std::string &id)
+    {
+        std::vector<Ready> ready;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            count("session");
+            invalidate(id);
+            collect(ready);
+        }
+        fire(ready);
+        return true;
+    }
+
+    bool sessionExist(const std::string &id) const
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_sessions.count(id) > 0;
+    }
+
+    /// <summary>
+    /// PUT /v1/agent/service/register
+    /// </summary>
+    bool serviceRegister(const Service &service)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        count("agent");
+        m_services[service.m_id] = service;
+        return true;
+    }
+
+    /// <summary>
+    /// PUT /v1/agent/service/deregister/id
+    /// </summary>
+    /// <returns>false if service not exist (404)</returns>
+    bool serviceDeregister(const std::string &id)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        count("agent");
+        return m_services.erase(id) > 0;
+    }
+
+    /// <summary>
+    /// GET /v1/agent/services, key: service ID
+    /// </summary>
+    std::map<std::string, Service> services()
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        count("agent");
+        return m_services;
+    }
+
+    /// <summary>
+    /// Requests received, key: kv_read, kv_watch, kv_write, session, agent
+    /// </summary>
+    std::map<std::string, std::size_t> requests() const
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_requests;
+    }
+
+    std::size_t totalRequests() const
+    {
+        std::size_t total = 0;
+        for (const auto &request : requests())
+            total += request.second;
+        return total;
+    }
+
+    /// <summary>
+    /// Cap session lock delay, appsvc always request 15s
+    /// </summary>
+    void lockDelayLimit(std::chrono::milliseconds limit)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_lockDelayLimit = limit;
+    }
+
+    // blocking queries not answered yet
+    std::size_t waiters() const
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_waiters.size();
+    }
+
+private:
+    struct Session
+    {
+        std::string m_name;
+        std::string m_behavior;
+        std::chrono::milliseconds m_ttl;
+        std::chrono::milliseconds m_lockDelay;
+        Clock::time_point m_expire;
+    };
+
+    struct Waiter
+    {
+        std::string m_key;
+        bool m_recurse;
+        long long m_index;
+        Clock::time_point m_deadline;
+        WatchCallback m_callback;
+    };
+    typedef std::pair<WatchCallback, KvResult> Ready;
+
+    void count(const std::string &type)
+    {
+        m_requests[type]++;
+    }
+
+    KvResult read(const std::string &key, bool recurse) const
+    {
+        KvResult result;
+        result.m_index = 0;
+        if (recurse)
+        {
+            for (auto entry = m_entries.lower_bound(key); entry != m_entries.end() && entry->first.compare(0, key.length(), key) == 0; ++entry)
+            {
+                result.m_entries.push_back(entry->second);
+                result.m_index = std::max(result.m_index, entry->second.m_modifyIndex);
+            }
+            // deleted keys advance index of the prefix as well
+            for (auto tombstone = m_tombstones.lower_bound(key); tombstone != m_tombstones.end() && tombstone->first.compare(0, key.length(), key) == 0; ++tombstone)
+                result.m_index = std::max(result.m_index, tombstone->second);
+        }
+        else
+        {
+            auto entry = m_entries.find(key);
+            if (entry != m_entries.end())
+            {
+                result.m_entries.push_back(entry->second);
+                result.m_index = entry->second.m_modifyIndex;
+            }
+        }
+        // same as Consul, missing key return the index of KV store
+        if (result.m_index == 0)
+            result.m_index = m_index;
+        return result;
+    }
+
+    KvEntry &write(const std::string &key, const std::string &value, uint64_t flags)
+    {
+        auto &entry = m_entries[key];
+        entry.m_modifyIndex = ++m_index;
+        if (entry.m_key.empty())
+        {
+            entry.m_key = key;
+            entry.m_createIndex = entry.m_modifyIndex;
+            entry.m_lockIndex = 0;
+            m_tombstones.erase(key);
+        }
+        entry.m_value = value;
+        entry.m_flags = flags;
+        return entry;
+    }
+
+    void invalidate(const std::string &id)
+    {
+        auto session = m_sessions.find(id);
+        if (session == m_sessions.end())
+            return;
+        const auto lockDelay = Clock::now() + session->second.m_lockDelay;
+        const bool remove = (session->second.m_behavior == "delete");
+        for (auto entry = m_entries.begin(); entry != m_entries.end();)
+        {
+            if (entry->second.m_session != id)
+            {
+                ++entry;
+                continue;
+            }
+            m_lockDelay[entry->first] = lockDelay;
+            if (remove)
+            {
+                m_tombstones[entry->first] = ++m_index;
+                entry = m_entries.erase(entry);
+            }
+            else
+            {
+                entry->second.m_session.clear();
+                entry->second.m_modifyIndex = ++m_index;
+                ++entry;
+            }
+        }
+        m_sessions.erase(session);
+    }
+
+    // move satisfied or timeout waiters to ready, lock is held
+    void collect(std::vector<Ready> &ready)
+    {
+        const auto now = Clock::now();
+        for (auto waiter = m_waiters.begin(); waiter != m_waiters.end();)
+        {
+            auto result = read(waiter->m_key, waiter->m_recurse);
+            if (result.m_index > waiter->m_index || waiter->m_deadline <= now)
+            {
+                ready.push_back(Ready(std::move(waiter->m_callback), std::move(result)));
+                waiter = m_waiters.erase(waiter);
+            }
+            else
+            {
+                ++waiter;
+            }
+        }
+    }
+
+    // callbacks run without lock, callback may call mock again
+    static void fire(std::vector<Ready> &ready)
+    {
+        for (auto &entry : ready)
+            entry.first(entry.second);
+        ready.clear();
+    }
+
+    // expire sessions and answer timeout blocking queries
+    void reap()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop)
+        {
+            const auto now = Clock::now();
+            std::vector<std::string> expired;
+            for (const auto &session : m_sessions)
+            {
+                if (session.second.m_ttl.count() > 0 && session.second.m_expire <= now)
+                    expired.push_back(session.first);
+            }
+            for (const auto &id : expired)
+                invalidate(id);
+
+            std::vector<Ready> ready;
+            collect(ready);
+            if (ready.size())
+            {
+                lock.unlock();
+                fire(ready);
+                lock.lock();
+                continue;
+            }
+
+            auto next = now + std::chrono::seconds(60);
+            for (const auto &session : m_sessions)
+            {
+                if (session.second.m_ttl.count() > 0)
+                    next = std::min(next, session.second.m_expire);
+            }
+            for (const auto &waiter : m_waiters)
+                next = std::min(next, waiter.m_deadline);
+            m_cv.wait_until(lock, next);
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    long long m_index;
+    unsigned long long m_sessionId;
+    bool m_stop;
+    std::chrono::milliseconds m_lockDelayLimit;
+    // key: KV key
+    std::map<std::string, KvEntry> m_entries;
+    // key: deleted KV key, value: index of delete
+    std::map<std::string, long long> m_tombstones;
+    // key: KV key, value: time lock can be acquired again after session invalidated
+    std::map<std::string, Clock::time_point> m_lockDelay;
+    // key: session ID
+    std::map<std::string, Session> m_sessions;
+    // key: service ID
+    std::map<std::string, Service> m_services;
+    std::list<Waiter> m_waiters;
+    std::map<std::string, std::size_t> m_requests;
+    std::thread m_reaper;
+};
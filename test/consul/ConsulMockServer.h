@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cpprest/http_listener.h>
+#include <cpprest/json.h>
+
+#include "../../src/common/Utility.h"
+#include "ConsulMock.h"
+
+//////////////////////////////////////////////////////////////////////////
+/// Consul HTTP API on top of ConsulMock, used to run ConsulHttpPool or
+/// a real appsvc (Consul Url point to the listen address) without Consul
+///  /v1/kv/<key>                 GET PUT DELETE
+///  /v1/session/<create|renew|destroy>
+///  /v1/agent/service/<register|deregister>, /v1/agent/services
+/// Blocking query is parked in ConsulMock, no listener thread is blocked.
+//////////////////////////////////////////////////////////////////////////
+class ConsulMockServer
+{
+public:
+    ConsulMockServer(ConsulMock &consul, const std::string &url)
+        : m_consul(consul), m_listener(web::uri(url))
+    {
+        // size cpprest thread pool before the listener use it, later ConsulConnection::init() does not resize
+        Utility::initCpprestThreadPool(16);
+        m_listener.support(std::bind(&ConsulMockServer::handle, this, std::placeholders::_1));
+        m_listener.open().wait();
+    }
+
+    ~ConsulMockServer()
+    {
+        m_listener.close().wait();
+    }
+
+    /// <summary>
+    /// Loopback URL with a free port, http_listener does not report the port bound by port 0
+    /// </summary>
+    static std::string freeLocalUrl()
+    {
+        const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            throw std::runtime_error("failed to create socket");
+        struct sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t length = sizeof(addr);
+        const bool bound = ::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == 0 &&
+                           ::getsockname(fd, reinterpret_cast<struct sockaddr *>(&addr), &length) == 0;
+        ::close(fd);
+        if (!bound)
+            throw std::runtime_error("failed to get a free port");
+        return "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+    }
+
+    /// <summary>
+    /// Parse Consul duration: 30000ms, 30s, 1m
+    /// </summary>
+    static std::chrono::milliseconds parseDuration(const std::string &duration)
+    {
+        char *unit = nullptr;
+        const auto value = std::strtod(duration.c_str(), &unit);
+        const std::string suffix = unit;
+        if (suffix == "ms")
+            return std::chrono::milliseconds(static_cast<long long>(value));
+        if (suffix == "m")
+            return std::chrono::milliseconds(static_cast<long long>(value * 60 * 1000));
+        // plain number is seconds
+        return std::chrono::milliseconds(static_cast<long long>(value * 1000));
+    }
+
+private:
+    void handle(web::http::http_request request)
+    {
+        const auto path = web::uri::decode(request.relative_uri().path());
+        const auto query = web::uri::split_query(request.relative_uri().query());
+        const std::string kvPrefix = "/v1/kv/";
+        const std::string sessionPrefix = "/v1/session/";
+        const std::string agentPrefix = "/v1/agent/";
+        try
+        {
+            if (path.compare(0, kvPrefix.length(), kvPrefix) == 0)
+                handleKv(request, path.substr(kvPrefix.length()), query);
+            else if (path.compare(0, sessionPrefix.length(), sessionPrefix) == 0)
+                handleSession(request, path.substr(sessionPrefix.length()));
+            else if (path.compare(0, agentPrefix.length(), agentPrefix) == 0)
+                handleAgent(request, path.substr(agentPrefix.length()));
+            else
+                request.reply(web::http::status_codes::NotFound, "unsupported path " + path);
+        }
+        catch (const std::exception &ex)
+        {
+            request.reply(web::http::status_codes::InternalError, ex.what());
+        }
+    }
+
+    void handleKv(web::http::http_request &request, const std::string &key, const std::map<std::string, std::string> &query)
+    {
+        const bool recurse = query.count("recurse") > 0;
+        if (request.method() == web::http::methods::GET)
+        {
+            const bool raw = query.count("raw") > 0;
+            auto reply = [request, raw](const ConsulMock::KvResult &result)
+            {
+                web::http::http_response response(result.m_entries.empty() ? web::http::status_codes::NotFound : web::http::status_codes::OK);
+                response.headers().add("X-Consul-Index", std::to_string(result.m_index));
+                if (raw && result.m_entries.size())
+                {
+                    response.set_body(result.m_entries.front().m_value);
+                }
+                else if (result.m_entries.size())
+                {
+                    auto listing = web::json::value::array(result.m_entries.size());
+                    for (std::size_t i = 0; i < result.m_entries.size(); ++i)
+                        listing[i] = toJson(result.m_entries[i]);
+                    response.set_body(listing);
+                }
+                request.reply(response);
+            };
+            auto index = query.find("index");
+            if (index != query.end())
+            {
+                auto wait = query.find("wait");
+                m_consul.kvWatch(key, recurse, std::atoll(index->second.c_str()), parseDuration(wait == query.end() ? "5m" : wait->second), reply);
+            }
+            else
+            {
+                reply(m_consul.kvGet(key, recurse));
+            }
+        }
+        else if (request.method() == web::http::methods::PUT)
+        {
+            auto value = request.extract_utf8string(true).get();
+            auto flags = query.find("flags");
+            auto acquire = query.find("acquire");
+            auto release = query.find("release");
+            const bool result = m_consul.kvPut(key, value, flags == query.end() ? 0 : std::strtoull(flags->second.c_str(), nullptr, 10),
+                                               acquire == query.end() ? std::string() : acquire->second,
+                                               release == query.end() ? std::string() : release->second);
+            request.reply(web::http::status_codes::OK, web::json::value::boolean(result));
+        }
+        else if (request.method() == web::http::methods::DEL)
+        {
+            request.reply(web::http::status_codes::OK, web::json::value::boolean(m_consul.kvDelete(key, recurse)));
+        }
+        else
+        {
+            request.reply(web::http::status_codes::MethodNotAllowed);
+        }
+    }
+
+    void handleSession(web::http::http_request &request, const std::string &action)
+    {
+        const std::string renew = "renew/";
+        const std::string destroy = "destroy/";
+        if (action == "create")
+        {
+            auto body = request.extract_json(true).get();
+            const auto ttl = HAS_JSON_FIELD(body, "TTL") ? parseDuration(GET_JSON_STR_VALUE(body, "TTL")) : std::chrono::milliseconds(0);
+            const auto lockDelay = HAS_JSON_FIELD(body, "LockDelay") ? parseDuration(GET_JSON_STR_VALUE(body, "LockDelay")) : std::chrono::milliseconds(15000);
+            const auto behavior = HAS_JSON_FIELD(body, "Behavior") ? GET_JSON_STR_VALUE(body, "Behavior") : std::string("release");
+            auto result = web::json::value::object();
+            result["ID"] = web::json::value::string(m_consul.sessionCreate(GET_JSON_STR_VALUE(body, "Name"), ttl, behavior, lockDelay));
+            request.reply(web::http::status_codes::OK, result);
+        }
+        else if (action.compare(0, renew.length(), renew) == 0)
+        {
+            const auto id = action.substr(renew.length());
+            if (m_consul.sessionRenew(id))
+            {
+                auto session = web::json::value::object();
+                session["ID"] = web::json::value::string(id);
+                auto result = web::json::value::array(1);
+                result[0] = session;
+                request.reply(web::http::status_codes::OK, result);
+            }
+            else
+            {
+                request.reply(web::http::status_codes::NotFound, "Session id '" + id + "' not found");
+            }
+        }
+        else if (action.compare(0, destroy.length(), destroy) == 0)
+        {
+            request.reply(web::http::status_codes::OK, web::json::value::boolean(m_consul.sessionDestroy(action.substr(destroy.length()))));
+        }
+        else
+        {
+            request.reply(web::http::status_codes::NotFound);
+        }
+    }
+
+    void handleAgent(web::http::http_request &request, const std::string &action)
+    {
+        const std::string deregister = "service/deregister/";
+        if (action == "service/register")
+        {
+            auto body = request.extract_json(true).get();
+            ConsulMock::Service service;
+            service.m_id = GET_JSON_STR_VALUE(body, "ID");
+            service.m_name = GET_JSON_STR_VALUE(body, "Name");
+            service.m_address = GET_JSON_STR_VALUE(body, "Address");
+            service.m_port = GET_JSON_INT_VALUE(body, "Port");
+            if (service.m_id.empty())
+                service.m_id = service.m_name;
+            m_consul.serviceRegister(service);
+            request.reply(web::http::status_codes::OK);
+        }
+        else if (action.compare(0, deregister.length(), deregister) == 0)
+        {
+            if (m_consul.serviceDeregister(action.substr(deregister.length())))
+                request.reply(web::http::status_codes::OK, web::json::value::boolean(true));
+            else
+                request.reply(web::http::status_codes::NotFound, "Unknown service ID");
+        }
+        else if (action == "services")
+        {
+            auto result = web::json::value::object();
+            for (const auto &service : m_consul.services())
+            {
+                auto json = web::json::value::object();
+                json["ID"] = web::json::value::string(service.second.m_id);
+                json["Service"] = web::json::value::string(service.second.m_name);
+                json["Address"] = web::json::value::string(service.second.m_address);
+                json["Port"] = web::json::value::number(service.second.m_port);
+                result[service.first] = json;
+            }
+            request.reply(web::http::status_codes::OK, result);
+        }
+        else
+        {
+            request.reply(web::http::status_codes::NotFound);
+        }
+    }
+
+    static web::json::value toJson(const ConsulMock::KvEntry &entry)
+    {
+        auto json = web::json::value::object();
+        json["Key"] = web::json::value::string(entry.m_key);
+        json["Flags"] = web::json::value::number(entry.m_flags);
+        json["CreateIndex"] = web::json::value::number(static_cast<int64_t>(entry.m_createIndex));
+        json["ModifyIndex"] = web::json::value::number(static_cast<int64_t>(entry.m_modifyIndex));
+        json["LockIndex"] = web::json::value::number(static_cast<int64_t>(entry.m_lockIndex));
+        // empty value is null in Consul
+        json["Value"] = entry.m_value.empty() ? web::json::value::null() : web::json::value::string(Utility::encode64(entry.m_value));
+        if (entry.m_session.length())
+            json["Session"] = web::json::value::string(entry.m_session);
+        return json;
+    }
+
+    ConsulMock &m_consul;
+    web::http::experimental::listener::http_listener m_listener;
+};
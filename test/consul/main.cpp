@@ -0,0 +1,341 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "../catch.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "../../src/common/Utility.h"
+#include "../../src/daemon/consul/ConsulHttpPool.h"
+#include "../../src/daemon/consul/ConsulKvCache.h"
+#include "ClusterSimulation.h"
+#include "ConsulMock.h"
+#include "ConsulMockServer.h"
+
+using namespace std::chrono;
+
+TEST_CASE("ConsulMock KV index and recurse", "[ConsulMock]")
+{
+    ConsulMock consul;
+    REQUIRE(consul.kvGet("appmesh/leader").m_entries.empty());
+
+    REQUIRE(consul.kvPut("appmesh/cluster/nodes/host1", "a"));
+    REQUIRE(consul.kvPut("appmesh/cluster/nodes/host2", "b"));
+    REQUIRE(consul.kvPut("appmesh/cluster/nodes/host1", "c", 100));
+    auto host1 = consul.kvGet("appmesh/cluster/nodes/host1");
+    REQUIRE(host1.m_entries.size() == 1);
+    REQUIRE(host1.m_entries[0].m_value == "c");
+    REQUIRE(host1.m_entries[0].m_flags == 100);
+    REQUIRE(host1.m_entries[0].m_createIndex == 1);
+    REQUIRE(host1.m_entries[0].m_modifyIndex == 3);
+    REQUIRE(host1.m_index == 3);
+
+    auto nodes = consul.kvGet("appmesh/cluster/nodes/", true);
+    REQUIRE(nodes.m_entries.size() == 2);
+    REQUIRE(nodes.m_index == 3);
+
+    // deleted key advance index of prefix, empty listing is 404
+    REQUIRE(consul.kvDelete("appmesh/cluster/", true));
+    nodes = consul.kvGet("appmesh/cluster/nodes/", true);
+    REQUIRE(nodes.m_entries.empty());
+    REQUIRE(nodes.m_index == 4);
+    REQUIRE(consul.requests().at("kv_write") == 4);
+}
+
+TEST_CASE("ConsulMock blocking query", "[ConsulMock]")
+{
+    ConsulMock consul;
+    consul.kvPut("appmesh/topology/host1", "app1");
+    const auto index = consul.kvGet("appmesh/topology/", true).m_index;
+
+    // index 0 return immediately, unchanged index wait until timeout
+    REQUIRE(consul.kvWatch("appmesh/topology/", true, 0, seconds(10)).m_index == index);
+    auto start = steady_clock::now();
+    REQUIRE(consul.kvWatch("appmesh/topology/", true, index, milliseconds(100)).m_index == index);
+    REQUIRE(steady_clock::now() - start >= milliseconds(100));
+
+    // write to other path does not wake the watch
+    std::thread writer([&consul]()
+                       {
+                           std::this_thread::sleep_for(milliseconds(50));
+                           consul.kvPut("appmesh/leader", "host1");
+                           std::this_thread::sleep_for(milliseconds(50));
+                           consul.kvPut("appmesh/topology/host2", "app2");
+                       });
+    start = steady_clock::now();
+    auto result = consul.kvWatch("appmesh/topology/", true, index, seconds(10));
+    writer.join();
+    REQUIRE(result.m_index > index);
+    REQUIRE(result.m_entries.size() == 2);
+    REQUIRE(steady_clock::now() - start < seconds(5));
+    REQUIRE(consul.waiters() == 0);
+}
+
+TEST_CASE("ConsulMock session lock", "[ConsulMock]")
+{
+    ConsulMock consul;
+    auto session1 = consul.sessionCreate("appmesh-lock-host1", seconds(0), "release", milliseconds(200));
+    auto session2 = consul.sessionCreate("appmesh-lock-host2", milliseconds(500), "delete", milliseconds(0));
+    REQUIRE(session1 != session2);
+
+    REQUIRE(consul.kvPut("appmesh/leader", "host1", 0, session1));
+    REQUIRE_FALSE(consul.kvPut("appmesh/leader", "host2", 0, session2));
+    REQUIRE_FALSE(consul.kvPut("appmesh/leader", "host2", 0, "not-exist"));
+    REQUIRE(consul.kvGet("appmesh/leader").m_entries[0].m_session == session1);
+
+    // release behavior keep the key, lock delay block acquire
+    REQUIRE(consul.sessionDestroy(session1));
+    auto leader = consul.kvGet("appmesh/leader");
+    REQUIRE(leader.m_entries.size() == 1);
+    REQUIRE(leader.m_entries[0].m_session.empty());
+    REQUIRE_FALSE(consul.kvPut("appmesh/leader", "host2", 0, session2));
+    std::this_thread::sleep_for(milliseconds(250));
+    REQUIRE(consul.sessionRenew(session2));
+    REQUIRE(consul.kvPut("appmesh/leader", "host2", 0, session2));
+    REQUIRE(consul.kvGet("appmesh/leader").m_entries[0].m_lockIndex == 2);
+
+    // delete behavior remove locked key when TTL expired
+    REQUIRE(consul.kvPut("appmesh/cluster/nodes/host2", "{}", 0, session2));
+    std::this_thread::sleep_for(milliseconds(800));
+    REQUIRE_FALSE(consul.sessionExist(session2));
+    REQUIRE_FALSE(consul.sessionRenew(session2));
+    REQUIRE(consul.kvGet("appmesh/leader").m_entries.empty());
+    REQUIRE(consul.kvGet("appmesh/cluster/nodes/host2").m_entries.empty());
+}
+
+TEST_CASE("ConsulMock agent service", "[ConsulMock]")
+{
+    ConsulMock consul;
+    ConsulMock::Service service;
+    service.m_id = "host1:myapp";
+    service.m_name = "myapp";
+    service.m_address = "host1";
+    service.m_port = 8080;
+    REQUIRE(consul.serviceRegister(service));
+    REQUIRE(consul.services().count("host1:myapp") == 1);
+    REQUIRE(consul.serviceDeregister("host1:myapp"));
+    REQUIRE_FALSE(consul.serviceDeregister("host1:myapp"));
+    REQUIRE(consul.services().empty());
+}
+
+TEST_CASE("ConsulMock HTTP API", "[ConsulMock]")
+{
+    const std::string url = ConsulMockServer::freeLocalUrl();
+    ConsulMock consul;
+    ConsulMockServer server(consul, url);
+    ConsulHttpPool pool(url, "", "", 2);
+    bool warm = false;
+
+    auto send = [&pool, &warm](const web::http::method &method, const std::string &path, const std::string &body)
+    {
+        web::http::http_request request(method);
+        request.set_request_uri(path);
+        if (body.length())
+            request.set_body(body);
+        return pool.request(request, warm);
+    };
+
+    auto session = send(web::http::methods::PUT, "/v1/session/create", "{\"Name\":\"appmesh-lock-host1\",\"TTL\":\"30s\",\"Behavior\":\"delete\",\"LockDelay\":\"15s\"}").extract_json(true).get();
+    const auto sessionId = GET_JSON_STR_VALUE(session, "ID");
+    REQUIRE(consul.sessionExist(sessionId));
+
+    REQUIRE(send(web::http::methods::PUT, "/v1/kv/appmesh/leader?acquire=" + sessionId, "host1").extract_utf8string(true).get() == "true");
+    REQUIRE(send(web::http::methods::GET, "/v1/kv/appmesh/leader?raw=true", "").extract_utf8string(true).get() == "host1");
+    REQUIRE(warm);
+
+    auto response = send(web::http::methods::GET, "/v1/kv/appmesh/?recurse=true", "");
+    REQUIRE(response.status_code() == web::http::status_codes::OK);
+    const auto index = std::atoll(response.headers().find("X-Consul-Index")->second.c_str());
+    auto listing = response.extract_json(true).get();
+    REQUIRE(listing.as_array().size() == 1);
+    REQUIRE(Utility::decode64(GET_JSON_STR_VALUE(listing.as_array().at(0), "Value")) == "host1");
+    REQUIRE(send(web::http::methods::GET, "/v1/kv/appmesh/cluster/?recurse=true", "").status_code() == web::http::status_codes::NotFound);
+
+    // blocking query is answered by the write of another request
+    std::thread writer([&consul]()
+                       {
+                           std::this_thread::sleep_for(milliseconds(100));
+                           consul.kvPut("appmesh/topology/host1", "app1");
+                       });
+    web::http::http_request watch(web::http::methods::GET);
+    watch.set_request_uri("/v1/kv/appmesh/topology/host1?index=" + std::to_string(index) + "&wait=30000ms");
+    response = pool.watch("appmesh/topology/host1", watch, 40, warm);
+    writer.join();
+    REQUIRE(response.status_code() == web::http::status_codes::OK);
+    REQUIRE(std::atoll(response.headers().find("X-Consul-Index")->second.c_str()) > index);
+
+    REQUIRE(send(web::http::methods::PUT, "/v1/agent/service/register", "{\"ID\":\"host1:app1\",\"Name\":\"app1\",\"Port\":8080}").status_code() == web::http::status_codes::OK);
+    REQUIRE(send(web::http::methods::PUT, "/v1/agent/service/deregister/host1:app1", "").extract_utf8string(true).get() == "true");
+    REQUIRE(send(web::http::methods::PUT, "/v1/session/renew/" + sessionId, "").status_code() == web::http::status_codes::OK);
+    REQUIRE(send(web::http::methods::PUT, "/v1/session/destroy/" + sessionId, "").status_code() == web::http::status_codes::OK);
+    REQUIRE(send(web::http::methods::PUT, "/v1/session/renew/" + sessionId, "").status_code() == web::http::status_codes::NotFound);
+}
+
+// Consul recurse KV listing, value is base64 encoded
+static web::json::value kvListing(const std::vector<std::tuple<std::string, std::string, long long>> &entries)
+{
+    auto listing = web::json::value::array(entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+        listing[i]["Key"] = web::json::value::string(std::get<0>(entries[i]));
+        listing[i]["Value"] = web::json::value::string(Utility::encode64(std::get<1>(entries[i])));
+        listing[i]["ModifyIndex"] = web::json::value::number(static_cast<int64_t>(std::get<2>(entries[i])));
+    }
+    return listing;
+}
+
+TEST_CASE("ConsulKvCache incremental apply", "[ConsulKvCache]")
+{
+    ConsulKvCache<std::string> cache;
+    std::vector<std::string> parsedKeys;
+    const ConsulKvCache<std::string>::Parser parser = [&parsedKeys](const std::string &key, const std::string &value, std::string &name) -> std::shared_ptr<std::string>
+    {
+        parsedKeys.push_back(key);
+        name = key.substr(key.rfind('/') + 1);
+        // ignore entry with empty name
+        return name.empty() ? nullptr : std::make_shared<std::string>(value);
+    };
+
+    REQUIRE(cache.apply(kvListing({{"nodes/host1", "a", 10}, {"nodes/host2", "b", 11}, {"nodes/", "dir", 5}}), 11, parser) == 3);
+    REQUIRE(cache.index() == 11);
+    auto items = cache.items();
+    REQUIRE(items.size() == 2);
+    REQUIRE(*items["host1"] == "a");
+    long long modifyIndex = 0;
+    REQUIRE(*cache.find("host2", modifyIndex) == "b");
+    REQUIRE(modifyIndex == 11);
+
+    SECTION("unchanged ModifyIndex is not parsed again")
+    {
+        parsedKeys.clear();
+        REQUIRE(cache.apply(kvListing({{"nodes/host1", "a", 10}, {"nodes/host2", "b2", 12}, {"nodes/", "dir", 5}}), 12, parser) == 1);
+        REQUIRE(parsedKeys == std::vector<std::string>{"nodes/host2"});
+        REQUIRE(*cache.find("host2", modifyIndex) == "b2");
+        REQUIRE(modifyIndex == 12);
+        REQUIRE(*cache.find("host1", modifyIndex) == "a");
+        REQUIRE(modifyIndex == 10);
+        // returned copy does not change cache
+        *cache.items()["host1"] = "changed";
+        REQUIRE(*cache.items()["host1"] == "a");
+    }
+
+    SECTION("deleted key is dropped")
+    {
+        REQUIRE(cache.apply(kvListing({{"nodes/host2", "b", 11}}), 13, parser) == 0);
+        REQUIRE(cache.items().size() == 1);
+        REQUIRE(cache.find("host1", modifyIndex) == nullptr);
+        REQUIRE(modifyIndex == 0);
+        // empty listing (404) drop all
+        REQUIRE(cache.apply(web::json::value::null(), 14, parser) == 0);
+        REQUIRE(cache.items().empty());
+        REQUIRE(cache.index() == 14);
+    }
+
+    SECTION("older listing is rejected")
+    {
+        parsedKeys.clear();
+        REQUIRE(cache.apply(kvListing({{"nodes/host1", "old", 9}}), 9, parser) == 0);
+        REQUIRE(parsedKeys.empty());
+        REQUIRE(cache.index() == 11);
+        REQUIRE(cache.items().size() == 2);
+        REQUIRE(*cache.find("host1", modifyIndex) == "a");
+        // unknown index always apply
+        REQUIRE(cache.apply(kvListing({{"nodes/host1", "a", 10}}), 0, parser) == 0);
+        REQUIRE(cache.items().size() == 1);
+    }
+
+    SECTION("clear")
+    {
+        cache.clear();
+        REQUIRE(cache.index() == 0);
+        REQUIRE(cache.items().empty());
+        parsedKeys.clear();
+        REQUIRE(cache.apply(kvListing({{"nodes/host1", "a", 10}}), 11, parser) == 1);
+    }
+}
+
+TEST_CASE("Cluster simulation converge and leader failover", "[ClusterSimulation]")
+{
+    const std::string url = ConsulMockServer::freeLocalUrl();
+    ConsulMock consul;
+    ConsulMockServer server(consul, url);
+    ClusterSimulation::Options options;
+    options.m_nodes = 8;
+    options.m_masters = 3;
+    ClusterSimulation cluster(consul, url, options);
+    cluster.start();
+    REQUIRE(cluster.waitLeader(seconds(10)).length());
+
+    for (int i = 0; i < 10; i++)
+        cluster.putTask("app" + std::to_string(i), 2, 512, i % 2 ? "zone1" : "");
+    REQUIRE(cluster.waitConverged(seconds(10)).count() >= 0);
+
+    // standby master take over and move replicas of the crashed worker
+    REQUIRE(cluster.failLeader(seconds(10)).count() >= 0);
+    REQUIRE(cluster.waitConverged(seconds(10)).count() >= 0);
+
+    cluster.deleteTask("app0");
+    REQUIRE(cluster.waitConverged(seconds(10)).count() >= 0);
+}
+
+TEST_CASE("ConsulConnection is not leader while another session hold the lock", "[ClusterSimulation]")
+{
+    const std::string url = ConsulMockServer::freeLocalUrl();
+    ConsulMock consul;
+    ConsulMockServer server(consul, url);
+    const auto other = consul.sessionCreate("appmesh-lock-other", milliseconds(0), "delete", milliseconds(0));
+    REQUIRE(consul.kvPut("appmesh/leader", "\"other\"", 0, other));
+
+    ClusterSimulation::Options options;
+    options.m_nodes = 4;
+    options.m_masters = 1;
+    ClusterSimulation cluster(consul, url, options);
+    cluster.start();
+    // the task wake the master to try election, acquire return 200 with false
+    cluster.putTask("app0", 2, 512);
+    std::this_thread::sleep_for(milliseconds(500));
+    REQUIRE(cluster.leaderSession().empty());
+    REQUIRE(cluster.placedReplicas().empty());
+
+    // lock is released with the other session, next cluster change elect the master
+    consul.sessionDestroy(other);
+    cluster.putTask("app1", 2, 512);
+    REQUIRE(cluster.waitLeader(seconds(10)).length());
+    REQUIRE(cluster.waitConverged(seconds(10)).count() >= 0);
+}
+
+TEST_CASE("Cluster simulation benchmark", "[ClusterSimulation][!benchmark]")
+{
+    const std::string url = ConsulMockServer::freeLocalUrl();
+    ConsulMock consul;
+    ConsulMockServer server(consul, url);
+    ClusterSimulation::Options options;
+    options.m_nodes = 200;
+    options.m_masters = 3;
+    options.m_zones = 10;
+    options.m_lockDelay = milliseconds(0);
+    ClusterSimulation cluster(consul, url, options);
+    cluster.start();
+    REQUIRE(cluster.waitLeader(seconds(30)).length());
+
+    const auto start = steady_clock::now();
+    for (int i = 0; i < 1000; i++)
+        cluster.putTask("app" + std::to_string(i), 3, 256, i % 10 ? "zone" + std::to_string(i % 10) : "");
+    const auto put = duration_cast<milliseconds>(steady_clock::now() - start);
+    const auto converge = cluster.waitConverged(seconds(120));
+    REQUIRE(converge.count() >= 0);
+    const auto failover = cluster.failLeader(seconds(60));
+    REQUIRE(failover.count() >= 0);
+    const auto reconverge = cluster.waitConverged(seconds(120));
+    REQUIRE(reconverge.count() >= 0);
+
+    std::cout << "nodes: " << options.m_nodes << ", masters: " << options.m_masters << ", tasks: 1000 x 3 replicas" << std::endl
+              << "schedule convergence: " << (put + converge).count() << " ms (" << converge.count() << " ms after last task put)" << std::endl
+              << "leader failover (lock delay " << options.m_lockDelay.count() << " ms): " << failover.count() << " ms" << std::endl
+              << "convergence after failover: " << reconverge.count() << " ms" << std::endl
+              << "Consul request rate: " << static_cast<long long>(cluster.requestRate()) << " /s" << std::endl;
+    for (const auto &request : consul.requests())
+        std::cout << "  " << request.first << ": " << request.second << std::endl;
+}
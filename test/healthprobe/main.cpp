@@ -0,0 +1,268 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include "../catch.hpp"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include "../../src/daemon/HealthProbe.h"
+
+//////////////////////////////////////////////////////////////////////////
+/// Local listening TCP socket on an ephemeral port, reply each accepted
+/// connection with the response after request header received.
+/// Without serve, connection is established by kernel backlog but never
+/// replied.
+//////////////////////////////////////////////////////////////////////////
+class ProbeServer
+{
+public:
+    explicit ProbeServer(const std::string &response, bool serve = true)
+        : m_port(0)
+    {
+        m_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(addr);
+        if (::bind(m_fd, reinterpret_cast<struct sockaddr *>(&addr), length) == 0 &&
+            ::getsockname(m_fd, reinterpret_cast<struct sockaddr *>(&addr), &length) == 0 && ::listen(m_fd, 8) == 0)
+        {
+            m_port = ntohs(addr.sin_port);
+        }
+        if (serve)
+        {
+            m_thread = std::thread(&ProbeServer::serve, this, response);
+        }
+    }
+    ~ProbeServer()
+    {
+        close();
+    }
+    int port() const { return m_port; }
+    // port is free after close, connect to it is refused
+    void close()
+    {
+        if (m_fd >= 0)
+        {
+            // wake up accept()
+            ::shutdown(m_fd, SHUT_RDWR);
+            if (m_thread.joinable())
+                m_thread.join();
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+private:
+    void serve(const std::string &response)
+    {
+        int client;
+        while ((client = ::accept(m_fd, nullptr, nullptr)) >= 0)
+        {
+            std::string request;
+            char buffer[256];
+            ssize_t received;
+            while (request.find("\r\n\r\n") == std::string::npos && (received = ::recv(client, buffer, sizeof(buffer), 0)) > 0)
+            {
+                request.append(buffer, received);
+            }
+            ::send(client, response.data(), response.length(), MSG_NOSIGNAL);
+            ::close(client);
+        }
+    }
+
+    int m_fd;
+    int m_port;
+    std::thread m_thread;
+};
+
+// drive socket probe the same way as HealthCheckTask, return false if not finished in time
+static bool pollProbe(const std::shared_ptr<HealthProbe> &probe, int timeoutMillSeconds = 3000)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMillSeconds);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        struct pollfd pfd;
+        pfd.fd = probe->fd();
+        pfd.events = probe->events();
+        pfd.revents = 0;
+        if (::poll(&pfd, 1, 50) > 0 && probe->onEvent(pfd.revents))
+            return true;
+    }
+    return false;
+}
+
+static std::shared_ptr<HealthProbe> runProbe(const std::string &spec)
+{
+    auto probe = HealthProbe::parse(spec);
+    if (!probe->start(0, 5))
+    {
+        REQUIRE(pollProbe(probe));
+    }
+    REQUIRE(probe->fd() < 0);
+    return probe;
+}
+
+TEST_CASE("HealthProbe parse command", "[HealthProbe]")
+{
+    REQUIRE(HealthProbe::parse("curl -f 127.0.0.1:8080/health")->type() == HealthProbe::Type::COMMAND);
+    REQUIRE_FALSE(HealthProbe::parse("sh -c 'exit 0'")->native());
+    // shell command contains "://"
+    REQUIRE(HealthProbe::parse("curl http://127.0.0.1/health")->type() == HealthProbe::Type::COMMAND);
+    REQUIRE(HealthProbe::parse("/bin/check --url=http://127.0.0.1")->type() == HealthProbe::Type::COMMAND);
+}
+
+TEST_CASE("HealthProbe parse native probe", "[HealthProbe]")
+{
+    REQUIRE(HealthProbe::parse("http://127.0.0.1:8080/health")->type() == HealthProbe::Type::HTTP);
+    REQUIRE(HealthProbe::parse("http://127.0.0.1/health 204")->type() == HealthProbe::Type::HTTP);
+    REQUIRE(HealthProbe::parse("http://localhost:8080")->type() == HealthProbe::Type::HTTP);
+    REQUIRE(HealthProbe::parse("http://[::1]:8080/health")->type() == HealthProbe::Type::HTTP);
+    REQUIRE(HealthProbe::parse("tcp://10.0.0.1:6379")->type() == HealthProbe::Type::TCP);
+    REQUIRE(HealthProbe::parse("tcp://[::1]:6379")->type() == HealthProbe::Type::TCP);
+    REQUIRE(HealthProbe::parse("unix:///var/run/app.sock")->type() == HealthProbe::Type::UNIX);
+    REQUIRE(HealthProbe::parse("file:///var/run/app.heartbeat 30")->type() == HealthProbe::Type::FILE);
+    REQUIRE(HealthProbe::parse("pid://")->type() == HealthProbe::Type::PID);
+    REQUIRE(HealthProbe::parse("pid://")->native());
+}
+
+TEST_CASE("HealthProbe parse invalid input", "[HealthProbe]")
+{
+    REQUIRE_THROWS_AS(HealthProbe::parse("grpc://127.0.0.1:50051"), std::invalid_argument);
+    // port is required by tcp, out of range port
+    REQUIRE_THROWS_AS(HealthProbe::parse("tcp://127.0.0.1"), std::invalid_argument);
+    REQUIRE_THROWS_AS(HealthProbe::parse("tcp://127.0.0.1:65536"), std::invalid_argument);
+    REQUIRE_THROWS_AS(HealthProbe::parse("http://:8080/health"), std::invalid_argument);
+    // host name is not resolved by DNS
+    REQUIRE_THROWS_AS(HealthProbe::parse("http://example.com:8080/health"), std::invalid_argument);
+    REQUIRE_THROWS_AS(HealthProbe::parse("http://127.0.0.1:8080/health ok"), std::invalid_argument);
+    REQUIRE_THROWS_AS(HealthProbe::parse("unix://var/run/app.sock"), std::invalid_argument);
+    REQUIRE_THROWS_AS(HealthProbe::parse("unix:///" + std::string(200, 'a')), std::invalid_argument);
+    REQUIRE_THROWS_AS(HealthProbe::parse("file://"), std::invalid_argument);
+}
+
+TEST_CASE("HealthProbe file and pid probe finish immediately", "[HealthProbe]")
+{
+    auto pid = HealthProbe::parse("pid://");
+    REQUIRE(pid->start(::getpid(), 5));
+    REQUIRE(pid->healthy());
+    REQUIRE(pid->start(0, 5));
+    REQUIRE_FALSE(pid->healthy());
+
+    auto file = HealthProbe::parse("file:///not/exist/heartbeat");
+    REQUIRE(file->start(0, 5));
+    REQUIRE_FALSE(file->healthy());
+    auto exist = HealthProbe::parse("file:///proc/self");
+    REQUIRE(exist->start(0, 5));
+    REQUIRE(exist->healthy());
+}
+
+TEST_CASE("HealthProbe http status", "[HealthProbe]")
+{
+    SECTION("healthy status")
+    {
+        ProbeServer server("HTTP/1.0 200 OK\r\nContent-Length: 0\r\n\r\n");
+        auto probe = runProbe("http://127.0.0.1:" + std::to_string(server.port()) + "/health");
+        REQUIRE(probe->healthy());
+        REQUIRE(probe->error().empty());
+        // probe can be started again
+        REQUIRE(runProbe("http://localhost:" + std::to_string(server.port()))->healthy());
+    }
+
+    SECTION("unexpected status")
+    {
+        ProbeServer server("HTTP/1.1 500 Internal Server Error\r\n\r\n");
+        auto probe = runProbe("http://127.0.0.1:" + std::to_string(server.port()) + "/health");
+        REQUIRE_FALSE(probe->healthy());
+        REQUIRE(probe->error() == "HTTP status 500");
+    }
+
+    SECTION("expected status argument")
+    {
+        ProbeServer server("HTTP/1.1 200 OK\r\n\r\n");
+        const auto url = "http://127.0.0.1:" + std::to_string(server.port()) + "/health";
+        REQUIRE(runProbe(url + " 200")->healthy());
+        auto probe = runProbe(url + " 204");
+        REQUIRE_FALSE(probe->healthy());
+        REQUIRE(probe->error() == "HTTP status 200");
+    }
+
+    SECTION("invalid response")
+    {
+        ProbeServer server("SSH-2.0-OpenSSH\r\n");
+        auto probe = runProbe("http://127.0.0.1:" + std::to_string(server.port()));
+        REQUIRE_FALSE(probe->healthy());
+        REQUIRE(probe->error() == "invalid HTTP response");
+    }
+
+    SECTION("connection closed without response")
+    {
+        ProbeServer server("");
+        REQUIRE_FALSE(runProbe("http://127.0.0.1:" + std::to_string(server.port()))->healthy());
+    }
+}
+
+TEST_CASE("HealthProbe tcp connect", "[HealthProbe]")
+{
+    ProbeServer server("", false);
+    const auto target = "tcp://127.0.0.1:" + std::to_string(server.port());
+    REQUIRE(runProbe(target)->healthy());
+
+    // connection refused
+    server.close();
+    auto probe = runProbe(target);
+    REQUIRE_FALSE(probe->healthy());
+    REQUIRE(probe->error() == std::strerror(ECONNREFUSED));
+}
+
+TEST_CASE("HealthProbe timeout", "[HealthProbe]")
+{
+    // connected but never replied
+    ProbeServer server("", false);
+    auto probe = HealthProbe::parse("http://127.0.0.1:" + std::to_string(server.port()) + "/health");
+    REQUIRE_FALSE(probe->start(0, 5));
+    REQUIRE_FALSE(pollProbe(probe, 300));
+    REQUIRE(probe->fd() >= 0);
+    // request is sent, wait for response
+    REQUIRE(probe->events() == POLLIN);
+
+    REQUIRE_FALSE(probe->checkTimeout(std::chrono::steady_clock::now()));
+    REQUIRE(probe->checkTimeout(std::chrono::steady_clock::now() + std::chrono::seconds(6)));
+    REQUIRE_FALSE(probe->healthy());
+    REQUIRE(probe->error() == "health check timeout");
+    REQUIRE(probe->fd() < 0);
+    // finished probe never timeout again
+    REQUIRE_FALSE(probe->checkTimeout(std::chrono::steady_clock::now() + std::chrono::seconds(6)));
+}
+
+TEST_CASE("HealthProbe unix socket", "[HealthProbe]")
+{
+    const auto path = "/tmp/appmesh_test_probe_" + std::to_string(::getpid()) + ".sock";
+    ::unlink(path.c_str());
+    const auto spec = "unix://" + path;
+
+    // not exist
+    REQUIRE_FALSE(runProbe(spec)->healthy());
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    REQUIRE(::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == 0);
+    REQUIRE(::listen(fd, 8) == 0);
+    REQUIRE(runProbe(spec)->healthy());
+
+    // socket file left without listener
+    ::close(fd);
+    auto probe = runProbe(spec);
+    REQUIRE_FALSE(probe->healthy());
+    REQUIRE(probe->error() == std::strerror(ECONNREFUSED));
+    ::unlink(path.c_str());
+}
@@ -0,0 +1,84 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#include "../catch.hpp"
+#include <string>
+#include <cpprest/json.h>
+#include "../../src/common/Utility.h"
+#include "../../src/daemon/ConfigJournal.h"
+
+static web::json::value checkpoint()
+{
+    return web::json::value::parse(R"({
+        "Applications": [
+            {"name": "app1", "command": "sleep 10", "status": 1},
+            {"name": "app2", "command": "sleep 20", "status": 1}
+        ],
+        "Labels": {"os": "linux"}
+    })");
+}
+
+static std::string appNames(const web::json::value &config)
+{
+    std::string names;
+    for (const auto &app : config.at(JSON_KEY_Applications).as_array())
+    {
+        names.append(GET_JSON_STR_VALUE(app, JSON_KEY_APP_name)).append(",");
+    }
+    return names;
+}
+
+TEST_CASE("ConfigJournal replay records", "[ConfigJournal]")
+{
+    auto config = checkpoint();
+    const std::string journal =
+        R"({"op":"app_add","name":"app3","app":{"name":"app3","command":"sleep 30","status":1}})"
+        "\n"
+        R"({"op":"app_add","name":"app1","app":{"name":"app1","command":"sleep 11","status":1}})"
+        "\n"
+        R"({"op":"app_status","name":"app2","status":0})"
+        "\n"
+        R"({"op":"app_remove","name":"app3"})"
+        "\n"
+        "\n"
+        R"({"op":"label_set","name":"zone","value":"a"})"
+        "\n"
+        R"({"op":"label_remove","name":"os"})"
+        "\n"
+        R"({"op":"unknown","name":"x"})"
+        "\n";
+    REQUIRE(ConfigJournal::replay(config, journal) == 6);
+    REQUIRE(appNames(config) == "app1,app2,");
+    REQUIRE(GET_JSON_STR_VALUE(config.at(JSON_KEY_Applications)[0], JSON_KEY_APP_command) == "sleep 11");
+    REQUIRE(GET_JSON_INT_VALUE(config.at(JSON_KEY_Applications)[1], JSON_KEY_APP_status) == 0);
+    REQUIRE(config.at(JSON_KEY_Labels).serialize() == R"({"zone":"a"})");
+
+    // records are idempotent, replay twice get the same result
+    const auto once = config.serialize();
+    ConfigJournal::replay(config, journal);
+    REQUIRE(config.serialize() == once);
+}
+
+TEST_CASE("ConfigJournal replay truncated record", "[ConfigJournal]")
+{
+    auto config = checkpoint();
+    // partial record terminated on reopen is skipped, the following record is kept
+    const std::string journal =
+        R"({"op":"app_remove","name":"app1"})"
+        "\n"
+        R"({"op":"app_add","name":"app4","app":{"name":"ap)"
+        "\n"
+        R"({"op":"label_set","name":"zone","value":"b"})"
+        "\n"
+        // last record partially written when crash
+        R"({"op":"app_remove","na)";
+    REQUIRE(ConfigJournal::replay(config, journal) == 2);
+    REQUIRE(appNames(config) == "app2,");
+    REQUIRE(GET_JSON_STR_VALUE(config.at(JSON_KEY_Labels), "zone") == "b");
+}
+
+TEST_CASE("ConfigJournal replay on empty checkpoint", "[ConfigJournal]")
+{
+    auto config = web::json::value::object();
+    REQUIRE(ConfigJournal::replay(config, R"({"op":"label_set","name":"zone","value":"c"})") == 1);
+    REQUIRE(config.at(JSON_KEY_Applications).size() == 0);
+    REQUIRE(GET_JSON_STR_VALUE(config.at(JSON_KEY_Labels), "zone") == "c");
+}
@@ -0,0 +1,170 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "../catch.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cpprest/json.h>
+#include "../../src/common/JsonWriter.h"
+#include "../../src/common/Utility.h"
+#include "../../src/daemon/Configuration.h"
+#include "../../src/daemon/application/Application.h"
+#include "../DaemonFixture.h"
+
+// minimal and full application definitions, owner is not set to avoid security init
+static std::vector<web::json::value> appDefinitions(std::size_t count)
+{
+    std::vector<web::json::value> apps;
+    apps.push_back(web::json::value::parse("{\"name\": \"app_min\", \"command\": \"sleep 60\"}"));
+    for (std::size_t i = 0; i < count; i++)
+    {
+        auto app = web::json::value::object();
+        app[JSON_KEY_APP_name] = web::json::value::string("app_" + std::to_string(i));
+        app[JSON_KEY_APP_command] = web::json::value::string("/bin/sleep " + std::to_string(i) + " \"quoted\"\t\\path");
+        app[JSON_KEY_APP_shell_mode] = web::json::value::boolean(i % 3 == 0);
+        app[JSON_KEY_APP_working_dir] = web::json::value::string("/tmp");
+        app[JSON_KEY_APP_status] = web::json::value::number(static_cast<int>(i % 2));
+        app[JSON_KEY_APP_owner_permission] = web::json::value::number(11);
+        app[JSON_KEY_APP_stdout_cache_num] = web::json::value::number(2);
+        app[JSON_KEY_APP_version] = web::json::value::number(static_cast<int>(i));
+        app[JSON_KEY_APP_metadata] = web::json::value::parse("{\"team\": \"ops\", \"replica\": 3}");
+        for (int e = 0; e < 10; e++)
+        {
+            app[JSON_KEY_APP_env]["ENV_" + std::to_string(e)] = web::json::value::string("value_" + std::to_string(e));
+        }
+        app[JSON_KEY_APP_sec_env]["TOKEN"] = web::json::value::string("secret");
+        app[JSON_KEY_APP_daily_limitation][JSON_KEY_DAILY_LIMITATION_daily_start] = web::json::value::string("09:00:00");
+        app[JSON_KEY_APP_daily_limitation][JSON_KEY_DAILY_LIMITATION_daily_end] = web::json::value::string("20:00:00");
+        app[JSON_KEY_APP_resource_limit][JSON_KEY_RESOURCE_LIMITATION_memory_mb] = web::json::value::number(512);
+        app[JSON_KEY_APP_resource_limit][JSON_KEY_RESOURCE_LIMITATION_cpu_shares] = web::json::value::number(100);
+        app[JSON_KEY_SHORT_APP_start_time] = web::json::value::string("2020-10-11T09:22:05");
+        app[JSON_KEY_APP_behavior][JSON_KEY_APP_behavior_exit] = web::json::value::string(JSON_KEY_APP_behavior_restart);
+        if (i % 2)
+        {
+            app[JSON_KEY_SHORT_APP_start_interval_seconds] = web::json::value::string("PT5M");
+            app[JSON_KEY_APP_retention] = web::json::value::string("PT10S");
+        }
+        apps.push_back(app);
+    }
+    return apps;
+}
+
+static std::vector<std::shared_ptr<Application>> buildApps(std::size_t count)
+{
+    auto config = initConfig();
+    std::vector<std::shared_ptr<Application>> apps;
+    for (const auto &definition : appDefinitions(count))
+    {
+        apps.push_back(config->parseApp(definition));
+    }
+    return apps;
+}
+
+static std::string writeJson(const std::shared_ptr<Application> &app, bool returnRuntimeInfo)
+{
+    std::string buffer;
+    JsonWriter writer(buffer);
+    app->writeJson(writer, returnRuntimeInfo);
+    return buffer;
+}
+
+// cpprest object keeps keys sorted, compare the serialized canonical DOM
+static std::string canonical(const std::string &json)
+{
+    return web::json::value::parse(json).serialize();
+}
+
+TEST_CASE("Application writeJson equivalent with AsJson", "[JsonWriter]")
+{
+    for (const auto &app : buildApps(6))
+    {
+        INFO(app->getName());
+        REQUIRE(canonical(writeJson(app, false)) == app->AsJson(false).serialize());
+        REQUIRE(canonical(writeJson(app, true)) == app->AsJson(true).serialize());
+        // runtime cache is produced by writeJson
+        REQUIRE(canonical(*app->AsJsonCached()) == app->AsJson(true).serialize());
+    }
+}
+
+TEST_CASE("Configuration writeJson equivalent with AsJson", "[JsonWriter]")
+{
+    auto config = initConfig();
+    for (const auto &definition : appDefinitions(3))
+    {
+        auto app = definition;
+        // disabled application is registered without start process
+        app[JSON_KEY_APP_status] = web::json::value::number(0);
+        config->addApp(app, false);
+    }
+    REQUIRE(config->getApps()->size() == 4);
+
+    std::string buffer;
+    JsonWriter writer(buffer);
+    config->writeJson(writer, "");
+    REQUIRE(canonical(buffer) == config->AsJson(false, "").serialize());
+
+    std::string pretty;
+    JsonWriter prettyWriter(pretty, true);
+    config->writeJson(prettyWriter, "");
+    REQUIRE(pretty == Utility::prettyJson(buffer));
+
+    for (const auto &app : *config->getApps())
+    {
+        config->removeApp(app->getName(), false);
+    }
+}
+
+TEST_CASE("JsonWriter escape and number format", "[JsonWriter]")
+{
+    std::string buffer;
+    JsonWriter writer(buffer);
+    writer.startArray();
+    writer.value(std::string("a\"b\\c\n\r\t\b\f") + '\x01');
+    writer.value(-12).value(int64_t(-9007199254740993LL)).value(uint64_t(18446744073709551615ULL));
+    writer.value(0.1).value(1e300).value(true).null();
+    writer.startObject().endObject().startArray().endArray();
+    writer.endArray();
+
+    auto dom = web::json::value::array();
+    dom[0] = web::json::value::string(std::string("a\"b\\c\n\r\t\b\f") + '\x01');
+    dom[1] = web::json::value::number(-12);
+    dom[2] = web::json::value::number(int64_t(-9007199254740993LL));
+    dom[3] = web::json::value::number(uint64_t(18446744073709551615ULL));
+    dom[4] = web::json::value::number(0.1);
+    dom[5] = web::json::value::number(1e300);
+    dom[6] = web::json::value::boolean(true);
+    dom[7] = web::json::value::null();
+    dom[8] = web::json::value::object();
+    dom[9] = web::json::value::array();
+    REQUIRE(buffer == dom.serialize());
+    REQUIRE(web::json::value::parse(buffer) == dom);
+}
+
+TEST_CASE("JsonWriter benchmark", "[JsonWriter][!benchmark]")
+{
+    const auto apps = buildApps(1000);
+    std::string buffer;
+
+    BENCHMARK("AsJson build and serialize 1000 applications")
+    {
+        auto result = web::json::value::array(apps.size());
+        for (std::size_t i = 0; i < apps.size(); i++)
+        {
+            result[i] = apps[i]->AsJson(true);
+        }
+        return result.serialize().length();
+    };
+
+    BENCHMARK("writeJson stream 1000 applications with reused buffer")
+    {
+        buffer.clear();
+        JsonWriter writer(buffer);
+        writer.startArray();
+        for (const auto &app : apps)
+        {
+            app->writeJson(writer, true);
+        }
+        writer.endArray();
+        return buffer.length();
+    };
+}
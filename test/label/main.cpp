@@ -0,0 +1,168 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "../catch.hpp"
+#include <map>
+#include <string>
+#include <vector>
+#include "../../src/daemon/Label.h"
+#include "../../src/daemon/consul/LabelIndex.h"
+
+typedef std::map<std::string, std::string> Labels;
+
+TEST_CASE("LabelMatcher exact and wildcard", "[LabelIndex]")
+{
+    const Labels node = {{"os", "centos7.6"}, {"arch", "x86_64"}, {"zone", "zone-a"}};
+    REQUIRE(LabelMatcher(Labels()).match(node));
+    REQUIRE(LabelMatcher(Labels{{"arch", "x86_64"}}).match(node));
+    REQUIRE(LabelMatcher(Labels{{"os", "centos*"}, {"zone", "zone-?"}}).match(node));
+    REQUIRE_FALSE(LabelMatcher(Labels{{"os", "ubuntu*"}}).match(node));
+    REQUIRE_FALSE(LabelMatcher(Labels{{"gpu", "*"}}).match(node));
+    REQUIRE_FALSE(LabelMatcher(Labels{{"arch", "x86_64"}, {"zone", "zone-b"}}).match(node));
+
+    REQUIRE(LabelMatcher::isWildcard("centos*"));
+    REQUIRE(LabelMatcher::isWildcard("zone-[ab]"));
+    REQUIRE_FALSE(LabelMatcher::isWildcard("x86_64"));
+}
+
+TEST_CASE("LabelIndex intersect posting lists", "[LabelIndex]")
+{
+    LabelIndex index;
+    index.addNode(Labels{{"zone", "a"}, {"os", "centos7"}});
+    index.addNode(Labels{{"zone", "b"}, {"os", "centos8"}});
+    index.addNode(Labels{{"zone", "a"}, {"os", "ubuntu"}, {"gpu", "true"}});
+    index.addNode(Labels());
+    REQUIRE(index.size() == 4);
+
+    REQUIRE(index.match(LabelMatcher(Labels())) == std::vector<std::size_t>({0, 1, 2, 3}));
+    REQUIRE(index.match(LabelMatcher(Labels{{"zone", "a"}})) == std::vector<std::size_t>({0, 2}));
+    REQUIRE(index.match(LabelMatcher(Labels{{"os", "centos*"}})) == std::vector<std::size_t>({0, 1}));
+    REQUIRE(index.match(LabelMatcher(Labels{{"zone", "a"}, {"os", "centos*"}})) == std::vector<std::size_t>({0}));
+    REQUIRE(index.match(LabelMatcher(Labels{{"gpu", "true"}, {"zone", "a"}})) == std::vector<std::size_t>({2}));
+    REQUIRE(index.match(LabelMatcher(Labels{{"zone", "c"}})).empty());
+    REQUIRE(index.match(LabelMatcher(Labels{{"rack", "*"}})).empty());
+}
+
+static std::shared_ptr<Label> toLabel(const Labels &labels)
+{
+    auto label = std::make_shared<Label>();
+    for (const auto &la : labels)
+        label->addLabel(la.first, la.second);
+    return label;
+}
+
+// 10 zones, 4 os versions, every 7th node has GPU, each node has unique host name label
+struct LabelledCluster
+{
+    LabelledCluster(std::size_t nodeCount, std::size_t taskCount)
+    {
+        const std::vector<std::string> os = {"centos7.6", "centos8.2", "ubuntu18.04", "ubuntu20.04"};
+        for (std::size_t i = 0; i < nodeCount; i++)
+        {
+            Labels labels = {{"HOST_NAME", "node" + std::to_string(i)}, {"arch", i % 5 ? "x86_64" : "aarch64"}, {"zone", "zone" + std::to_string(i % 10)}, {"os_version", os[i % os.size()]}};
+            if (i % 7 == 0)
+                labels["gpu"] = "true";
+            m_nodes.push_back(toLabel(labels));
+            m_nodeLabels.push_back(m_nodes.back()->getLabels());
+        }
+        for (std::size_t i = 0; i < taskCount; i++)
+        {
+            Labels condition = {{"zone", "zone" + std::to_string(i % 10)}};
+            if (i % 2)
+                condition["arch"] = "x86_64";
+            if (i % 3 == 0)
+                condition["os_version"] = i % 2 ? "centos*" : "ubuntu20.04";
+            if (i % 11 == 0)
+                condition["gpu"] = "true";
+            if (i % 50 == 0)
+                condition = {{"HOST_NAME", "node" + std::to_string(i)}};
+            m_tasks.push_back(toLabel(condition));
+        }
+    }
+
+    std::vector<std::shared_ptr<Label>> m_nodes;
+    // label copy of each node, taken once per schedule
+    std::vector<Labels> m_nodeLabels;
+    std::vector<std::shared_ptr<Label>> m_tasks;
+};
+
+// Label::match for every task and node pair
+static std::size_t pairSchedule(const LabelledCluster &cluster)
+{
+    std::size_t matched = 0;
+    for (const auto &task : cluster.m_tasks)
+    {
+        for (const auto &node : cluster.m_nodes)
+        {
+            if (node->match(task))
+                matched++;
+        }
+    }
+    return matched;
+}
+
+static std::size_t compiledSchedule(const LabelledCluster &cluster)
+{
+    std::size_t matched = 0;
+    for (const auto &task : cluster.m_tasks)
+    {
+        const LabelMatcher matcher(task->getLabels());
+        for (const auto &node : cluster.m_nodeLabels)
+        {
+            if (matcher.match(node))
+                matched++;
+        }
+    }
+    return matched;
+}
+
+static std::size_t indexSchedule(const LabelledCluster &cluster, const std::vector<LabelMatcher> &matchers)
+{
+    LabelIndex index;
+    for (const auto &node : cluster.m_nodeLabels)
+        index.addNode(node);
+    std::size_t matched = 0;
+    for (const auto &matcher : matchers)
+        matched += index.match(matcher).size();
+    return matched;
+}
+
+TEST_CASE("LabelIndex match same nodes as Label::match", "[LabelIndex]")
+{
+    LabelledCluster cluster(1000, 200);
+    LabelIndex index;
+    for (const auto &node : cluster.m_nodes)
+        index.addNode(node->getLabels());
+    for (const auto &task : cluster.m_tasks)
+    {
+        std::vector<std::size_t> expected;
+        for (std::size_t node = 0; node < cluster.m_nodes.size(); node++)
+        {
+            if (cluster.m_nodes[node]->match(task))
+                expected.push_back(node);
+        }
+        REQUIRE(index.match(LabelMatcher(task->getLabels())) == expected);
+    }
+}
+
+TEST_CASE("Match 1k tasks over 10k nodes benchmark", "[LabelIndex][!benchmark]")
+{
+    LabelledCluster cluster(10000, 1000);
+    // task conditions are compiled once when task is parsed
+    std::vector<LabelMatcher> matchers;
+    for (const auto &task : cluster.m_tasks)
+        matchers.push_back(LabelMatcher(task->getLabels()));
+    REQUIRE(pairSchedule(cluster) == indexSchedule(cluster, matchers));
+
+    BENCHMARK("Label::match per task and node")
+    {
+        return pairSchedule(cluster);
+    };
+    BENCHMARK("compiled matcher per task and node")
+    {
+        return compiledSchedule(cluster);
+    };
+    BENCHMARK("inverted label index (include index build)")
+    {
+        return indexSchedule(cluster, matchers);
+    };
+}
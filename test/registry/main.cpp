@@ -0,0 +1,244 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "../catch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cpprest/json.h>
+#include "../../src/common/RcuRegistry.h"
+#include "../../src/common/Utility.h"
+#include "../../src/daemon/Configuration.h"
+#include "../../src/daemon/application/Application.h"
+#include "../DaemonFixture.h"
+
+struct Item
+{
+    explicit Item(const std::string &name) : m_name(name) {}
+    const std::string &getName() const { return m_name; }
+    std::string m_name;
+};
+
+// baseline: vector with recursive mutex, copy on read and scan by name
+class LockedRegistry
+{
+public:
+    std::vector<std::shared_ptr<Item>> getApps() const
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_mutex);
+        return m_apps;
+    }
+    std::shared_ptr<Item> find(const std::string &name) const
+    {
+        auto apps = getApps();
+        auto iter = std::find_if(apps.begin(), apps.end(), [&name](const std::shared_ptr<Item> &app)
+                                 { return app->getName() == name; });
+        return iter == apps.end() ? nullptr : *iter;
+    }
+    void put(const std::shared_ptr<Item> &item)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_mutex);
+        for (auto &app : m_apps)
+        {
+            if (app->getName() == item->getName())
+            {
+                app = item;
+                return;
+            }
+        }
+        m_apps.push_back(item);
+    }
+    void remove(const std::string &name)
+    {
+        std::lock_guard<std::recursive_mutex> guard(m_mutex);
+        m_apps.erase(std::remove_if(m_apps.begin(), m_apps.end(), [&name](const std::shared_ptr<Item> &app)
+                                    { return app->getName() == name; }),
+                     m_apps.end());
+    }
+
+private:
+    std::vector<std::shared_ptr<Item>> m_apps;
+    mutable std::recursive_mutex m_mutex;
+};
+
+static std::string appName(std::size_t i)
+{
+    return "app_" + std::to_string(i);
+}
+
+TEST_CASE("RcuRegistry operations", "[RcuRegistry]")
+{
+    RcuRegistry<Item> registry;
+    REQUIRE(registry.snapshot()->empty());
+    REQUIRE(registry.add("a", std::make_shared<Item>("a")));
+    REQUIRE_FALSE(registry.add("a", std::make_shared<Item>("a")));
+    REQUIRE(registry.put("b", std::make_shared<Item>("b")) == nullptr);
+    REQUIRE(registry.put("c", std::make_shared<Item>("c")) == nullptr);
+
+    // replace keep position
+    auto oldB = registry.find("b");
+    auto newB = std::make_shared<Item>("b");
+    REQUIRE(registry.put("b", newB) == oldB);
+    REQUIRE(registry.find("b") == newB);
+
+    // old snapshot is not changed by writer
+    auto snapshot = registry.snapshot();
+    REQUIRE(registry.remove("a")->getName() == "a");
+    REQUIRE(registry.remove("a") == nullptr);
+    REQUIRE(snapshot->size() == 3);
+    REQUIRE(snapshot->find("a") != nullptr);
+
+    // order and index after remove
+    auto current = registry.snapshot();
+    REQUIRE(current->size() == 2);
+    REQUIRE(current->items()[0] == newB);
+    REQUIRE(current->items()[1]->getName() == "c");
+    REQUIRE(current->find("c") == current->items()[1]);
+    REQUIRE(current->find("a") == nullptr);
+    REQUIRE(registry.version() == 5);
+}
+
+TEST_CASE("RcuRegistry concurrent read and write", "[RcuRegistry]")
+{
+    RcuRegistry<Item> registry;
+    for (std::size_t i = 0; i < 100; i++)
+        registry.put(appName(i), std::make_shared<Item>(appName(i)));
+
+    std::atomic<bool> stop(false);
+    std::atomic<std::size_t> failed(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++)
+    {
+        readers.emplace_back([&]()
+                             {
+                                 while (!stop)
+                                 {
+                                     auto snapshot = registry.snapshot();
+                                     for (const auto &item : *snapshot)
+                                     {
+                                         if (snapshot->find(item->getName()) != item)
+                                             failed++;
+                                     }
+                                     // stable apps are never removed
+                                     if (snapshot->find(appName(0)) == nullptr)
+                                         failed++;
+                                 }
+                             });
+    }
+    for (std::size_t i = 0; i < 2000; i++)
+    {
+        const auto name = appName(100 + (i / 2) % 10);
+        if (i % 2)
+            registry.remove(name);
+        else
+            registry.put(name, std::make_shared<Item>(name));
+    }
+    stop = true;
+    for (auto &reader : readers)
+        reader.join();
+    REQUIRE(failed == 0);
+    REQUIRE(registry.snapshot()->size() == 100);
+}
+
+// REST readers list and lookup applications while a writer keeps adding and removing run applications
+template <typename Registry, typename ReadFn, typename ChurnFn>
+static std::size_t contention(Registry &registry, const ReadFn &read, const ChurnFn &churn)
+{
+    std::atomic<bool> stop(false);
+    std::thread writer([&]()
+                       {
+                           std::size_t i = 0;
+                           while (!stop)
+                           {
+                               churn(registry, i++);
+                               std::this_thread::yield();
+                           }
+                       });
+    std::vector<std::thread> readers;
+    std::atomic<std::size_t> total(0);
+    for (int t = 0; t < 4; t++)
+    {
+        readers.emplace_back([&, t]()
+                             {
+                                 std::size_t found = 0;
+                                 for (std::size_t i = 0; i < 2000; i++)
+                                     found += read(registry, t * 2000 + i);
+                                 total += found;
+                             });
+    }
+    for (auto &reader : readers)
+        reader.join();
+    stop = true;
+    writer.join();
+    return total;
+}
+
+// disabled application, registered without start process
+static web::json::value appJson(const std::string &name)
+{
+    auto app = web::json::value::object();
+    app[JSON_KEY_APP_name] = web::json::value::string(name);
+    app[JSON_KEY_APP_command] = web::json::value::string("sleep 60");
+    app[JSON_KEY_APP_status] = web::json::value::number(0);
+    return app;
+}
+
+TEST_CASE("Application registry contention benchmark", "[RcuRegistry][!benchmark]")
+{
+    const std::size_t appCount = 1000;
+    auto config = initConfig();
+    LockedRegistry locked;
+    for (std::size_t i = 0; i < appCount; i++)
+    {
+        auto app = config->addApp(appJson(appName(i)), false);
+        locked.put(std::make_shared<Item>(app->getName()));
+    }
+
+    BENCHMARK("locked vector: 4 readers (lookup + list every 10th) with app churn")
+    {
+        return contention(
+            locked,
+            [appCount](LockedRegistry &r, std::size_t i) -> std::size_t
+            {
+                std::size_t found = r.find(appName(i % appCount)) ? 1 : 0;
+                if (i % 10 == 0)
+                    found += r.getApps().size();
+                return found;
+            },
+            [appCount](LockedRegistry &r, std::size_t i)
+            {
+                const auto name = appName(appCount + (i / 2) % 16);
+                if (i % 2)
+                    r.remove(name);
+                else
+                    r.put(std::make_shared<Item>(name));
+            });
+    };
+
+    BENCHMARK("Configuration: 4 readers (getApp + getApps every 10th) with addApp/removeApp churn")
+    {
+        return contention(
+            *config,
+            [appCount](Configuration &r, std::size_t i) -> std::size_t
+            {
+                std::size_t found = r.getApp(appName(i % appCount)) ? 1 : 0;
+                if (i % 10 == 0)
+                    found += r.getApps()->size();
+                return found;
+            },
+            [appCount](Configuration &r, std::size_t i)
+            {
+                const auto name = appName(appCount + (i / 2) % 16);
+                if (i % 2)
+                    r.removeApp(name, false);
+                else
+                    r.addApp(appJson(name), false);
+            });
+    };
+
+    for (const auto &app : *config->getApps())
+        config->removeApp(app->getName(), false);
+}
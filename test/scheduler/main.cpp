@@ -0,0 +1,239 @@
+#define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "../catch.hpp"
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <cpprest/json.h>
+#include "../../src/daemon/Configuration.h"
+#include "../../src/daemon/application/Application.h"
+#include "../../src/daemon/consul/ConsulEntity.h"
+#include "../../src/daemon/consul/ResourceScheduler.h"
+#include "../../src/daemon/consul/Scheduler.h"
+#include "../DaemonFixture.h"
+
+static const uint64_t GB = 1024ULL * 1024 * 1024;
+static const uint64_t MB = 1024ULL * 1024;
+
+static std::vector<std::size_t> allNodes(const ResourceScheduler &scheduler)
+{
+    std::vector<std::size_t> nodes(scheduler.nodes().size());
+    for (std::size_t i = 0; i < nodes.size(); i++)
+        nodes[i] = i;
+    return nodes;
+}
+
+TEST_CASE("ResourceScheduler strategy name", "[ResourceScheduler]")
+{
+    REQUIRE(ResourceScheduler::parseStrategy("") == ResourceScheduler::Strategy::SPREAD);
+    REQUIRE(ResourceScheduler::parseStrategy("binpack") == ResourceScheduler::Strategy::BINPACK);
+    REQUIRE(ResourceScheduler::parseStrategy("leastloaded") == ResourceScheduler::Strategy::LEAST_LOADED);
+    REQUIRE_THROWS_AS(ResourceScheduler::parseStrategy("random"), std::invalid_argument);
+    REQUIRE(ResourceScheduler::strategyName(ResourceScheduler::parseStrategy("binpack")) == "binpack");
+}
+
+TEST_CASE("ResourceScheduler place one replica per node", "[ResourceScheduler]")
+{
+    ResourceScheduler scheduler(ResourceScheduler::Strategy::SPREAD);
+    for (int i = 0; i < 3; i++)
+        scheduler.addNode("host" + std::to_string(i), 4, 8 * GB);
+    scheduler.addRequest("app", 0, 5, 0, 0, allNodes(scheduler));
+    scheduler.schedule();
+
+    const auto &placement = scheduler.requests()[0].m_placement;
+    REQUIRE(placement.size() == 3);
+    REQUIRE(std::set<std::size_t>(placement.begin(), placement.end()).size() == 3);
+}
+
+TEST_CASE("ResourceScheduler share heap between requests", "[ResourceScheduler]")
+{
+    ResourceScheduler scheduler(ResourceScheduler::Strategy::SPREAD);
+    for (int i = 0; i < 3; i++)
+        scheduler.addNode("host" + std::to_string(i), 4, 8 * GB);
+    // same candidates in different order use one heap, score of assigned node is updated
+    scheduler.addRequest("app1", 0, 2, 0, 1 * GB, {0, 1, 2});
+    scheduler.addRequest("app2", 0, 2, 0, 1 * GB, {2, 1, 0});
+    scheduler.schedule();
+
+    std::map<std::size_t, int> apps;
+    for (const auto &request : scheduler.requests())
+    {
+        REQUIRE(request.m_placement.size() == 2);
+        for (const auto node : request.m_placement)
+            apps[node]++;
+    }
+    // spread 4 replicas to 3 nodes
+    REQUIRE(apps.size() == 3);
+    for (const auto &node : scheduler.nodes())
+        REQUIRE(node.m_apps <= 2);
+}
+
+TEST_CASE("ResourceScheduler respect priority and resource", "[ResourceScheduler]")
+{
+    ResourceScheduler scheduler(ResourceScheduler::Strategy::SPREAD);
+    scheduler.addNode("small", 2, 4 * GB);
+    const auto candidates = allNodes(scheduler);
+    // added first but lower priority, no memory left after high priority one
+    scheduler.addRequest("low", 1, 1, 0, 2 * GB, candidates);
+    scheduler.addRequest("high", 10, 1, 0, 3 * GB, candidates);
+    // CPU request exceed node cores
+    scheduler.addRequest("cpu", 100, 1, 4, 1 * MB, candidates);
+    scheduler.schedule();
+
+    REQUIRE(scheduler.requests()[0].m_placement.empty());
+    REQUIRE(scheduler.requests()[1].m_placement.size() == 1);
+    REQUIRE(scheduler.requests()[2].m_placement.empty());
+    REQUIRE(scheduler.nodes()[0].m_memoryUsed == 3 * GB);
+    REQUIRE(scheduler.nodes()[0].m_apps == 1);
+}
+
+TEST_CASE("ResourceScheduler keep running replicas", "[ResourceScheduler]")
+{
+    ResourceScheduler scheduler(ResourceScheduler::Strategy::SPREAD);
+    for (int i = 0; i < 4; i++)
+        scheduler.addNode("host" + std::to_string(i), 4, 8 * GB);
+    // host3 is running but not matched any more
+    scheduler.addRequest("app", 0, 2, 0, 1 * GB, {0, 1, 2}, {2, 3});
+    scheduler.schedule();
+
+    const auto &request = scheduler.requests()[0];
+    REQUIRE(request.m_kept == 1);
+    REQUIRE(request.m_placement.size() == 2);
+    REQUIRE(request.m_placement[0] == 2);
+    REQUIRE(request.m_placement[1] != 3);
+}
+
+TEST_CASE("ResourceScheduler incremental schedule", "[ResourceScheduler]")
+{
+    ResourceScheduler scheduler(ResourceScheduler::Strategy::SPREAD, 3);
+    for (int i = 0; i < 6; i++)
+        scheduler.addNode("host" + std::to_string(i), 4, 8 * GB);
+    // stable: all replicas running on matched hosts, nothing moved
+    scheduler.addRequest("stable", 0, 2, 0, 1 * GB, allNodes(scheduler), {0, 1});
+    // over-replicated: scale down from 3 to 1, keep first running replica
+    scheduler.addRequest("shrink", 0, 1, 0, 1 * GB, allNodes(scheduler), {2, 3, 4});
+    // orphaned replica on host5 and scale up, limited by max moves
+    scheduler.addRequest("grow", 1, 5, 0, 1 * GB, {0, 1, 2, 3, 4}, {0, 5});
+    scheduler.schedule();
+
+    const auto &requests = scheduler.requests();
+    REQUIRE(requests[0].m_placement == std::vector<std::size_t>({0, 1}));
+    REQUIRE(requests[1].m_placement == std::vector<std::size_t>({2}));
+    REQUIRE(requests[2].m_kept == 1);
+    REQUIRE(requests[2].m_placement.size() == 4);
+    REQUIRE(scheduler.moves() == 3);
+}
+
+TEST_CASE("ResourceScheduler strategies", "[ResourceScheduler]")
+{
+    auto run = [](ResourceScheduler::Strategy strategy)
+    {
+        ResourceScheduler scheduler(strategy);
+        scheduler.addNode("busy", 8, 16 * GB, 4, 8 * GB, 4);
+        scheduler.addNode("idle", 8, 16 * GB);
+        scheduler.addRequest("app", 0, 1, 1, 1 * GB, allNodes(scheduler));
+        scheduler.schedule();
+        return scheduler.nodes()[scheduler.requests()[0].m_placement.at(0)].m_name;
+    };
+    REQUIRE(run(ResourceScheduler::Strategy::SPREAD) == "idle");
+    REQUIRE(run(ResourceScheduler::Strategy::LEAST_LOADED) == "idle");
+    REQUIRE(run(ResourceScheduler::Strategy::BINPACK) == "busy");
+}
+
+// Consul cluster: nodes in 10 zones, most tasks match one zone, every 50th task match all nodes
+struct ConsulCluster
+{
+    ConsulCluster(std::size_t nodeCount, std::size_t taskCount, std::size_t replicas)
+    {
+        auto config = initConfig();
+        const std::size_t zones = 10;
+        std::vector<std::map<std::string, std::shared_ptr<ConsulNode>>> zoneHosts(zones);
+        for (std::size_t i = 0; i < nodeCount; i++)
+        {
+            auto node = std::make_shared<ConsulNode>();
+            node->m_hostName = "node" + std::to_string(i);
+            node->m_cores = 16 + (i % 4) * 16;
+            node->m_total_bytes = (32 + (i % 4) * 32) * GB;
+            m_nodes[node->m_hostName] = node;
+            zoneHosts[i % zones][node->m_hostName] = node;
+        }
+        for (std::size_t i = 0; i < taskCount; i++)
+        {
+            auto task = std::make_shared<ConsulTask>();
+            const auto name = "task" + std::to_string(i);
+            task->m_app = config->parseApp(web::json::value::parse("{\"name\": \"" + name + "\", \"command\": \"sleep 60\"}"));
+            task->m_replication = replicas;
+            task->m_priority = static_cast<int>(i % 5);
+            task->m_requestCpu = 0.25 * (1 + i % 4);
+            task->m_requestMemMega = 64 + (i % 8) * 64;
+            task->m_matchedHosts = (i % 50 == 0) ? m_nodes : zoneHosts[i % zones];
+            m_tasks[name] = task;
+        }
+        reset();
+    }
+
+    // schedule consume task set and occupy node resource, restore before each schedule
+    void reset()
+    {
+        for (const auto &node : m_nodes)
+        {
+            node.second->m_assignedApps.clear();
+            node.second->m_occupyMemoryBytes = 0;
+        }
+        for (const auto &task : m_tasks)
+        {
+            task.second->m_tasksSet.clear();
+            for (std::size_t i = 1; i <= task.second->m_replication; i++)
+                task.second->m_tasksSet.insert(i);
+        }
+    }
+
+    std::map<std::string, std::shared_ptr<ConsulNode>> m_nodes;
+    std::map<std::string, std::shared_ptr<ConsulTask>> m_tasks;
+};
+
+static std::size_t scheduleCluster(ConsulCluster &cluster, ResourceScheduler::Strategy strategy)
+{
+    cluster.reset();
+    const auto topology = Scheduler::scheduleTask(cluster.m_tasks, std::map<std::string, std::shared_ptr<ConsulTopology>>(), strategy);
+    std::size_t placed = 0;
+    for (const auto &host : topology)
+        placed += host.second->m_scheduleApps.size();
+    return placed;
+}
+
+TEST_CASE("Scheduler place all replicas of Consul tasks", "[Scheduler]")
+{
+    ConsulCluster cluster(500, 500, 10);
+    for (const auto strategy : {ResourceScheduler::Strategy::SPREAD, ResourceScheduler::Strategy::BINPACK, ResourceScheduler::Strategy::LEAST_LOADED})
+    {
+        REQUIRE(scheduleCluster(cluster, strategy) == 5000);
+        std::size_t assigned = 0;
+        for (const auto &node : cluster.m_nodes)
+            assigned += node.second->m_assignedApps.size();
+        REQUIRE(assigned == 5000);
+        for (const auto &task : cluster.m_tasks)
+            REQUIRE(task.second->m_tasksSet.empty());
+    }
+}
+
+TEST_CASE("Scheduler::scheduleTask benchmark", "[Scheduler][!benchmark]")
+{
+    // 1000 tasks x 50 replicas (50k) over 5000 nodes, include task set and node resource reset
+    ConsulCluster cluster(5000, 1000, 50);
+
+    BENCHMARK("scheduleTask: spread")
+    {
+        return scheduleCluster(cluster, ResourceScheduler::Strategy::SPREAD);
+    };
+    BENCHMARK("scheduleTask: binpack")
+    {
+        return scheduleCluster(cluster, ResourceScheduler::Strategy::BINPACK);
+    };
+    BENCHMARK("scheduleTask: leastloaded")
+    {
+        return scheduleCluster(cluster, ResourceScheduler::Strategy::LEAST_LOADED);
+    };
+}
@@ -1,6 +1,9 @@
 #define CATCH_CONFIG_MAIN // This tells Catch to provide a main() - only do this in one cpp file
 #include "../../src/common/DateTime.h"
 #include "../../src/common/Utility.h"
+#include "../../src/daemon/Configuration.h"
+#include "../../src/daemon/security/Security.h"
+#include "../../src/daemon/security/TokenCache.h"
 #include "../../src/daemon/security/ldapplugin/ldapcpp/cldap.h"
 #include "../catch.hpp"
 #include <ace/Init_ACE.h>
@@ -20,6 +23,8 @@
 #include <thread>
 #include <time.h>
 
+#include "../DaemonFixture.h"
+
 TEST_CASE("ldapcpp Test", "[security]")
 {
 
@@ -61,3 +66,140 @@ TEST_CASE("ldapcpp Test", "[security]")
         }
     }
 }
+
+static std::shared_ptr<const TokenCacheEntry> tokenEntry(const std::string &token, const std::string &userName, uint64_t permissions = 0,
+                                                         const std::chrono::system_clock::time_point &expireTime = std::chrono::system_clock::now() + std::chrono::hours(1))
+{
+    return std::make_shared<TokenCacheEntry>(token, userName, "", expireTime, permissions);
+}
+
+static std::shared_ptr<Security> testSecurity()
+{
+    return Security::FromJson(web::json::value::parse(R"({
+        "Roles": {
+            "viewer": ["app-view", "app-reg"],
+            "legacy": ["no-such-permission"]
+        },
+        "Users": {
+            "user1": {"key": "pwd1", "roles": ["viewer", "legacy"]},
+            "user2": {"key": "pwd2", "roles": ["viewer"]}
+        }
+    })"));
+}
+
+TEST_CASE("TokenCache LRU eviction", "[TokenCache]")
+{
+    TokenCache cache(2, 0);
+    cache.put(tokenEntry("token1", "user1"));
+    cache.put(tokenEntry("token2", "user1"));
+    // touch token1, token2 become least recently used
+    REQUIRE(cache.get("token1") != nullptr);
+    cache.put(tokenEntry("token3", "user1"));
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.get("token2") == nullptr);
+    REQUIRE(cache.get("token1") != nullptr);
+    REQUIRE(cache.get("token3") != nullptr);
+
+    // put same token again replace the entry
+    cache.put(tokenEntry("token3", "user2"));
+    REQUIRE(cache.size() == 2);
+    REQUIRE(cache.get("token3")->m_userName == "user2");
+
+    // zero capacity disable cache
+    TokenCache disabled(0, 0);
+    disabled.put(tokenEntry("token1", "user1"));
+    REQUIRE(disabled.size() == 0);
+    REQUIRE(disabled.get("token1") == nullptr);
+}
+
+TEST_CASE("TokenCache expiration", "[TokenCache]")
+{
+    SECTION("JWT expired")
+    {
+        TokenCache cache(4, 0);
+        cache.put(tokenEntry("token1", "user1", 0, std::chrono::system_clock::now() - std::chrono::seconds(1)));
+        REQUIRE(cache.get("token1") == nullptr);
+        REQUIRE(cache.size() == 0);
+    }
+
+    SECTION("cache TTL")
+    {
+        TokenCache cache(4, 1);
+        cache.put(tokenEntry("token1", "user1"));
+        REQUIRE(cache.get("token1") != nullptr);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        REQUIRE(cache.get("token1") == nullptr);
+        REQUIRE(cache.size() == 0);
+    }
+}
+
+TEST_CASE("TokenCache permission bitmask", "[TokenCache]")
+{
+    initConfig();
+    auto security = testSecurity();
+
+    const auto viewBit = Security::permissionBit(PERMISSION_KEY_view_app);
+    const auto regBit = Security::permissionBit(PERMISSION_KEY_app_reg);
+    const auto controlBit = Security::permissionBit(PERMISSION_KEY_app_control);
+    REQUIRE(viewBit >= 0);
+    REQUIRE(regBit >= 0);
+    REQUIRE(viewBit != regBit);
+    REQUIRE(Security::permissionBit("no-such-permission") == -1);
+
+    // unknown permission is not compiled into mask
+    const auto mask = security->getUserPermissionMask("user1", "");
+    REQUIRE(mask == ((uint64_t(1) << viewBit) | (uint64_t(1) << regBit)));
+
+    const auto entry = tokenEntry("token1", "user1", mask);
+    REQUIRE(entry->hasPermission(viewBit));
+    REQUIRE(entry->hasPermission(regBit));
+    REQUIRE_FALSE(entry->hasPermission(controlBit));
+    REQUIRE_FALSE(entry->hasPermission(-1));
+    REQUIRE_FALSE(entry->hasPermission(64));
+}
+
+TEST_CASE("TokenCache invalidation", "[TokenCache]")
+{
+    initConfig();
+    Security::instance(testSecurity());
+    auto cache = TokenCache::instance();
+    REQUIRE(cache->size() == 0);
+    cache->put(tokenEntry("token1", "user1"));
+    cache->put(tokenEntry("token2", "user2"));
+
+    SECTION("user lock")
+    {
+        Security::instance()->getUserInfo("user1")->lock();
+        REQUIRE(cache->get("token1") == nullptr);
+        REQUIRE(cache->get("token2") != nullptr);
+        Security::instance()->getUserInfo("user1")->unlock();
+    }
+
+    SECTION("password change")
+    {
+        Security::instance()->changeUserPasswd("user2", "new-pwd");
+        REQUIRE(cache->get("token2") == nullptr);
+        REQUIRE(cache->get("token1") != nullptr);
+    }
+
+    SECTION("role change")
+    {
+        Security::instance()->addRole(web::json::value::parse(R"(["app-view"])"), "viewer");
+        REQUIRE(cache->size() == 0);
+    }
+
+    SECTION("JWT salt change")
+    {
+        const auto salt = Configuration::instance()->getJwt()->m_jwtSalt;
+        auto update = web::json::value::parse(R"({"REST": {"JWT": {}}})");
+
+        // same salt keep cache
+        update[JSON_KEY_REST][JSON_KEY_JWT][JSON_KEY_JWTSalt] = web::json::value::string(salt);
+        Configuration::instance()->hotUpdate(update);
+        REQUIRE(cache->size() == 2);
+
+        update[JSON_KEY_REST][JSON_KEY_JWT][JSON_KEY_JWTSalt] = web::json::value::string(salt + "-changed");
+        Configuration::instance()->hotUpdate(update);
+        REQUIRE(cache->size() == 0);
+    }
+}
@@ -7,6 +7,8 @@
 #include <time.h>
 #include <set>
 #include <fstream>
+#include <cstdio>
+#include <iterator>
 #include <ace/Init_ACE.h>
 #include <ace/OS.h>
 #include <cpprest/json.h>
@@ -19,6 +21,7 @@
 #include <log4cpp/OstreamAppender.hh>
 #include "../../src/common/DateTime.h"
 #include "../../src/common/Utility.h"
+#include "../../src/daemon/rest/FileTransfer.h"
 
 void init()
 {
@@ -150,3 +153,76 @@ TEST_CASE("cpprestsdk", "[Utility]")
     LOG_INF << "web::json::value: " << a;
     LOG_INF << "web::json::value: " << a.serialize();
 }
+
+TEST_CASE("FileTransfer Range", "[Utility]")
+{
+    init();
+
+    std::size_t start = 0, length = 0;
+    REQUIRE(FileTransfer::parseRange("bytes=0-99", 1000, start, length));
+    REQUIRE((start == 0 && length == 100));
+    REQUIRE(FileTransfer::parseRange("bytes=900-", 1000, start, length));
+    REQUIRE((start == 900 && length == 100));
+    REQUIRE(FileTransfer::parseRange("bytes=-100", 1000, start, length));
+    REQUIRE((start == 900 && length == 100));
+    REQUIRE(FileTransfer::parseRange("bytes=0-4095", 1000, start, length));
+    REQUIRE((start == 0 && length == 1000));
+    REQUIRE_FALSE(FileTransfer::parseRange("bytes=1000-", 1000, start, length));
+    REQUIRE_FALSE(FileTransfer::parseRange("bytes=0-1,5-9", 1000, start, length));
+    REQUIRE_FALSE(FileTransfer::parseRange("items=0-1", 1000, start, length));
+
+    const std::string etag = "\"1000-1600000000\"";
+    bool partial = false;
+    std::map<std::string, std::string> headers = {{HTTP_HEADER_KEY_range, "bytes=0-99"}};
+    REQUIRE(FileTransfer::resolveRange(headers, etag, 1000, start, length, partial));
+    REQUIRE((partial && start == 0 && length == 100));
+
+    // If-Range mismatch reply whole file
+    headers[HTTP_HEADER_KEY_if_range] = "\"1000-1\"";
+    REQUIRE(FileTransfer::resolveRange(headers, etag, 1000, start, length, partial));
+    REQUIRE((!partial && start == 0 && length == 1000));
+
+    // appc get always request the first chunk, empty file reply whole (empty) content
+    headers = {{HTTP_HEADER_KEY_range, "bytes=0-1023"}};
+    REQUIRE(FileTransfer::resolveRange(headers, etag, 0, start, length, partial));
+    REQUIRE((!partial && start == 0 && length == 0));
+
+    headers = {{HTTP_HEADER_KEY_range, "bytes=2000-"}};
+    REQUIRE_FALSE(FileTransfer::resolveRange(headers, etag, 1000, start, length, partial));
+}
+
+TEST_CASE("FileTransfer chunk upload", "[Utility]")
+{
+    init();
+
+    const std::string path = "/tmp/appmesh_test_upload.bin";
+    std::remove(path.c_str());
+    std::remove((path + FILE_UPLOAD_PART_SUFFIX).c_str());
+    std::remove((path + FILE_UPLOAD_INDEX_SUFFIX).c_str());
+
+    // offset + length wrap around is rejected
+    REQUIRE_THROWS_AS(FileTransfer::writeChunk(path, static_cast<std::size_t>(-1), 8, "a", "ab", 2), std::invalid_argument);
+    REQUIRE_THROWS_AS(FileTransfer::writeChunk(path, 6, 8, "a", "abc", 3), std::invalid_argument);
+
+    // first chunk of file "a"
+    REQUIRE_FALSE(FileTransfer::writeChunk(path, 0, 8, "a", "AAAA", 4));
+    std::size_t fileSize = 0;
+    std::string fileChecksum;
+    auto ranges = FileTransfer::receivedRanges(path, fileSize, fileChecksum);
+    REQUIRE((fileSize == 8 && fileChecksum == "a"));
+    REQUIRE(ranges == FileTransfer::Ranges({{0, 4}}));
+
+    // another file with the same size restart the upload, old chunk is dropped
+    REQUIRE_FALSE(FileTransfer::writeChunk(path, 4, 8, "b", "bbbb", 4));
+    ranges = FileTransfer::receivedRanges(path, fileSize, fileChecksum);
+    REQUIRE((fileSize == 8 && fileChecksum == "b"));
+    REQUIRE(ranges == FileTransfer::Ranges({{4, 4}}));
+
+    REQUIRE(FileTransfer::writeChunk(path, 0, 8, "b", "BBBB", 4));
+    REQUIRE(FileTransfer::receivedRanges(path, fileSize, fileChecksum).empty());
+    std::ifstream stream(path, std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    REQUIRE(content == "BBBBbbbb");
+    REQUIRE_FALSE(Utility::isFileExist(path + FILE_UPLOAD_PART_SUFFIX));
+    std::remove(path.c_str());
+}